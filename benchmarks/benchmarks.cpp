@@ -0,0 +1,212 @@
+// Benchmarks of the QCustomPlot hot paths, one data-driven slot per function, the rows are data sizes
+#include <QtTest>
+#include <random>
+#include "qcustomplot.h"
+
+//exposes the protected line pipeline of QCPGraph
+class BenchmarkGraph : public QCPGraph
+{
+public:
+    BenchmarkGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) : QCPGraph(keyAxis, valueAxis) {}
+    using QCPGraph::getOptimizedLineData;
+    using QCPGraph::dataToLines;
+};
+
+class Benchmarks : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void addSizeRows();
+    static QVector<QCPGraphData> noisySine(int size);
+
+private slots:
+    void getOptimizedLineData_data();
+    void getOptimizedLineData();
+    void dataToLines_data();
+    void dataToLines();
+    void unsortedAdd_data();
+    void unsortedAdd();
+    void findBegin_data();
+    void findBegin();
+    void colorize_data();
+    void colorize();
+    void tickerGenerate_data();
+    void tickerGenerate();
+    void headlessReplot_data();
+    void headlessReplot();
+};
+
+void Benchmarks::addSizeRows()
+{
+    QTest::addColumn<int>("size");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("10M") << 10000000;
+    QTest::newRow("100M") << 100000000;
+}
+
+QVector<QCPGraphData> Benchmarks::noisySine(int size)
+{
+    //sorted keys from 0 to size-1, so benchmarks with equal sizes see equal data
+    QVector<QCPGraphData> data(size);
+    std::mt19937 generator(1);
+    std::normal_distribution<double> noise(0, 0.1);
+    for (int i = 0; i < size; i++)
+        data[i] = QCPGraphData(i, qSin(i/1000.0) + noise(generator));
+    return data;
+}
+
+void Benchmarks::getOptimizedLineData_data()
+{
+    addSizeRows();
+}
+
+void Benchmarks::getOptimizedLineData()
+{
+    QFETCH(int, size);
+    QCustomPlot plot;
+    plot.resize(800, 600);
+    BenchmarkGraph *graph = new BenchmarkGraph(plot.xAxis, plot.yAxis);
+    graph->data()->set(noisySine(size), true);
+    plot.xAxis->setRange(0, size);
+    plot.yAxis->setRange(-1.5, 1.5);
+    plot.replot(); //lays out the axis rect, so the pixel range is known
+    QCPGraphDataContainer::const_iterator begin = graph->data()->constBegin();
+    QCPGraphDataContainer::const_iterator end = graph->data()->constEnd();
+    QVector<QCPGraphData> lineData;
+    QBENCHMARK {
+        graph->getOptimizedLineData(&lineData, begin, end);
+    }
+    QVERIFY(!lineData.isEmpty());
+}
+
+void Benchmarks::dataToLines_data()
+{
+    addSizeRows();
+}
+
+void Benchmarks::dataToLines()
+{
+    QFETCH(int, size);
+    QCustomPlot plot;
+    plot.resize(800, 600);
+    BenchmarkGraph *graph = new BenchmarkGraph(plot.xAxis, plot.yAxis);
+    plot.xAxis->setRange(0, size);
+    plot.yAxis->setRange(-1.5, 1.5);
+    plot.replot();
+    const QVector<QCPGraphData> data = noisySine(size);
+    QVector<QPointF> lines;
+    QBENCHMARK {
+        lines = graph->dataToLines(data);
+    }
+    QCOMPARE(lines.size(), size);
+}
+
+void Benchmarks::unsortedAdd_data()
+{
+    addSizeRows();
+}
+
+void Benchmarks::unsortedAdd()
+{
+    QFETCH(int, size);
+    QVector<QCPGraphData> data = noisySine(size);
+    std::shuffle(data.begin(), data.end(), std::mt19937(2));
+    QCPGraphDataContainer container;
+    QBENCHMARK {
+        container.clear();
+        container.add(data, false);
+    }
+    QCOMPARE(container.size(), size);
+}
+
+void Benchmarks::findBegin_data()
+{
+    addSizeRows();
+}
+
+void Benchmarks::findBegin()
+{
+    QFETCH(int, size);
+    QCPGraphDataContainer container;
+    container.set(noisySine(size), true);
+    //many lookups per iteration, a single binary search is below the timer resolution
+    const int lookups = 10000;
+    QVector<double> keys(lookups);
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> key(0, size);
+    for (int i = 0; i < lookups; i++)
+        keys[i] = key(generator);
+    qint64 found = 0;
+    QBENCHMARK {
+        for (int i = 0; i < lookups; i++)
+            found += container.findBegin(keys.at(i)) - container.constBegin();
+    }
+    QVERIFY(found > 0);
+}
+
+void Benchmarks::colorize_data()
+{
+    addSizeRows();
+}
+
+void Benchmarks::colorize()
+{
+    QFETCH(int, size);
+    QCPColorGradient gradient(QCPColorGradient::gpJet);
+    QVector<double> data(size);
+    for (int i = 0; i < size; i++)
+        data[i] = qSin(i/1000.0);
+    QVector<QRgb> scanLine(size);
+    QBENCHMARK {
+        gradient.colorize(data.constData(), QCPRange(-1, 1), scanLine.data(), size);
+    }
+    QVERIFY(scanLine.first() != 0);
+}
+
+void Benchmarks::tickerGenerate_data()
+{
+    //the size of a ticking is its number of ticks; beyond 100k ticks the tick labels alone exhaust the memory
+    QTest::addColumn<int>("size");
+    QTest::newRow("10") << 10;
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("100k") << 100000;
+}
+
+void Benchmarks::tickerGenerate()
+{
+    QFETCH(int, size);
+    QCPAxisTicker ticker;
+    ticker.setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    ticker.setTickCount(size);
+    const QCPRange range(0, size);
+    QVector<double> ticks, subTicks;
+    QVector<QString> tickLabels;
+    QBENCHMARK {
+        ticker.generate(range, QLocale::c(), QLatin1Char('g'), 6, ticks, &subTicks, &tickLabels);
+    }
+    QVERIFY(!ticks.isEmpty());
+}
+
+void Benchmarks::headlessReplot_data()
+{
+    addSizeRows();
+}
+
+void Benchmarks::headlessReplot()
+{
+    QFETCH(int, size);
+    //never shown, so the replot only renders into the paint buffers
+    QCustomPlot plot;
+    plot.resize(800, 600);
+    QCPGraph *graph = plot.addGraph();
+    graph->data()->set(noisySine(size), true);
+    plot.rescaleAxes();
+    QBENCHMARK {
+        plot.replot(QCustomPlot::rpImmediateRefresh);
+    }
+}
+
+QTEST_MAIN(Benchmarks)
+#include "benchmarks.moc"
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# QtTest benchmarks of the QCustomPlot hot paths.
+# Run them before and after a library upgrade and compare, e.g.
+#   ./benchmarks -o results.xml,xml -o results.csv,csv
+# Single functions or sizes are selected as usual with QtTest, e.g.
+#   ./benchmarks getOptimizedLineData:10M
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+
+TARGET = benchmarks
+TEMPLATE = app
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += benchmarks.cpp \
+        ../qcustomplot.cpp
+
+HEADERS  += ../qcustomplot.h
@@ -5,7 +5,7 @@
 #-------------------------------------------------
 
 QT       += core gui
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport concurrent
 
 TARGET = graph-editor
 TEMPLATE = app
@@ -19,3 +19,6 @@ HEADERS  += mainwindow.h \
 
 FORMS    += mainwindow.ui
 CONFIG += c++11
+# enable to record replot timings (QCustomPlot::replotProfiler):
+# DEFINES += QCUSTOMPLOT_PROFILE_REPLOT
+# benchmarks of the library hot paths are a separate QtTest project: benchmarks/benchmarks.pro
@@ -2,10 +2,302 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QMap>
+#include <QActionGroup>
 #include <QList>
 #include "float.h"
 #include <math.h>
 #include <random>
+#include <QtConcurrent>
+
+//histograms of fewer values aren't split across threads
+static const int minimumHistogramChunk = 65536;
+
+//counts spans of measurements into bins on a worker thread, every task fills its own partial histogram
+class HistogramTask : public QRunnable
+{
+public:
+    HistogramTask(const QVector<QPair<const double*, int>> &spans, double lower, double scale, bool logarithmic, QVector<double> *counts, QSemaphore *done) :
+        spans(spans), lower(lower), scale(scale), logarithmic(logarithmic), counts(counts), done(done)
+    {
+    }
+
+    void run() override
+    {
+        int bins = counts->length();
+        double *binCounts = counts->data();
+        QVector<double> positions;
+        for (int s = 0; s < spans.length(); s++)
+        {
+            const double *values = spans[s].first;
+            int n = spans[s].second;
+            positions.resize(n);
+            double *position = positions.data();
+            //bin positions first, without branches so the compiler can vectorize the loop
+            if (logarithmic)
+            {
+                for (int k = 0; k < n; k++)
+                    position[k] = (log10(values[k]) - lower) * scale;
+            } else
+            {
+                for (int k = 0; k < n; k++)
+                    position[k] = (values[k] - lower) * scale;
+            }
+            //NaN, and on log bins non-positive values, fail the comparison; the maximum may round slightly above bins
+            for (int k = 0; k < n; k++)
+            {
+                if (position[k] >= 0 && position[k] < bins + 1)
+                    binCounts[qMin(int(position[k]), bins - 1)] += 1;
+            }
+        }
+        if (done)
+            done->release();
+    }
+
+private:
+    QVector<QPair<const double*, int>> spans;
+    double lower, scale;
+    bool logarithmic;
+    QVector<double> *counts;
+    QSemaphore *done;
+};
+
+//summarizes spans of measurements on a worker thread, every task fills its own sketch
+class SketchTask : public QRunnable
+{
+public:
+    SketchTask(const QVector<QPair<const double*, int>> &spans, QCPQuantileSketch *sketch, QSemaphore *done) :
+        spans(spans), sketch(sketch), done(done)
+    {
+    }
+
+    void run() override
+    {
+        for (int s = 0; s < spans.length(); s++)
+        {
+            for (int k = 0; k < spans[s].second; k++)
+                sketch->addValue(spans[s].first[k]);
+        }
+        if (done)
+            done->release();
+    }
+
+private:
+    QVector<QPair<const double*, int>> spans;
+    QCPQuantileSketch *sketch;
+    QSemaphore *done;
+};
+
+//cuts spans of measurements into one chunk per thread, fewer chunks if there are few values
+static QVector<QVector<QPair<const double*, int>>> splitSpans(const QVector<QPair<const double*, int>> &spans)
+{
+    qint64 total = 0;
+    for (int s = 0; s<spans.length(); s++)
+        total += spans[s].second;
+    int chunks = int(qMax(qint64(1), qMin(qint64(QThread::idealThreadCount()), total/minimumHistogramChunk)));
+    QVector<QVector<QPair<const double*, int>>> chunkSpans(chunks);
+    qint64 offset = 0;
+    int chunk = 0;
+    for (int s = 0; s<spans.length(); s++)
+    {
+        int start = 0;
+        while (start < spans[s].second)
+        {
+            qint64 chunkEnd = (chunk+1)*total/chunks;
+            if (offset >= chunkEnd)
+            {
+                chunk++;
+                continue;
+            }
+            int take = int(qMin(qint64(spans[s].second - start), chunkEnd - offset));
+            chunkSpans[chunk].append(qMakePair(spans[s].first + start, take));
+            start += take;
+            offset += take;
+        }
+    }
+    return chunkSpans;
+}
+
+//number of resampled means per point for the bootstrap intervals
+static const int bootstrapResamples = 1000;
+
+//resamples the rows [begin, end) of graphdata on a worker thread, every task draws from its own random stream
+class BootstrapTask : public QRunnable
+{
+public:
+    BootstrapTask(const QVector<QVector<double>> *rows, int begin, int end, unsigned int seed, double *lower, double *upper, QSemaphore *done) :
+        rows(rows), begin(begin), end(end), seed(seed), lower(lower), upper(upper), done(done)
+    {
+    }
+
+    void run() override
+    {
+        std::mt19937 generator(seed);
+        QVector<double> means(bootstrapResamples);
+        int lowIndex = int(0.025 * (bootstrapResamples - 1));
+        int highIndex = int(0.975 * (bootstrapResamples - 1));
+        for (int i = begin; i < end; i++)
+        {
+            //column 0 of a row is x
+            const double *values = rows->at(i).constData() + 1;
+            int n = rows->at(i).length() - 1;
+            if (n < 2)
+            {
+                lower[i] = upper[i] = (n == 1) ? values[0] : NAN;
+                continue;
+            }
+            for (int b = 0; b < bootstrapResamples; b++)
+            {
+                double sum = 0;
+                for (int k = 0; k < n; k++)
+                    sum += values[(quint64(generator()) * n) >> 32]; //uniform index without division
+                means[b] = sum / n;
+            }
+            std::nth_element(means.begin(), means.begin() + lowIndex, means.end());
+            lower[i] = means[lowIndex];
+            std::nth_element(means.begin() + lowIndex, means.begin() + highIndex, means.end());
+            upper[i] = means[highIndex];
+        }
+        if (done)
+            done->release();
+    }
+
+private:
+    const QVector<QVector<double>> *rows;
+    int begin, end;
+    unsigned int seed;
+    double *lower, *upper;
+    QSemaphore *done;
+};
+
+static double studentCoefficient(int n)
+{
+    //Student coefficient for n measurements and confidence 0.95 (two-sided), n-1 degrees of freedom
+    static const double table[30] = {12.7062, 4.3027, 3.1824, 2.7764, 2.5706, 2.4469, 2.3646, 2.3060, 2.2622, 2.2281,
+                                     2.2010, 2.1788, 2.1604, 2.1448, 2.1314, 2.1199, 2.1098, 2.1009, 2.0930, 2.0860,
+                                     2.0796, 2.0739, 2.0687, 2.0639, 2.0595, 2.0555, 2.0518, 2.0484, 2.0452, 2.0423};
+    int df = n - 1;
+    if (df < 1)
+        return NAN;
+    if (df <= 30)
+        return table[df - 1];
+    //Cornish-Fisher expansion around the normal quantile, better than 1e-4 above 30 degrees of freedom
+    double z = 1.959963984540054;
+    double z3 = z*z*z, z5 = z3*z*z, z7 = z5*z*z;
+    return z + (z3 + z)/(4*df) + (5*z5 + 16*z3 + 3*z)/(96.0*df*df) + (3*z7 + 19*z5 + 17*z3 - 15*z)/(384.0*df*df*df);
+}
+
+//Student interval of the mean of n measurements, without touching any widget so it can run on worker threads;
+//the mean and the standard error of the mean are returned through the pointers that aren't null
+static double studentInterval(const double *values, int n, double *mean, double *meanSquaredError)
+{
+    if (n < 2)
+        return 0;
+    double sum = 0, squaredErrorsSum = 0;
+    for (int k = 0; k < n; k++)
+        sum += values[k];
+    double average = sum / n;
+    for (int k = 0; k < n; k++)
+        squaredErrorsSum += (average - values[k]) * (average - values[k]);
+    double error = sqrt(squaredErrorsSum / (double(n) * (n - 1)));
+    if (mean)
+        *mean = average;
+    if (meanSquaredError)
+        *meanSquaredError = error;
+    return error * studentCoefficient(n); //надежность 0,95
+}
+
+//recomputes the Student intervals of the rows [begin, end) of graphdata around the given means on a worker thread
+class StudentTask : public QRunnable
+{
+public:
+    StudentTask(const QVector<QVector<double>> *rows, int begin, int end, const double *mean, double *student, double *lower, double *upper, QSemaphore *done) :
+        rows(rows), begin(begin), end(end), mean(mean), student(student), lower(lower), upper(upper), done(done)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = begin; i < end; i++)
+        {
+            //column 0 of a row is x
+            double interval = studentInterval(rows->at(i).constData() + 1, rows->at(i).length() - 1, 0, 0);
+            student[i] = interval;
+            lower[i] = mean[i] - interval;
+            upper[i] = mean[i] + interval;
+        }
+        if (done)
+            done->release();
+    }
+
+private:
+    const QVector<QVector<double>> *rows;
+    int begin, end;
+    const double *mean;
+    double *student, *lower, *upper;
+    QSemaphore *done;
+};
+
+//percentile bootstrap interval of the mean of every point, chunks of points are resampled in parallel
+static Intervals calculateBootstrap(const QVector<QVector<double>> &graphdata, unsigned int seed)
+{
+    Intervals result;
+    int rows = graphdata.length();
+    if (rows == 0)
+        return result;
+    result.student.resize(rows);
+    result.lower.resize(rows);
+    result.upper.resize(rows);
+    double *lower = result.lower.data();
+    double *upper = result.upper.data();
+    int chunks = qBound(1, QThread::idealThreadCount(), rows);
+    QSemaphore chunksDone;
+    for (int chunk = 1; chunk < chunks; chunk++)
+        QThreadPool::globalInstance()->start(new BootstrapTask(&graphdata, chunk*rows/chunks, (chunk+1)*rows/chunks, seed + chunk, lower, upper, &chunksDone));
+    BootstrapTask(&graphdata, 0, rows/chunks, seed, lower, upper, 0).run(); //first chunk on this thread
+    chunksDone.acquire(chunks - 1);
+    for (int i = 0; i<rows; i++)
+    {
+        result.student[i] = (upper[i] - lower[i]) / 2;
+    }
+    return result;
+}
+
+//Student interval of every point around its mean, chunks of points are computed in parallel
+static Intervals calculateStudentIntervals(const QVector<QVector<double>> &graphdata, const QVector<double> &means)
+{
+    Intervals result;
+    int rows = graphdata.length();
+    if (rows == 0)
+        return result;
+    result.student.resize(rows);
+    result.lower.resize(rows);
+    result.upper.resize(rows);
+    const double *mean = means.constData();
+    double *student = result.student.data();
+    double *lower = result.lower.data();
+    double *upper = result.upper.data();
+    int chunks = qBound(1, QThread::idealThreadCount(), rows);
+    QSemaphore chunksDone;
+    for (int chunk = 1; chunk < chunks; chunk++)
+        QThreadPool::globalInstance()->start(new StudentTask(&graphdata, chunk*rows/chunks, (chunk+1)*rows/chunks, mean, student, lower, upper, &chunksDone));
+    StudentTask(&graphdata, 0, rows/chunks, mean, student, lower, upper, 0).run(); //first chunk on this thread
+    chunksDone.acquire(chunks - 1);
+    return result;
+}
+
+//runs on a pool thread through QtConcurrent, the rows and means are copies so the GUI thread may replace the graph meanwhile
+static Intervals calculateIntervals(QVector<QVector<double>> graphdata, QVector<double> means, bool bootstrap, unsigned int seed)
+{
+    if (bootstrap)
+        return calculateBootstrap(graphdata, seed);
+    return calculateStudentIntervals(graphdata, means);
+}
+
+//orders rows of graphdata by x, their column 0
+static bool rowLessThan(const QVector<double> &a, const QVector<double> &b)
+{
+    return a.at(0) < b.at(0);
+}
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -14,7 +306,16 @@ MainWindow::MainWindow(QWidget *parent) :
     srand(QDateTime::currentDateTime().toTime_t());
     ui->setupUi(this);
 
+    // replots requested by the slots below are coalesced into frames shared by both plots:
+    replotScheduler = new QCPReplotScheduler(this);
+    ui->customPlot->setReplotScheduler(replotScheduler);
+    ui->plotDistribution->setReplotScheduler(replotScheduler);
+
     ui->customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectAxes | QCP::iSelectPlottables);
+    // graphs get their own paint buffer, so dragging can scroll it instead of redrawing all points:
+    ui->customPlot->layer("main")->setMode(QCPLayer::lmBuffered);
+    ui->customPlot->setPlottingHint(QCP::phBlitDrag);
+    ui->customPlot->setPlottingHint(QCP::phProgressiveZoom);
     ui->customPlot->xAxis->setRange(0, 10);
     ui->customPlot->yAxis->setRange(-1, 11);
     ui->customPlot->axisRect()->setupFullAxesBox();
@@ -53,19 +354,36 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->actionOpen, SIGNAL(triggered(bool)), this, SLOT(loadGraph()));
     connect(ui->actionScreenshot, SIGNAL(triggered(bool)), this, SLOT(saveScreenshot()));
     connect(ui->actionAddRandom, SIGNAL(triggered(bool)), this, SLOT(addRandomGraph()));
+    connect(ui->actionBootstrap, SIGNAL(toggled(bool)), this, SLOT(setBootstrapIntervals(bool)));
+    connect(&MainWindow::intervalWatcher, SIGNAL(finished()), this, SLOT(intervalsCalculated()));
+    connect(ui->actionDistributionAll, SIGNAL(triggered(bool)), this, SLOT(showAllDistribution()));
+    QActionGroup *binModes = new QActionGroup(this);
+    binModes->addAction(ui->actionBinsFixed);
+    binModes->addAction(ui->actionBinsFreedmanDiaconis);
+    binModes->addAction(ui->actionBinsLog);
+    connect(binModes, SIGNAL(triggered(QAction*)), this, SLOT(binModeChanged()));
 }
 
 MainWindow::~MainWindow()
 {
+    //the running calculation only touches its own copies, but it must not outlive the pool at exit
+    MainWindow::intervalWatcher.waitForFinished();
     delete ui;
 }
 
 void MainWindow::graphDoubleClick(QCPAbstractPlottable *plottable, int dataIndex)
 {
+    //only indices of the band are rows of graphdata, the boxes also report clicks but index their own sorted container
+    if (!qobject_cast<QCPBand*>(plottable))
+        return;
     double dataValue = plottable->interface1D()->dataMainValue(dataIndex);
     double dataKey = plottable->interface1D()->dataMainKey(dataIndex);
     ui->label_point->setText("Значение в выбранной точке: x = "+QString::number(dataKey)+" y = "+QString::number(dataValue));
-    MainWindow::calculateStudent(MainWindow::currentGraph.graphdata[dataIndex]);
+    //column 0 of a row is x, the measurements follow
+    MainWindow::calculateStudent(MainWindow::currentGraph.graphdata[dataIndex].mid(1));
+    //show the distribution of the clicked point
+    MainWindow::distributionRow = dataIndex;
+    plotDistrPlot();
 }
 
 void MainWindow::saveScreenshot()
@@ -148,18 +466,28 @@ void MainWindow::loadGraph()
             analytics_offset = 4; //+1 because of "\n"
         }
         //read data massive
-        //while not eos read line
-        QVector<double> y_values;
+        //while not eos read line, every row is x followed by the measurements
+        QVector<QVector<double>> rows;
         while (!file.atEnd())
         {
             QString line = file.readLine();
             QStringList line_list = line.split(';');
-            y_values.clear();
-            double x = line_list[0].replace(",", ".").toDouble();
+            QVector<double> row;
+            row.append(line_list[0].replace(",", ".").toDouble());
             for (int i = 1; i<(line_list.length()-analytics_offset); i++)
             {
-                y_values.append(line_list[i].replace(",", ".").toDouble());
+                row.append(line_list[i].replace(",", ".").toDouble());
             }
+            rows.append(row);
+        }
+        file.close();
+        //the plot renders the columns in place and needs them sorted by x, a hand-edited file may not be
+        std::stable_sort(rows.begin(), rows.end(), rowLessThan);
+        QVector<double> y_values;
+        for (int r = 0; r<rows.length(); r++)
+        {
+            double x = rows[r][0];
+            y_values = rows[r].mid(1);
             MainWindow::currentGraph.x.append(x);
             double y = calculateExpectedValue(y_values);
             double student = calculateStudent(y_values);
@@ -167,8 +495,9 @@ void MainWindow::loadGraph()
             MainWindow::currentGraph.y_mean.append(y);
             MainWindow::currentGraph.y_min.append(y - student);
             MainWindow::currentGraph.y_max.append(y + student);
+            //keep the raw row like addRandomGraph does, x first
+            MainWindow::currentGraph.graphdata.append(rows[r]);
         }
-        file.close();
         MainWindow::addGraph();
     }
 }
@@ -184,7 +513,7 @@ void MainWindow::titleDoubleClick(QMouseEvent* event)
         if (ok)
         {
             title->setText(newTitle);
-            ui->customPlot->replot();
+            ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
         }
     }
 }
@@ -199,7 +528,7 @@ void MainWindow::axisLabelDoubleClick(QCPAxis *axis, QCPAxis::SelectablePart par
         if (ok)
         {
             axis->setLabel(newLabel);
-            ui->customPlot->replot();
+            ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
         }
     }
 }
@@ -260,9 +589,69 @@ void MainWindow::mouseWheel()
 
 void MainWindow::plotDistrPlot()
 {
+    //distribution of the selected point's measurements, or of all measurements if no point is selected;
+    //range and quartiles come from a sketch of the values that only lives while the plot is computed
+    int rows = MainWindow::currentGraph.graphdata.length();
+    if (MainWindow::distributionRow >= rows)
+        MainWindow::distributionRow = -1;
+    QVector<QPair<const double*, int>> spans;
+    for (int i = 0; i<rows; i++)
+    {
+        if (MainWindow::distributionRow >= 0 && i != MainWindow::distributionRow)
+            continue;
+        //column 0 of a row is x
+        spans.append(qMakePair(MainWindow::currentGraph.graphdata.at(i).constData() + 1, MainWindow::currentGraph.graphdata.at(i).length() - 1));
+    }
+    QCPQuantileSketch distribution = calculateDistribution(spans);
+    MainWindow::currentGraph.xd.clear();
+    MainWindow::currentGraph.yd.clear();
+    bool logarithmic = MainWindow::binMode == bmLog;
+    if (logarithmic && !distribution.isEmpty() && distribution.minimum() <= 0)
+    {
+        ui->statusBar->showMessage("Логарифмические интервалы только для положительных значений", 3000);
+        logarithmic = false;
+    }
+    if (!distribution.isEmpty() && distribution.maximum() > distribution.minimum())
+    {
+        //bins are equal on the scale of the plot, which is log10 of the values for logarithmic bins
+        QCPRange range(distribution.minimum(), distribution.maximum());
+        double q1 = distribution.quantile(0.25), q3 = distribution.quantile(0.75);
+        if (logarithmic)
+        {
+            range = QCPRange(log10(range.lower), log10(range.upper));
+            q1 = log10(q1); //quantiles keep their order under log10, so these are the quartiles of the log10 values
+            q3 = log10(q3);
+        }
+        int bins = MainWindow::binCount;
+        if (MainWindow::binMode == bmFreedmanDiaconis || logarithmic)
+        {
+            //bin width 2*IQR/cbrt(n), on the same scale as the range
+            double iqr = q3 - q1;
+            if (iqr > 0)
+                bins = qBound(1, int(ceil(range.size() / (2 * iqr * pow(double(distribution.count()), -1.0/3)))), 1000);
+        }
+        QVector<double> counts = calculateHistogram(spans, range, bins, logarithmic);
+        double delta = range.size() / bins;
+        for (int i = 0; i<bins; i++)
+        {
+            double center = range.lower + i*delta + delta/2;
+            MainWindow::currentGraph.xd.append(logarithmic ? pow(10, center) : center);
+            MainWindow::currentGraph.yd.append(counts[i] / distribution.count());
+        }
+    }
+    //a logarithmic axis needs the log ticker for ticks at powers of ten
+    if (logarithmic)
+    {
+        ui->plotDistribution->xAxis->setScaleType(QCPAxis::stLogarithmic);
+        ui->plotDistribution->xAxis->setTicker(QSharedPointer<QCPAxisTickerLog>(new QCPAxisTickerLog));
+    } else
+    {
+        ui->plotDistribution->xAxis->setScaleType(QCPAxis::stLinear);
+        ui->plotDistribution->xAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+    }
     ui->plotDistribution->clearGraphs();
     ui->plotDistribution->addGraph();
-    ui->plotDistribution->graph()->setData(MainWindow::currentGraph.xd, MainWindow::currentGraph.yd);
+    ui->plotDistribution->graph()->setDataSource(QSharedPointer<QCPGraphDataSource>(new QCPVectorGraphDataSource(&MainWindow::currentGraph.xd, &MainWindow::currentGraph.yd)));
     QCPScatterStyle scatter;
     scatter.setShape(QCPScatterStyle::ssCircle);
     scatter.setPen(QPen(Qt::blue));
@@ -272,46 +661,51 @@ void MainWindow::plotDistrPlot()
     ui->plotDistribution->graph()->setScatterStyle(QCPScatterStyle(scatter));
     ui->plotDistribution->graph()->setSelectable(QCP::stSingleData);
     ui->plotDistribution->rescaleAxes();
-    ui->plotDistribution->replot();
+    ui->plotDistribution->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void MainWindow::addGraph()
 {
+    MainWindow::graphRevision++;
     MainWindow::currentGraph.plotted = true;
     MainWindow::title->setText(MainWindow::currentGraph.title);
     ui->customPlot->xAxis->setLabel(MainWindow::currentGraph.xaxisname);
     ui->customPlot->yAxis->setLabel(MainWindow::currentGraph.yaxisname);
-    //main
-    ui->customPlot->addGraph();
-    ui->customPlot->graph()->setData(MainWindow::currentGraph.x, MainWindow::currentGraph.y_mean);
+    //spread of the measurements of every point as boxes, exact quartiles from the rows (column 0 of a row is x)
+    QCPStatisticalBox *boxes = new QCPStatisticalBox(ui->customPlot->xAxis, ui->customPlot->yAxis);
+    boxes->data()->set(QCPStatisticalBox::samplesToBoxes(MainWindow::currentGraph.x, MainWindow::currentGraph.graphdata, 1));
+    if (MainWindow::currentGraph.x.length() > 1)
+    {
+        double step = (MainWindow::currentGraph.x.last() - MainWindow::currentGraph.x.first()) / (MainWindow::currentGraph.x.length() - 1);
+        boxes->setWidth(fabs(step) * 0.5);
+        boxes->setWhiskerWidth(fabs(step) * 0.25);
+    }
+    boxes->setPen(QPen(Qt::gray));
+    boxes->setWhiskerPen(QPen(Qt::gray, 1, Qt::DashLine));
+    boxes->setWhiskerBarPen(QPen(Qt::gray));
+    boxes->setMedianPen(QPen(Qt::darkGray, 2));
+    boxes->setSelectable(QCP::stNone);
+    //mean with the Student interval as one band, rendering the columns of currentGraph in place with a single search and sampling pass
+    QCPBand *band = new QCPBand(ui->customPlot->xAxis, ui->customPlot->yAxis);
+    MainWindow::bandSource = QSharedPointer<QCPBandDataSource>(new QCPVectorBandDataSource(&MainWindow::currentGraph.x, &MainWindow::currentGraph.y_mean, &MainWindow::currentGraph.y_min, &MainWindow::currentGraph.y_max));
+    band->setDataSource(MainWindow::bandSource);
     QCPScatterStyle scatter;
     scatter.setShape(QCPScatterStyle::ssCircle);
     scatter.setPen(QPen(Qt::blue));
     scatter.setBrush(Qt::white);
     scatter.setSize(5);
-    ui->customPlot->graph()->setScatterStyle(QCPScatterStyle(scatter));
-    ui->customPlot->graph()->setPen(QPen(Qt::darkMagenta));
-    ui->customPlot->graph()->setSelectable(QCP::stSingleData);
-    //min
-    scatter.setShape(QCPScatterStyle::ssCircle);
-    scatter.setPen(QPen(Qt::gray));
-    scatter.setBrush(Qt::white);
-    scatter.setSize(3);
-    ui->customPlot->addGraph();
-    ui->customPlot->graph()->setData(MainWindow::currentGraph.x, MainWindow::currentGraph.y_min);
-    ui->customPlot->graph()->setPen(QPen(Qt::gray));
-    ui->customPlot->graph()->setScatterStyle(QCPScatterStyle(scatter));
-    ui->customPlot->graph()->setSelectable(QCP::stSingleData);
-    //max
-    ui->customPlot->addGraph();
-    ui->customPlot->graph()->setData(MainWindow::currentGraph.x, MainWindow::currentGraph.y_max);
-    ui->customPlot->graph()->setPen(QPen(Qt::gray));
-    ui->customPlot->graph()->setScatterStyle(QCPScatterStyle(scatter));
-    ui->customPlot->graph()->setSelectable(QCP::stSingleData);
+    band->setScatterStyle(QCPScatterStyle(scatter));
+    band->setPen(QPen(Qt::darkMagenta));
+    band->setBoundsPen(QPen(Qt::gray));
+    band->setBrush(QColor(128, 128, 128, 40));
+    band->setSelectable(QCP::stSingleData);
     //plot
     ui->customPlot->rescaleAxes();
-    ui->customPlot->replot();
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
     plotDistrPlot();
+    //the band starts with the Student intervals of the loaded rows and switches to the bootstrap ones when they are ready
+    if (MainWindow::bootstrapIntervals)
+        startIntervals();
 }
 
 void MainWindow::addRandomGraph()
@@ -360,6 +754,8 @@ void MainWindow::removeAllGraphs()
     MainWindow::currentGraph.student.clear();
     MainWindow::currentGraph.y_min.clear();
     MainWindow::currentGraph.y_max.clear();
+    MainWindow::currentGraph.graphdata.clear();
+    MainWindow::distributionRow = -1;
     MainWindow::currentGraph.xd.clear();
     MainWindow::currentGraph.yd.clear();
     MainWindow::currentGraph.plotted = false;
@@ -367,10 +763,10 @@ void MainWindow::removeAllGraphs()
     ui->label_final->setText("Абсолютное значение с учетом Стьюдента: ");
     ui->label_percent->setText("Относительная погрешность: ");
     ui->label_point->setText("Значение в выбранной точке:");
-    ui->customPlot->clearGraphs();
-    ui->customPlot->replot();
+    ui->customPlot->clearPlottables();
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
     ui->plotDistribution->clearGraphs();
-    ui->plotDistribution->replot();
+    ui->plotDistribution->replot(QCustomPlot::rpQueuedReplot);
 }
 
 double MainWindow::calculateExpectedValue(QVector<double> values)
@@ -388,8 +784,6 @@ double MainWindow::calculateExpectedValue(QVector<double> values)
     }
     double delta = (max - min) / 10;
     double p[10];
-    MainWindow::currentGraph.yd.clear();
-    MainWindow::currentGraph.xd.clear();
     QMap<double, int> groups;;
     for(int i=0;i<10;i++)
     {
@@ -405,29 +799,6 @@ double MainWindow::calculateExpectedValue(QVector<double> values)
         if(i==0)
             temp++;
         p[i] = temp/(double)(values.length());
-        MainWindow::currentGraph.yd.append(p[i]);
-        MainWindow::currentGraph.xd.append(i);
-    }
-
-    for(int i=0;i<10;i++)
-    {
-        int temp = 0;
-        foreach(item, values)
-        {
-            if(item>min+i*delta && item<=min+(i+1)*delta)
-            {
-                temp++;
-                groups.insert(item, i);
-            }
-        }
-        if(i==0)
-            temp++;
-        p[i] = temp/(double)(values.length());
-        if(MainWindow::currentGraph.yd.length()<10)
-        {
-            MainWindow::currentGraph.yd.append(p[i]);
-            MainWindow::currentGraph.xd.append(i);
-        }
         result += (min + i*delta + delta/2) * p[i];
     }
     return result;
@@ -435,25 +806,11 @@ double MainWindow::calculateExpectedValue(QVector<double> values)
 
 double MainWindow::calculateStudent(QVector<double> values)
 {
-    double mean,sum,squaredErrorsSum=0,meanSquaredError;
+    double mean,meanSquaredError;
     int n=values.length();
-    double item;
-    foreach(item, values)
-    {
-        sum+=item;
-    }
-    mean = sum/n;
-
-    QList<double> errors;
-    foreach(item, values)
-    {
-        errors.append(mean-item);
-        squaredErrorsSum+=(mean-item)*(mean-item);
-    }
-
-    meanSquaredError = sqrt(squaredErrorsSum/(n*(n-1)));
-
-    double trustedInterval = meanSquaredError * 1.9840; //1.984 - Коэффициент для n=100 и надежности 0,95
+    if (n < 2)
+        return 0;
+    double trustedInterval = studentInterval(values.constData(), n, &mean, &meanSquaredError);
     double percentErrorInterval = fabs(trustedInterval/mean*100);
 
     ui->label_mean->setText(QString("Среднеквадратическое отклонение: ").append(QString::number(meanSquaredError)));
@@ -462,3 +819,102 @@ double MainWindow::calculateStudent(QVector<double> values)
 
     return trustedInterval;    
 }
+
+void MainWindow::setBootstrapIntervals(bool enabled)
+{
+    MainWindow::bootstrapIntervals = enabled;
+    if (not MainWindow::currentGraph.plotted)
+        return;
+    startIntervals();
+}
+
+void MainWindow::startIntervals()
+{
+    //a million points take seconds to resample, so the intervals are computed off the GUI thread and the toggle is locked meanwhile
+    if (MainWindow::intervalWatcher.isRunning())
+        return;
+    ui->actionBootstrap->setEnabled(false);
+    ui->statusBar->showMessage("Вычисление доверительных интервалов...");
+    MainWindow::intervalRevision = MainWindow::graphRevision;
+    unsigned int seed = QDateTime::currentDateTime().toTime_t();
+    MainWindow::intervalWatcher.setFuture(QtConcurrent::run(calculateIntervals, MainWindow::currentGraph.graphdata, MainWindow::currentGraph.y_mean, MainWindow::bootstrapIntervals, seed));
+}
+
+void MainWindow::intervalsCalculated()
+{
+    ui->actionBootstrap->setEnabled(true);
+    ui->statusBar->clearMessage();
+    if (not MainWindow::currentGraph.plotted)
+        return;
+    if (MainWindow::intervalRevision != MainWindow::graphRevision)
+    {
+        //the graph was replaced while computing, the new one has its Student intervals already
+        if (MainWindow::bootstrapIntervals)
+            startIntervals();
+        return;
+    }
+    Intervals result = MainWindow::intervalWatcher.result();
+    MainWindow::currentGraph.student = result.student;
+    MainWindow::currentGraph.y_min = result.lower;
+    MainWindow::currentGraph.y_max = result.upper;
+    //the band renders y_min and y_max in place, so a replot shows the new intervals and keeps the zoom
+    MainWindow::bandSource->dataChanged();
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void MainWindow::showAllDistribution()
+{
+    MainWindow::distributionRow = -1;
+    plotDistrPlot();
+}
+
+void MainWindow::binModeChanged()
+{
+    if (ui->actionBinsFreedmanDiaconis->isChecked())
+        MainWindow::binMode = bmFreedmanDiaconis;
+    else if (ui->actionBinsLog->isChecked())
+        MainWindow::binMode = bmLog;
+    else
+        MainWindow::binMode = bmFixed;
+    plotDistrPlot();
+}
+
+QVector<double> MainWindow::calculateHistogram(const QVector<QPair<const double*, int>> &spans, const QCPRange &range, int bins, bool logarithmic)
+{
+    //the values are cut into one chunk per thread, each counted into its own partial histogram, merged at the end
+    QVector<QVector<QPair<const double*, int>>> chunkSpans = splitSpans(spans);
+    int chunks = chunkSpans.length();
+    double scale = bins / range.size();
+    QVector<QVector<double>> partials(chunks, QVector<double>(bins, 0));
+    QSemaphore chunksDone;
+    for (int i = 1; i < chunks; i++)
+        QThreadPool::globalInstance()->start(new HistogramTask(chunkSpans[i], range.lower, scale, logarithmic, &partials[i], &chunksDone));
+    HistogramTask(chunkSpans[0], range.lower, scale, logarithmic, &partials[0], 0).run(); //first chunk on this thread
+    chunksDone.acquire(chunks - 1);
+
+    QVector<double> counts = partials[0];
+    for (int i = 1; i < chunks; i++)
+    {
+        for (int bin = 0; bin<bins; bin++)
+            counts[bin] += partials[i][bin];
+    }
+    return counts;
+}
+
+QCPQuantileSketch MainWindow::calculateDistribution(const QVector<QPair<const double*, int>> &spans)
+{
+    //range and quartiles of the values, every chunk is summarized into its own sketch, merged at the end
+    QVector<QVector<QPair<const double*, int>>> chunkSpans = splitSpans(spans);
+    int chunks = chunkSpans.length();
+    QVector<QCPQuantileSketch> partials(chunks);
+    QSemaphore chunksDone;
+    for (int i = 1; i < chunks; i++)
+        QThreadPool::globalInstance()->start(new SketchTask(chunkSpans[i], &partials[i], &chunksDone));
+    SketchTask(chunkSpans[0], &partials[0], 0).run(); //first chunk on this thread
+    chunksDone.acquire(chunks - 1);
+
+    QCPQuantileSketch distribution = partials[0];
+    for (int i = 1; i < chunks; i++)
+        distribution.merge(partials[i]);
+    return distribution;
+}
@@ -3,6 +3,7 @@
 
 #include <QMainWindow>
 #include <QInputDialog>
+#include <QFutureWatcher>
 #include "qcustomplot.h"
 
 struct Graph {
@@ -13,6 +14,11 @@ struct Graph {
     QVector<QVector<double>> graphdata;
 };
 
+//intervals of every point of a Graph, computed off the GUI thread and then copied into its columns
+struct Intervals {
+    QVector<double> student, lower, upper;
+};
+
 namespace Ui {
 class MainWindow;
 }
@@ -41,11 +47,27 @@ private slots:
     void saveScreenshot();
     double calculateExpectedValue(QVector<double> values);
     double calculateStudent(QVector<double> values);
+    void setBootstrapIntervals(bool enabled);
+    void startIntervals();
+    void intervalsCalculated();
+    void showAllDistribution();
+    void binModeChanged();
+    QCPQuantileSketch calculateDistribution(const QVector<QPair<const double*, int>> &spans);
+    QVector<double> calculateHistogram(const QVector<QPair<const double*, int>> &spans, const QCPRange &range, int bins, bool logarithmic);
     void plotDistrPlot();
 
 private:
     Ui::MainWindow *ui;
+    QCPReplotScheduler *replotScheduler;
     Graph currentGraph;
+    QSharedPointer<QCPBandDataSource> bandSource; //columns of currentGraph shown by the band of addGraph
+    bool bootstrapIntervals = false; //percentile bootstrap instead of the Student interval
+    QFutureWatcher<Intervals> intervalWatcher; //intervals being computed for currentGraph
+    int graphRevision = 0, intervalRevision = 0; //graph plotted by addGraph and the one the running intervals belong to
+    enum BinMode { bmFixed, bmFreedmanDiaconis, bmLog };
+    BinMode binMode = bmFixed;
+    int binCount = 10; //number of bins of bmFixed, bmLog chooses its own like bmFreedmanDiaconis
+    int distributionRow = -1; //point whose measurements the distribution plot shows, -1 for all points
 };
 
 #endif // MAINWINDOW_H
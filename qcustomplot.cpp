@@ -474,6 +474,210 @@ void QCPPainter::makeNonCosmetic()
     QPainter::setPen(p);
   }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLineRasterizer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLineRasterizer
+  \brief Software rasterizer for thin solid polylines in raster image paint buffers
+
+  QPainter's stroker is general purpose and becomes the bottleneck when drawing long antialiased
+  polylines, e.g. dense graphs. This class rasterizes polylines with solid pens of up to 3 pixels
+  width directly into the pixels of the \c QImage the provided \ref QCPPainter is drawing on, one
+  scanline span per segment row. Segments are drawn as capsules, so consecutive segments are joined
+  with round joins.
+
+  It is used by \ref QCPAbstractPlottable1D::drawPolyline when the plotting hint \ref
+  QCP::phRasterLines is set. The paint buffers are then \ref QCPPaintBufferImage instances, so the
+  painter's device is a \c QImage in premultiplied ARGB32 format.
+
+  After construction, check \ref isValid. If the painter's current state can't be handled (e.g.
+  dashed, textured or wide pens, composition modes other than SourceOver, rotated coordinate
+  systems or devices other than such images), the rasterizer is invalid and the caller must fall
+  back to regular QPainter drawing.
+*/
+
+/*!
+  Creates a rasterizer that draws with the current pen, transformation and clip rect of \a painter
+  onto the painter's device.
+*/
+QCPLineRasterizer::QCPLineRasterizer(QCPPainter *painter) :
+  mValid(false),
+  mAntialiased(false),
+  mBits(0),
+  mBytesPerLine(0),
+  mColor(0),
+  mHalfWidth(0)
+{
+  if (!painter || !painter->isActive() || !painter->device() || painter->device()->devType() != QInternal::Image)
+    return;
+  QImage *image = static_cast<QImage*>(painter->device());
+  if (image->format() != QImage::Format_ARGB32_Premultiplied)
+    return;
+  const QPen pen = painter->pen();
+  if (pen.style() != Qt::SolidLine || pen.brush().style() != Qt::SolidPattern || painter->compositionMode() != QPainter::CompositionMode_SourceOver)
+    return;
+  mTransform = painter->deviceTransform();
+  if (mTransform.type() > QTransform::TxScale || !qFuzzyCompare(qAbs(mTransform.m11()), qAbs(mTransform.m22())))
+    return;
+  
+  // determine pen width in device pixels (width zero means cosmetic one pixel pen):
+  const double scale = qAbs(mTransform.m11());
+  double width = pen.widthF();
+  if (width == 0)
+    width = 1;
+  else if (!pen.isCosmetic())
+    width *= scale;
+  if (width > 3.0*qMax(1.0, scale))
+    return;
+  mHalfWidth = width*0.5;
+  mAntialiased = painter->antialiasing();
+  if (!mAntialiased) // aliased QPainter lines fill the pixels whose top left corners the line passes
+    mTransform *= QTransform::fromTranslate(0.5, 0.5);
+  
+  QColor color = pen.color();
+  color.setAlphaF(color.alphaF()*painter->opacity());
+  mColor = qPremultiply(color.rgba());
+  
+  mClipRect = image->rect();
+  if (painter->hasClipping())
+    mClipRect &= painter->deviceTransform().mapRect(painter->clipBoundingRect()).toAlignedRect();
+  mBits = image->bits();
+  mBytesPerLine = image->bytesPerLine();
+  mValid = true;
+}
+
+/*!
+  Draws the polyline defined by \a points and \a pointCount with the pen of the painter this
+  rasterizer was created with.
+
+  Like \ref QCPAbstractPlottable1D::drawPolyline, points with NaN or infinite coordinates create a
+  gap in the line.
+
+  Must only be called if the rasterizer is valid (see \ref isValid).
+*/
+void QCPLineRasterizer::drawPolyline(const QPointF *points, int pointCount)
+{
+  if (!mValid)
+    return;
+  bool haveLast = false;
+  bool lastConnected = false;
+  QPointF last;
+  for (int i=0; i<pointCount; ++i)
+  {
+    const QPointF &point = points[i];
+    if (qIsNaN(point.x()) || qIsNaN(point.y()) || qIsInf(point.x()) || qIsInf(point.y())) // NaNs create a gap in the line
+    {
+      haveLast = false;
+      continue;
+    }
+    const QPointF devicePoint = mTransform.map(point);
+    if (haveLast)
+    {
+      drawSegment(last, devicePoint, lastConnected);
+      lastConnected = true;
+    } else
+      lastConnected = false;
+    last = devicePoint;
+    haveLast = true;
+  }
+}
+
+/*! \internal
+
+  Rasterizes the capsule-shaped segment from \a start to \a end (in device pixel coordinates) row by
+  row. For each pixel row, only the span intersecting the segment's band is visited.
+
+  If \a skipStartCap is true, pixels lying before \a start (as seen along the segment) are skipped,
+  i.e. the segment is drawn without its round start cap. Those pixels lie within the end cap of the
+  previous segment, so for a connected polyline they are only blended once. This doesn't prevent
+  all double blending at joins: Pixels within the bodies of both segments, e.g. on the inner side
+  of a sharp turn, are still blended by both segments, so joins of translucent pens may appear
+  slightly darker there.
+*/
+void QCPLineRasterizer::drawSegment(const QPointF &start, const QPointF &end, bool skipStartCap)
+{
+  const double reach = mAntialiased ? mHalfWidth+0.5 : mHalfWidth;
+  const double reachSquared = reach*reach;
+  const double halfWidthSquared = mHalfWidth*mHalfWidth;
+  const double minX = qMin(start.x(), end.x())-reach;
+  const double maxX = qMax(start.x(), end.x())+reach;
+  const double minY = qMin(start.y(), end.y())-reach;
+  const double maxY = qMax(start.y(), end.y())+reach;
+  // pixel i is considered if its center i+0.5 lies within the bounding box:
+  const int rowBegin = qMax(mClipRect.top(), (int)qMax(-1.0e9, ceil(minY-0.5)));
+  const int rowEnd = qMin(mClipRect.bottom(), (int)qMin(1.0e9, floor(maxY-0.5)));
+  const int colBegin = qMax(mClipRect.left(), (int)qMax(-1.0e9, ceil(minX-0.5)));
+  const int colEnd = qMin(mClipRect.right(), (int)qMin(1.0e9, floor(maxX-0.5)));
+  if (rowBegin > rowEnd || colBegin > colEnd)
+    return;
+  
+  const double dx = end.x()-start.x();
+  const double dy = end.y()-start.y();
+  const double lengthSquared = dx*dx+dy*dy;
+  const double bandHalfWidth = reach*qSqrt(lengthSquared);
+  const bool useBand = qAbs(dy) > 1e-6;
+  for (int row=rowBegin; row<=rowEnd; ++row)
+  {
+    const double cy = row+0.5;
+    int spanBegin = colBegin;
+    int spanEnd = colEnd;
+    if (useBand) // restrict span to pixels whose distance to the infinite line is at most reach
+    {
+      const double center = start.x()+(cy-start.y())*dx/dy;
+      const double halfSpan = qAbs(bandHalfWidth/dy);
+      spanBegin = qMax(spanBegin, (int)qMax(-1.0e9, ceil(center-halfSpan-0.5)));
+      spanEnd = qMin(spanEnd, (int)qMin(1.0e9, floor(center+halfSpan-0.5)));
+    }
+    quint32 *line = reinterpret_cast<quint32*>(mBits+row*mBytesPerLine);
+    for (int col=spanBegin; col<=spanEnd; ++col)
+    {
+      const double px = col+0.5-start.x();
+      const double py = cy-start.y();
+      double t = lengthSquared > 0 ? (px*dx+py*dy)/lengthSquared : 0;
+      if (t < 0)
+      {
+        if (skipStartCap)
+          continue;
+        t = 0;
+      } else if (t > 1)
+        t = 1;
+      const double ex = px-t*dx;
+      const double ey = py-t*dy;
+      const double distanceSquared = ex*ex+ey*ey;
+      if (distanceSquared > reachSquared)
+        continue;
+      if (mAntialiased)
+      {
+        const double coverage = qMin(1.0, reach-qSqrt(distanceSquared));
+        blendPixel(line+col, (int)(coverage*255+0.5));
+      } else if (distanceSquared <= halfWidthSquared)
+        blendPixel(line+col, 255);
+    }
+  }
+}
+
+/*! \internal
+
+  Blends the pen color with the given \a coverage (0 to 255) onto the premultiplied ARGB32 \a pixel
+  using SourceOver composition.
+*/
+void QCPLineRasterizer::blendPixel(quint32 *pixel, int coverage) const
+{
+  if (coverage <= 0)
+    return;
+  const int sourceAlpha = ((mColor >> 24)*coverage+127)/255;
+  const int inverse = 255-sourceAlpha;
+  const quint32 destination = *pixel;
+  quint32 result = 0;
+  for (int shift=0; shift<32; shift+=8)
+  {
+    const int value = ((int)((mColor >> shift) & 0xff)*coverage + (int)((destination >> shift) & 0xff)*inverse + 127)/255;
+    result |= quint32(qMin(value, 255)) << shift;
+  }
+  *pixel = result;
+}
 /* end of 'src/painter.cpp' */
 
 
@@ -638,6 +842,23 @@ void QCPAbstractPaintBuffer::setDevicePixelRatio(double ratio)
   }
 }
 
+/*!
+  Moves the content of \a rect (in logical pixels) by \a delta. Content moved outside of \a rect is
+  discarded, the part of \a rect that is exposed by the move keeps its previous content and must be
+  redrawn by the caller.
+
+  Returns whether the scroll was performed. The default implementation doesn't support scrolling
+  and returns false, so the caller must fall back to clearing and redrawing the whole buffer.
+
+  \see QCPLayer::drawScrolledToPaintBuffer
+*/
+bool QCPAbstractPaintBuffer::scroll(const QRect &rect, const QPoint &delta)
+{
+  Q_UNUSED(rect)
+  Q_UNUSED(delta)
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferPixmap
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -686,6 +907,17 @@ void QCPPaintBufferPixmap::clear(const QColor &color)
   mBuffer.fill(color);
 }
 
+/* inherits documentation from base class */
+bool QCPPaintBufferPixmap::scroll(const QRect &rect, const QPoint &delta)
+{
+  const QPointF deviceDelta = QPointF(delta)*mDevicePixelRatio;
+  if (deviceDelta != QPointF(deviceDelta.toPoint())) // fractional device pixel ratio, content can't be moved exactly
+    return false;
+  const QRect deviceRect(rect.topLeft()*mDevicePixelRatio, rect.size()*mDevicePixelRatio);
+  mBuffer.scroll(deviceDelta.toPoint().x(), deviceDelta.toPoint().y(), deviceRect);
+  return true;
+}
+
 /* inherits documentation from base class */
 void QCPPaintBufferPixmap::reallocateBuffer()
 {
@@ -706,6 +938,100 @@ void QCPPaintBufferPixmap::reallocateBuffer()
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering
+
+  This paint buffer uses software rendering like \ref QCPPaintBufferPixmap, but keeps its surface
+  as a \c QImage in premultiplied ARGB32 format. This gives direct access to the pixels, which is
+  used by \ref QCPLineRasterizer to draw thin solid polylines without going through QPainter's
+  stroker. It is used if the plotting hint \ref QCP::phRasterLines is set and \ref
+  QCustomPlot::setOpenGl is false.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio)
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  QCPPainter *result = new QCPPainter(&mBuffer);
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+bool QCPPaintBufferImage::scroll(const QRect &rect, const QPoint &delta)
+{
+  const QPointF deviceDelta = QPointF(delta)*mDevicePixelRatio;
+  if (deviceDelta != QPointF(deviceDelta.toPoint())) // fractional device pixel ratio, content can't be moved exactly
+    return false;
+  const QPoint d = deviceDelta.toPoint();
+  const QRect deviceRect = QRect(rect.topLeft()*mDevicePixelRatio, rect.size()*mDevicePixelRatio) & mBuffer.rect();
+  const QRect target = deviceRect.translated(d) & deviceRect;
+  if (target.isEmpty())
+    return true;
+  // move line by line, iterating against the vertical direction of the move so no source line is overwritten before it's read:
+  const int lineBytes = target.width()*4;
+  for (int i=0; i<target.height(); ++i)
+  {
+    const int y = d.y() > 0 ? target.bottom()-i : target.top()+i;
+    uchar *targetLine = mBuffer.scanLine(y)+target.left()*4;
+    const uchar *sourceLine = mBuffer.constScanLine(y-d.y())+(target.left()-d.x())*4;
+    memmove(targetLine, sourceLine, lineBytes);
+  }
+  return true;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+}
+
 
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1124,7 +1450,46 @@ void QCPLayer::draw(QCPPainter *painter)
       painter->save();
       painter->setClipRect(child->clipRect().translated(0, -1));
       child->applyDefaultAntialiasingHint(painter);
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+      QElapsedTimer drawClock;
+      drawClock.start();
+      child->draw(painter);
+      mParentPlot->mReplotProfiler->addLayerableTime(child, drawClock.nsecsElapsed());
+#else
+      child->draw(painter);
+#endif
+      painter->restore();
+    }
+  }
+}
+
+/*! \internal
+
+  Draws the contents of this layer with the provided \a painter, restricted to \a region. Each
+  layerable is clipped to the intersection of its clip rect and \a region.
+
+  \see draw, drawScrolledToPaintBuffer
+*/
+void QCPLayer::drawExposed(QCPPainter *painter, const QRegion &region)
+{
+  foreach (QCPLayerable *child, mChildren)
+  {
+    if (child->realVisibility())
+    {
+      const QRegion clip = region.intersected(child->clipRect().translated(0, -1));
+      if (clip.isEmpty())
+        continue;
+      painter->save();
+      painter->setClipRegion(clip);
+      child->applyDefaultAntialiasingHint(painter);
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+      QElapsedTimer drawClock;
+      drawClock.start();
       child->draw(painter);
+      mParentPlot->mReplotProfiler->addLayerableTime(child, drawClock.nsecsElapsed());
+#else
+      child->draw(painter);
+#endif
       painter->restore();
     }
   }
@@ -1156,6 +1521,54 @@ void QCPLayer::drawToPaintBuffer()
     qDebug() << Q_FUNC_INFO << "no valid paint buffer associated with this layer";
 }
 
+/*! \internal
+
+  Updates the paint buffer of this layer by moving its content inside \a rect by \a delta, and
+  drawing only the part of \a rect that was exposed by the move. This is used by QCustomPlot
+  during range drags with the plotting hint \ref QCP::phBlitDrag, for buffered layers whose
+  layerables all move with the drag.
+
+  If the paint buffer doesn't support scrolling (see \ref QCPAbstractPaintBuffer::scroll), the
+  buffer is cleared and the layer is drawn completely.
+
+  \see drawToPaintBuffer
+*/
+void QCPLayer::drawScrolledToPaintBuffer(const QRect &rect, const QPoint &delta)
+{
+  if (mPaintBuffer.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "no valid paint buffer associated with this layer";
+    return;
+  }
+  QCPAbstractPaintBuffer *buffer = mPaintBuffer.data();
+  if (!buffer->scroll(rect, delta))
+  {
+    buffer->clear(Qt::transparent);
+    drawToPaintBuffer();
+    return;
+  }
+  const QRegion exposed = QRegion(rect).subtracted(QRegion(rect.translated(delta) & rect));
+  if (exposed.isEmpty())
+    return;
+  if (QCPPainter *painter = buffer->startPainting())
+  {
+    if (painter->isActive())
+    {
+      // clear the exposed strip, then draw only into it:
+      painter->save();
+      painter->setCompositionMode(QPainter::CompositionMode_Source);
+      painter->setClipRegion(exposed);
+      painter->fillRect(rect, Qt::transparent);
+      painter->restore();
+      drawExposed(painter, exposed);
+    } else
+      qDebug() << Q_FUNC_INFO << "paint buffer returned inactive painter";
+    delete painter;
+    buffer->donePainting();
+  } else
+    qDebug() << Q_FUNC_INFO << "paint buffer returned zero painter";
+}
+
 /*!
   If the layer mode (\ref setMode) is set to \ref lmBuffered, this method allows replotting only
   the layerables on this specific layer, without the need to replot all other layers (as a call to
@@ -5310,89 +5723,357 @@ void QCPLineEnding::draw(QCPPainter *painter, const QCPVector2D &pos, double ang
 /* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPAxisTicker
+//////////////////// QCPNumberFormatter
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-/*! \class QCPAxisTicker
-  \brief The base class tick generator used by QCPAxis to create tick positions and tick labels
-  
-  Each QCPAxis has an internal QCPAxisTicker (or a subclass) in order to generate tick positions
-  and tick labels for the current axis range. The ticker of an axis can be set via \ref
-  QCPAxis::setTicker. Since that method takes a <tt>QSharedPointer<QCPAxisTicker></tt>, multiple
-  axes can share the same ticker instance.
-  
-  This base class generates normal tick coordinates and numeric labels for linear axes. It picks a
-  reasonable tick step (the separation between ticks) which results in readable tick labels. The
-  number of ticks that should be approximately generated can be set via \ref setTickCount.
-  Depending on the current tick step strategy (\ref setTickStepStrategy), the algorithm either
-  sacrifices readability to better match the specified tick count (\ref
-  QCPAxisTicker::tssMeetTickCount) or relaxes the tick count in favor of better tick steps (\ref
-  QCPAxisTicker::tssReadability), which is the default.
-  
-  The following more specialized axis ticker subclasses are available, see details in the
-  respective class documentation:
-  
-  <center>
-  <table>
-  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerFixed</td><td>\image html axisticker-fixed.png</td></tr>
-  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerLog</td><td>\image html axisticker-log.png</td></tr>
-  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerPi</td><td>\image html axisticker-pi.png</td></tr>
-  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerText</td><td>\image html axisticker-text.png</td></tr>
-  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerDateTime</td><td>\image html axisticker-datetime.png</td></tr>
-  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerTime</td><td>\image html axisticker-time.png
-    \image html axisticker-time2.png</td></tr>
-  </table>
-  </center>
-  
-  \section axisticker-subclassing Creating own axis tickers
-  
-  Creating own axis tickers can be achieved very easily by sublassing QCPAxisTicker and
-  reimplementing some or all of the available virtual methods.
+/*! \class QCPNumberFormatter
+  \brief Fast locale-aware conversion of numbers to tick label strings
 
-  In the simplest case you might wish to just generate different tick steps than the other tickers,
-  so you only reimplement the method \ref getTickStep. If you additionally want control over the
-  string that will be shown as tick label, reimplement \ref getTickLabel.
-  
-  If you wish to have complete control, you can generate the tick vectors and tick label vectors
-  yourself by reimplementing \ref createTickVector and \ref createLabelVector. The default
-  implementations use the previously mentioned virtual methods \ref getTickStep and \ref
-  getTickLabel, but your reimplementations don't necessarily need to do so. For example in the case
-  of unequal tick steps, the method \ref getTickStep loses its usefulness and can be ignored.
-  
-  The sub tick count between major ticks can be controlled with \ref getSubTickCount. Full sub tick
-  placement control is obtained by reimplementing \ref createSubTickVector.
-  
-  See the documentation of all these virtual methods in QCPAxisTicker for detailed information
-  about the parameters and expected return values.
+  Tick labels are regenerated on every replot, so converting each tick coordinate with
+  <tt>QLocale::toString</tt> becomes noticeable during animated zooms and drags. \ref toString
+  produces the same text as <tt>QLocale::toString(value, formatChar, precision)</tt>, but writes
+  the digits into a stack buffer using integer arithmetic and only creates a single QString at the
+  end.
+
+  The fast path handles the format characters 'f', 'e', 'E', 'g' and 'G' with up to 15 significant
+  digits. Whenever the result can't be guaranteed to match \c QLocale exactly (e.g. the value lies
+  very close to a rounding tie, the locale requires group separators or unusual number options),
+  the conversion transparently falls back to \c QLocale::toString.
+
+  \ref findExponent is used by the axis painter to split exponential labels into base and
+  superscript exponent when beautifully typeset powers are enabled (see \ref
+  QCPAxis::setNumberFormat), without creating intermediate string copies.
 */
 
 /*!
-  Constructs the ticker and sets reasonable default values. Axis tickers are commonly created
-  managed by a QSharedPointer, which then can be passed to QCPAxis::setTicker.
+  Returns \a value formatted as text, identical to <tt>locale.toString(value,
+  formatChar.toLatin1(), precision)</tt>.
 */
-QCPAxisTicker::QCPAxisTicker() :
-  mTickStepStrategy(tssReadability),
-  mTickCount(5),
-  mTickOrigin(0)
+QString QCPNumberFormatter::toString(double value, const QLocale &locale, QChar formatChar, int precision)
 {
-}
+  const char format = formatChar.toLatin1();
+  int length = -1;
+  char buffer[64];
+  // only plain number options are handled by the fast path, group separators only if they can't appear:
+  const int options = int(locale.numberOptions());
+  if ((options & ~int(QLocale::OmitGroupSeparator)) == 0 && ((options & QLocale::OmitGroupSeparator) || qAbs(value) < 1000))
+    length = writeDigits(value, format, precision, buffer);
+  if (length < 0)
+    return locale.toString(value, format, precision);
 
-QCPAxisTicker::~QCPAxisTicker()
-{
-  
+  const QChar decimalPoint = locale.decimalPoint();
+  const QChar zeroDigit = locale.zeroDigit();
+  const QChar negativeSign = locale.negativeSign();
+  const QChar positiveSign = locale.positiveSign();
+  const QChar exponential = locale.exponential();
+  if (decimalPoint == QLatin1Char('.') && zeroDigit == QLatin1Char('0') && negativeSign == QLatin1Char('-') &&
+      positiveSign == QLatin1Char('+') && exponential == QLatin1Char('e'))
+    return QString::fromLatin1(buffer, length);
+
+  QChar localized[64];
+  for (int i=0; i<length; ++i)
+  {
+    const char c = buffer[i];
+    if (c >= '0' && c <= '9')
+      localized[i] = QChar(zeroDigit.unicode()+(c-'0'));
+    else if (c == '.')
+      localized[i] = decimalPoint;
+    else if (c == '-')
+      localized[i] = negativeSign;
+    else if (c == '+')
+      localized[i] = positiveSign;
+    else if (c == 'e')
+      localized[i] = exponential;
+    else // c == 'E'
+      localized[i] = exponential.toUpper();
+  }
+  return QString(localized, length);
 }
 
 /*!
-  Sets which strategy the axis ticker follows when choosing the size of the tick step. For the
-  available strategies, see \ref TickStepStrategy.
+  Locates a decimal power of the form "2e+05" in \a text, as it is generated by the number
+  formats 'e' and 'g'. Returns false if \a text contains no such power.
+
+  Otherwise, \a ePos is set to the index of the exponential character, \a eLast to the index of the
+  last character belonging to the exponent and \a exponent is set to the exponent as it should be
+  displayed as superscript, i.e. without the "+" sign and without leading zeros.
 */
-void QCPAxisTicker::setTickStepStrategy(QCPAxisTicker::TickStepStrategy strategy)
+bool QCPNumberFormatter::findExponent(const QString &text, int *ePos, int *eLast, QString *exponent)
 {
-  mTickStepStrategy = strategy;
+  const int pos = text.indexOf(QLatin1Char('e'));
+  if (pos <= 0 || !text.at(pos-1).isDigit())
+    return false;
+  int last = pos;
+  while (last+1 < text.size() && (text.at(last+1) == QLatin1Char('+') || text.at(last+1) == QLatin1Char('-') || text.at(last+1).isDigit()))
+    ++last;
+  if (last == pos) // only if also to right of 'e' is a digit/+/- interpret it as beautifiable power
+    return false;
+
+  *ePos = pos;
+  *eLast = last;
+  // clip "+" and leading zeros off the exponent (leave one zero so "e+00" turns into "0"):
+  const int expLength = last-pos;
+  int skip = 0;
+  while (expLength-skip > 2 && text.at(pos+2+skip) == QLatin1Char('0'))
+    ++skip;
+  exponent->clear();
+  exponent->reserve(expLength-skip);
+  if (text.at(pos+1) != QLatin1Char('+'))
+    exponent->append(text.at(pos+1));
+  exponent->append(text.midRef(pos+2+skip, expLength-1-skip));
+  return true;
 }
 
-/*!
-  Sets how many ticks this ticker shall aim to generate across the axis range. Note that \a count
-  is not guaranteed to be matched exactly, as generating readable tick intervals may conflict with
+/*! \internal
+
+  Writes \a value in the C locale representation of the given \a formatChar and \a precision into
+  \a buffer, which must hold at least 64 characters. Returns the number of characters written, or
+  -1 if the value must be formatted by QLocale to obtain an exact result.
+*/
+int QCPNumberFormatter::writeDigits(double value, char formatChar, int precision, char *buffer)
+{
+  static const qint64 intPowers[] = {1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL,
+                                     10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL, 1000000000000000LL};
+  if (qIsNaN(value) || qIsInf(value) || precision < 0 || precision > 15)
+    return -1;
+  if (value == 0 && 1.0/value < 0) // negative zero, sign handling differs between Qt versions
+    return -1;
+
+  char *out = buffer;
+  const double absValue = qAbs(value);
+  if (value < 0)
+    *out++ = '-';
+
+  if (formatChar == 'f')
+  {
+    qint64 digits;
+    if (!scaledDigits(absValue, precision, &digits))
+      return -1;
+    if (digits == 0 && value < 0) // negative values rounding to zero, let QLocale decide about the sign
+      return -1;
+    out += writeInteger(digits/intPowers[precision], 1, out);
+    if (precision > 0)
+    {
+      *out++ = '.';
+      out += writeInteger(digits%intPowers[precision], precision, out);
+    }
+    return out-buffer;
+  }
+
+  const bool generalFormat = formatChar == 'g' || formatChar == 'G';
+  if (!generalFormat && formatChar != 'e' && formatChar != 'E')
+    return -1;
+  const char exponentialChar = (formatChar == 'E' || formatChar == 'G') ? 'E' : 'e';
+  if (absValue == 0)
+  {
+    if (!generalFormat)
+      return -1;
+    *out++ = '0';
+    return out-buffer;
+  }
+  const int significant = generalFormat ? precision : precision+1;
+  if (significant < 1 || significant > 15)
+    return -1;
+
+  // find decimal exponent and the significant digits, correcting for inaccuracies of the logarithm and rounding carries:
+  int exponent = qFloor(qLn(absValue)/qLn(10.0));
+  qint64 digits;
+  if (!scaledDigits(absValue, significant-1-exponent, &digits))
+    return -1;
+  if (digits >= intPowers[significant])
+  {
+    ++exponent;
+    if (!scaledDigits(absValue, significant-1-exponent, &digits))
+      return -1;
+  } else if (digits < intPowers[significant-1])
+  {
+    --exponent;
+    if (!scaledDigits(absValue, significant-1-exponent, &digits))
+      return -1;
+  }
+  if (digits < intPowers[significant-1] || digits >= intPowers[significant])
+    return -1;
+
+  int digitCount = significant;
+  if (generalFormat) // 'g' removes trailing zeros
+  {
+    while (digitCount > 1 && digits%10 == 0)
+    {
+      digits /= 10;
+      --digitCount;
+    }
+  }
+  char digitText[16];
+  writeInteger(digits, digitCount, digitText);
+
+  if (generalFormat && exponent >= -4 && exponent < significant) // fixed notation
+  {
+    if (exponent < 0)
+    {
+      *out++ = '0';
+      *out++ = '.';
+      for (int i=0; i<-exponent-1; ++i)
+        *out++ = '0';
+      for (int i=0; i<digitCount; ++i)
+        *out++ = digitText[i];
+    } else
+    {
+      for (int i=0; i<=exponent; ++i)
+        *out++ = i < digitCount ? digitText[i] : '0';
+      if (digitCount > exponent+1)
+      {
+        *out++ = '.';
+        for (int i=exponent+1; i<digitCount; ++i)
+          *out++ = digitText[i];
+      }
+    }
+    return out-buffer;
+  }
+
+  // scientific notation:
+  *out++ = digitText[0];
+  if (digitCount > 1)
+  {
+    *out++ = '.';
+    for (int i=1; i<digitCount; ++i)
+      *out++ = digitText[i];
+  }
+  *out++ = exponentialChar;
+  *out++ = exponent < 0 ? '-' : '+';
+  out += writeInteger(qAbs(exponent), 2, out);
+  return out-buffer;
+}
+
+/*! \internal
+
+  Calculates \a absValue multiplied by 10^\a scaleExponent, rounded to the nearest integer, and
+  stores the result in \a digits.
+
+  Returns false if the result can't be determined reliably with double arithmetic, i.e. if the
+  power is not exactly representable, the result exceeds the double mantissa or the scaled value
+  lies so close to a rounding tie that the exact decimal expansion of \a absValue would be needed.
+*/
+bool QCPNumberFormatter::scaledDigits(double absValue, int scaleExponent, qint64 *digits)
+{
+  static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  if (scaleExponent > 22 || scaleExponent < -22)
+    return false;
+  const double scaled = scaleExponent >= 0 ? absValue*powers[scaleExponent] : absValue/powers[-scaleExponent];
+  if (scaled >= 1e15)
+    return false;
+  const double integral = floor(scaled); // do not use qFloor here, it truncates to int
+  const double fraction = scaled-integral;
+  if (qAbs(fraction-0.5) < 1e-9+scaled*1e-15)
+    return false;
+  *digits = (qint64)integral + (fraction > 0.5 ? 1 : 0);
+  return true;
+}
+
+/*! \internal
+
+  Writes the non-negative \a value in decimal into \a buffer, padded with leading zeros to at
+  least \a minDigits digits. Returns the number of characters written.
+*/
+int QCPNumberFormatter::writeInteger(qint64 value, int minDigits, char *buffer)
+{
+  char reversed[24];
+  int count = 0;
+  do
+  {
+    reversed[count++] = char('0'+value%10);
+    value /= 10;
+  } while (value > 0);
+  while (count < minDigits)
+    reversed[count++] = '0';
+  for (int i=0; i<count; ++i)
+    buffer[i] = reversed[count-1-i];
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPAxisTicker
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \class QCPAxisTicker
+  \brief The base class tick generator used by QCPAxis to create tick positions and tick labels
+  
+  Each QCPAxis has an internal QCPAxisTicker (or a subclass) in order to generate tick positions
+  and tick labels for the current axis range. The ticker of an axis can be set via \ref
+  QCPAxis::setTicker. Since that method takes a <tt>QSharedPointer<QCPAxisTicker></tt>, multiple
+  axes can share the same ticker instance.
+  
+  This base class generates normal tick coordinates and numeric labels for linear axes. It picks a
+  reasonable tick step (the separation between ticks) which results in readable tick labels. The
+  number of ticks that should be approximately generated can be set via \ref setTickCount.
+  Depending on the current tick step strategy (\ref setTickStepStrategy), the algorithm either
+  sacrifices readability to better match the specified tick count (\ref
+  QCPAxisTicker::tssMeetTickCount) or relaxes the tick count in favor of better tick steps (\ref
+  QCPAxisTicker::tssReadability), which is the default.
+  
+  The following more specialized axis ticker subclasses are available, see details in the
+  respective class documentation:
+  
+  <center>
+  <table>
+  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerFixed</td><td>\image html axisticker-fixed.png</td></tr>
+  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerLog</td><td>\image html axisticker-log.png</td></tr>
+  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerPi</td><td>\image html axisticker-pi.png</td></tr>
+  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerText</td><td>\image html axisticker-text.png</td></tr>
+  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerDateTime</td><td>\image html axisticker-datetime.png</td></tr>
+  <tr><td style="text-align:right; padding: 0 1em">QCPAxisTickerTime</td><td>\image html axisticker-time.png
+    \image html axisticker-time2.png</td></tr>
+  </table>
+  </center>
+  
+  \section axisticker-subclassing Creating own axis tickers
+  
+  Creating own axis tickers can be achieved very easily by sublassing QCPAxisTicker and
+  reimplementing some or all of the available virtual methods.
+
+  In the simplest case you might wish to just generate different tick steps than the other tickers,
+  so you only reimplement the method \ref getTickStep. If you additionally want control over the
+  string that will be shown as tick label, reimplement \ref getTickLabel.
+  
+  If you wish to have complete control, you can generate the tick vectors and tick label vectors
+  yourself by reimplementing \ref createTickVector and \ref createLabelVector. The default
+  implementations use the previously mentioned virtual methods \ref getTickStep and \ref
+  getTickLabel, but your reimplementations don't necessarily need to do so. For example in the case
+  of unequal tick steps, the method \ref getTickStep loses its usefulness and can be ignored.
+  
+  The sub tick count between major ticks can be controlled with \ref getSubTickCount. Full sub tick
+  placement control is obtained by reimplementing \ref createSubTickVector.
+  
+  See the documentation of all these virtual methods in QCPAxisTicker for detailed information
+  about the parameters and expected return values.
+*/
+
+/*!
+  Constructs the ticker and sets reasonable default values. Axis tickers are commonly created
+  managed by a QSharedPointer, which then can be passed to QCPAxis::setTicker.
+*/
+QCPAxisTicker::QCPAxisTicker() :
+  mTickStepStrategy(tssReadability),
+  mTickCount(5),
+  mTickOrigin(0)
+{
+}
+
+QCPAxisTicker::~QCPAxisTicker()
+{
+  
+}
+
+/*!
+  Sets which strategy the axis ticker follows when choosing the size of the tick step. For the
+  available strategies, see \ref TickStepStrategy.
+*/
+void QCPAxisTicker::setTickStepStrategy(QCPAxisTicker::TickStepStrategy strategy)
+{
+  mTickStepStrategy = strategy;
+}
+
+/*!
+  Sets how many ticks this ticker shall aim to generate across the axis range. Note that \a count
+  is not guaranteed to be matched exactly, as generating readable tick intervals may conflict with
   the requested number of ticks.
 
   Whether the readability has priority over meeting the requested \a count can be specified with
@@ -5545,7 +6226,7 @@ int QCPAxisTicker::getSubTickCount(double tickStep)
 */
 QString QCPAxisTicker::getTickLabel(double tick, const QLocale &locale, QChar formatChar, int precision)
 {
-  return locale.toString(tick, formatChar.toLatin1(), precision);
+  return QCPNumberFormatter::toString(tick, locale, formatChar, precision);
 }
 
 /*! \internal
@@ -8767,7 +9448,14 @@ void QCPAxis::setupTickVectors()
   if ((!mTicks && !mTickLabels && !mGrid->visible()) || mRange.size() <= 0) return;
   
   QVector<QString> oldLabels = mTickVectorLabels;
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  QElapsedTimer tickClock;
+  tickClock.start();
+#endif
   mTicker->generate(mRange, mParentPlot->locale(), mNumberFormatChar, mNumberPrecision, mTickVector, mSubTicks ? &mSubTickVector : 0, mTickLabels ? &mTickVectorLabels : 0);
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  mParentPlot->mReplotProfiler->addPhaseTime(QCPReplotProfiler::fpAxisTicks, tickClock.nsecsElapsed());
+#endif
   mCachedMarginValid &= mTickVectorLabels == oldLabels; // if labels have changed, margin might have changed, too
 }
 
@@ -9371,17 +10059,7 @@ QCPAxisPainterPrivate::TickLabelData QCPAxisPainterPrivate::getTickLabelData(con
   int ePos = -1; // first index of exponent part, text before that will be basePart, text until eLast will be expPart
   int eLast = -1; // last index of exponent part, rest of text after this will be suffixPart
   if (substituteExponent)
-  {
-    ePos = text.indexOf(QLatin1Char('e'));
-    if (ePos > 0 && text.at(ePos-1).isDigit())
-    {
-      eLast = ePos;
-      while (eLast+1 < text.size() && (text.at(eLast+1) == QLatin1Char('+') || text.at(eLast+1) == QLatin1Char('-') || text.at(eLast+1).isDigit()))
-        ++eLast;
-      if (eLast > ePos) // only if also to right of 'e' is a digit/+/- interpret it as beautifiable power
-        useBeautifulPowers = true;
-    }
-  }
+    useBeautifulPowers = QCPNumberFormatter::findExponent(text, &ePos, &eLast, &result.expPart);
   
   // calculate text bounding rects and do string preparation for beautiful decimal powers:
   result.baseFont = font;
@@ -9397,12 +10075,6 @@ QCPAxisPainterPrivate::TickLabelData QCPAxisPainterPrivate::getTickLabelData(con
       result.basePart = QLatin1String("10");
     else
       result.basePart += (numberMultiplyCross ? QString(QChar(215)) : QString(QChar(183))) + QLatin1String("10");
-    result.expPart = text.mid(ePos+1, eLast-ePos);
-    // clip "+" and leading zeros off expPart:
-    while (result.expPart.length() > 2 && result.expPart.at(1) == QLatin1Char('0')) // length > 2 so we leave one zero when numberFormatChar is 'e'
-      result.expPart.remove(1, 1);
-    if (!result.expPart.isEmpty() && result.expPart.at(0) == QLatin1Char('+'))
-      result.expPart.remove(0, 1);
     // prepare smaller font for exponent:
     result.expFont = font;
     if (result.expFont.pointSize() > 0)
@@ -12613,10 +13285,15 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mSelectionRectMode(QCP::srmNone),
   mSelectionRect(0),
   mOpenGl(false),
+  mCoarseReplotBudget(16),
+  mRefineDelay(150),
   mMouseHasMoved(false),
   mMouseEventLayerable(0),
   mReplotting(false),
   mReplotQueued(false),
+  mDragFrameReplot(false),
+  mCoarseReplot(false),
+  mCoarseSampleDensity(8),
   mOpenGlMultisamples(16),
   mOpenGlAntialiasedElementsBackup(QCP::aeNone),
   mOpenGlCacheLabelsBackup(true)
@@ -12631,6 +13308,11 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 #ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
   setBufferDevicePixelRatio(QWidget::devicePixelRatio());
 #endif
+  mRefineTimer.setSingleShot(true);
+  connect(&mRefineTimer, SIGNAL(timeout()), this, SLOT(replot()));
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  mReplotProfiler = new QCPReplotProfiler;
+#endif
   
   mOpenGlAntialiasedElementsBackup = mAntialiasedElements;
   mOpenGlCacheLabelsBackup = mPlottingHints.testFlag(QCP::phCacheLabels);
@@ -12695,6 +13377,9 @@ QCustomPlot::~QCustomPlot()
   mCurrentLayer = 0;
   qDeleteAll(mLayers); // don't use removeLayer, because it would prevent the last layer to be removed
   mLayers.clear();
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  delete mReplotProfiler;
+#endif
 }
 
 /*!
@@ -12912,7 +13597,13 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  const bool paintBufferTypeChanged = (hints.testFlag(QCP::phRasterLines) != mPlottingHints.testFlag(QCP::phRasterLines));
   mPlottingHints = hints;
+  if (paintBufferTypeChanged && !mOpenGl) // recreate all paint buffers with the appropriate type
+  {
+    mPaintBuffers.clear();
+    setupPaintBuffers();
+  }
 }
 
 /*!
@@ -13087,6 +13778,51 @@ void QCustomPlot::setOpenGl(bool enabled, int multisampling)
 #endif
 }
 
+/*!
+  Sets the frame time in milliseconds that a coarse replot (\ref replotCoarse) should not exceed.
+  
+  The number of data points a coarse replot visits per pixel is adapted after each coarse replot:
+  It is halved if the replot took longer than \a milliseconds, and doubled if it took less than
+  half of that.
+  
+  \see setRefineDelay, QCP::phProgressiveZoom
+*/
+void QCustomPlot::setCoarseReplotBudget(int milliseconds)
+{
+  mCoarseReplotBudget = qMax(1, milliseconds);
+}
+
+/*!
+  Sets the time in milliseconds after the last coarse replot (\ref replotCoarse) until a full
+  quality replot is performed. Every coarse replot restarts this delay, so during continuous
+  interaction (e.g. fast mouse wheel zooming), only the coarse previews are drawn.
+  
+  \see setCoarseReplotBudget, QCP::phProgressiveZoom
+*/
+void QCustomPlot::setRefineDelay(int milliseconds)
+{
+  mRefineDelay = qMax(0, milliseconds);
+}
+
+/*!
+  Sets the \a scheduler which performs the replots of this QCustomPlot that are requested with
+  \ref replot "replot(rpQueuedReplot)". Pass 0 to return to the default behaviour of replotting in
+  the next event loop iteration.
+  
+  A scheduler may be shared by multiple QCustomPlots. Their queued replots are then coalesced and
+  rendered together, at most once per frame of the scheduler's frame rate.
+  
+  The QCustomPlot doesn't take ownership of \a scheduler.
+  
+  \see QCPReplotScheduler
+*/
+void QCustomPlot::setReplotScheduler(QCPReplotScheduler *scheduler)
+{
+  if (mReplotScheduler && mReplotScheduler.data() != scheduler)
+    mReplotScheduler.data()->unschedule(this);
+  mReplotScheduler = scheduler;
+}
+
 /*!
   Sets the viewport of this QCustomPlot. Usually users of QCustomPlot don't need to change the
   viewport manually.
@@ -14114,7 +14850,8 @@ void QCustomPlot::deselectAll()
   it is advisable to set \a refreshPriority to \ref QCustomPlot::rpQueuedReplot. This way, the
   actual replotting is deferred to the next event loop iteration. Multiple successive calls of \ref
   replot with this priority will only cause a single replot, avoiding redundant replots and
-  improving performance.
+  improving performance. If a replot scheduler is set (\ref setReplotScheduler), the replot is
+  deferred to the next frame of the scheduler instead.
 
   Under a few circumstances, QCustomPlot causes a replot by itself. Those are resize events of the
   QCustomPlot widget and user interactions (object selection and range dragging/zooming).
@@ -14132,6 +14869,11 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
   if (refreshPriority == QCustomPlot::rpQueuedReplot)
   {
+    if (mReplotScheduler)
+    {
+      mReplotScheduler.data()->schedule(this);
+      return;
+    }
     if (!mReplotQueued)
     {
       mReplotQueued = true;
@@ -14144,15 +14886,52 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     return;
   mReplotting = true;
   mReplotQueued = false;
+  if (!mCoarseReplot) // a full replot makes a pending refinement of a coarse replot redundant
+    mRefineTimer.stop();
+  if (mReplotScheduler) // this replot also satisfies a scheduled one
+    mReplotScheduler.data()->unschedule(this);
   emit beforeReplot();
   
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  QElapsedTimer frameClock, phaseClock;
+  frameClock.start();
+  phaseClock.start();
+  mReplotProfiler->beginFrame();
+#endif
   updateLayout();
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  mReplotProfiler->addPhaseTime(QCPReplotProfiler::fpLayout, phaseClock.nsecsElapsed());
+#endif
+  // during a range drag with phBlitDrag, the drag frames scroll the buffered layers that move with the drag instead of
+  // redrawing them. Other replots during the drag (e.g. after data changes) redraw everything:
+  QList<QCPLayer*> scrollLayers;
+  QPoint scrollDelta;
+  if (mDragScrollAxisRect && mDragFrameReplot && !hasInvalidatedPaintBuffers() && !mPaintBuffers.isEmpty() && mPaintBuffers.first()->size() == viewport().size())
+    scrollLayers = mDragScrollAxisRect.data()->dragScrollLayers(&scrollDelta);
   // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers:
-  setupPaintBuffers();
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  phaseClock.start();
+#endif
+  setupPaintBuffers(scrollLayers);
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  mReplotProfiler->addPhaseTime(QCPReplotProfiler::fpPaintBuffers, phaseClock.nsecsElapsed());
+  phaseClock.start();
+#endif
   foreach (QCPLayer *layer, mLayers)
-    layer->drawToPaintBuffer();
+  {
+    if (scrollLayers.contains(layer))
+      layer->drawScrolledToPaintBuffer(mDragScrollAxisRect.data()->rect(), scrollDelta);
+    else
+      layer->drawToPaintBuffer();
+  }
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  mReplotProfiler->addPhaseTime(QCPReplotProfiler::fpLayers, phaseClock.nsecsElapsed());
+  mReplotProfiler->endFrame(frameClock.nsecsElapsed());
+#endif
   for (int i=0; i<mPaintBuffers.size(); ++i)
     mPaintBuffers.at(i)->setInvalidated(false);
+  if (mDragScrollAxisRect) // buffers now show the dragged axis rect at its current ranges
+    mDragScrollAxisRect.data()->mDragRenderedPos = mDragScrollAxisRect.data()->mDragLastPos;
   
   if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
     repaint();
@@ -14163,6 +14942,45 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = false;
 }
 
+/*!
+  Performs a fast preview replot and schedules a full quality replot to follow after the delay set
+  with \ref setRefineDelay.
+  
+  During the coarse replot, antialiasing is disabled for all elements and \ref coarseReplot
+  returns true. Plottables may use this to reduce their drawing effort, e.g. \ref QCPGraph only
+  visits a limited number of data points per pixel and omits scatter symbols. The number of data
+  points visited per pixel adapts to the measured frame time, see \ref setCoarseReplotBudget.
+  
+  This is used for mouse wheel zooming when the plotting hint \ref QCP::phProgressiveZoom is set.
+  
+  \see replot
+*/
+void QCustomPlot::replotCoarse()
+{
+  if (mReplotting)
+    return;
+  
+  const QCP::AntialiasedElements antialiasedBackup = mAntialiasedElements;
+  const QCP::AntialiasedElements notAntialiasedBackup = mNotAntialiasedElements;
+  mAntialiasedElements = QCP::aeNone;
+  mNotAntialiasedElements = QCP::aeAll;
+  mCoarseReplot = true;
+  QElapsedTimer frameClock;
+  frameClock.start();
+  replot();
+  const qint64 frameTime = frameClock.elapsed();
+  mCoarseReplot = false;
+  mAntialiasedElements = antialiasedBackup;
+  mNotAntialiasedElements = notAntialiasedBackup;
+  
+  // adapt the number of points visited per pixel to the frame time budget:
+  if (frameTime > mCoarseReplotBudget)
+    mCoarseSampleDensity = qMax(1, mCoarseSampleDensity/2);
+  else if (frameTime < mCoarseReplotBudget/2)
+    mCoarseSampleDensity = qMin(64, mCoarseSampleDensity*2);
+  mRefineTimer.start(mRefineDelay);
+}
+
 /*!
   Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
   
@@ -14456,12 +15274,21 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
   QCPPainter painter(this);
   if (painter.isActive())
   {
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+    QElapsedTimer paintClock;
+    paintClock.start();
+#endif
     painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
     if (mBackgroundBrush.style() != Qt::NoBrush)
       painter.fillRect(mViewport, mBackgroundBrush);
     drawBackground(&painter);
     for (int bufferIndex = 0; bufferIndex < mPaintBuffers.size(); ++bufferIndex)
       mPaintBuffers.at(bufferIndex)->draw(&painter);
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+    mReplotProfiler->addPhaseTime(QCPReplotProfiler::fpPaintEvent, paintClock.nsecsElapsed());
+    if (mReplotProfiler->overlayVisible())
+      mReplotProfiler->drawOverlay(&painter, mViewport);
+#endif
   }
 }
 
@@ -14781,13 +15608,15 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
   This method uses \ref createPaintBuffer to create new paint buffers.
 
   After this method, the paint buffers are empty (filled with \c Qt::transparent) and invalidated
-  (so an attempt to replot only a single buffered layer causes a full replot).
+  (so an attempt to replot only a single buffered layer causes a full replot). The buffers of the
+  \ref QCPLayer::lmBuffered layers in \a preservedLayers keep their content, so they can be
+  scrolled by \ref QCPLayer::drawScrolledToPaintBuffer.
 
   This method is called in every \ref replot call, prior to actually drawing the layers (into their
   associated paint buffer). If the paint buffers don't need changing/reallocating, this method
   basically leaves them alone and thus finishes very fast.
 */
-void QCustomPlot::setupPaintBuffers()
+void QCustomPlot::setupPaintBuffers(const QList<QCPLayer*> &preservedLayers)
 {
   int bufferIndex = 0;
   if (mPaintBuffers.isEmpty())
@@ -14816,11 +15645,15 @@ void QCustomPlot::setupPaintBuffers()
   // remove unneeded buffers:
   while (mPaintBuffers.size()-1 > bufferIndex)
     mPaintBuffers.removeLast();
-  // resize buffers to viewport size and clear contents:
+  // resize buffers to viewport size and clear contents (except of the buffers whose content is preserved):
+  QList<QCPAbstractPaintBuffer*> preservedBuffers;
+  foreach (QCPLayer *layer, preservedLayers)
+    preservedBuffers.append(layer->mPaintBuffer.data());
   for (int i=0; i<mPaintBuffers.size(); ++i)
   {
     mPaintBuffers.at(i)->setSize(viewport().size()); // won't do anything if already correct size
-    mPaintBuffers.at(i)->clear(Qt::transparent);
+    if (!preservedBuffers.contains(mPaintBuffers.at(i).data()))
+      mPaintBuffers.at(i)->clear(Qt::transparent);
     mPaintBuffers.at(i)->setInvalidated();
   }
 }
@@ -14845,7 +15678,9 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 #endif
-  } else
+  } else if (mPlottingHints.testFlag(QCP::phRasterLines))
+    return new QCPPaintBufferImage(viewport().size(), mBufferDevicePixelRatio);
+  else
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 }
 
@@ -15442,5891 +16277,8042 @@ void QCustomPlot::toPainter(QCPPainter *painter, int width, int height)
   } else
     qDebug() << Q_FUNC_INFO << "Passed painter is not active";
 }
-/* end of 'src/core.cpp' */
-
-//amalgamation: add plottable1d.cpp
-
-/* including file 'src/colorgradient.cpp', size 24646                        */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPColorGradient
+//////////////////// QCPReplotScheduler
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPColorGradient
-  \brief Defines a color gradient for use with e.g. \ref QCPColorMap
-  
-  This class describes a color gradient which can be used to encode data with color. For example,
-  QCPColorMap and QCPColorScale have \ref QCPColorMap::setGradient "setGradient" methods which
-  take an instance of this class. Colors are set with \ref setColorStopAt(double position, const QColor &color)
-  with a \a position from 0 to 1. In between these defined color positions, the
-  color will be interpolated linearly either in RGB or HSV space, see \ref setColorInterpolation.
+/*! \class QCPReplotScheduler
+  \brief Coalesces queued replots of one or more QCustomPlots into frames of a fixed rate
 
-  Alternatively, load one of the preset color gradients shown in the image below, with \ref
-  loadPreset, or by directly specifying the preset in the constructor.
-  
-  Apart from red, green and blue components, the gradient also interpolates the alpha values of the
-  configured color stops. This allows to display some portions of the data range as transparent in
-  the plot.
-  
-  \image html QCPColorGradient.png
-  
-  The \ref QCPColorGradient(GradientPreset preset) constructor allows directly converting a \ref
-  GradientPreset to a QCPColorGradient. This means that you can directly pass \ref GradientPreset
-  to all the \a setGradient methods, e.g.:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorgradient-setgradient
-  
-  The total number of levels used in the gradient can be set with \ref setLevelCount. Whether the
-  color gradient shall be applied periodically (wrapping around) to data values that lie outside
-  the data range specified on the plottable instance can be controlled with \ref setPeriodic.
+  Applications often request replots from many places, e.g. every slot that changes some aspect of
+  the plot. With \ref QCustomPlot::rpQueuedReplot, those requests are only merged within one event
+  loop iteration, so a burst of updates spread over several iterations still causes a burst of
+  replots.
+
+  When a QCPReplotScheduler is set on a QCustomPlot with \ref QCustomPlot::setReplotScheduler,
+  queued replots of that plot are handed to the scheduler instead. The scheduler renders all plots
+  with pending replots together in one frame, and starts at most one frame per frame interval (see
+  \ref setFrameRate). If a frame takes longer than the interval, or the event loop was busy when
+  the frame was due, the frames that couldn't be shown in time are dropped instead of being
+  rendered late. All replot requests that arrived meanwhile are merged into the next frame. The
+  number of dropped frames is available via \ref skippedFrames.
+
+  Sharing one scheduler between multiple QCustomPlots lets them update in the same frame.
 */
 
-/*!
-  Constructs a new, empty QCPColorGradient with no predefined color stops. You can add own color
-  stops with \ref setColorStopAt.
+/* start documentation of inline functions */
 
-  The color level count is initialized to 350.
+/*! \fn int QCPReplotScheduler::renderedFrames() const
+
+  Returns the number of frames rendered since construction or the last call of \ref
+  resetFrameCounters.
 */
-QCPColorGradient::QCPColorGradient() :
-  mLevelCount(350),
-  mColorInterpolation(ciRGB),
-  mPeriodic(false),
-  mColorBufferInvalidated(true)
-{
-  mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
-}
 
-/*!
-  Constructs a new QCPColorGradient initialized with the colors and color interpolation according
-  to \a preset.
+/*! \fn int QCPReplotScheduler::skippedFrames() const
 
-  The color level count is initialized to 350.
+  Returns the number of frames that were dropped since construction or the last call of \ref
+  resetFrameCounters, because a frame overran its interval or the event loop couldn't start a frame
+  in time.
 */
-QCPColorGradient::QCPColorGradient(GradientPreset preset) :
-  mLevelCount(350),
-  mColorInterpolation(ciRGB),
-  mPeriodic(false),
-  mColorBufferInvalidated(true)
-{
-  mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
-  loadPreset(preset);
-}
 
-/* undocumented operator */
-bool QCPColorGradient::operator==(const QCPColorGradient &other) const
+/* end documentation of inline functions */
+
+/*!
+  Creates a replot scheduler which renders frames at the refresh rate of the primary screen.
+*/
+QCPReplotScheduler::QCPReplotScheduler(QObject *parent) :
+  QObject(parent),
+  mFrameRate(0),
+  mNextFrameTime(0),
+  mRenderedFrames(0),
+  mSkippedFrames(0),
+  mRendering(false)
 {
-  return ((other.mLevelCount == this->mLevelCount) &&
-          (other.mColorInterpolation == this->mColorInterpolation) &&
-          (other.mPeriodic == this->mPeriodic) &&
-          (other.mColorStops == this->mColorStops));
+  mFrameTimer.setSingleShot(true);
+  connect(&mFrameTimer, SIGNAL(timeout()), this, SLOT(renderFrame()));
 }
 
 /*!
-  Sets the number of discretization levels of the color gradient to \a n. The default is 350 which
-  is typically enough to create a smooth appearance. The minimum number of levels is 2.
-
-  \image html QCPColorGradient-levelcount.png
+  Sets the maximum number of frames per second. If \a frameRate is 0, the refresh rate of the
+  primary screen is used (or 60 frames per second if it can't be determined).
 */
-void QCPColorGradient::setLevelCount(int n)
+void QCPReplotScheduler::setFrameRate(double frameRate)
 {
-  if (n < 2)
-  {
-    qDebug() << Q_FUNC_INFO << "n must be greater or equal 2 but was" << n;
-    n = 2;
-  }
-  if (n != mLevelCount)
-  {
-    mLevelCount = n;
-    mColorBufferInvalidated = true;
-  }
+  mFrameRate = qMax(0.0, frameRate);
 }
 
 /*!
-  Sets at which positions from 0 to 1 which color shall occur. The positions are the keys, the
-  colors are the values of the passed QMap \a colorStops. In between these color stops, the color
-  is interpolated according to \ref setColorInterpolation.
+  Requests a replot of \a plot in the next frame. Requesting the replot of a plot that is already
+  scheduled has no effect.
   
-  A more convenient way to create a custom gradient may be to clear all color stops with \ref
-  clearColorStops (or creating a new, empty QCPColorGradient) and then adding them one by one with
-  \ref setColorStopAt.
+  If no frame was rendered within the last frame interval, the next frame is rendered in the next
+  event loop iteration. Otherwise, it is rendered one frame interval after the previous one.
   
-  \see clearColorStops
+  Usually this is called by \ref QCustomPlot::replot with \ref QCustomPlot::rpQueuedReplot priority.
 */
-void QCPColorGradient::setColorStops(const QMap<double, QColor> &colorStops)
+void QCPReplotScheduler::schedule(QCustomPlot *plot)
 {
-  mColorStops = colorStops;
-  mColorBufferInvalidated = true;
+  if (!plot)
+    return;
+  if (!isScheduled(plot))
+    mScheduledPlots.append(plot);
+  if (!mFrameTimer.isActive() && !mRendering) // while rendering, renderFrame starts the timer for the next frame itself
+  {
+    if (!mFrameClock.isValid())
+      mFrameClock.start();
+    const double now = frameClockTime();
+    if (mNextFrameTime < now) // idle since the last frame, render as soon as possible
+      mNextFrameTime = now;
+    mFrameTimer.start(qCeil(mNextFrameTime-now));
+  }
 }
 
 /*!
-  Sets the \a color the gradient will have at the specified \a position (from 0 to 1). In between
-  these color stops, the color is interpolated according to \ref setColorInterpolation.
-  
-  \see setColorStops, clearColorStops
+  Removes a pending replot of \a plot. This is called by \ref QCustomPlot::replot when the plot is
+  replotted before the scheduled frame.
 */
-void QCPColorGradient::setColorStopAt(double position, const QColor &color)
+void QCPReplotScheduler::unschedule(QCustomPlot *plot)
 {
-  mColorStops.insert(position, color);
-  mColorBufferInvalidated = true;
+  for (int i=mScheduledPlots.size()-1; i>=0; --i)
+  {
+    if (mScheduledPlots.at(i).data() == plot || mScheduledPlots.at(i).isNull())
+      mScheduledPlots.removeAt(i);
+  }
+  if (mScheduledPlots.isEmpty())
+    mFrameTimer.stop();
 }
 
 /*!
-  Sets whether the colors in between the configured color stops (see \ref setColorStopAt) shall be
-  interpolated linearly in RGB or in HSV color space.
-  
-  For example, a sweep in RGB space from red to green will have a muddy brown intermediate color,
-  whereas in HSV space the intermediate color is yellow.
+  Returns whether \a plot has a pending replot in the next frame.
 */
-void QCPColorGradient::setColorInterpolation(QCPColorGradient::ColorInterpolation interpolation)
+bool QCPReplotScheduler::isScheduled(QCustomPlot *plot) const
 {
-  if (interpolation != mColorInterpolation)
+  for (int i=0; i<mScheduledPlots.size(); ++i)
   {
-    mColorInterpolation = interpolation;
-    mColorBufferInvalidated = true;
+    if (mScheduledPlots.at(i).data() == plot)
+      return true;
   }
+  return false;
 }
 
 /*!
-  Sets whether data points that are outside the configured data range (e.g. \ref
-  QCPColorMap::setDataRange) are colored by periodically repeating the color gradient or whether
-  they all have the same color, corresponding to the respective gradient boundary color.
-  
-  \image html QCPColorGradient-periodic.png
-  
-  As shown in the image above, gradients that have the same start and end color are especially
-  suitable for a periodic gradient mapping, since they produce smooth color transitions throughout
-  the color map. A preset that has this property is \ref gpHues.
-  
-  In practice, using periodic color gradients makes sense when the data corresponds to a periodic
-  dimension, such as an angle or a phase. If this is not the case, the color encoding might become
-  ambiguous, because multiple different data values are shown as the same color.
+  Resets the counters returned by \ref renderedFrames and \ref skippedFrames to zero.
 */
-void QCPColorGradient::setPeriodic(bool enabled)
+void QCPReplotScheduler::resetFrameCounters()
 {
-  mPeriodic = enabled;
+  mRenderedFrames = 0;
+  mSkippedFrames = 0;
 }
 
-/*! \overload
+/*! \internal
   
-  This method is used to quickly convert a \a data array to colors. The colors will be output in
-  the array \a scanLine. Both \a data and \a scanLine must have the length \a n when passed to this
-  function. The data range that shall be used for mapping the data value to the gradient is passed
-  in \a range. \a logarithmic indicates whether the data values shall be mapped to colors
-  logarithmically.
+  Returns the frame interval in milliseconds, as given by \ref setFrameRate or the refresh rate of
+  the primary screen.
+*/
+double QCPReplotScheduler::frameInterval() const
+{
+  double frameRate = mFrameRate;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+  if (frameRate <= 0 && QGuiApplication::primaryScreen())
+    frameRate = QGuiApplication::primaryScreen()->refreshRate();
+#endif
+  if (frameRate <= 0)
+    frameRate = 60;
+  return 1000.0/frameRate;
+}
 
-  if \a data actually contains 2D-data linearized via <tt>[row*columnCount + column]</tt>, you can
-  set \a dataIndexFactor to <tt>columnCount</tt> to convert a column instead of a row of the data
-  array, in \a scanLine. \a scanLine will remain a regular (1D) array. This works because \a data
-  is addressed <tt>data[i*dataIndexFactor]</tt>.
+/*! \internal
   
-  Use the overloaded method to additionally provide alpha map data.
+  Returns the time in milliseconds since the frame clock was started, with sub-millisecond
+  resolution.
+*/
+double QCPReplotScheduler::frameClockTime() const
+{
+  return mFrameClock.nsecsElapsed()*1e-6;
+}
 
-  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
-  with alpha (see QImage::Format_ARGB32_Premultiplied).
+/*! \internal
+  
+  Replots all scheduled plots in one frame and determines when the next frame may start. Frame
+  times are kept on a grid of frame intervals, so frames whose time passed while the previous frame
+  was rendering or the event loop was busy are counted as skipped.
 */
-void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+void QCPReplotScheduler::renderFrame()
 {
-  // If you change something here, make sure to also adapt color() and the other colorize() overload
-  if (!data)
+  const double interval = frameInterval();
+  double now = frameClockTime();
+  if (now-mNextFrameTime >= interval) // timer fired late, the frames due meanwhile are dropped
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as data";
-    return;
+    const int missed = int((now-mNextFrameTime)/interval);
+    mSkippedFrames += missed;
+    mNextFrameTime += missed*interval;
   }
-  if (!scanLine)
+  
+  // plots scheduled while this frame renders (e.g. via beforeReplot/afterReplot) go to the next frame:
+  QList<QPointer<QCustomPlot> > plots = mScheduledPlots;
+  mScheduledPlots.clear();
+  mRendering = true;
+  for (int i=0; i<plots.size(); ++i)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
-    return;
+    // queue the widget repaints, so Qt flushes all plots of this frame in one backing store update:
+    if (plots.at(i))
+      plots.at(i).data()->replot(QCustomPlot::rpQueuedRefresh);
   }
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
+  mRendering = false;
+  ++mRenderedFrames;
   
-  if (!logarithmic)
-  {
-    const double posToIndexFactor = (mLevelCount-1)/range.size();
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    } else
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    }
-  } else // logarithmic == true
+  mNextFrameTime += interval;
+  now = frameClockTime();
+  if (now > mNextFrameTime) // this frame overran the following frame time(s), drop them
   {
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1)) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    } else
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    }
+    const int overrun = int((now-mNextFrameTime)/interval)+1;
+    mSkippedFrames += overrun;
+    mNextFrameTime += overrun*interval;
   }
+  if (!mScheduledPlots.isEmpty())
+    mFrameTimer.start(qCeil(qMax(0.0, mNextFrameTime-now)));
 }
 
-/*! \overload
 
-  Additionally to the other overload of \ref colorize, this method takes the array \a alpha, which
-  has the same size and structure as \a data and encodes the alpha information per data point.
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPReplotProfiler
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
-  with alpha (see QImage::Format_ARGB32_Premultiplied).
+/*! \class QCPReplotProfiler
+  \brief Records the durations of the phases of recent replots and of individual layerable draws
+
+  Each QCustomPlot owns a replot profiler, accessible via \ref QCustomPlot::replotProfiler, if
+  QCustomPlot is compiled with the macro \c QCUSTOMPLOT_PROFILE_REPLOT defined (e.g. by adding
+  <tt>DEFINES += QCUSTOMPLOT_PROFILE_REPLOT</tt> to the qmake project file). Without that macro,
+  neither this class nor any of the timing code in the replot exists, so normal builds don't pay
+  for the instrumentation.
+
+  For the last \ref setHistorySize replots, the profiler keeps the total replot time (\ref
+  frameTimes), the time of each \ref Phase (\ref phaseTimes) and, for every layerable, the time its
+  \ref QCPLayerable::draw took (\ref layerableTimes). All times are in milliseconds.
+
+  With \ref setOverlayVisible, a summary of the average times is drawn on top of the plot. \ref
+  saveCsv writes all recorded timings to a file, e.g. to compare the replot performance of two
+  builds.
 */
-void QCPColorGradient::colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+
+/*!
+  Creates a replot profiler which keeps the timings of the last \a historySize replots.
+*/
+QCPReplotProfiler::QCPReplotProfiler(int historySize) :
+  mHistorySize(qMax(1, historySize)),
+  mOverlayVisible(false)
 {
-  // If you change something here, make sure to also adapt color() and the other colorize() overload
-  if (!data)
+  beginFrame();
+}
+
+/*!
+  Sets the number of recent replots (or draws, respectively) whose timings are kept. This clears
+  all recorded timings.
+*/
+void QCPReplotProfiler::setHistorySize(int frames)
+{
+  mHistorySize = qMax(1, frames);
+  clear();
+}
+
+/*!
+  Sets whether the timing summary overlay is drawn on top of the plot in every paint event. The
+  overlay shows the average times over the recorded history for the whole replot, each phase and
+  the most expensive layerables.
+*/
+void QCPReplotProfiler::setOverlayVisible(bool visible)
+{
+  mOverlayVisible = visible;
+}
+
+/*!
+  Returns the total durations of the recorded replots in milliseconds, oldest first.
+*/
+QVector<double> QCPReplotProfiler::frameTimes() const
+{
+  return historyTimes(mFrameHistory);
+}
+
+/*!
+  Returns the durations of \a phase in the recorded replots in milliseconds, oldest first. For
+  \ref fpPaintEvent, the durations of the recorded paint events are returned.
+*/
+QVector<double> QCPReplotProfiler::phaseTimes(Phase phase) const
+{
+  return historyTimes(mPhaseHistories[phase]);
+}
+
+/*!
+  Returns the durations of the recorded draws of \a layerable in milliseconds, oldest first.
+*/
+QVector<double> QCPReplotProfiler::layerableTimes(QCPLayerable *layerable) const
+{
+  QHash<QCPLayerable*, TimingHistory>::const_iterator it = mLayerableHistories.constFind(layerable);
+  if (it == mLayerableHistories.constEnd() || it.value().layerable.data() != layerable)
+    return QVector<double>();
+  return historyTimes(it.value());
+}
+
+/*!
+  Returns all layerables for which draw timings were recorded.
+*/
+QList<QCPLayerable*> QCPReplotProfiler::layerables() const
+{
+  QList<QCPLayerable*> result;
+  QHash<QCPLayerable*, TimingHistory>::const_iterator it;
+  for (it = mLayerableHistories.constBegin(); it != mLayerableHistories.constEnd(); ++it)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as data";
-    return;
+    if (it.value().layerable)
+      result.append(it.value().layerable.data());
   }
-  if (!alpha)
+  return result;
+}
+
+/*!
+  Removes all recorded timings.
+*/
+void QCPReplotProfiler::clear()
+{
+  mFrameHistory = TimingHistory();
+  for (int i=0; i<phaseCount; ++i)
+    mPhaseHistories[i] = TimingHistory();
+  mLayerableHistories.clear();
+  beginFrame();
+}
+
+/*!
+  Writes all recorded timings to the file \a fileName as comma separated values with the columns
+  \c series, \c sample and \c milliseconds. The series are \c replot for the total replot times,
+  the phase names (see \ref Phase) and the names of the layerables (the plottable name if set,
+  otherwise the class name, followed by the object address to distinguish equally named ones).
+  Samples are numbered from oldest to newest, starting at 0.
+  
+  Returns true on success.
+*/
+bool QCPReplotProfiler::saveCsv(const QString &fileName) const
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
-    return;
+    qDebug() << Q_FUNC_INFO << "Failed to open file" << fileName << "for writing:" << file.errorString();
+    return false;
   }
-  if (!scanLine)
+  QTextStream stream(&file);
+  stream << "series,sample,milliseconds\n";
+  QList<QPair<QString, QVector<double> > > series;
+  series.append(qMakePair(QString(QLatin1String("replot")), frameTimes()));
+  for (int i=0; i<phaseCount; ++i)
+    series.append(qMakePair(phaseName(Phase(i)), phaseTimes(Phase(i))));
+  foreach (QCPLayerable *layerable, layerables())
+    series.append(qMakePair(QString(QLatin1String("%1 (0x%2)")).arg(layerableName(layerable)).arg(quintptr(layerable), 0, 16), layerableTimes(layerable)));
+  for (int i=0; i<series.size(); ++i)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
-    return;
+    QString name = series.at(i).first;
+    name.replace(QLatin1Char('"'), QLatin1String("\"\""));
+    for (int k=0; k<series.at(i).second.size(); ++k)
+      stream << '"' << name << "\"," << k << ',' << QString::number(series.at(i).second.at(k), 'f', 4) << '\n';
   }
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
+  stream.flush();
+  return file.error() == QFile::NoError;
+}
+
+/*! \internal
   
-  if (!logarithmic)
+  Starts the timing of a new replot. Called by \ref QCustomPlot::replot.
+*/
+void QCPReplotProfiler::beginFrame()
+{
+  for (int i=0; i<phaseCount; ++i)
+    mFramePhaseTimes[i] = 0;
+}
+
+/*! \internal
+  
+  Finishes the timing of a replot which took \a nanoseconds in total, and records the accumulated
+  phase times of the replot. Called by \ref QCustomPlot::replot.
+*/
+void QCPReplotProfiler::endFrame(qint64 nanoseconds)
+{
+  pushTime(&mFrameHistory, nanoseconds);
+  for (int i=0; i<phaseCount; ++i)
   {
-    const double posToIndexFactor = (mLevelCount-1)/range.size();
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        if (alpha[dataIndexFactor*i] == 255)
-        {
-          scanLine[i] = mColorBuffer.at(index);
-        } else
-        {
-          const QRgb rgb = mColorBuffer.at(index);
-          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
-          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
-        }
-      }
-    } else
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        if (alpha[dataIndexFactor*i] == 255)
-        {
-          scanLine[i] = mColorBuffer.at(index);
-        } else
-        {
-          const QRgb rgb = mColorBuffer.at(index);
-          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
-          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
-        }
-      }
-    }
-  } else // logarithmic == true
+    if (i != fpPaintEvent)
+      pushTime(&mPhaseHistories[i], mFramePhaseTimes[i]);
+  }
+  // forget layerables that were deleted:
+  QHash<QCPLayerable*, TimingHistory>::iterator it = mLayerableHistories.begin();
+  while (it != mLayerableHistories.end())
   {
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1)) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        if (alpha[dataIndexFactor*i] == 255)
-        {
-          scanLine[i] = mColorBuffer.at(index);
-        } else
-        {
-          const QRgb rgb = mColorBuffer.at(index);
-          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
-          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
-        }
-      }
-    } else
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        if (alpha[dataIndexFactor*i] == 255)
-        {
-          scanLine[i] = mColorBuffer.at(index);
-        } else
-        {
-          const QRgb rgb = mColorBuffer.at(index);
-          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
-          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
-        }
-      }
-    }
+    if (it.value().layerable.isNull())
+      it = mLayerableHistories.erase(it);
+    else
+      ++it;
   }
 }
 
 /*! \internal
-
-  This method is used to colorize a single data value given in \a position, to colors. The data
-  range that shall be used for mapping the data value to the gradient is passed in \a range. \a
-  logarithmic indicates whether the data value shall be mapped to a color logarithmically.
-
-  If an entire array of data values shall be converted, rather use \ref colorize, for better
-  performance.
-
-  The returned QRgb has its r, g and b components premultiplied with alpha (see
-  QImage::Format_ARGB32_Premultiplied).
+  
+  Adds \a nanoseconds to the time of \a phase in the current replot. A phase may be entered
+  multiple times per replot, e.g. \ref fpAxisTicks once per axis.
+  
+  Paint events are not part of a replot, so each call with \ref fpPaintEvent is recorded as a
+  separate entry.
 */
-QRgb QCPColorGradient::color(double position, const QCPRange &range, bool logarithmic)
+void QCPReplotProfiler::addPhaseTime(Phase phase, qint64 nanoseconds)
 {
-  // If you change something here, make sure to also adapt ::colorize()
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
-  int index = 0;
-  if (!logarithmic)
-    index = (position-range.lower)*(mLevelCount-1)/range.size();
+  if (phase == fpPaintEvent)
+    pushTime(&mPhaseHistories[phase], nanoseconds);
   else
-    index = qLn(position/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
-  if (mPeriodic)
-  {
-    index = index % mLevelCount;
-    if (index < 0)
-      index += mLevelCount;
-  } else
+    mFramePhaseTimes[phase] += nanoseconds;
+}
+
+/*! \internal
+  
+  Records that a draw of \a layerable took \a nanoseconds. Called by \ref QCPLayer for every
+  layerable it draws.
+*/
+void QCPReplotProfiler::addLayerableTime(QCPLayerable *layerable, qint64 nanoseconds)
+{
+  TimingHistory &history = mLayerableHistories[layerable];
+  if (history.layerable.data() != layerable) // new entry, or a new layerable at the address of a deleted one
   {
-    if (index < 0)
-      index = 0;
-    else if (index >= mLevelCount)
-      index = mLevelCount-1;
+    history = TimingHistory();
+    history.layerable = layerable;
   }
-  return mColorBuffer.at(index);
+  pushTime(&history, nanoseconds);
 }
 
-/*!
-  Clears the current color stops and loads the specified \a preset. A preset consists of predefined
-  color stops and the corresponding color interpolation method.
+/*! \internal
   
-  The available presets are:
-  \image html QCPColorGradient.png
+  Draws the timing summary overlay with \a painter into the top left corner of \a viewport. Called
+  in the paint event of QCustomPlot, if \ref setOverlayVisible is enabled.
 */
-void QCPColorGradient::loadPreset(GradientPreset preset)
+void QCPReplotProfiler::drawOverlay(QCPPainter *painter, const QRect &viewport) const
 {
-  clearColorStops();
-  switch (preset)
+  const int maxLayerables = 5;
+  
+  QStringList lines;
+  lines.append(QString(QLatin1String("%1 %2 ms")).arg(QLatin1String("replot"), -14).arg(averageTime(frameTimes()), 7, 'f', 2));
+  for (int i=0; i<phaseCount; ++i)
+    lines.append(QString(QLatin1String("  %1 %2 ms")).arg(phaseName(Phase(i)), -12).arg(averageTime(phaseTimes(Phase(i))), 7, 'f', 2));
+  
+  // list the layerables with the highest average draw times:
+  QMultiMap<double, QCPLayerable*> layerablesByTime;
+  foreach (QCPLayerable *layerable, layerables())
+    layerablesByTime.insert(averageTime(layerableTimes(layerable)), layerable);
+  QMapIterator<double, QCPLayerable*> it(layerablesByTime);
+  it.toBack();
+  while (it.hasPrevious() && lines.size() < phaseCount+1+maxLayerables)
   {
-    case gpGrayscale:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, Qt::black);
-      setColorStopAt(1, Qt::white);
-      break;
-    case gpHot:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(50, 0, 0));
-      setColorStopAt(0.2, QColor(180, 10, 0));
-      setColorStopAt(0.4, QColor(245, 50, 0));
-      setColorStopAt(0.6, QColor(255, 150, 10));
-      setColorStopAt(0.8, QColor(255, 255, 50));
-      setColorStopAt(1, QColor(255, 255, 255));
-      break;
-    case gpCold:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(0, 0, 50));
-      setColorStopAt(0.2, QColor(0, 10, 180));
-      setColorStopAt(0.4, QColor(0, 50, 245));
-      setColorStopAt(0.6, QColor(10, 150, 255));
-      setColorStopAt(0.8, QColor(50, 255, 255));
-      setColorStopAt(1, QColor(255, 255, 255));
-      break;
-    case gpNight:
-      setColorInterpolation(ciHSV);
-      setColorStopAt(0, QColor(10, 20, 30));
-      setColorStopAt(1, QColor(250, 255, 250));
-      break;
-    case gpCandy:
-      setColorInterpolation(ciHSV);
-      setColorStopAt(0, QColor(0, 0, 255));
-      setColorStopAt(1, QColor(255, 250, 250));
-      break;
-    case gpGeography:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(70, 170, 210));
-      setColorStopAt(0.20, QColor(90, 160, 180));
-      setColorStopAt(0.25, QColor(45, 130, 175));
-      setColorStopAt(0.30, QColor(100, 140, 125));
-      setColorStopAt(0.5, QColor(100, 140, 100));
-      setColorStopAt(0.6, QColor(130, 145, 120));
-      setColorStopAt(0.7, QColor(140, 130, 120));
-      setColorStopAt(0.9, QColor(180, 190, 190));
-      setColorStopAt(1, QColor(210, 210, 230));
-      break;
-    case gpIon:
-      setColorInterpolation(ciHSV);
-      setColorStopAt(0, QColor(50, 10, 10));
-      setColorStopAt(0.45, QColor(0, 0, 255));
-      setColorStopAt(0.8, QColor(0, 255, 255));
-      setColorStopAt(1, QColor(0, 255, 0));
-      break;
-    case gpThermal:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(0, 0, 50));
-      setColorStopAt(0.15, QColor(20, 0, 120));
-      setColorStopAt(0.33, QColor(200, 30, 140));
-      setColorStopAt(0.6, QColor(255, 100, 0));
-      setColorStopAt(0.85, QColor(255, 255, 40));
-      setColorStopAt(1, QColor(255, 255, 255));
-      break;
-    case gpPolar:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(50, 255, 255));
-      setColorStopAt(0.18, QColor(10, 70, 255));
-      setColorStopAt(0.28, QColor(10, 10, 190));
-      setColorStopAt(0.5, QColor(0, 0, 0));
-      setColorStopAt(0.72, QColor(190, 10, 10));
-      setColorStopAt(0.82, QColor(255, 70, 10));
-      setColorStopAt(1, QColor(255, 255, 50));
-      break;
-    case gpSpectrum:
-      setColorInterpolation(ciHSV);
-      setColorStopAt(0, QColor(50, 0, 50));
-      setColorStopAt(0.15, QColor(0, 0, 255));
-      setColorStopAt(0.35, QColor(0, 255, 255));
-      setColorStopAt(0.6, QColor(255, 255, 0));
-      setColorStopAt(0.75, QColor(255, 30, 0));
-      setColorStopAt(1, QColor(50, 0, 0));
-      break;
-    case gpJet:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(0, 0, 100));
-      setColorStopAt(0.15, QColor(0, 50, 255));
-      setColorStopAt(0.35, QColor(0, 255, 255));
-      setColorStopAt(0.65, QColor(255, 255, 0));
-      setColorStopAt(0.85, QColor(255, 30, 0));
-      setColorStopAt(1, QColor(100, 0, 0));
-      break;
-    case gpHues:
-      setColorInterpolation(ciHSV);
-      setColorStopAt(0, QColor(255, 0, 0));
-      setColorStopAt(1.0/3.0, QColor(0, 0, 255));
-      setColorStopAt(2.0/3.0, QColor(0, 255, 0));
-      setColorStopAt(1, QColor(255, 0, 0));
-      break;
+    it.previous();
+    lines.append(QString(QLatin1String("%1 %2 ms")).arg(layerableName(it.value()).left(14), -14).arg(it.key(), 7, 'f', 2));
   }
+  
+  painter->save();
+  painter->setClipRect(viewport);
+  QFont font(QLatin1String("Monospace"), 8);
+  font.setStyleHint(QFont::TypeWriter);
+  painter->setFont(font);
+  const QFontMetrics metrics(font);
+  const int margin = 4;
+  int textWidth = 0;
+  for (int i=0; i<lines.size(); ++i)
+#if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
+    textWidth = qMax(textWidth, metrics.width(lines.at(i)));
+#else
+    textWidth = qMax(textWidth, metrics.horizontalAdvance(lines.at(i)));
+#endif
+  const QRect box(viewport.topLeft()+QPoint(margin, margin), QSize(textWidth+2*margin, lines.size()*metrics.height()+2*margin));
+  painter->fillRect(box, QColor(0, 0, 0, 160));
+  painter->setPen(Qt::white);
+  for (int i=0; i<lines.size(); ++i)
+    painter->drawText(box.left()+margin, box.top()+margin+i*metrics.height()+metrics.ascent(), lines.at(i));
+  painter->restore();
 }
 
-/*!
-  Clears all color stops.
+/*! \internal
   
-  \see setColorStops, setColorStopAt
+  Appends \a nanoseconds (converted to milliseconds) to the ring buffer of \a history, overwriting
+  the oldest entry once the history size is reached.
 */
-void QCPColorGradient::clearColorStops()
+void QCPReplotProfiler::pushTime(TimingHistory *history, qint64 nanoseconds) const
 {
-  mColorStops.clear();
-  mColorBufferInvalidated = true;
+  if (history->times.size() != mHistorySize)
+  {
+    history->times.fill(0, mHistorySize);
+    history->next = 0;
+    history->count = 0;
+  }
+  history->times[history->next] = nanoseconds*1e-6;
+  history->next = (history->next+1)%mHistorySize;
+  history->count = qMin(history->count+1, mHistorySize);
 }
 
-/*!
-  Returns an inverted gradient. The inverted gradient has all properties as this \ref
-  QCPColorGradient, but the order of the color stops is inverted.
+/*! \internal
   
-  \see setColorStops, setColorStopAt
+  Returns the recorded times of \a history in chronological order.
 */
-QCPColorGradient QCPColorGradient::inverted() const
+QVector<double> QCPReplotProfiler::historyTimes(const TimingHistory &history) const
 {
-  QCPColorGradient result(*this);
-  result.clearColorStops();
-  for (QMap<double, QColor>::const_iterator it=mColorStops.constBegin(); it!=mColorStops.constEnd(); ++it)
-    result.setColorStopAt(1.0-it.key(), it.value());
+  QVector<double> result;
+  result.reserve(history.count);
+  const int size = history.times.size();
+  for (int i=history.count; i>0; --i)
+    result.append(history.times.at((history.next-i+size)%size));
   return result;
 }
 
 /*! \internal
   
-  Returns true if the color gradient uses transparency, i.e. if any of the configured color stops
-  has an alpha value below 255.
+  Returns the mean of \a times, or 0 if \a times is empty.
 */
-bool QCPColorGradient::stopsUseAlpha() const
+double QCPReplotProfiler::averageTime(const QVector<double> &times)
 {
-  for (QMap<double, QColor>::const_iterator it=mColorStops.constBegin(); it!=mColorStops.constEnd(); ++it)
+  if (times.isEmpty())
+    return 0;
+  double sum = 0;
+  for (int i=0; i<times.size(); ++i)
+    sum += times.at(i);
+  return sum/times.size();
+}
+
+/*! \internal
+  
+  Returns the name of \a phase as used in the overlay and in \ref saveCsv.
+*/
+QString QCPReplotProfiler::phaseName(Phase phase)
+{
+  switch (phase)
   {
-    if (it.value().alpha() < 255)
-      return true;
+    case fpLayout: return QLatin1String("layout");
+    case fpAxisTicks: return QLatin1String("axis ticks");
+    case fpPaintBuffers: return QLatin1String("paint buffers");
+    case fpLayers: return QLatin1String("layers");
+    case fpMapImages: return QLatin1String("map images");
+    case fpPaintEvent: return QLatin1String("paint event");
   }
-  return false;
+  return QString();
 }
 
 /*! \internal
   
-  Updates the internal color buffer which will be used by \ref colorize and \ref color, to quickly
-  convert positions to colors. This is where the interpolation between color stops is calculated.
+  Returns the name of a plottable if it is set, or otherwise the class name of \a layerable.
 */
-void QCPColorGradient::updateColorBuffer()
+QString QCPReplotProfiler::layerableName(QCPLayerable *layerable)
 {
-  if (mColorBuffer.size() != mLevelCount)
-    mColorBuffer.resize(mLevelCount);
-  if (mColorStops.size() > 1)
-  {
-    double indexToPosFactor = 1.0/(double)(mLevelCount-1);
-    const bool useAlpha = stopsUseAlpha();
-    for (int i=0; i<mLevelCount; ++i)
-    {
-      double position = i*indexToPosFactor;
-      QMap<double, QColor>::const_iterator it = mColorStops.lowerBound(position);
-      if (it == mColorStops.constEnd()) // position is on or after last stop, use color of last stop
-      {
-        mColorBuffer[i] = (it-1).value().rgba();
-      } else if (it == mColorStops.constBegin()) // position is on or before first stop, use color of first stop
-      {
-        mColorBuffer[i] = it.value().rgba();
-      } else // position is in between stops (or on an intermediate stop), interpolate color
-      {
-        QMap<double, QColor>::const_iterator high = it;
-        QMap<double, QColor>::const_iterator low = it-1;
-        double t = (position-low.key())/(high.key()-low.key()); // interpolation factor 0..1
-        switch (mColorInterpolation)
-        {
-          case ciRGB:
-          {
-            if (useAlpha)
-            {
-              const int alpha = (1-t)*low.value().alpha() + t*high.value().alpha();
-              const float alphaPremultiplier = alpha/255.0f; // since we use QImage::Format_ARGB32_Premultiplied
-              mColorBuffer[i] = qRgba(((1-t)*low.value().red() + t*high.value().red())*alphaPremultiplier,
-                                      ((1-t)*low.value().green() + t*high.value().green())*alphaPremultiplier,
-                                      ((1-t)*low.value().blue() + t*high.value().blue())*alphaPremultiplier,
-                                      alpha);
-            } else
-            {
-              mColorBuffer[i] = qRgb(((1-t)*low.value().red() + t*high.value().red()),
-                                     ((1-t)*low.value().green() + t*high.value().green()),
-                                     ((1-t)*low.value().blue() + t*high.value().blue()));
-            }
-            break;
-          }
-          case ciHSV:
-          {
-            QColor lowHsv = low.value().toHsv();
-            QColor highHsv = high.value().toHsv();
-            double hue = 0;
-            double hueDiff = highHsv.hueF()-lowHsv.hueF();
-            if (hueDiff > 0.5)
-              hue = lowHsv.hueF() - t*(1.0-hueDiff);
-            else if (hueDiff < -0.5)
-              hue = lowHsv.hueF() + t*(1.0+hueDiff);
-            else
-              hue = lowHsv.hueF() + t*hueDiff;
-            if (hue < 0) hue += 1.0;
-            else if (hue >= 1.0) hue -= 1.0;
-            if (useAlpha)
-            {
-              const QRgb rgb = QColor::fromHsvF(hue,
-                                                (1-t)*lowHsv.saturationF() + t*highHsv.saturationF(),
-                                                (1-t)*lowHsv.valueF() + t*highHsv.valueF()).rgb();
-              const float alpha = (1-t)*lowHsv.alphaF() + t*highHsv.alphaF();
-              mColorBuffer[i] = qRgba(qRed(rgb)*alpha, qGreen(rgb)*alpha, qBlue(rgb)*alpha, 255*alpha);
-            }
-            else
-            {
-              mColorBuffer[i] = QColor::fromHsvF(hue,
-                                                 (1-t)*lowHsv.saturationF() + t*highHsv.saturationF(),
-                                                 (1-t)*lowHsv.valueF() + t*highHsv.valueF()).rgb();
-            }
-            break;
-          }
-        }
-      }
-    }
-  } else if (mColorStops.size() == 1)
-  {
-    const QRgb rgb = mColorStops.constBegin().value().rgb();
-    const float alpha = mColorStops.constBegin().value().alphaF();
-    mColorBuffer.fill(qRgba(qRed(rgb)*alpha, qGreen(rgb)*alpha, qBlue(rgb)*alpha, 255*alpha));
-  } else // mColorStops is empty, fill color buffer with black
+  if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(layerable))
   {
-    mColorBuffer.fill(qRgb(0, 0, 0));
+    if (!plottable->name().isEmpty())
+      return plottable->name();
   }
-  mColorBufferInvalidated = false;
+  return QLatin1String(layerable->metaObject()->className());
 }
-/* end of 'src/colorgradient.cpp' */
+#endif // QCUSTOMPLOT_PROFILE_REPLOT
+/* end of 'src/core.cpp' */
 
+//amalgamation: add plottable1d.cpp
 
-/* including file 'src/selectiondecorator-bracket.cpp', size 12313           */
+/* including file 'src/colorgradient.cpp', size 24646                        */
 /* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPSelectionDecoratorBracket
+//////////////////// QCPColorGradient
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPSelectionDecoratorBracket
-  \brief A selection decorator which draws brackets around each selected data segment
+/*! \class QCPColorGradient
+  \brief Defines a color gradient for use with e.g. \ref QCPColorMap
   
-  Additionally to the regular highlighting of selected segments via color, fill and scatter style,
-  this \ref QCPSelectionDecorator subclass draws markers at the begin and end of each selected data
-  segment of the plottable.
+  This class describes a color gradient which can be used to encode data with color. For example,
+  QCPColorMap and QCPColorScale have \ref QCPColorMap::setGradient "setGradient" methods which
+  take an instance of this class. Colors are set with \ref setColorStopAt(double position, const QColor &color)
+  with a \a position from 0 to 1. In between these defined color positions, the
+  color will be interpolated linearly either in RGB or HSV space, see \ref setColorInterpolation.
+
+  Alternatively, load one of the preset color gradients shown in the image below, with \ref
+  loadPreset, or by directly specifying the preset in the constructor.
   
-  The shape of the markers can be controlled with \ref setBracketStyle, \ref setBracketWidth and
-  \ref setBracketHeight. The color/fill can be controlled with \ref setBracketPen and \ref
-  setBracketBrush.
+  Apart from red, green and blue components, the gradient also interpolates the alpha values of the
+  configured color stops. This allows to display some portions of the data range as transparent in
+  the plot.
   
-  To introduce custom bracket styles, it is only necessary to sublcass \ref
-  QCPSelectionDecoratorBracket and reimplement \ref drawBracket. The rest will be managed by the
-  base class.
+  \image html QCPColorGradient.png
+  
+  The \ref QCPColorGradient(GradientPreset preset) constructor allows directly converting a \ref
+  GradientPreset to a QCPColorGradient. This means that you can directly pass \ref GradientPreset
+  to all the \a setGradient methods, e.g.:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorgradient-setgradient
+  
+  The total number of levels used in the gradient can be set with \ref setLevelCount. Whether the
+  color gradient shall be applied periodically (wrapping around) to data values that lie outside
+  the data range specified on the plottable instance can be controlled with \ref setPeriodic.
 */
 
 /*!
-  Creates a new QCPSelectionDecoratorBracket instance with default values.
-*/
-QCPSelectionDecoratorBracket::QCPSelectionDecoratorBracket() :
-  mBracketPen(QPen(Qt::black)),
-  mBracketBrush(Qt::NoBrush),
-  mBracketWidth(5),
-  mBracketHeight(50),
-  mBracketStyle(bsSquareBracket),
-  mTangentToData(false),
-  mTangentAverage(2)
-{
-  
-}
-
-QCPSelectionDecoratorBracket::~QCPSelectionDecoratorBracket()
-{
-}
+  Constructs a new, empty QCPColorGradient with no predefined color stops. You can add own color
+  stops with \ref setColorStopAt.
 
-/*!
-  Sets the pen that will be used to draw the brackets at the beginning and end of each selected
-  data segment.
+  The color level count is initialized to 350.
 */
-void QCPSelectionDecoratorBracket::setBracketPen(const QPen &pen)
+QCPColorGradient::QCPColorGradient() :
+  mLevelCount(350),
+  mColorInterpolation(ciRGB),
+  mPeriodic(false),
+  mColorBufferInvalidated(true)
 {
-  mBracketPen = pen;
+  mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
 }
 
 /*!
-  Sets the brush that will be used to draw the brackets at the beginning and end of each selected
-  data segment.
+  Constructs a new QCPColorGradient initialized with the colors and color interpolation according
+  to \a preset.
+
+  The color level count is initialized to 350.
 */
-void QCPSelectionDecoratorBracket::setBracketBrush(const QBrush &brush)
+QCPColorGradient::QCPColorGradient(GradientPreset preset) :
+  mLevelCount(350),
+  mColorInterpolation(ciRGB),
+  mPeriodic(false),
+  mColorBufferInvalidated(true)
 {
-  mBracketBrush = brush;
+  mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
+  loadPreset(preset);
 }
 
-/*!
-  Sets the width of the drawn bracket. The width dimension is always parallel to the key axis of
-  the data, or the tangent direction of the current data slope, if \ref setTangentToData is
-  enabled.
-*/
-void QCPSelectionDecoratorBracket::setBracketWidth(int width)
+/* undocumented operator */
+bool QCPColorGradient::operator==(const QCPColorGradient &other) const
 {
-  mBracketWidth = width;
+  return ((other.mLevelCount == this->mLevelCount) &&
+          (other.mColorInterpolation == this->mColorInterpolation) &&
+          (other.mPeriodic == this->mPeriodic) &&
+          (other.mColorStops == this->mColorStops));
 }
 
 /*!
-  Sets the height of the drawn bracket. The height dimension is always perpendicular to the key axis
-  of the data, or the tangent direction of the current data slope, if \ref setTangentToData is
-  enabled.
+  Sets the number of discretization levels of the color gradient to \a n. The default is 350 which
+  is typically enough to create a smooth appearance. The minimum number of levels is 2.
+
+  \image html QCPColorGradient-levelcount.png
 */
-void QCPSelectionDecoratorBracket::setBracketHeight(int height)
+void QCPColorGradient::setLevelCount(int n)
 {
-  mBracketHeight = height;
+  if (n < 2)
+  {
+    qDebug() << Q_FUNC_INFO << "n must be greater or equal 2 but was" << n;
+    n = 2;
+  }
+  if (n != mLevelCount)
+  {
+    mLevelCount = n;
+    mColorBufferInvalidated = true;
+  }
 }
 
 /*!
-  Sets the shape that the bracket/marker will have.
+  Sets at which positions from 0 to 1 which color shall occur. The positions are the keys, the
+  colors are the values of the passed QMap \a colorStops. In between these color stops, the color
+  is interpolated according to \ref setColorInterpolation.
   
-  \see setBracketWidth, setBracketHeight
+  A more convenient way to create a custom gradient may be to clear all color stops with \ref
+  clearColorStops (or creating a new, empty QCPColorGradient) and then adding them one by one with
+  \ref setColorStopAt.
+  
+  \see clearColorStops
 */
-void QCPSelectionDecoratorBracket::setBracketStyle(QCPSelectionDecoratorBracket::BracketStyle style)
+void QCPColorGradient::setColorStops(const QMap<double, QColor> &colorStops)
 {
-  mBracketStyle = style;
+  mColorStops = colorStops;
+  mColorBufferInvalidated = true;
 }
 
 /*!
-  Sets whether the brackets will be rotated such that they align with the slope of the data at the
-  position that they appear in.
+  Sets the \a color the gradient will have at the specified \a position (from 0 to 1). In between
+  these color stops, the color is interpolated according to \ref setColorInterpolation.
   
-  For noisy data, it might be more visually appealing to average the slope over multiple data
-  points. This can be configured via \ref setTangentAverage.
+  \see setColorStops, clearColorStops
 */
-void QCPSelectionDecoratorBracket::setTangentToData(bool enabled)
+void QCPColorGradient::setColorStopAt(double position, const QColor &color)
 {
-  mTangentToData = enabled;
+  mColorStops.insert(position, color);
+  mColorBufferInvalidated = true;
 }
 
 /*!
-  Controls over how many data points the slope shall be averaged, when brackets shall be aligned
-  with the data (if \ref setTangentToData is true).
+  Sets whether the colors in between the configured color stops (see \ref setColorStopAt) shall be
+  interpolated linearly in RGB or in HSV color space.
   
-  From the position of the bracket, \a pointCount points towards the selected data range will be
-  taken into account. The smallest value of \a pointCount is 1, which is effectively equivalent to
-  disabling \ref setTangentToData.
+  For example, a sweep in RGB space from red to green will have a muddy brown intermediate color,
+  whereas in HSV space the intermediate color is yellow.
 */
-void QCPSelectionDecoratorBracket::setTangentAverage(int pointCount)
+void QCPColorGradient::setColorInterpolation(QCPColorGradient::ColorInterpolation interpolation)
 {
-  mTangentAverage = pointCount;
-  if (mTangentAverage < 1)
-    mTangentAverage = 1;
+  if (interpolation != mColorInterpolation)
+  {
+    mColorInterpolation = interpolation;
+    mColorBufferInvalidated = true;
+  }
 }
 
 /*!
-  Draws the bracket shape with \a painter. The parameter \a direction is either -1 or 1 and
-  indicates whether the bracket shall point to the left or the right (i.e. is a closing or opening
-  bracket, respectively).
+  Sets whether data points that are outside the configured data range (e.g. \ref
+  QCPColorMap::setDataRange) are colored by periodically repeating the color gradient or whether
+  they all have the same color, corresponding to the respective gradient boundary color.
   
-  The passed \a painter already contains all transformations that are necessary to position and
-  rotate the bracket appropriately. Painting operations can be performed as if drawing upright
-  brackets on flat data with horizontal key axis, with (0, 0) being the center of the bracket.
+  \image html QCPColorGradient-periodic.png
   
-  If you wish to sublcass \ref QCPSelectionDecoratorBracket in order to provide custom bracket
-  shapes (see \ref QCPSelectionDecoratorBracket::bsUserStyle), this is the method you should
-  reimplement.
+  As shown in the image above, gradients that have the same start and end color are especially
+  suitable for a periodic gradient mapping, since they produce smooth color transitions throughout
+  the color map. A preset that has this property is \ref gpHues.
+  
+  In practice, using periodic color gradients makes sense when the data corresponds to a periodic
+  dimension, such as an angle or a phase. If this is not the case, the color encoding might become
+  ambiguous, because multiple different data values are shown as the same color.
 */
-void QCPSelectionDecoratorBracket::drawBracket(QCPPainter *painter, int direction) const
+void QCPColorGradient::setPeriodic(bool enabled)
 {
-  switch (mBracketStyle)
-  {
-    case bsSquareBracket:
-    {
-      painter->drawLine(QLineF(mBracketWidth*direction, -mBracketHeight*0.5, 0, -mBracketHeight*0.5));
-      painter->drawLine(QLineF(mBracketWidth*direction, mBracketHeight*0.5, 0, mBracketHeight*0.5));
-      painter->drawLine(QLineF(0, -mBracketHeight*0.5, 0, mBracketHeight*0.5));
-      break;
-    }
-    case bsHalfEllipse:
-    {
-      painter->drawArc(-mBracketWidth*0.5, -mBracketHeight*0.5, mBracketWidth, mBracketHeight, -90*16, -180*16*direction);
-      break;
-    }
-    case bsEllipse:
-    {
-      painter->drawEllipse(-mBracketWidth*0.5, -mBracketHeight*0.5, mBracketWidth, mBracketHeight);
-      break;
-    }
-    case bsPlus:
-    {
-      painter->drawLine(QLineF(0, -mBracketHeight*0.5, 0, mBracketHeight*0.5));
-      painter->drawLine(QLineF(-mBracketWidth*0.5, 0, mBracketWidth*0.5, 0));
-      break;
-    }
-    default:
-    {
-      qDebug() << Q_FUNC_INFO << "unknown/custom bracket style can't be handeld by default implementation:" << static_cast<int>(mBracketStyle);
-      break;
-    }
-  }
+  mPeriodic = enabled;
 }
 
-/*!
-  Draws the bracket decoration on the data points at the begin and end of each selected data
-  segment given in \a seletion.
+/*! \overload
   
-  It uses the method \ref drawBracket to actually draw the shapes.
+  This method is used to quickly convert a \a data array to colors. The colors will be output in
+  the array \a scanLine. Both \a data and \a scanLine must have the length \a n when passed to this
+  function. The data range that shall be used for mapping the data value to the gradient is passed
+  in \a range. \a logarithmic indicates whether the data values shall be mapped to colors
+  logarithmically.
+
+  if \a data actually contains 2D-data linearized via <tt>[row*columnCount + column]</tt>, you can
+  set \a dataIndexFactor to <tt>columnCount</tt> to convert a column instead of a row of the data
+  array, in \a scanLine. \a scanLine will remain a regular (1D) array. This works because \a data
+  is addressed <tt>data[i*dataIndexFactor]</tt>.
   
-  \seebaseclassmethod
+  Use the overloaded method to additionally provide alpha map data.
+
+  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
+  with alpha (see QImage::Format_ARGB32_Premultiplied).
 */
-void QCPSelectionDecoratorBracket::drawDecoration(QCPPainter *painter, QCPDataSelection selection)
+void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
-  if (!mPlottable || selection.isEmpty()) return;
+  // If you change something here, make sure to also adapt color() and the other colorize() overload
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  if (mColorBufferInvalidated)
+    updateColorBuffer();
   
-  if (QCPPlottableInterface1D *interface1d = mPlottable->interface1D())
+  const QRgb *colorBuffer = mColorBuffer.constData();
+  if (!logarithmic)
   {
-    foreach (const QCPDataRange &dataRange, selection.dataRanges())
+    const double posToIndexFactor = (mLevelCount-1)/range.size();
+    if (mPeriodic)
     {
-      // determine position and (if tangent mode is enabled) angle of brackets:
-      int openBracketDir = (mPlottable->keyAxis() && !mPlottable->keyAxis()->rangeReversed()) ? 1 : -1;
-      int closeBracketDir = -openBracketDir;
-      QPointF openBracketPos = getPixelCoordinates(interface1d, dataRange.begin());
-      QPointF closeBracketPos = getPixelCoordinates(interface1d, dataRange.end()-1);
-      double openBracketAngle = 0;
-      double closeBracketAngle = 0;
-      if (mTangentToData)
+      for (int i=0; i<n; ++i)
       {
-        openBracketAngle = getTangentAngle(interface1d, dataRange.begin(), openBracketDir);
-        closeBracketAngle = getTangentAngle(interface1d, dataRange.end()-1, closeBracketDir);
+        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
+        if (index < 0)
+          index += mLevelCount;
+        scanLine[i] = colorBuffer[index];
+      }
+    } else
+    {
+      // work in blocks, so scaling/clamping and the color lookup each run in tight, branchless loops which the compiler can vectorize:
+      const int blockSize = 256;
+      const double maxIndex = mLevelCount-1;
+      int indices[blockSize];
+      for (int blockStart=0; blockStart<n; blockStart+=blockSize)
+      {
+        const int blockCount = qMin(blockSize, n-blockStart);
+        const double *blockData = data+dataIndexFactor*blockStart;
+        for (int i=0; i<blockCount; ++i)
+        {
+          const double index = (blockData[dataIndexFactor*i]-range.lower)*posToIndexFactor;
+          indices[i] = (int)(index > 0 ? (index < maxIndex ? index : maxIndex) : 0); // also maps NaN to 0
+        }
+        QRgb *blockScanLine = scanLine+blockStart;
+        for (int i=0; i<blockCount; ++i)
+          blockScanLine[i] = colorBuffer[indices[i]];
+      }
+    }
+  } else // logarithmic == true
+  {
+    const double logPosToIndexFactor = (mLevelCount-1)/qLn(range.upper/range.lower);
+    if (mPeriodic)
+    {
+      for (int i=0; i<n; ++i)
+      {
+        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)*logPosToIndexFactor) % mLevelCount;
+        if (index < 0)
+          index += mLevelCount;
+        scanLine[i] = colorBuffer[index];
+      }
+    } else
+    {
+      for (int i=0; i<n; ++i)
+      {
+        int index = qLn(data[dataIndexFactor*i]/range.lower)*logPosToIndexFactor;
+        if (index < 0)
+          index = 0;
+        else if (index >= mLevelCount)
+          index = mLevelCount-1;
+        scanLine[i] = colorBuffer[index];
       }
-      // draw opening bracket:
-      QTransform oldTransform = painter->transform();
-      painter->setPen(mBracketPen);
-      painter->setBrush(mBracketBrush);
-      painter->translate(openBracketPos);
-      painter->rotate(openBracketAngle/M_PI*180.0);
-      drawBracket(painter, openBracketDir);
-      painter->setTransform(oldTransform);
-      // draw closing bracket:
-      painter->setPen(mBracketPen);
-      painter->setBrush(mBracketBrush);
-      painter->translate(closeBracketPos);
-      painter->rotate(closeBracketAngle/M_PI*180.0);
-      drawBracket(painter, closeBracketDir);
-      painter->setTransform(oldTransform);
     }
   }
 }
 
-/*! \internal
-  
-  If \ref setTangentToData is enabled, brackets need to be rotated according to the data slope.
-  This method returns the angle in radians by which a bracket at the given \a dataIndex must be
-  rotated.
-  
-  The parameter \a direction must be set to either -1 or 1, representing whether it is an opening
-  or closing bracket. Since for slope calculation multiple data points are required, this defines
-  the direction in which the algorithm walks, starting at \a dataIndex, to average those data
-  points. (see \ref setTangentToData and \ref setTangentAverage)
-  
-  \a interface1d is the interface to the plottable's data which is used to query data coordinates.
+/*! \overload
+
+  Additionally to the other overload of \ref colorize, this method takes the array \a alpha, which
+  has the same size and structure as \a data and encodes the alpha information per data point.
+
+  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
+  with alpha (see QImage::Format_ARGB32_Premultiplied).
 */
-double QCPSelectionDecoratorBracket::getTangentAngle(const QCPPlottableInterface1D *interface1d, int dataIndex, int direction) const
+void QCPColorGradient::colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
-  if (!interface1d || dataIndex < 0 || dataIndex >= interface1d->dataCount())
-    return 0;
-  direction = direction < 0 ? -1 : 1; // enforce direction is either -1 or 1
-  
-  // how many steps we can actually go from index in the given direction without exceeding data bounds:
-  int averageCount;
-  if (direction < 0)
-    averageCount = qMin(mTangentAverage, dataIndex);
-  else
-    averageCount = qMin(mTangentAverage, interface1d->dataCount()-1-dataIndex);
-  qDebug() << averageCount;
-  // calculate point average of averageCount points:
-  QVector<QPointF> points(averageCount);
-  QPointF pointsAverage;
-  int currentIndex = dataIndex;
-  for (int i=0; i<averageCount; ++i)
+  // If you change something here, make sure to also adapt color() and the other colorize() overload
+  if (!data)
   {
-    points[i] = getPixelCoordinates(interface1d, currentIndex);
-    pointsAverage += points[i];
-    currentIndex += direction;
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
   }
-  pointsAverage /= (double)averageCount;
-  
-  // calculate slope of linear regression through points:
-  double numSum = 0;
-  double denomSum = 0;
-  for (int i=0; i<averageCount; ++i)
+  if (!alpha)
   {
-    const double dx = points.at(i).x()-pointsAverage.x();
-    const double dy = points.at(i).y()-pointsAverage.y();
-    numSum += dx*dy;
-    denomSum += dx*dx;
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
   }
-  if (!qFuzzyIsNull(denomSum) && !qFuzzyIsNull(numSum))
+  if (!scanLine)
   {
-    return qAtan2(numSum, denomSum);
-  } else // undetermined angle, probably mTangentAverage == 1, so using only one data point
-    return 0;
-}
-
-/*! \internal
-  
-  Returns the pixel coordinates of the data point at \a dataIndex, using \a interface1d to access
-  the data points.
-*/
-QPointF QCPSelectionDecoratorBracket::getPixelCoordinates(const QCPPlottableInterface1D *interface1d, int dataIndex) const
-{
-  QCPAxis *keyAxis = mPlottable->keyAxis();
-  QCPAxis *valueAxis = mPlottable->valueAxis();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(0, 0); }
-  
-  if (keyAxis->orientation() == Qt::Horizontal)
-    return QPointF(keyAxis->coordToPixel(interface1d->dataMainKey(dataIndex)), valueAxis->coordToPixel(interface1d->dataMainValue(dataIndex)));
-  else
-    return QPointF(valueAxis->coordToPixel(interface1d->dataMainValue(dataIndex)), keyAxis->coordToPixel(interface1d->dataMainKey(dataIndex)));
-}
-/* end of 'src/selectiondecorator-bracket.cpp' */
-
-
-/* including file 'src/layoutelements/layoutelement-axisrect.cpp', size 47509 */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200  */
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPAxisRect
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPAxisRect
-  \brief Holds multiple axes and arranges them in a rectangular shape.
-  
-  This class represents an axis rect, a rectangular area that is bounded on all sides with an
-  arbitrary number of axes.
-  
-  Initially QCustomPlot has one axis rect, accessible via QCustomPlot::axisRect(). However, the
-  layout system allows to have multiple axis rects, e.g. arranged in a grid layout
-  (QCustomPlot::plotLayout).
-  
-  By default, QCPAxisRect comes with four axes, at bottom, top, left and right. They can be
-  accessed via \ref axis by providing the respective axis type (\ref QCPAxis::AxisType) and index.
-  If you need all axes in the axis rect, use \ref axes. The top and right axes are set to be
-  invisible initially (QCPAxis::setVisible). To add more axes to a side, use \ref addAxis or \ref
-  addAxes. To remove an axis, use \ref removeAxis.
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  if (mColorBufferInvalidated)
+    updateColorBuffer();
   
-  The axis rect layerable itself only draws a background pixmap or color, if specified (\ref
-  setBackground). It is placed on the "background" layer initially (see \ref QCPLayer for an
-  explanation of the QCustomPlot layer system). The axes that are held by the axis rect can be
+  if (!logarithmic)
+  {
+    const double posToIndexFactor = (mLevelCount-1)/range.size();
+    if (mPeriodic)
+    {
+      for (int i=0; i<n; ++i)
+      {
+        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
+        if (index < 0)
+          index += mLevelCount;
+        if (alpha[dataIndexFactor*i] == 255)
+        {
+          scanLine[i] = mColorBuffer.at(index);
+        } else
+        {
+          const QRgb rgb = mColorBuffer.at(index);
+          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
+          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
+        }
+      }
+    } else
+    {
+      for (int i=0; i<n; ++i)
+      {
+        int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
+        if (index < 0)
+          index = 0;
+        else if (index >= mLevelCount)
+          index = mLevelCount-1;
+        if (alpha[dataIndexFactor*i] == 255)
+        {
+          scanLine[i] = mColorBuffer.at(index);
+        } else
+        {
+          const QRgb rgb = mColorBuffer.at(index);
+          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
+          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
+        }
+      }
+    }
+  } else // logarithmic == true
+  {
+    const double logPosToIndexFactor = (mLevelCount-1)/qLn(range.upper/range.lower);
+    if (mPeriodic)
+    {
+      for (int i=0; i<n; ++i)
+      {
+        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)*logPosToIndexFactor) % mLevelCount;
+        if (index < 0)
+          index += mLevelCount;
+        if (alpha[dataIndexFactor*i] == 255)
+        {
+          scanLine[i] = mColorBuffer.at(index);
+        } else
+        {
+          const QRgb rgb = mColorBuffer.at(index);
+          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
+          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
+        }
+      }
+    } else
+    {
+      for (int i=0; i<n; ++i)
+      {
+        int index = qLn(data[dataIndexFactor*i]/range.lower)*logPosToIndexFactor;
+        if (index < 0)
+          index = 0;
+        else if (index >= mLevelCount)
+          index = mLevelCount-1;
+        if (alpha[dataIndexFactor*i] == 255)
+        {
+          scanLine[i] = mColorBuffer.at(index);
+        } else
+        {
+          const QRgb rgb = mColorBuffer.at(index);
+          const float alphaF = alpha[dataIndexFactor*i]/255.0f;
+          scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
+        }
+      }
+    }
+  }
+}
+
+/*! \internal
+
+  This method is used to colorize a single data value given in \a position, to colors. The data
+  range that shall be used for mapping the data value to the gradient is passed in \a range. \a
+  logarithmic indicates whether the data value shall be mapped to a color logarithmically.
+
+  If an entire array of data values shall be converted, rather use \ref colorize, for better
+  performance.
+
+  The returned QRgb has its r, g and b components premultiplied with alpha (see
+  QImage::Format_ARGB32_Premultiplied).
+*/
+QRgb QCPColorGradient::color(double position, const QCPRange &range, bool logarithmic)
+{
+  // If you change something here, make sure to also adapt ::colorize()
+  if (mColorBufferInvalidated)
+    updateColorBuffer();
+  int index = 0;
+  if (!logarithmic)
+    index = (position-range.lower)*(mLevelCount-1)/range.size();
+  else
+    index = qLn(position/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
+  if (mPeriodic)
+  {
+    index = index % mLevelCount;
+    if (index < 0)
+      index += mLevelCount;
+  } else
+  {
+    if (index < 0)
+      index = 0;
+    else if (index >= mLevelCount)
+      index = mLevelCount-1;
+  }
+  return mColorBuffer.at(index);
+}
+
+/*!
+  Clears the current color stops and loads the specified \a preset. A preset consists of predefined
+  color stops and the corresponding color interpolation method.
+  
+  The available presets are:
+  \image html QCPColorGradient.png
+*/
+void QCPColorGradient::loadPreset(GradientPreset preset)
+{
+  clearColorStops();
+  switch (preset)
+  {
+    case gpGrayscale:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, Qt::black);
+      setColorStopAt(1, Qt::white);
+      break;
+    case gpHot:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(50, 0, 0));
+      setColorStopAt(0.2, QColor(180, 10, 0));
+      setColorStopAt(0.4, QColor(245, 50, 0));
+      setColorStopAt(0.6, QColor(255, 150, 10));
+      setColorStopAt(0.8, QColor(255, 255, 50));
+      setColorStopAt(1, QColor(255, 255, 255));
+      break;
+    case gpCold:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(0, 0, 50));
+      setColorStopAt(0.2, QColor(0, 10, 180));
+      setColorStopAt(0.4, QColor(0, 50, 245));
+      setColorStopAt(0.6, QColor(10, 150, 255));
+      setColorStopAt(0.8, QColor(50, 255, 255));
+      setColorStopAt(1, QColor(255, 255, 255));
+      break;
+    case gpNight:
+      setColorInterpolation(ciHSV);
+      setColorStopAt(0, QColor(10, 20, 30));
+      setColorStopAt(1, QColor(250, 255, 250));
+      break;
+    case gpCandy:
+      setColorInterpolation(ciHSV);
+      setColorStopAt(0, QColor(0, 0, 255));
+      setColorStopAt(1, QColor(255, 250, 250));
+      break;
+    case gpGeography:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(70, 170, 210));
+      setColorStopAt(0.20, QColor(90, 160, 180));
+      setColorStopAt(0.25, QColor(45, 130, 175));
+      setColorStopAt(0.30, QColor(100, 140, 125));
+      setColorStopAt(0.5, QColor(100, 140, 100));
+      setColorStopAt(0.6, QColor(130, 145, 120));
+      setColorStopAt(0.7, QColor(140, 130, 120));
+      setColorStopAt(0.9, QColor(180, 190, 190));
+      setColorStopAt(1, QColor(210, 210, 230));
+      break;
+    case gpIon:
+      setColorInterpolation(ciHSV);
+      setColorStopAt(0, QColor(50, 10, 10));
+      setColorStopAt(0.45, QColor(0, 0, 255));
+      setColorStopAt(0.8, QColor(0, 255, 255));
+      setColorStopAt(1, QColor(0, 255, 0));
+      break;
+    case gpThermal:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(0, 0, 50));
+      setColorStopAt(0.15, QColor(20, 0, 120));
+      setColorStopAt(0.33, QColor(200, 30, 140));
+      setColorStopAt(0.6, QColor(255, 100, 0));
+      setColorStopAt(0.85, QColor(255, 255, 40));
+      setColorStopAt(1, QColor(255, 255, 255));
+      break;
+    case gpPolar:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(50, 255, 255));
+      setColorStopAt(0.18, QColor(10, 70, 255));
+      setColorStopAt(0.28, QColor(10, 10, 190));
+      setColorStopAt(0.5, QColor(0, 0, 0));
+      setColorStopAt(0.72, QColor(190, 10, 10));
+      setColorStopAt(0.82, QColor(255, 70, 10));
+      setColorStopAt(1, QColor(255, 255, 50));
+      break;
+    case gpSpectrum:
+      setColorInterpolation(ciHSV);
+      setColorStopAt(0, QColor(50, 0, 50));
+      setColorStopAt(0.15, QColor(0, 0, 255));
+      setColorStopAt(0.35, QColor(0, 255, 255));
+      setColorStopAt(0.6, QColor(255, 255, 0));
+      setColorStopAt(0.75, QColor(255, 30, 0));
+      setColorStopAt(1, QColor(50, 0, 0));
+      break;
+    case gpJet:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(0, 0, 100));
+      setColorStopAt(0.15, QColor(0, 50, 255));
+      setColorStopAt(0.35, QColor(0, 255, 255));
+      setColorStopAt(0.65, QColor(255, 255, 0));
+      setColorStopAt(0.85, QColor(255, 30, 0));
+      setColorStopAt(1, QColor(100, 0, 0));
+      break;
+    case gpHues:
+      setColorInterpolation(ciHSV);
+      setColorStopAt(0, QColor(255, 0, 0));
+      setColorStopAt(1.0/3.0, QColor(0, 0, 255));
+      setColorStopAt(2.0/3.0, QColor(0, 255, 0));
+      setColorStopAt(1, QColor(255, 0, 0));
+      break;
+  }
+}
+
+/*!
+  Clears all color stops.
+  
+  \see setColorStops, setColorStopAt
+*/
+void QCPColorGradient::clearColorStops()
+{
+  mColorStops.clear();
+  mColorBufferInvalidated = true;
+}
+
+/*!
+  Returns an inverted gradient. The inverted gradient has all properties as this \ref
+  QCPColorGradient, but the order of the color stops is inverted.
+  
+  \see setColorStops, setColorStopAt
+*/
+QCPColorGradient QCPColorGradient::inverted() const
+{
+  QCPColorGradient result(*this);
+  result.clearColorStops();
+  for (QMap<double, QColor>::const_iterator it=mColorStops.constBegin(); it!=mColorStops.constEnd(); ++it)
+    result.setColorStopAt(1.0-it.key(), it.value());
+  return result;
+}
+
+/*! \internal
+  
+  Returns true if the color gradient uses transparency, i.e. if any of the configured color stops
+  has an alpha value below 255.
+*/
+bool QCPColorGradient::stopsUseAlpha() const
+{
+  for (QMap<double, QColor>::const_iterator it=mColorStops.constBegin(); it!=mColorStops.constEnd(); ++it)
+  {
+    if (it.value().alpha() < 255)
+      return true;
+  }
+  return false;
+}
+
+/*! \internal
+  
+  Updates the internal color buffer which will be used by \ref colorize and \ref color, to quickly
+  convert positions to colors. This is where the interpolation between color stops is calculated.
+*/
+void QCPColorGradient::updateColorBuffer()
+{
+  if (mColorBuffer.size() != mLevelCount)
+    mColorBuffer.resize(mLevelCount);
+  if (mColorStops.size() > 1)
+  {
+    double indexToPosFactor = 1.0/(double)(mLevelCount-1);
+    const bool useAlpha = stopsUseAlpha();
+    for (int i=0; i<mLevelCount; ++i)
+    {
+      double position = i*indexToPosFactor;
+      QMap<double, QColor>::const_iterator it = mColorStops.lowerBound(position);
+      if (it == mColorStops.constEnd()) // position is on or after last stop, use color of last stop
+      {
+        mColorBuffer[i] = (it-1).value().rgba();
+      } else if (it == mColorStops.constBegin()) // position is on or before first stop, use color of first stop
+      {
+        mColorBuffer[i] = it.value().rgba();
+      } else // position is in between stops (or on an intermediate stop), interpolate color
+      {
+        QMap<double, QColor>::const_iterator high = it;
+        QMap<double, QColor>::const_iterator low = it-1;
+        double t = (position-low.key())/(high.key()-low.key()); // interpolation factor 0..1
+        switch (mColorInterpolation)
+        {
+          case ciRGB:
+          {
+            if (useAlpha)
+            {
+              const int alpha = (1-t)*low.value().alpha() + t*high.value().alpha();
+              const float alphaPremultiplier = alpha/255.0f; // since we use QImage::Format_ARGB32_Premultiplied
+              mColorBuffer[i] = qRgba(((1-t)*low.value().red() + t*high.value().red())*alphaPremultiplier,
+                                      ((1-t)*low.value().green() + t*high.value().green())*alphaPremultiplier,
+                                      ((1-t)*low.value().blue() + t*high.value().blue())*alphaPremultiplier,
+                                      alpha);
+            } else
+            {
+              mColorBuffer[i] = qRgb(((1-t)*low.value().red() + t*high.value().red()),
+                                     ((1-t)*low.value().green() + t*high.value().green()),
+                                     ((1-t)*low.value().blue() + t*high.value().blue()));
+            }
+            break;
+          }
+          case ciHSV:
+          {
+            QColor lowHsv = low.value().toHsv();
+            QColor highHsv = high.value().toHsv();
+            double hue = 0;
+            double hueDiff = highHsv.hueF()-lowHsv.hueF();
+            if (hueDiff > 0.5)
+              hue = lowHsv.hueF() - t*(1.0-hueDiff);
+            else if (hueDiff < -0.5)
+              hue = lowHsv.hueF() + t*(1.0+hueDiff);
+            else
+              hue = lowHsv.hueF() + t*hueDiff;
+            if (hue < 0) hue += 1.0;
+            else if (hue >= 1.0) hue -= 1.0;
+            if (useAlpha)
+            {
+              const QRgb rgb = QColor::fromHsvF(hue,
+                                                (1-t)*lowHsv.saturationF() + t*highHsv.saturationF(),
+                                                (1-t)*lowHsv.valueF() + t*highHsv.valueF()).rgb();
+              const float alpha = (1-t)*lowHsv.alphaF() + t*highHsv.alphaF();
+              mColorBuffer[i] = qRgba(qRed(rgb)*alpha, qGreen(rgb)*alpha, qBlue(rgb)*alpha, 255*alpha);
+            }
+            else
+            {
+              mColorBuffer[i] = QColor::fromHsvF(hue,
+                                                 (1-t)*lowHsv.saturationF() + t*highHsv.saturationF(),
+                                                 (1-t)*lowHsv.valueF() + t*highHsv.valueF()).rgb();
+            }
+            break;
+          }
+        }
+      }
+    }
+  } else if (mColorStops.size() == 1)
+  {
+    const QRgb rgb = mColorStops.constBegin().value().rgb();
+    const float alpha = mColorStops.constBegin().value().alphaF();
+    mColorBuffer.fill(qRgba(qRed(rgb)*alpha, qGreen(rgb)*alpha, qBlue(rgb)*alpha, 255*alpha));
+  } else // mColorStops is empty, fill color buffer with black
+  {
+    mColorBuffer.fill(qRgb(0, 0, 0));
+  }
+  mColorBufferInvalidated = false;
+}
+/* end of 'src/colorgradient.cpp' */
+
+
+/* including file 'src/selectiondecorator-bracket.cpp', size 12313           */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPSelectionDecoratorBracket
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPSelectionDecoratorBracket
+  \brief A selection decorator which draws brackets around each selected data segment
+  
+  Additionally to the regular highlighting of selected segments via color, fill and scatter style,
+  this \ref QCPSelectionDecorator subclass draws markers at the begin and end of each selected data
+  segment of the plottable.
+  
+  The shape of the markers can be controlled with \ref setBracketStyle, \ref setBracketWidth and
+  \ref setBracketHeight. The color/fill can be controlled with \ref setBracketPen and \ref
+  setBracketBrush.
+  
+  To introduce custom bracket styles, it is only necessary to sublcass \ref
+  QCPSelectionDecoratorBracket and reimplement \ref drawBracket. The rest will be managed by the
+  base class.
+*/
+
+/*!
+  Creates a new QCPSelectionDecoratorBracket instance with default values.
+*/
+QCPSelectionDecoratorBracket::QCPSelectionDecoratorBracket() :
+  mBracketPen(QPen(Qt::black)),
+  mBracketBrush(Qt::NoBrush),
+  mBracketWidth(5),
+  mBracketHeight(50),
+  mBracketStyle(bsSquareBracket),
+  mTangentToData(false),
+  mTangentAverage(2)
+{
+  
+}
+
+QCPSelectionDecoratorBracket::~QCPSelectionDecoratorBracket()
+{
+}
+
+/*!
+  Sets the pen that will be used to draw the brackets at the beginning and end of each selected
+  data segment.
+*/
+void QCPSelectionDecoratorBracket::setBracketPen(const QPen &pen)
+{
+  mBracketPen = pen;
+}
+
+/*!
+  Sets the brush that will be used to draw the brackets at the beginning and end of each selected
+  data segment.
+*/
+void QCPSelectionDecoratorBracket::setBracketBrush(const QBrush &brush)
+{
+  mBracketBrush = brush;
+}
+
+/*!
+  Sets the width of the drawn bracket. The width dimension is always parallel to the key axis of
+  the data, or the tangent direction of the current data slope, if \ref setTangentToData is
+  enabled.
+*/
+void QCPSelectionDecoratorBracket::setBracketWidth(int width)
+{
+  mBracketWidth = width;
+}
+
+/*!
+  Sets the height of the drawn bracket. The height dimension is always perpendicular to the key axis
+  of the data, or the tangent direction of the current data slope, if \ref setTangentToData is
+  enabled.
+*/
+void QCPSelectionDecoratorBracket::setBracketHeight(int height)
+{
+  mBracketHeight = height;
+}
+
+/*!
+  Sets the shape that the bracket/marker will have.
+  
+  \see setBracketWidth, setBracketHeight
+*/
+void QCPSelectionDecoratorBracket::setBracketStyle(QCPSelectionDecoratorBracket::BracketStyle style)
+{
+  mBracketStyle = style;
+}
+
+/*!
+  Sets whether the brackets will be rotated such that they align with the slope of the data at the
+  position that they appear in.
+  
+  For noisy data, it might be more visually appealing to average the slope over multiple data
+  points. This can be configured via \ref setTangentAverage.
+*/
+void QCPSelectionDecoratorBracket::setTangentToData(bool enabled)
+{
+  mTangentToData = enabled;
+}
+
+/*!
+  Controls over how many data points the slope shall be averaged, when brackets shall be aligned
+  with the data (if \ref setTangentToData is true).
+  
+  From the position of the bracket, \a pointCount points towards the selected data range will be
+  taken into account. The smallest value of \a pointCount is 1, which is effectively equivalent to
+  disabling \ref setTangentToData.
+*/
+void QCPSelectionDecoratorBracket::setTangentAverage(int pointCount)
+{
+  mTangentAverage = pointCount;
+  if (mTangentAverage < 1)
+    mTangentAverage = 1;
+}
+
+/*!
+  Draws the bracket shape with \a painter. The parameter \a direction is either -1 or 1 and
+  indicates whether the bracket shall point to the left or the right (i.e. is a closing or opening
+  bracket, respectively).
+  
+  The passed \a painter already contains all transformations that are necessary to position and
+  rotate the bracket appropriately. Painting operations can be performed as if drawing upright
+  brackets on flat data with horizontal key axis, with (0, 0) being the center of the bracket.
+  
+  If you wish to sublcass \ref QCPSelectionDecoratorBracket in order to provide custom bracket
+  shapes (see \ref QCPSelectionDecoratorBracket::bsUserStyle), this is the method you should
+  reimplement.
+*/
+void QCPSelectionDecoratorBracket::drawBracket(QCPPainter *painter, int direction) const
+{
+  switch (mBracketStyle)
+  {
+    case bsSquareBracket:
+    {
+      painter->drawLine(QLineF(mBracketWidth*direction, -mBracketHeight*0.5, 0, -mBracketHeight*0.5));
+      painter->drawLine(QLineF(mBracketWidth*direction, mBracketHeight*0.5, 0, mBracketHeight*0.5));
+      painter->drawLine(QLineF(0, -mBracketHeight*0.5, 0, mBracketHeight*0.5));
+      break;
+    }
+    case bsHalfEllipse:
+    {
+      painter->drawArc(-mBracketWidth*0.5, -mBracketHeight*0.5, mBracketWidth, mBracketHeight, -90*16, -180*16*direction);
+      break;
+    }
+    case bsEllipse:
+    {
+      painter->drawEllipse(-mBracketWidth*0.5, -mBracketHeight*0.5, mBracketWidth, mBracketHeight);
+      break;
+    }
+    case bsPlus:
+    {
+      painter->drawLine(QLineF(0, -mBracketHeight*0.5, 0, mBracketHeight*0.5));
+      painter->drawLine(QLineF(-mBracketWidth*0.5, 0, mBracketWidth*0.5, 0));
+      break;
+    }
+    default:
+    {
+      qDebug() << Q_FUNC_INFO << "unknown/custom bracket style can't be handeld by default implementation:" << static_cast<int>(mBracketStyle);
+      break;
+    }
+  }
+}
+
+/*!
+  Draws the bracket decoration on the data points at the begin and end of each selected data
+  segment given in \a seletion.
+  
+  It uses the method \ref drawBracket to actually draw the shapes.
+  
+  \seebaseclassmethod
+*/
+void QCPSelectionDecoratorBracket::drawDecoration(QCPPainter *painter, QCPDataSelection selection)
+{
+  if (!mPlottable || selection.isEmpty()) return;
+  
+  if (QCPPlottableInterface1D *interface1d = mPlottable->interface1D())
+  {
+    foreach (const QCPDataRange &dataRange, selection.dataRanges())
+    {
+      // determine position and (if tangent mode is enabled) angle of brackets:
+      int openBracketDir = (mPlottable->keyAxis() && !mPlottable->keyAxis()->rangeReversed()) ? 1 : -1;
+      int closeBracketDir = -openBracketDir;
+      QPointF openBracketPos = getPixelCoordinates(interface1d, dataRange.begin());
+      QPointF closeBracketPos = getPixelCoordinates(interface1d, dataRange.end()-1);
+      double openBracketAngle = 0;
+      double closeBracketAngle = 0;
+      if (mTangentToData)
+      {
+        openBracketAngle = getTangentAngle(interface1d, dataRange.begin(), openBracketDir);
+        closeBracketAngle = getTangentAngle(interface1d, dataRange.end()-1, closeBracketDir);
+      }
+      // draw opening bracket:
+      QTransform oldTransform = painter->transform();
+      painter->setPen(mBracketPen);
+      painter->setBrush(mBracketBrush);
+      painter->translate(openBracketPos);
+      painter->rotate(openBracketAngle/M_PI*180.0);
+      drawBracket(painter, openBracketDir);
+      painter->setTransform(oldTransform);
+      // draw closing bracket:
+      painter->setPen(mBracketPen);
+      painter->setBrush(mBracketBrush);
+      painter->translate(closeBracketPos);
+      painter->rotate(closeBracketAngle/M_PI*180.0);
+      drawBracket(painter, closeBracketDir);
+      painter->setTransform(oldTransform);
+    }
+  }
+}
+
+/*! \internal
+  
+  If \ref setTangentToData is enabled, brackets need to be rotated according to the data slope.
+  This method returns the angle in radians by which a bracket at the given \a dataIndex must be
+  rotated.
+  
+  The parameter \a direction must be set to either -1 or 1, representing whether it is an opening
+  or closing bracket. Since for slope calculation multiple data points are required, this defines
+  the direction in which the algorithm walks, starting at \a dataIndex, to average those data
+  points. (see \ref setTangentToData and \ref setTangentAverage)
+  
+  \a interface1d is the interface to the plottable's data which is used to query data coordinates.
+*/
+double QCPSelectionDecoratorBracket::getTangentAngle(const QCPPlottableInterface1D *interface1d, int dataIndex, int direction) const
+{
+  if (!interface1d || dataIndex < 0 || dataIndex >= interface1d->dataCount())
+    return 0;
+  direction = direction < 0 ? -1 : 1; // enforce direction is either -1 or 1
+  
+  // how many steps we can actually go from index in the given direction without exceeding data bounds:
+  int averageCount;
+  if (direction < 0)
+    averageCount = qMin(mTangentAverage, dataIndex);
+  else
+    averageCount = qMin(mTangentAverage, interface1d->dataCount()-1-dataIndex);
+  qDebug() << averageCount;
+  // calculate point average of averageCount points:
+  QVector<QPointF> points(averageCount);
+  QPointF pointsAverage;
+  int currentIndex = dataIndex;
+  for (int i=0; i<averageCount; ++i)
+  {
+    points[i] = getPixelCoordinates(interface1d, currentIndex);
+    pointsAverage += points[i];
+    currentIndex += direction;
+  }
+  pointsAverage /= (double)averageCount;
+  
+  // calculate slope of linear regression through points:
+  double numSum = 0;
+  double denomSum = 0;
+  for (int i=0; i<averageCount; ++i)
+  {
+    const double dx = points.at(i).x()-pointsAverage.x();
+    const double dy = points.at(i).y()-pointsAverage.y();
+    numSum += dx*dy;
+    denomSum += dx*dx;
+  }
+  if (!qFuzzyIsNull(denomSum) && !qFuzzyIsNull(numSum))
+  {
+    return qAtan2(numSum, denomSum);
+  } else // undetermined angle, probably mTangentAverage == 1, so using only one data point
+    return 0;
+}
+
+/*! \internal
+  
+  Returns the pixel coordinates of the data point at \a dataIndex, using \a interface1d to access
+  the data points.
+*/
+QPointF QCPSelectionDecoratorBracket::getPixelCoordinates(const QCPPlottableInterface1D *interface1d, int dataIndex) const
+{
+  QCPAxis *keyAxis = mPlottable->keyAxis();
+  QCPAxis *valueAxis = mPlottable->valueAxis();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(0, 0); }
+  
+  if (keyAxis->orientation() == Qt::Horizontal)
+    return QPointF(keyAxis->coordToPixel(interface1d->dataMainKey(dataIndex)), valueAxis->coordToPixel(interface1d->dataMainValue(dataIndex)));
+  else
+    return QPointF(valueAxis->coordToPixel(interface1d->dataMainValue(dataIndex)), keyAxis->coordToPixel(interface1d->dataMainKey(dataIndex)));
+}
+/* end of 'src/selectiondecorator-bracket.cpp' */
+
+
+/* including file 'src/layoutelements/layoutelement-axisrect.cpp', size 47509 */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200  */
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPAxisRect
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPAxisRect
+  \brief Holds multiple axes and arranges them in a rectangular shape.
+  
+  This class represents an axis rect, a rectangular area that is bounded on all sides with an
+  arbitrary number of axes.
+  
+  Initially QCustomPlot has one axis rect, accessible via QCustomPlot::axisRect(). However, the
+  layout system allows to have multiple axis rects, e.g. arranged in a grid layout
+  (QCustomPlot::plotLayout).
+  
+  By default, QCPAxisRect comes with four axes, at bottom, top, left and right. They can be
+  accessed via \ref axis by providing the respective axis type (\ref QCPAxis::AxisType) and index.
+  If you need all axes in the axis rect, use \ref axes. The top and right axes are set to be
+  invisible initially (QCPAxis::setVisible). To add more axes to a side, use \ref addAxis or \ref
+  addAxes. To remove an axis, use \ref removeAxis.
+  
+  The axis rect layerable itself only draws a background pixmap or color, if specified (\ref
+  setBackground). It is placed on the "background" layer initially (see \ref QCPLayer for an
+  explanation of the QCustomPlot layer system). The axes that are held by the axis rect can be
   placed on other layers, independently of the axis rect.
   
-  Every axis rect has a child layout of type \ref QCPLayoutInset. It is accessible via \ref
-  insetLayout and can be used to have other layout elements (or even other layouts with multiple
-  elements) hovering inside the axis rect.
+  Every axis rect has a child layout of type \ref QCPLayoutInset. It is accessible via \ref
+  insetLayout and can be used to have other layout elements (or even other layouts with multiple
+  elements) hovering inside the axis rect.
+  
+  If an axis rect is clicked and dragged, it processes this by moving certain axis ranges. The
+  behaviour can be controlled with \ref setRangeDrag and \ref setRangeDragAxes. If the mouse wheel
+  is scrolled while the cursor is on the axis rect, certain axes are scaled. This is controllable
+  via \ref setRangeZoom, \ref setRangeZoomAxes and \ref setRangeZoomFactor. These interactions are
+  only enabled if \ref QCustomPlot::setInteractions contains \ref QCP::iRangeDrag and \ref
+  QCP::iRangeZoom.
+  
+  \image html AxisRectSpacingOverview.png
+  <center>Overview of the spacings and paddings that define the geometry of an axis. The dashed
+  line on the far left indicates the viewport/widget border.</center>
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn QCPLayoutInset *QCPAxisRect::insetLayout() const
+  
+  Returns the inset layout of this axis rect. It can be used to place other layout elements (or
+  even layouts with multiple other elements) inside/on top of an axis rect.
+  
+  \see QCPLayoutInset
+*/
+
+/*! \fn int QCPAxisRect::left() const
+  
+  Returns the pixel position of the left border of this axis rect. Margins are not taken into
+  account here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn int QCPAxisRect::right() const
+  
+  Returns the pixel position of the right border of this axis rect. Margins are not taken into
+  account here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn int QCPAxisRect::top() const
+  
+  Returns the pixel position of the top border of this axis rect. Margins are not taken into
+  account here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn int QCPAxisRect::bottom() const
+  
+  Returns the pixel position of the bottom border of this axis rect. Margins are not taken into
+  account here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn int QCPAxisRect::width() const
+  
+  Returns the pixel width of this axis rect. Margins are not taken into account here, so the
+  returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn int QCPAxisRect::height() const
+  
+  Returns the pixel height of this axis rect. Margins are not taken into account here, so the
+  returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn QSize QCPAxisRect::size() const
+  
+  Returns the pixel size of this axis rect. Margins are not taken into account here, so the
+  returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn QPoint QCPAxisRect::topLeft() const
+  
+  Returns the top left corner of this axis rect in pixels. Margins are not taken into account here,
+  so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn QPoint QCPAxisRect::topRight() const
+  
+  Returns the top right corner of this axis rect in pixels. Margins are not taken into account
+  here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn QPoint QCPAxisRect::bottomLeft() const
+  
+  Returns the bottom left corner of this axis rect in pixels. Margins are not taken into account
+  here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn QPoint QCPAxisRect::bottomRight() const
+  
+  Returns the bottom right corner of this axis rect in pixels. Margins are not taken into account
+  here, so the returned value is with respect to the inner \ref rect.
+*/
+
+/*! \fn QPoint QCPAxisRect::center() const
+  
+  Returns the center of this axis rect in pixels. Margins are not taken into account here, so the
+  returned value is with respect to the inner \ref rect.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Creates a QCPAxisRect instance and sets default values. An axis is added for each of the four
+  sides, the top and right axes are set invisible initially.
+*/
+QCPAxisRect::QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes) :
+  QCPLayoutElement(parentPlot),
+  mBackgroundBrush(Qt::NoBrush),
+  mBackgroundScaled(true),
+  mBackgroundScaledMode(Qt::KeepAspectRatioByExpanding),
+  mInsetLayout(new QCPLayoutInset),
+  mRangeDrag(Qt::Horizontal|Qt::Vertical),
+  mRangeZoom(Qt::Horizontal|Qt::Vertical),
+  mRangeZoomFactorHorz(0.85),
+  mRangeZoomFactorVert(0.85),
+  mDragging(false),
+  mDragFrameInterval(16)
+{
+  mDragFrameTimer.setSingleShot(true);
+  connect(&mDragFrameTimer, SIGNAL(timeout()), this, SLOT(dragFrame()));
+  mInsetLayout->initializeParentPlot(mParentPlot);
+  mInsetLayout->setParentLayerable(this);
+  mInsetLayout->setParent(this);
+  
+  setMinimumSize(50, 50);
+  setMinimumMargins(QMargins(15, 15, 15, 15));
+  mAxes.insert(QCPAxis::atLeft, QList<QCPAxis*>());
+  mAxes.insert(QCPAxis::atRight, QList<QCPAxis*>());
+  mAxes.insert(QCPAxis::atTop, QList<QCPAxis*>());
+  mAxes.insert(QCPAxis::atBottom, QList<QCPAxis*>());
+  
+  if (setupDefaultAxes)
+  {
+    QCPAxis *xAxis = addAxis(QCPAxis::atBottom);
+    QCPAxis *yAxis = addAxis(QCPAxis::atLeft);
+    QCPAxis *xAxis2 = addAxis(QCPAxis::atTop);
+    QCPAxis *yAxis2 = addAxis(QCPAxis::atRight);
+    setRangeDragAxes(xAxis, yAxis);
+    setRangeZoomAxes(xAxis, yAxis);
+    xAxis2->setVisible(false);
+    yAxis2->setVisible(false);
+    xAxis->grid()->setVisible(true);
+    yAxis->grid()->setVisible(true);
+    xAxis2->grid()->setVisible(false);
+    yAxis2->grid()->setVisible(false);
+    xAxis2->grid()->setZeroLinePen(Qt::NoPen);
+    yAxis2->grid()->setZeroLinePen(Qt::NoPen);
+    xAxis2->grid()->setVisible(false);
+    yAxis2->grid()->setVisible(false);
+  }
+}
+
+QCPAxisRect::~QCPAxisRect()
+{
+  delete mInsetLayout;
+  mInsetLayout = 0;
+  
+  QList<QCPAxis*> axesList = axes();
+  for (int i=0; i<axesList.size(); ++i)
+    removeAxis(axesList.at(i));
+}
+
+/*!
+  Returns the number of axes on the axis rect side specified with \a type.
+  
+  \see axis
+*/
+int QCPAxisRect::axisCount(QCPAxis::AxisType type) const
+{
+  return mAxes.value(type).size();
+}
+
+/*!
+  Returns the axis with the given \a index on the axis rect side specified with \a type.
+  
+  \see axisCount, axes
+*/
+QCPAxis *QCPAxisRect::axis(QCPAxis::AxisType type, int index) const
+{
+  QList<QCPAxis*> ax(mAxes.value(type));
+  if (index >= 0 && index < ax.size())
+  {
+    return ax.at(index);
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Axis index out of bounds:" << index;
+    return 0;
+  }
+}
+
+/*!
+  Returns all axes on the axis rect sides specified with \a types.
+  
+  \a types may be a single \ref QCPAxis::AxisType or an <tt>or</tt>-combination, to get the axes of
+  multiple sides.
+  
+  \see axis
+*/
+QList<QCPAxis*> QCPAxisRect::axes(QCPAxis::AxisTypes types) const
+{
+  QList<QCPAxis*> result;
+  if (types.testFlag(QCPAxis::atLeft))
+    result << mAxes.value(QCPAxis::atLeft);
+  if (types.testFlag(QCPAxis::atRight))
+    result << mAxes.value(QCPAxis::atRight);
+  if (types.testFlag(QCPAxis::atTop))
+    result << mAxes.value(QCPAxis::atTop);
+  if (types.testFlag(QCPAxis::atBottom))
+    result << mAxes.value(QCPAxis::atBottom);
+  return result;
+}
+
+/*! \overload
+  
+  Returns all axes of this axis rect.
+*/
+QList<QCPAxis*> QCPAxisRect::axes() const
+{
+  QList<QCPAxis*> result;
+  QHashIterator<QCPAxis::AxisType, QList<QCPAxis*> > it(mAxes);
+  while (it.hasNext())
+  {
+    it.next();
+    result << it.value();
+  }
+  return result;
+}
+
+/*!
+  Adds a new axis to the axis rect side specified with \a type, and returns it. If \a axis is 0, a
+  new QCPAxis instance is created internally. QCustomPlot owns the returned axis, so if you want to
+  remove an axis, use \ref removeAxis instead of deleting it manually.
+
+  You may inject QCPAxis instances (or sublasses of QCPAxis) by setting \a axis to an axis that was
+  previously created outside QCustomPlot. It is important to note that QCustomPlot takes ownership
+  of the axis, so you may not delete it afterwards. Further, the \a axis must have been created
+  with this axis rect as parent and with the same axis type as specified in \a type. If this is not
+  the case, a debug output is generated, the axis is not added, and the method returns 0.
+
+  This method can not be used to move \a axis between axis rects. The same \a axis instance must
+  not be added multiple times to the same or different axis rects.
+
+  If an axis rect side already contains one or more axes, the lower and upper endings of the new
+  axis (\ref QCPAxis::setLowerEnding, \ref QCPAxis::setUpperEnding) are set to \ref
+  QCPLineEnding::esHalfBar.
+
+  \see addAxes, setupFullAxesBox
+*/
+QCPAxis *QCPAxisRect::addAxis(QCPAxis::AxisType type, QCPAxis *axis)
+{
+  QCPAxis *newAxis = axis;
+  if (!newAxis)
+  {
+    newAxis = new QCPAxis(this, type);
+  } else // user provided existing axis instance, do some sanity checks
+  {
+    if (newAxis->axisType() != type)
+    {
+      qDebug() << Q_FUNC_INFO << "passed axis has different axis type than specified in type parameter";
+      return 0;
+    }
+    if (newAxis->axisRect() != this)
+    {
+      qDebug() << Q_FUNC_INFO << "passed axis doesn't have this axis rect as parent axis rect";
+      return 0;
+    }
+    if (axes().contains(newAxis))
+    {
+      qDebug() << Q_FUNC_INFO << "passed axis is already owned by this axis rect";
+      return 0;
+    }
+  }
+  if (mAxes[type].size() > 0) // multiple axes on one side, add half-bar axis ending to additional axes with offset
+  {
+    bool invert = (type == QCPAxis::atRight) || (type == QCPAxis::atBottom);
+    newAxis->setLowerEnding(QCPLineEnding(QCPLineEnding::esHalfBar, 6, 10, !invert));
+    newAxis->setUpperEnding(QCPLineEnding(QCPLineEnding::esHalfBar, 6, 10, invert));
+  }
+  mAxes[type].append(newAxis);
+  
+  // reset convenience axis pointers on parent QCustomPlot if they are unset:
+  if (mParentPlot && mParentPlot->axisRectCount() > 0 && mParentPlot->axisRect(0) == this)
+  {
+    switch (type)
+    {
+      case QCPAxis::atBottom: { if (!mParentPlot->xAxis) mParentPlot->xAxis = newAxis; break; }
+      case QCPAxis::atLeft: { if (!mParentPlot->yAxis) mParentPlot->yAxis = newAxis; break; }
+      case QCPAxis::atTop: { if (!mParentPlot->xAxis2) mParentPlot->xAxis2 = newAxis; break; }
+      case QCPAxis::atRight: { if (!mParentPlot->yAxis2) mParentPlot->yAxis2 = newAxis; break; }
+    }
+  }
+  
+  return newAxis;
+}
+
+/*!
+  Adds a new axis with \ref addAxis to each axis rect side specified in \a types. This may be an
+  <tt>or</tt>-combination of QCPAxis::AxisType, so axes can be added to multiple sides at once.
+  
+  Returns a list of the added axes.
+  
+  \see addAxis, setupFullAxesBox
+*/
+QList<QCPAxis*> QCPAxisRect::addAxes(QCPAxis::AxisTypes types)
+{
+  QList<QCPAxis*> result;
+  if (types.testFlag(QCPAxis::atLeft))
+    result << addAxis(QCPAxis::atLeft);
+  if (types.testFlag(QCPAxis::atRight))
+    result << addAxis(QCPAxis::atRight);
+  if (types.testFlag(QCPAxis::atTop))
+    result << addAxis(QCPAxis::atTop);
+  if (types.testFlag(QCPAxis::atBottom))
+    result << addAxis(QCPAxis::atBottom);
+  return result;
+}
+
+/*!
+  Removes the specified \a axis from the axis rect and deletes it.
+  
+  Returns true on success, i.e. if \a axis was a valid axis in this axis rect.
+  
+  \see addAxis
+*/
+bool QCPAxisRect::removeAxis(QCPAxis *axis)
+{
+  // don't access axis->axisType() to provide safety when axis is an invalid pointer, rather go through all axis containers:
+  QHashIterator<QCPAxis::AxisType, QList<QCPAxis*> > it(mAxes);
+  while (it.hasNext())
+  {
+    it.next();
+    if (it.value().contains(axis))
+    {
+      mAxes[it.key()].removeOne(axis);
+      if (qobject_cast<QCustomPlot*>(parentPlot())) // make sure this isn't called from QObject dtor when QCustomPlot is already destructed (happens when the axis rect is not in any layout and thus QObject-child of QCustomPlot)
+        parentPlot()->axisRemoved(axis);
+      delete axis;
+      return true;
+    }
+  }
+  qDebug() << Q_FUNC_INFO << "Axis isn't in axis rect:" << reinterpret_cast<quintptr>(axis);
+  return false;
+}
+
+/*!
+  Zooms in (or out) to the passed rectangular region \a pixelRect, given in pixel coordinates.
+
+  All axes of this axis rect will have their range zoomed accordingly. If you only wish to zoom
+  specific axes, use the overloaded version of this method.
+  
+  \see QCustomPlot::setSelectionRectMode
+*/
+void QCPAxisRect::zoom(const QRectF &pixelRect)
+{
+  zoom(pixelRect, axes());
+}
+
+/*! \overload
+  
+  Zooms in (or out) to the passed rectangular region \a pixelRect, given in pixel coordinates.
+  
+  Only the axes passed in \a affectedAxes will have their ranges zoomed accordingly.
+  
+  \see QCustomPlot::setSelectionRectMode
+*/
+void QCPAxisRect::zoom(const QRectF &pixelRect, const QList<QCPAxis*> &affectedAxes)
+{
+  foreach (QCPAxis *axis, affectedAxes)
+  {
+    if (!axis)
+    {
+      qDebug() << Q_FUNC_INFO << "a passed axis was zero";
+      continue;
+    }
+    QCPRange pixelRange;
+    if (axis->orientation() == Qt::Horizontal)
+      pixelRange = QCPRange(pixelRect.left(), pixelRect.right());
+    else
+      pixelRange = QCPRange(pixelRect.top(), pixelRect.bottom());
+    axis->setRange(axis->pixelToCoord(pixelRange.lower), axis->pixelToCoord(pixelRange.upper));
+  }
+}
+
+/*!
+  Convenience function to create an axis on each side that doesn't have any axes yet and set their
+  visibility to true. Further, the top/right axes are assigned the following properties of the
+  bottom/left axes:
+
+  \li range (\ref QCPAxis::setRange)
+  \li range reversed (\ref QCPAxis::setRangeReversed)
+  \li scale type (\ref QCPAxis::setScaleType)
+  \li tick visibility (\ref QCPAxis::setTicks)
+  \li number format (\ref QCPAxis::setNumberFormat)
+  \li number precision (\ref QCPAxis::setNumberPrecision)
+  \li tick count of ticker (\ref QCPAxisTicker::setTickCount)
+  \li tick origin of ticker (\ref QCPAxisTicker::setTickOrigin)
+
+  Tick label visibility (\ref QCPAxis::setTickLabels) of the right and top axes are set to false.
+
+  If \a connectRanges is true, the \ref QCPAxis::rangeChanged "rangeChanged" signals of the bottom
+  and left axes are connected to the \ref QCPAxis::setRange slots of the top and right axes.
+*/
+void QCPAxisRect::setupFullAxesBox(bool connectRanges)
+{
+  QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
+  if (axisCount(QCPAxis::atBottom) == 0)
+    xAxis = addAxis(QCPAxis::atBottom);
+  else
+    xAxis = axis(QCPAxis::atBottom);
+  
+  if (axisCount(QCPAxis::atLeft) == 0)
+    yAxis = addAxis(QCPAxis::atLeft);
+  else
+    yAxis = axis(QCPAxis::atLeft);
+  
+  if (axisCount(QCPAxis::atTop) == 0)
+    xAxis2 = addAxis(QCPAxis::atTop);
+  else
+    xAxis2 = axis(QCPAxis::atTop);
+  
+  if (axisCount(QCPAxis::atRight) == 0)
+    yAxis2 = addAxis(QCPAxis::atRight);
+  else
+    yAxis2 = axis(QCPAxis::atRight);
+  
+  xAxis->setVisible(true);
+  yAxis->setVisible(true);
+  xAxis2->setVisible(true);
+  yAxis2->setVisible(true);
+  xAxis2->setTickLabels(false);
+  yAxis2->setTickLabels(false);
+  
+  xAxis2->setRange(xAxis->range());
+  xAxis2->setRangeReversed(xAxis->rangeReversed());
+  xAxis2->setScaleType(xAxis->scaleType());
+  xAxis2->setTicks(xAxis->ticks());
+  xAxis2->setNumberFormat(xAxis->numberFormat());
+  xAxis2->setNumberPrecision(xAxis->numberPrecision());
+  xAxis2->ticker()->setTickCount(xAxis->ticker()->tickCount());
+  xAxis2->ticker()->setTickOrigin(xAxis->ticker()->tickOrigin());
+  
+  yAxis2->setRange(yAxis->range());
+  yAxis2->setRangeReversed(yAxis->rangeReversed());
+  yAxis2->setScaleType(yAxis->scaleType());
+  yAxis2->setTicks(yAxis->ticks());
+  yAxis2->setNumberFormat(yAxis->numberFormat());
+  yAxis2->setNumberPrecision(yAxis->numberPrecision());
+  yAxis2->ticker()->setTickCount(yAxis->ticker()->tickCount());
+  yAxis2->ticker()->setTickOrigin(yAxis->ticker()->tickOrigin());
+  
+  if (connectRanges)
+  {
+    connect(xAxis, SIGNAL(rangeChanged(QCPRange)), xAxis2, SLOT(setRange(QCPRange)));
+    connect(yAxis, SIGNAL(rangeChanged(QCPRange)), yAxis2, SLOT(setRange(QCPRange)));
+  }
+}
+
+/*!
+  Returns a list of all the plottables that are associated with this axis rect.
+  
+  A plottable is considered associated with an axis rect if its key or value axis (or both) is in
+  this axis rect.
+  
+  \see graphs, items
+*/
+QList<QCPAbstractPlottable*> QCPAxisRect::plottables() const
+{
+  // Note: don't append all QCPAxis::plottables() into a list, because we might get duplicate entries
+  QList<QCPAbstractPlottable*> result;
+  for (int i=0; i<mParentPlot->mPlottables.size(); ++i)
+  {
+    if (mParentPlot->mPlottables.at(i)->keyAxis()->axisRect() == this || mParentPlot->mPlottables.at(i)->valueAxis()->axisRect() == this)
+      result.append(mParentPlot->mPlottables.at(i));
+  }
+  return result;
+}
+
+/*!
+  Returns a list of all the graphs that are associated with this axis rect.
+  
+  A graph is considered associated with an axis rect if its key or value axis (or both) is in
+  this axis rect.
+  
+  \see plottables, items
+*/
+QList<QCPGraph*> QCPAxisRect::graphs() const
+{
+  // Note: don't append all QCPAxis::graphs() into a list, because we might get duplicate entries
+  QList<QCPGraph*> result;
+  for (int i=0; i<mParentPlot->mGraphs.size(); ++i)
+  {
+    if (mParentPlot->mGraphs.at(i)->keyAxis()->axisRect() == this || mParentPlot->mGraphs.at(i)->valueAxis()->axisRect() == this)
+      result.append(mParentPlot->mGraphs.at(i));
+  }
+  return result;
+}
+
+/*!
+  Returns a list of all the items that are associated with this axis rect.
+  
+  An item is considered associated with an axis rect if any of its positions has key or value axis
+  set to an axis that is in this axis rect, or if any of its positions has \ref
+  QCPItemPosition::setAxisRect set to the axis rect, or if the clip axis rect (\ref
+  QCPAbstractItem::setClipAxisRect) is set to this axis rect.
+  
+  \see plottables, graphs
+*/
+QList<QCPAbstractItem *> QCPAxisRect::items() const
+{
+  // Note: don't just append all QCPAxis::items() into a list, because we might get duplicate entries
+  //       and miss those items that have this axis rect as clipAxisRect.
+  QList<QCPAbstractItem*> result;
+  for (int itemId=0; itemId<mParentPlot->mItems.size(); ++itemId)
+  {
+    if (mParentPlot->mItems.at(itemId)->clipAxisRect() == this)
+    {
+      result.append(mParentPlot->mItems.at(itemId));
+      continue;
+    }
+    QList<QCPItemPosition*> positions = mParentPlot->mItems.at(itemId)->positions();
+    for (int posId=0; posId<positions.size(); ++posId)
+    {
+      if (positions.at(posId)->axisRect() == this ||
+          positions.at(posId)->keyAxis()->axisRect() == this ||
+          positions.at(posId)->valueAxis()->axisRect() == this)
+      {
+        result.append(mParentPlot->mItems.at(itemId));
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+/*!
+  This method is called automatically upon replot and doesn't need to be called by users of
+  QCPAxisRect.
+  
+  Calls the base class implementation to update the margins (see \ref QCPLayoutElement::update),
+  and finally passes the \ref rect to the inset layout (\ref insetLayout) and calls its
+  QCPInsetLayout::update function.
+  
+  \seebaseclassmethod
+*/
+void QCPAxisRect::update(UpdatePhase phase)
+{
+  QCPLayoutElement::update(phase);
+  
+  switch (phase)
+  {
+    case upPreparation:
+    {
+      QList<QCPAxis*> allAxes = axes();
+      for (int i=0; i<allAxes.size(); ++i)
+        allAxes.at(i)->setupTickVectors();
+      break;
+    }
+    case upLayout:
+    {
+      mInsetLayout->setOuterRect(rect());
+      break;
+    }
+    default: break;
+  }
+  
+  // pass update call on to inset layout (doesn't happen automatically, because QCPAxisRect doesn't derive from QCPLayout):
+  mInsetLayout->update(phase);
+}
+
+/* inherits documentation from base class */
+QList<QCPLayoutElement*> QCPAxisRect::elements(bool recursive) const
+{
+  QList<QCPLayoutElement*> result;
+  if (mInsetLayout)
+  {
+    result << mInsetLayout;
+    if (recursive)
+      result << mInsetLayout->elements(recursive);
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPAxisRect::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+  painter->setAntialiasing(false);
+}
+
+/* inherits documentation from base class */
+void QCPAxisRect::draw(QCPPainter *painter)
+{
+  drawBackground(painter);
+}
+
+/*!
+  Sets \a pm as the axis background pixmap. The axis background pixmap will be drawn inside the
+  axis rect. Since axis rects place themselves on the "background" layer by default, the axis rect
+  backgrounds are usually drawn below everything else.
+
+  For cases where the provided pixmap doesn't have the same size as the axis rect, scaling can be
+  enabled with \ref setBackgroundScaled and the scaling mode (i.e. whether and how the aspect ratio
+  is preserved) can be set with \ref setBackgroundScaledMode. To set all these options in one call,
+  consider using the overloaded version of this function.
+
+  Below the pixmap, the axis rect may be optionally filled with a brush, if specified with \ref
+  setBackground(const QBrush &brush).
+  
+  \see setBackgroundScaled, setBackgroundScaledMode, setBackground(const QBrush &brush)
+*/
+void QCPAxisRect::setBackground(const QPixmap &pm)
+{
+  mBackgroundPixmap = pm;
+  mScaledBackgroundPixmap = QPixmap();
+}
+
+/*! \overload
+  
+  Sets \a brush as the background brush. The axis rect background will be filled with this brush.
+  Since axis rects place themselves on the "background" layer by default, the axis rect backgrounds
+  are usually drawn below everything else.
+
+  The brush will be drawn before (under) any background pixmap, which may be specified with \ref
+  setBackground(const QPixmap &pm).
+
+  To disable drawing of a background brush, set \a brush to Qt::NoBrush.
+  
+  \see setBackground(const QPixmap &pm)
+*/
+void QCPAxisRect::setBackground(const QBrush &brush)
+{
+  mBackgroundBrush = brush;
+}
+
+/*! \overload
+  
+  Allows setting the background pixmap of the axis rect, whether it shall be scaled and how it
+  shall be scaled in one call.
+
+  \see setBackground(const QPixmap &pm), setBackgroundScaled, setBackgroundScaledMode
+*/
+void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioMode mode)
+{
+  mBackgroundPixmap = pm;
+  mScaledBackgroundPixmap = QPixmap();
+  mBackgroundScaled = scaled;
+  mBackgroundScaledMode = mode;
+}
+
+/*!
+  Sets whether the axis background pixmap shall be scaled to fit the axis rect or not. If \a scaled
+  is set to true, you may control whether and how the aspect ratio of the original pixmap is
+  preserved with \ref setBackgroundScaledMode.
+  
+  Note that the scaled version of the original pixmap is buffered, so there is no performance
+  penalty on replots. (Except when the axis rect dimensions are changed continuously.)
+  
+  \see setBackground, setBackgroundScaledMode
+*/
+void QCPAxisRect::setBackgroundScaled(bool scaled)
+{
+  mBackgroundScaled = scaled;
+}
+
+/*!
+  If scaling of the axis background pixmap is enabled (\ref setBackgroundScaled), use this function to
+  define whether and how the aspect ratio of the original pixmap passed to \ref setBackground is preserved.
+  \see setBackground, setBackgroundScaled
+*/
+void QCPAxisRect::setBackgroundScaledMode(Qt::AspectRatioMode mode)
+{
+  mBackgroundScaledMode = mode;
+}
+
+/*!
+  Returns the range drag axis of the \a orientation provided. If multiple axes were set, returns
+  the first one (use \ref rangeDragAxes to retrieve a list with all set axes).
+
+  \see setRangeDragAxes
+*/
+QCPAxis *QCPAxisRect::rangeDragAxis(Qt::Orientation orientation)
+{
+  if (orientation == Qt::Horizontal)
+    return mRangeDragHorzAxis.isEmpty() ? 0 : mRangeDragHorzAxis.first().data();
+  else
+    return mRangeDragVertAxis.isEmpty() ? 0 : mRangeDragVertAxis.first().data();
+}
+
+/*!
+  Returns the range zoom axis of the \a orientation provided. If multiple axes were set, returns
+  the first one (use \ref rangeZoomAxes to retrieve a list with all set axes).
+
+  \see setRangeZoomAxes
+*/
+QCPAxis *QCPAxisRect::rangeZoomAxis(Qt::Orientation orientation)
+{
+  if (orientation == Qt::Horizontal)
+    return mRangeZoomHorzAxis.isEmpty() ? 0 : mRangeZoomHorzAxis.first().data();
+  else
+    return mRangeZoomVertAxis.isEmpty() ? 0 : mRangeZoomVertAxis.first().data();
+}
+
+/*!
+  Returns all range drag axes of the \a orientation provided.
+
+  \see rangeZoomAxis, setRangeZoomAxes
+*/
+QList<QCPAxis*> QCPAxisRect::rangeDragAxes(Qt::Orientation orientation)
+{
+  QList<QCPAxis*> result;
+  if (orientation == Qt::Horizontal)
+  {
+    for (int i=0; i<mRangeDragHorzAxis.size(); ++i)
+    {
+      if (!mRangeDragHorzAxis.at(i).isNull())
+        result.append(mRangeDragHorzAxis.at(i).data());
+    }
+  } else
+  {
+    for (int i=0; i<mRangeDragVertAxis.size(); ++i)
+    {
+      if (!mRangeDragVertAxis.at(i).isNull())
+        result.append(mRangeDragVertAxis.at(i).data());
+    }
+  }
+  return result;
+}
+
+/*!
+  Returns all range zoom axes of the \a orientation provided.
+
+  \see rangeDragAxis, setRangeDragAxes
+*/
+QList<QCPAxis*> QCPAxisRect::rangeZoomAxes(Qt::Orientation orientation)
+{
+  QList<QCPAxis*> result;
+  if (orientation == Qt::Horizontal)
+  {
+    for (int i=0; i<mRangeZoomHorzAxis.size(); ++i)
+    {
+      if (!mRangeZoomHorzAxis.at(i).isNull())
+        result.append(mRangeZoomHorzAxis.at(i).data());
+    }
+  } else
+  {
+    for (int i=0; i<mRangeZoomVertAxis.size(); ++i)
+    {
+      if (!mRangeZoomVertAxis.at(i).isNull())
+        result.append(mRangeZoomVertAxis.at(i).data());
+    }
+  }
+  return result;
+}
+
+/*!
+  Returns the range zoom factor of the \a orientation provided.
+  
+  \see setRangeZoomFactor
+*/
+double QCPAxisRect::rangeZoomFactor(Qt::Orientation orientation)
+{
+  return (orientation == Qt::Horizontal ? mRangeZoomFactorHorz : mRangeZoomFactorVert);
+}
+
+/*!
+  Sets which axis orientation may be range dragged by the user with mouse interaction.
+  What orientation corresponds to which specific axis can be set with
+  \ref setRangeDragAxes(QCPAxis *horizontal, QCPAxis *vertical). By
+  default, the horizontal axis is the bottom axis (xAxis) and the vertical axis
+  is the left axis (yAxis).
+  
+  To disable range dragging entirely, pass 0 as \a orientations or remove \ref QCP::iRangeDrag from \ref
+  QCustomPlot::setInteractions. To enable range dragging for both directions, pass <tt>Qt::Horizontal |
+  Qt::Vertical</tt> as \a orientations.
+  
+  In addition to setting \a orientations to a non-zero value, make sure \ref QCustomPlot::setInteractions
+  contains \ref QCP::iRangeDrag to enable the range dragging interaction.
+  
+  \see setRangeZoom, setRangeDragAxes, QCustomPlot::setNoAntialiasingOnDrag
+*/
+void QCPAxisRect::setRangeDrag(Qt::Orientations orientations)
+{
+  mRangeDrag = orientations;
+}
+
+/*!
+  Sets which axis orientation may be zoomed by the user with the mouse wheel. What orientation
+  corresponds to which specific axis can be set with \ref setRangeZoomAxes(QCPAxis *horizontal,
+  QCPAxis *vertical). By default, the horizontal axis is the bottom axis (xAxis) and the vertical
+  axis is the left axis (yAxis).
+
+  To disable range zooming entirely, pass 0 as \a orientations or remove \ref QCP::iRangeZoom from \ref
+  QCustomPlot::setInteractions. To enable range zooming for both directions, pass <tt>Qt::Horizontal |
+  Qt::Vertical</tt> as \a orientations.
+  
+  In addition to setting \a orientations to a non-zero value, make sure \ref QCustomPlot::setInteractions
+  contains \ref QCP::iRangeZoom to enable the range zooming interaction.
+  
+  \see setRangeZoomFactor, setRangeZoomAxes, setRangeDrag
+*/
+void QCPAxisRect::setRangeZoom(Qt::Orientations orientations)
+{
+  mRangeZoom = orientations;
+}
+
+/*! \overload
+  
+  Sets the axes whose range will be dragged when \ref setRangeDrag enables mouse range dragging on
+  the QCustomPlot widget. Pass 0 if no axis shall be dragged in the respective orientation.
+
+  Use the overload taking a list of axes, if multiple axes (more than one per orientation) shall
+  react to dragging interactions.
+
+  \see setRangeZoomAxes
+*/
+void QCPAxisRect::setRangeDragAxes(QCPAxis *horizontal, QCPAxis *vertical)
+{
+  QList<QCPAxis*> horz, vert;
+  if (horizontal)
+    horz.append(horizontal);
+  if (vertical)
+    vert.append(vertical);
+  setRangeDragAxes(horz, vert);
+}
+
+/*! \overload
+
+  This method allows to set up multiple axes to react to horizontal and vertical dragging. The drag
+  orientation that the respective axis will react to is deduced from its orientation (\ref
+  QCPAxis::orientation).
+
+  In the unusual case that you wish to e.g. drag a vertically oriented axis with a horizontal drag
+  motion, use the overload taking two separate lists for horizontal and vertical dragging.
+*/
+void QCPAxisRect::setRangeDragAxes(QList<QCPAxis*> axes)
+{
+  QList<QCPAxis*> horz, vert;
+  foreach (QCPAxis *ax, axes)
+  {
+    if (ax->orientation() == Qt::Horizontal)
+      horz.append(ax);
+    else
+      vert.append(ax);
+  }
+  setRangeDragAxes(horz, vert);
+}
+
+/*! \overload
+
+  This method allows to set multiple axes up to react to horizontal and vertical dragging, and
+  define specifically which axis reacts to which drag orientation (irrespective of the axis
+  orientation).
+*/
+void QCPAxisRect::setRangeDragAxes(QList<QCPAxis*> horizontal, QList<QCPAxis*> vertical)
+{
+  mRangeDragHorzAxis.clear();
+  foreach (QCPAxis *ax, horizontal)
+  {
+    QPointer<QCPAxis> axPointer(ax);
+    if (!axPointer.isNull())
+      mRangeDragHorzAxis.append(axPointer);
+    else
+      qDebug() << Q_FUNC_INFO << "invalid axis passed in horizontal list:" << reinterpret_cast<quintptr>(ax);
+  }
+  mRangeDragVertAxis.clear();
+  foreach (QCPAxis *ax, vertical)
+  {
+    QPointer<QCPAxis> axPointer(ax);
+    if (!axPointer.isNull())
+      mRangeDragVertAxis.append(axPointer);
+    else
+      qDebug() << Q_FUNC_INFO << "invalid axis passed in vertical list:" << reinterpret_cast<quintptr>(ax);
+  }
+}
+
+/*!
+  Sets the axes whose range will be zoomed when \ref setRangeZoom enables mouse wheel zooming on
+  the QCustomPlot widget. Pass 0 if no axis shall be zoomed in the respective orientation.
+
+  The two axes can be zoomed with different strengths, when different factors are passed to \ref
+  setRangeZoomFactor(double horizontalFactor, double verticalFactor).
+
+  Use the overload taking a list of axes, if multiple axes (more than one per orientation) shall
+  react to zooming interactions.
+
+  \see setRangeDragAxes
+*/
+void QCPAxisRect::setRangeZoomAxes(QCPAxis *horizontal, QCPAxis *vertical)
+{
+  QList<QCPAxis*> horz, vert;
+  if (horizontal)
+    horz.append(horizontal);
+  if (vertical)
+    vert.append(vertical);
+  setRangeZoomAxes(horz, vert);
+}
+
+/*! \overload
+
+  This method allows to set up multiple axes to react to horizontal and vertical range zooming. The
+  zoom orientation that the respective axis will react to is deduced from its orientation (\ref
+  QCPAxis::orientation).
+
+  In the unusual case that you wish to e.g. zoom a vertically oriented axis with a horizontal zoom
+  interaction, use the overload taking two separate lists for horizontal and vertical zooming.
+*/
+void QCPAxisRect::setRangeZoomAxes(QList<QCPAxis*> axes)
+{
+  QList<QCPAxis*> horz, vert;
+  foreach (QCPAxis *ax, axes)
+  {
+    if (ax->orientation() == Qt::Horizontal)
+      horz.append(ax);
+    else
+      vert.append(ax);
+  }
+  setRangeZoomAxes(horz, vert);
+}
+
+/*! \overload
+
+  This method allows to set multiple axes up to react to horizontal and vertical zooming, and
+  define specifically which axis reacts to which zoom orientation (irrespective of the axis
+  orientation).
+*/
+void QCPAxisRect::setRangeZoomAxes(QList<QCPAxis*> horizontal, QList<QCPAxis*> vertical)
+{
+  mRangeZoomHorzAxis.clear();
+  foreach (QCPAxis *ax, horizontal)
+  {
+    QPointer<QCPAxis> axPointer(ax);
+    if (!axPointer.isNull())
+      mRangeZoomHorzAxis.append(axPointer);
+    else
+      qDebug() << Q_FUNC_INFO << "invalid axis passed in horizontal list:" << reinterpret_cast<quintptr>(ax);
+  }
+  mRangeZoomVertAxis.clear();
+  foreach (QCPAxis *ax, vertical)
+  {
+    QPointer<QCPAxis> axPointer(ax);
+    if (!axPointer.isNull())
+      mRangeZoomVertAxis.append(axPointer);
+    else
+      qDebug() << Q_FUNC_INFO << "invalid axis passed in vertical list:" << reinterpret_cast<quintptr>(ax);
+  }
+}
+
+/*!
+  Sets how strong one rotation step of the mouse wheel zooms, when range zoom was activated with
+  \ref setRangeZoom. The two parameters \a horizontalFactor and \a verticalFactor provide a way to
+  let the horizontal axis zoom at different rates than the vertical axis. Which axis is horizontal
+  and which is vertical, can be set with \ref setRangeZoomAxes.
+
+  When the zoom factor is greater than one, scrolling the mouse wheel backwards (towards the user)
+  will zoom in (make the currently visible range smaller). For zoom factors smaller than one, the
+  same scrolling direction will zoom out.
+*/
+void QCPAxisRect::setRangeZoomFactor(double horizontalFactor, double verticalFactor)
+{
+  mRangeZoomFactorHorz = horizontalFactor;
+  mRangeZoomFactorVert = verticalFactor;
+}
+
+/*! \overload
+  
+  Sets both the horizontal and vertical zoom \a factor.
+*/
+void QCPAxisRect::setRangeZoomFactor(double factor)
+{
+  mRangeZoomFactorHorz = factor;
+  mRangeZoomFactorVert = factor;
+}
+
+/*! \internal
   
-  If an axis rect is clicked and dragged, it processes this by moving certain axis ranges. The
-  behaviour can be controlled with \ref setRangeDrag and \ref setRangeDragAxes. If the mouse wheel
-  is scrolled while the cursor is on the axis rect, certain axes are scaled. This is controllable
-  via \ref setRangeZoom, \ref setRangeZoomAxes and \ref setRangeZoomFactor. These interactions are
-  only enabled if \ref QCustomPlot::setInteractions contains \ref QCP::iRangeDrag and \ref
-  QCP::iRangeZoom.
+  Draws the background of this axis rect. It may consist of a background fill (a QBrush) and a
+  pixmap.
+  
+  If a brush was given via \ref setBackground(const QBrush &brush), this function first draws an
+  according filling inside the axis rect with the provided \a painter.
+  
+  Then, if a pixmap was provided via \ref setBackground, this function buffers the scaled version
+  depending on \ref setBackgroundScaled and \ref setBackgroundScaledMode and then draws it inside
+  the axis rect with the provided \a painter. The scaled version is buffered in
+  mScaledBackgroundPixmap to prevent expensive rescaling at every redraw. It is only updated, when
+  the axis rect has changed in a way that requires a rescale of the background pixmap (this is
+  dependent on the \ref setBackgroundScaledMode), or when a differend axis background pixmap was
+  set.
+  
+  \see setBackground, setBackgroundScaled, setBackgroundScaledMode
+*/
+void QCPAxisRect::drawBackground(QCPPainter *painter)
+{
+  // draw background fill:
+  if (mBackgroundBrush != Qt::NoBrush)
+    painter->fillRect(mRect, mBackgroundBrush);
+  
+  // draw background pixmap (on top of fill, if brush specified):
+  if (!mBackgroundPixmap.isNull())
+  {
+    if (mBackgroundScaled)
+    {
+      // check whether mScaledBackground needs to be updated:
+      QSize scaledSize(mBackgroundPixmap.size());
+      scaledSize.scale(mRect.size(), mBackgroundScaledMode);
+      if (mScaledBackgroundPixmap.size() != scaledSize)
+        mScaledBackgroundPixmap = mBackgroundPixmap.scaled(mRect.size(), mBackgroundScaledMode, Qt::SmoothTransformation);
+      painter->drawPixmap(mRect.topLeft()+QPoint(0, -1), mScaledBackgroundPixmap, QRect(0, 0, mRect.width(), mRect.height()) & mScaledBackgroundPixmap.rect());
+    } else
+    {
+      painter->drawPixmap(mRect.topLeft()+QPoint(0, -1), mBackgroundPixmap, QRect(0, 0, mRect.width(), mRect.height()));
+    }
+  }
+}
+
+/*! \internal
+  
+  This function makes sure multiple axes on the side specified with \a type don't collide, but are
+  distributed according to their respective space requirement (QCPAxis::calculateMargin).
+  
+  It does this by setting an appropriate offset (\ref QCPAxis::setOffset) on all axes except the
+  one with index zero.
+  
+  This function is called by \ref calculateAutoMargin.
+*/
+void QCPAxisRect::updateAxesOffset(QCPAxis::AxisType type)
+{
+  const QList<QCPAxis*> axesList = mAxes.value(type);
+  if (axesList.isEmpty())
+    return;
+  
+  bool isFirstVisible = !axesList.first()->visible(); // if the first axis is visible, the second axis (which is where the loop starts) isn't the first visible axis, so initialize with false
+  for (int i=1; i<axesList.size(); ++i)
+  {
+    int offset = axesList.at(i-1)->offset() + axesList.at(i-1)->calculateMargin();
+    if (axesList.at(i)->visible()) // only add inner tick length to offset if this axis is visible and it's not the first visible one (might happen if true first axis is invisible)
+    {
+      if (!isFirstVisible)
+        offset += axesList.at(i)->tickLengthIn();
+      isFirstVisible = false;
+    }
+    axesList.at(i)->setOffset(offset);
+  }
+}
+
+/*! \internal
+  
+  Returns the layers whose paint buffers can be scrolled during the current range drag (see \ref
+  QCP::phBlitDrag), and writes the distance the content has to be moved by to \a delta.
+  
+  Eligible layers are in \ref QCPLayer::lmBuffered mode and only contain plottables that are
+  clipped to this axis rect and whose axes all are moved by the drag. If the content moved out of
+  the axis rect completely, no layers are returned, so they are redrawn.
+*/
+QList<QCPLayer*> QCPAxisRect::dragScrollLayers(QPoint *delta) const
+{
+  QList<QCPLayer*> result;
+  *delta = mDragLastPos-mDragRenderedPos;
+  if (!mRangeDrag.testFlag(Qt::Horizontal))
+    delta->setX(0);
+  if (!mRangeDrag.testFlag(Qt::Vertical))
+    delta->setY(0);
+  if (qAbs(delta->x()) >= width() || qAbs(delta->y()) >= height())
+    return result;
+  
+  const QList<QCPAxis*> horzAxes = rangeDragAxes(Qt::Horizontal);
+  const QList<QCPAxis*> vertAxes = rangeDragAxes(Qt::Vertical);
+  foreach (QCPLayer *layer, mParentPlot->mLayers)
+  {
+    if (layer->mode() != QCPLayer::lmBuffered || layer->children().isEmpty())
+      continue;
+    bool scrollable = true;
+    foreach (QCPLayerable *child, layer->children())
+    {
+      QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(child);
+      if (!plottable || !plottable->clipToAxisRect() || !plottable->keyAxis() || !plottable->valueAxis() || plottable->keyAxis()->axisRect() != this)
+      {
+        scrollable = false;
+        break;
+      }
+      const bool keyHorizontal = plottable->keyAxis()->orientation() == Qt::Horizontal;
+      QCPAxis *horzAxis = keyHorizontal ? plottable->keyAxis() : plottable->valueAxis();
+      QCPAxis *vertAxis = keyHorizontal ? plottable->valueAxis() : plottable->keyAxis();
+      if ((delta->x() != 0 && !horzAxes.contains(horzAxis)) || (delta->y() != 0 && !vertAxes.contains(vertAxis)))
+      {
+        scrollable = false;
+        break;
+      }
+    }
+    if (scrollable)
+      result.append(layer);
+  }
+  return result;
+}
+
+/*! \internal
   
-  \image html AxisRectSpacingOverview.png
-  <center>Overview of the spacings and paddings that define the geometry of an axis. The dashed
-  line on the far left indicates the viewport/widget border.</center>
+  Performs the coalesced replot of a range drag with the plotting hint \ref QCP::phBlitDrag. It is
+  called by the drag frame timer, which \ref mouseMoveEvent starts such that replots happen at most
+  once per screen refresh interval. Only these replots scroll the paint buffers of the dragged
+  layers, any other replot during the drag draws all layers in full.
 */
+void QCPAxisRect::dragFrame()
+{
+  if (!mDragging || mParentPlot->mDragScrollAxisRect.data() != this)
+    return;
+  mDragFrameClock.start();
+  mParentPlot->mDragFrameReplot = true;
+  mParentPlot->replot();
+  mParentPlot->mDragFrameReplot = false;
+}
 
-/* start documentation of inline functions */
-
-/*! \fn QCPLayoutInset *QCPAxisRect::insetLayout() const
+/* inherits documentation from base class */
+int QCPAxisRect::calculateAutoMargin(QCP::MarginSide side)
+{
+  if (!mAutoMargins.testFlag(side))
+    qDebug() << Q_FUNC_INFO << "Called with side that isn't specified as auto margin";
   
-  Returns the inset layout of this axis rect. It can be used to place other layout elements (or
-  even layouts with multiple other elements) inside/on top of an axis rect.
+  updateAxesOffset(QCPAxis::marginSideToAxisType(side));
   
-  \see QCPLayoutInset
-*/
+  // note: only need to look at the last (outer most) axis to determine the total margin, due to updateAxisOffset call
+  const QList<QCPAxis*> axesList = mAxes.value(QCPAxis::marginSideToAxisType(side));
+  if (axesList.size() > 0)
+    return axesList.last()->offset() + axesList.last()->calculateMargin();
+  else
+    return 0;
+}
 
-/*! \fn int QCPAxisRect::left() const
+/*! \internal
   
-  Returns the pixel position of the left border of this axis rect. Margins are not taken into
-  account here, so the returned value is with respect to the inner \ref rect.
-*/
-
-/*! \fn int QCPAxisRect::right() const
+  Reacts to a change in layout to potentially set the convenience axis pointers \ref
+  QCustomPlot::xAxis, \ref QCustomPlot::yAxis, etc. of the parent QCustomPlot to the respective
+  axes of this axis rect. This is only done if the respective convenience pointer is currently zero
+  and if there is no QCPAxisRect at position (0, 0) of the plot layout.
   
-  Returns the pixel position of the right border of this axis rect. Margins are not taken into
-  account here, so the returned value is with respect to the inner \ref rect.
+  This automation makes it simpler to replace the main axis rect with a newly created one, without
+  the need to manually reset the convenience pointers.
 */
+void QCPAxisRect::layoutChanged()
+{
+  if (mParentPlot && mParentPlot->axisRectCount() > 0 && mParentPlot->axisRect(0) == this)
+  {
+    if (axisCount(QCPAxis::atBottom) > 0 && !mParentPlot->xAxis)
+      mParentPlot->xAxis = axis(QCPAxis::atBottom);
+    if (axisCount(QCPAxis::atLeft) > 0 && !mParentPlot->yAxis)
+      mParentPlot->yAxis = axis(QCPAxis::atLeft);
+    if (axisCount(QCPAxis::atTop) > 0 && !mParentPlot->xAxis2)
+      mParentPlot->xAxis2 = axis(QCPAxis::atTop);
+    if (axisCount(QCPAxis::atRight) > 0 && !mParentPlot->yAxis2)
+      mParentPlot->yAxis2 = axis(QCPAxis::atRight);
+  }
+}
 
-/*! \fn int QCPAxisRect::top() const
+/*! \internal
   
-  Returns the pixel position of the top border of this axis rect. Margins are not taken into
-  account here, so the returned value is with respect to the inner \ref rect.
-*/
+  Event handler for when a mouse button is pressed on the axis rect. If the left mouse button is
+  pressed, the range dragging interaction is initialized (the actual range manipulation happens in
+  the \ref mouseMoveEvent).
 
-/*! \fn int QCPAxisRect::bottom() const
+  The mDragging flag is set to true and some anchor points are set that are needed to determine the
+  distance the mouse was dragged in the mouse move/release events later.
   
-  Returns the pixel position of the bottom border of this axis rect. Margins are not taken into
-  account here, so the returned value is with respect to the inner \ref rect.
+  \see mouseMoveEvent, mouseReleaseEvent
 */
+void QCPAxisRect::mousePressEvent(QMouseEvent *event, const QVariant &details)
+{
+  Q_UNUSED(details)
+  mDragStart = event->pos(); // need this even when not LeftButton is pressed, to determine in releaseEvent whether it was a full click (no position change between press and release)
+  if (event->buttons() & Qt::LeftButton)
+  {
+    mDragging = true;
+    // initialize antialiasing backup in case we start dragging:
+    if (mParentPlot->noAntialiasingOnDrag())
+    {
+      mAADragBackup = mParentPlot->antialiasedElements();
+      mNotAADragBackup = mParentPlot->notAntialiasedElements();
+    }
+    // Mouse range dragging interaction:
+    if (mParentPlot->interactions().testFlag(QCP::iRangeDrag))
+    {
+      mDragLastPos = mDragRenderedPos = event->pos();
+      mDragFrameClock.invalidate();
+      if (mParentPlot->plottingHints().testFlag(QCP::phBlitDrag))
+      {
+        // replots during the drag are coalesced to the refresh rate of the screen showing the plot:
+        mDragFrameInterval = 16;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        QWindow *window = mParentPlot->window()->windowHandle();
+        QScreen *screen = window ? window->screen() : QGuiApplication::primaryScreen();
+        if (screen && screen->refreshRate() > 0)
+          mDragFrameInterval = qRound(1000.0/screen->refreshRate());
+#endif
+      }
+      mDragStartHorzRange.clear();
+      for (int i=0; i<mRangeDragHorzAxis.size(); ++i)
+        mDragStartHorzRange.append(mRangeDragHorzAxis.at(i).isNull() ? QCPRange() : mRangeDragHorzAxis.at(i)->range());
+      mDragStartVertRange.clear();
+      for (int i=0; i<mRangeDragVertAxis.size(); ++i)
+        mDragStartVertRange.append(mRangeDragVertAxis.at(i).isNull() ? QCPRange() : mRangeDragVertAxis.at(i)->range());
+    }
+  }
+}
 
-/*! \fn int QCPAxisRect::width() const
+/*! \internal
   
-  Returns the pixel width of this axis rect. Margins are not taken into account here, so the
-  returned value is with respect to the inner \ref rect.
-*/
-
-/*! \fn int QCPAxisRect::height() const
+  Event handler for when the mouse is moved on the axis rect. If range dragging was activated in a
+  preceding \ref mousePressEvent, the range is moved accordingly.
   
-  Returns the pixel height of this axis rect. Margins are not taken into account here, so the
-  returned value is with respect to the inner \ref rect.
-*/
-
-/*! \fn QSize QCPAxisRect::size() const
+  If the plotting hint \ref QCP::phBlitDrag is set, the replot isn't performed immediately. Instead,
+  replots are coalesced to the screen refresh rate, and the buffered layers which only hold
+  plottables of this axis rect are scrolled by the drag distance, so only the exposed strip must be
+  drawn (see \ref dragScrollLayers). When the drag ends, \ref mouseReleaseEvent performs an exact
+  replot.
   
-  Returns the pixel size of this axis rect. Margins are not taken into account here, so the
-  returned value is with respect to the inner \ref rect.
+  \see mousePressEvent, mouseReleaseEvent
 */
+void QCPAxisRect::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
+{
+  Q_UNUSED(startPos)
+  // Mouse range dragging interaction:
+  if (mDragging && mParentPlot->interactions().testFlag(QCP::iRangeDrag))
+  {
+    
+    if (mRangeDrag.testFlag(Qt::Horizontal))
+    {
+      for (int i=0; i<mRangeDragHorzAxis.size(); ++i)
+      {
+        QCPAxis *ax = mRangeDragHorzAxis.at(i).data();
+        if (!ax)
+          continue;
+        if (i >= mDragStartHorzRange.size())
+          break;
+        if (ax->mScaleType == QCPAxis::stLinear)
+        {
+          double diff = ax->pixelToCoord(mDragStart.x()) - ax->pixelToCoord(event->pos().x());
+          ax->setRange(mDragStartHorzRange.at(i).lower+diff, mDragStartHorzRange.at(i).upper+diff);
+        } else if (ax->mScaleType == QCPAxis::stLogarithmic)
+        {
+          double diff = ax->pixelToCoord(mDragStart.x()) / ax->pixelToCoord(event->pos().x());
+          ax->setRange(mDragStartHorzRange.at(i).lower*diff, mDragStartHorzRange.at(i).upper*diff);
+        }
+      }
+    }
+    
+    if (mRangeDrag.testFlag(Qt::Vertical))
+    {
+      for (int i=0; i<mRangeDragVertAxis.size(); ++i)
+      {
+        QCPAxis *ax = mRangeDragVertAxis.at(i).data();
+        if (!ax)
+          continue;
+        if (i >= mDragStartVertRange.size())
+          break;
+        if (ax->mScaleType == QCPAxis::stLinear)
+        {
+          double diff = ax->pixelToCoord(mDragStart.y()) - ax->pixelToCoord(event->pos().y());
+          ax->setRange(mDragStartVertRange.at(i).lower+diff, mDragStartVertRange.at(i).upper+diff);
+        } else if (ax->mScaleType == QCPAxis::stLogarithmic)
+        {
+          double diff = ax->pixelToCoord(mDragStart.y()) / ax->pixelToCoord(event->pos().y());
+          ax->setRange(mDragStartVertRange.at(i).lower*diff, mDragStartVertRange.at(i).upper*diff);
+        }
+      }
+    }
+    
+    if (mRangeDrag != 0) // if either vertical or horizontal drag was enabled, do a replot
+    {
+      if (mParentPlot->noAntialiasingOnDrag())
+        mParentPlot->setNotAntialiasedElements(QCP::aeAll);
+      mDragLastPos = event->pos();
+      if (mParentPlot->plottingHints().testFlag(QCP::phBlitDrag))
+      {
+        // scroll the buffered plottable layers instead of redrawing them, at most once per screen refresh:
+        mParentPlot->mDragScrollAxisRect = this;
+        if (!mDragFrameTimer.isActive())
+        {
+          const qint64 sinceLastFrame = mDragFrameClock.isValid() ? mDragFrameClock.elapsed() : qint64(mDragFrameInterval);
+          mDragFrameTimer.start(int(qMax(qint64(0), mDragFrameInterval-sinceLastFrame)));
+        }
+      } else
+        mParentPlot->replot();
+    }
+    
+  }
+}
 
-/*! \fn QPoint QCPAxisRect::topLeft() const
-  
-  Returns the top left corner of this axis rect in pixels. Margins are not taken into account here,
-  so the returned value is with respect to the inner \ref rect.
-*/
+/* inherits documentation from base class */
+void QCPAxisRect::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
+{
+  Q_UNUSED(event)
+  Q_UNUSED(startPos)
+  mDragging = false;
+  if (mParentPlot->noAntialiasingOnDrag())
+  {
+    mParentPlot->setAntialiasedElements(mAADragBackup);
+    mParentPlot->setNotAntialiasedElements(mNotAADragBackup);
+  }
+  if (mParentPlot->mDragScrollAxisRect.data() == this)
+  {
+    // the scrolled buffers only approximate the plot, so finish the drag with an exact replot:
+    mDragFrameTimer.stop();
+    mParentPlot->mDragScrollAxisRect = 0;
+    mParentPlot->replot();
+  }
+}
 
-/*! \fn QPoint QCPAxisRect::topRight() const
+/*! \internal
   
-  Returns the top right corner of this axis rect in pixels. Margins are not taken into account
-  here, so the returned value is with respect to the inner \ref rect.
+  Event handler for mouse wheel events. If rangeZoom is Qt::Horizontal, Qt::Vertical or both, the
+  ranges of the axes defined as rangeZoomHorzAxis and rangeZoomVertAxis are scaled. The center of
+  the scaling operation is the current cursor position inside the axis rect. The scaling factor is
+  dependent on the mouse wheel delta (which direction the wheel was rotated) to provide a natural
+  zooming feel. The Strength of the zoom can be controlled via \ref setRangeZoomFactor.
+  
+  Note, that event->delta() is usually +/-120 for single rotation steps. However, if the mouse
+  wheel is turned rapidly, many steps may bunch up to one event, so the event->delta() may then be
+  multiples of 120. This is taken into account here, by calculating \a wheelSteps and using it as
+  exponent of the range zoom factor. This takes care of the wheel direction automatically, by
+  inverting the factor, when the wheel step is negative (f^-1 = 1/f).
+  
+  If the plotting hint \ref QCP::phProgressiveZoom is set, the zoomed plot is first shown as a
+  coarse preview (\ref QCustomPlot::replotCoarse) and refined once the wheel comes to rest.
 */
+void QCPAxisRect::wheelEvent(QWheelEvent *event)
+{
+  // Mouse range zooming interaction:
+  if (mParentPlot->interactions().testFlag(QCP::iRangeZoom))
+  {
+    if (mRangeZoom != 0)
+    {
+      double factor;
+      double wheelSteps = event->delta()/120.0; // a single step delta is +/-120 usually
+      if (mRangeZoom.testFlag(Qt::Horizontal))
+      {
+        factor = qPow(mRangeZoomFactorHorz, wheelSteps);
+        for (int i=0; i<mRangeZoomHorzAxis.size(); ++i)
+        {
+          if (!mRangeZoomHorzAxis.at(i).isNull())
+            mRangeZoomHorzAxis.at(i)->scaleRange(factor, mRangeZoomHorzAxis.at(i)->pixelToCoord(event->pos().x()));
+        }
+      }
+      if (mRangeZoom.testFlag(Qt::Vertical))
+      {
+        factor = qPow(mRangeZoomFactorVert, wheelSteps);
+        for (int i=0; i<mRangeZoomVertAxis.size(); ++i)
+        {
+          if (!mRangeZoomVertAxis.at(i).isNull())
+            mRangeZoomVertAxis.at(i)->scaleRange(factor, mRangeZoomVertAxis.at(i)->pixelToCoord(event->pos().y()));
+        }
+      }
+      if (mParentPlot->plottingHints().testFlag(QCP::phProgressiveZoom))
+        mParentPlot->replotCoarse();
+      else
+        mParentPlot->replot();
+    }
+  }
+}
+/* end of 'src/layoutelements/layoutelement-axisrect.cpp' */
+
+
+/* including file 'src/layoutelements/layoutelement-legend.cpp', size 30933  */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPAbstractLegendItem
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \fn QPoint QCPAxisRect::bottomLeft() const
+/*! \class QCPAbstractLegendItem
+  \brief The abstract base class for all entries in a QCPLegend.
   
-  Returns the bottom left corner of this axis rect in pixels. Margins are not taken into account
-  here, so the returned value is with respect to the inner \ref rect.
-*/
+  It defines a very basic interface for entries in a QCPLegend. For representing plottables in the
+  legend, the subclass \ref QCPPlottableLegendItem is more suitable.
+  
+  Only derive directly from this class when you need absolute freedom (e.g. a custom legend entry
+  that's not even associated with a plottable).
 
-/*! \fn QPoint QCPAxisRect::bottomRight() const
+  You must implement the following pure virtual functions:
+  \li \ref draw (from QCPLayerable)
   
-  Returns the bottom right corner of this axis rect in pixels. Margins are not taken into account
-  here, so the returned value is with respect to the inner \ref rect.
+  You inherit the following members you may use:
+  <table>
+    <tr>
+      <td>QCPLegend *\b mParentLegend</td>
+      <td>A pointer to the parent QCPLegend.</td>
+    </tr><tr>
+      <td>QFont \b mFont</td>
+      <td>The generic font of the item. You should use this font for all or at least the most prominent text of the item.</td>
+    </tr>
+  </table>
 */
 
-/*! \fn QPoint QCPAxisRect::center() const
+/* start of documentation of signals */
+
+/*! \fn void QCPAbstractLegendItem::selectionChanged(bool selected)
   
-  Returns the center of this axis rect in pixels. Margins are not taken into account here, so the
-  returned value is with respect to the inner \ref rect.
+  This signal is emitted when the selection state of this legend item has changed, either by user
+  interaction or by a direct call to \ref setSelected.
 */
 
-/* end documentation of inline functions */
+/* end of documentation of signals */
 
 /*!
-  Creates a QCPAxisRect instance and sets default values. An axis is added for each of the four
-  sides, the top and right axes are set invisible initially.
+  Constructs a QCPAbstractLegendItem and associates it with the QCPLegend \a parent. This does not
+  cause the item to be added to \a parent, so \ref QCPLegend::addItem must be called separately.
 */
-QCPAxisRect::QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes) :
-  QCPLayoutElement(parentPlot),
-  mBackgroundBrush(Qt::NoBrush),
-  mBackgroundScaled(true),
-  mBackgroundScaledMode(Qt::KeepAspectRatioByExpanding),
-  mInsetLayout(new QCPLayoutInset),
-  mRangeDrag(Qt::Horizontal|Qt::Vertical),
-  mRangeZoom(Qt::Horizontal|Qt::Vertical),
-  mRangeZoomFactorHorz(0.85),
-  mRangeZoomFactorVert(0.85),
-  mDragging(false)
+QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
+  QCPLayoutElement(parent->parentPlot()),
+  mParentLegend(parent),
+  mFont(parent->font()),
+  mTextColor(parent->textColor()),
+  mSelectedFont(parent->selectedFont()),
+  mSelectedTextColor(parent->selectedTextColor()),
+  mSelectable(true),
+  mSelected(false)
 {
-  mInsetLayout->initializeParentPlot(mParentPlot);
-  mInsetLayout->setParentLayerable(this);
-  mInsetLayout->setParent(this);
-  
-  setMinimumSize(50, 50);
-  setMinimumMargins(QMargins(15, 15, 15, 15));
-  mAxes.insert(QCPAxis::atLeft, QList<QCPAxis*>());
-  mAxes.insert(QCPAxis::atRight, QList<QCPAxis*>());
-  mAxes.insert(QCPAxis::atTop, QList<QCPAxis*>());
-  mAxes.insert(QCPAxis::atBottom, QList<QCPAxis*>());
-  
-  if (setupDefaultAxes)
-  {
-    QCPAxis *xAxis = addAxis(QCPAxis::atBottom);
-    QCPAxis *yAxis = addAxis(QCPAxis::atLeft);
-    QCPAxis *xAxis2 = addAxis(QCPAxis::atTop);
-    QCPAxis *yAxis2 = addAxis(QCPAxis::atRight);
-    setRangeDragAxes(xAxis, yAxis);
-    setRangeZoomAxes(xAxis, yAxis);
-    xAxis2->setVisible(false);
-    yAxis2->setVisible(false);
-    xAxis->grid()->setVisible(true);
-    yAxis->grid()->setVisible(true);
-    xAxis2->grid()->setVisible(false);
-    yAxis2->grid()->setVisible(false);
-    xAxis2->grid()->setZeroLinePen(Qt::NoPen);
-    yAxis2->grid()->setZeroLinePen(Qt::NoPen);
-    xAxis2->grid()->setVisible(false);
-    yAxis2->grid()->setVisible(false);
-  }
+  setLayer(QLatin1String("legend"));
+  setMargins(QMargins(0, 0, 0, 0));
 }
 
-QCPAxisRect::~QCPAxisRect()
-{
-  delete mInsetLayout;
-  mInsetLayout = 0;
+/*!
+  Sets the default font of this specific legend item to \a font.
   
-  QList<QCPAxis*> axesList = axes();
-  for (int i=0; i<axesList.size(); ++i)
-    removeAxis(axesList.at(i));
+  \see setTextColor, QCPLegend::setFont
+*/
+void QCPAbstractLegendItem::setFont(const QFont &font)
+{
+  mFont = font;
 }
 
 /*!
-  Returns the number of axes on the axis rect side specified with \a type.
+  Sets the default text color of this specific legend item to \a color.
   
-  \see axis
+  \see setFont, QCPLegend::setTextColor
 */
-int QCPAxisRect::axisCount(QCPAxis::AxisType type) const
+void QCPAbstractLegendItem::setTextColor(const QColor &color)
 {
-  return mAxes.value(type).size();
+  mTextColor = color;
 }
 
 /*!
-  Returns the axis with the given \a index on the axis rect side specified with \a type.
+  When this legend item is selected, \a font is used to draw generic text, instead of the normal
+  font set with \ref setFont.
   
-  \see axisCount, axes
+  \see setFont, QCPLegend::setSelectedFont
 */
-QCPAxis *QCPAxisRect::axis(QCPAxis::AxisType type, int index) const
+void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 {
-  QList<QCPAxis*> ax(mAxes.value(type));
-  if (index >= 0 && index < ax.size())
-  {
-    return ax.at(index);
-  } else
-  {
-    qDebug() << Q_FUNC_INFO << "Axis index out of bounds:" << index;
-    return 0;
-  }
+  mSelectedFont = font;
 }
 
 /*!
-  Returns all axes on the axis rect sides specified with \a types.
-  
-  \a types may be a single \ref QCPAxis::AxisType or an <tt>or</tt>-combination, to get the axes of
-  multiple sides.
+  When this legend item is selected, \a color is used to draw generic text, instead of the normal
+  color set with \ref setTextColor.
   
-  \see axis
+  \see setTextColor, QCPLegend::setSelectedTextColor
 */
-QList<QCPAxis*> QCPAxisRect::axes(QCPAxis::AxisTypes types) const
+void QCPAbstractLegendItem::setSelectedTextColor(const QColor &color)
 {
-  QList<QCPAxis*> result;
-  if (types.testFlag(QCPAxis::atLeft))
-    result << mAxes.value(QCPAxis::atLeft);
-  if (types.testFlag(QCPAxis::atRight))
-    result << mAxes.value(QCPAxis::atRight);
-  if (types.testFlag(QCPAxis::atTop))
-    result << mAxes.value(QCPAxis::atTop);
-  if (types.testFlag(QCPAxis::atBottom))
-    result << mAxes.value(QCPAxis::atBottom);
-  return result;
+  mSelectedTextColor = color;
 }
 
-/*! \overload
+/*!
+  Sets whether this specific legend item is selectable.
   
-  Returns all axes of this axis rect.
+  \see setSelectedParts, QCustomPlot::setInteractions
 */
-QList<QCPAxis*> QCPAxisRect::axes() const
+void QCPAbstractLegendItem::setSelectable(bool selectable)
 {
-  QList<QCPAxis*> result;
-  QHashIterator<QCPAxis::AxisType, QList<QCPAxis*> > it(mAxes);
-  while (it.hasNext())
+  if (mSelectable != selectable)
   {
-    it.next();
-    result << it.value();
+    mSelectable = selectable;
+    emit selectableChanged(mSelectable);
   }
-  return result;
 }
 
 /*!
-  Adds a new axis to the axis rect side specified with \a type, and returns it. If \a axis is 0, a
-  new QCPAxis instance is created internally. QCustomPlot owns the returned axis, so if you want to
-  remove an axis, use \ref removeAxis instead of deleting it manually.
+  Sets whether this specific legend item is selected.
+  
+  It is possible to set the selection state of this item by calling this function directly, even if
+  setSelectable is set to false.
+  
+  \see setSelectableParts, QCustomPlot::setInteractions
+*/
+void QCPAbstractLegendItem::setSelected(bool selected)
+{
+  if (mSelected != selected)
+  {
+    mSelected = selected;
+    emit selectionChanged(mSelected);
+  }
+}
 
-  You may inject QCPAxis instances (or sublasses of QCPAxis) by setting \a axis to an axis that was
-  previously created outside QCustomPlot. It is important to note that QCustomPlot takes ownership
-  of the axis, so you may not delete it afterwards. Further, the \a axis must have been created
-  with this axis rect as parent and with the same axis type as specified in \a type. If this is not
-  the case, a debug output is generated, the axis is not added, and the method returns 0.
+/* inherits documentation from base class */
+double QCPAbstractLegendItem::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  Q_UNUSED(details)
+  if (!mParentPlot) return -1;
+  if (onlySelectable && (!mSelectable || !mParentLegend->selectableParts().testFlag(QCPLegend::spItems)))
+    return -1;
+  
+  if (mRect.contains(pos.toPoint()))
+    return mParentPlot->selectionTolerance()*0.99;
+  else
+    return -1;
+}
 
-  This method can not be used to move \a axis between axis rects. The same \a axis instance must
-  not be added multiple times to the same or different axis rects.
+/* inherits documentation from base class */
+void QCPAbstractLegendItem::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+  applyAntialiasingHint(painter, mAntialiased, QCP::aeLegendItems);
+}
 
-  If an axis rect side already contains one or more axes, the lower and upper endings of the new
-  axis (\ref QCPAxis::setLowerEnding, \ref QCPAxis::setUpperEnding) are set to \ref
-  QCPLineEnding::esHalfBar.
+/* inherits documentation from base class */
+QRect QCPAbstractLegendItem::clipRect() const
+{
+  return mOuterRect;
+}
 
-  \see addAxes, setupFullAxesBox
-*/
-QCPAxis *QCPAxisRect::addAxis(QCPAxis::AxisType type, QCPAxis *axis)
+/* inherits documentation from base class */
+void QCPAbstractLegendItem::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
 {
-  QCPAxis *newAxis = axis;
-  if (!newAxis)
-  {
-    newAxis = new QCPAxis(this, type);
-  } else // user provided existing axis instance, do some sanity checks
-  {
-    if (newAxis->axisType() != type)
-    {
-      qDebug() << Q_FUNC_INFO << "passed axis has different axis type than specified in type parameter";
-      return 0;
-    }
-    if (newAxis->axisRect() != this)
-    {
-      qDebug() << Q_FUNC_INFO << "passed axis doesn't have this axis rect as parent axis rect";
-      return 0;
-    }
-    if (axes().contains(newAxis))
-    {
-      qDebug() << Q_FUNC_INFO << "passed axis is already owned by this axis rect";
-      return 0;
-    }
-  }
-  if (mAxes[type].size() > 0) // multiple axes on one side, add half-bar axis ending to additional axes with offset
+  Q_UNUSED(event)
+  Q_UNUSED(details)
+  if (mSelectable && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
   {
-    bool invert = (type == QCPAxis::atRight) || (type == QCPAxis::atBottom);
-    newAxis->setLowerEnding(QCPLineEnding(QCPLineEnding::esHalfBar, 6, 10, !invert));
-    newAxis->setUpperEnding(QCPLineEnding(QCPLineEnding::esHalfBar, 6, 10, invert));
+    bool selBefore = mSelected;
+    setSelected(additive ? !mSelected : true);
+    if (selectionStateChanged)
+      *selectionStateChanged = mSelected != selBefore;
   }
-  mAxes[type].append(newAxis);
-  
-  // reset convenience axis pointers on parent QCustomPlot if they are unset:
-  if (mParentPlot && mParentPlot->axisRectCount() > 0 && mParentPlot->axisRect(0) == this)
+}
+
+/* inherits documentation from base class */
+void QCPAbstractLegendItem::deselectEvent(bool *selectionStateChanged)
+{
+  if (mSelectable && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
   {
-    switch (type)
-    {
-      case QCPAxis::atBottom: { if (!mParentPlot->xAxis) mParentPlot->xAxis = newAxis; break; }
-      case QCPAxis::atLeft: { if (!mParentPlot->yAxis) mParentPlot->yAxis = newAxis; break; }
-      case QCPAxis::atTop: { if (!mParentPlot->xAxis2) mParentPlot->xAxis2 = newAxis; break; }
-      case QCPAxis::atRight: { if (!mParentPlot->yAxis2) mParentPlot->yAxis2 = newAxis; break; }
-    }
+    bool selBefore = mSelected;
+    setSelected(false);
+    if (selectionStateChanged)
+      *selectionStateChanged = mSelected != selBefore;
   }
-  
-  return newAxis;
 }
 
-/*!
-  Adds a new axis with \ref addAxis to each axis rect side specified in \a types. This may be an
-  <tt>or</tt>-combination of QCPAxis::AxisType, so axes can be added to multiple sides at once.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPlottableLegendItem
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPlottableLegendItem
+  \brief A legend item representing a plottable with an icon and the plottable name.
   
-  Returns a list of the added axes.
+  This is the standard legend item for plottables. It displays an icon of the plottable next to the
+  plottable name. The icon is drawn by the respective plottable itself (\ref
+  QCPAbstractPlottable::drawLegendIcon), and tries to give an intuitive symbol for the plottable.
+  For example, the QCPGraph draws a centered horizontal line and/or a single scatter point in the
+  middle.
   
-  \see addAxis, setupFullAxesBox
+  Legend items of this type are always associated with one plottable (retrievable via the
+  plottable() function and settable with the constructor). You may change the font of the plottable
+  name with \ref setFont. Icon padding and border pen is taken from the parent QCPLegend, see \ref
+  QCPLegend::setIconBorderPen and \ref QCPLegend::setIconTextPadding.
+
+  The function \ref QCPAbstractPlottable::addToLegend/\ref QCPAbstractPlottable::removeFromLegend
+  creates/removes legend items of this type in the default implementation. However, these functions
+  may be reimplemented such that a different kind of legend item (e.g a direct subclass of
+  QCPAbstractLegendItem) is used for that plottable.
+  
+  Since QCPLegend is based on QCPLayoutGrid, a legend item itself is just a subclass of
+  QCPLayoutElement. While it could be added to a legend (or any other layout) via the normal layout
+  interface, QCPLegend has specialized functions for handling legend items conveniently, see the
+  documentation of \ref QCPLegend.
 */
-QList<QCPAxis*> QCPAxisRect::addAxes(QCPAxis::AxisTypes types)
-{
-  QList<QCPAxis*> result;
-  if (types.testFlag(QCPAxis::atLeft))
-    result << addAxis(QCPAxis::atLeft);
-  if (types.testFlag(QCPAxis::atRight))
-    result << addAxis(QCPAxis::atRight);
-  if (types.testFlag(QCPAxis::atTop))
-    result << addAxis(QCPAxis::atTop);
-  if (types.testFlag(QCPAxis::atBottom))
-    result << addAxis(QCPAxis::atBottom);
-  return result;
-}
 
 /*!
-  Removes the specified \a axis from the axis rect and deletes it.
+  Creates a new legend item associated with \a plottable.
   
-  Returns true on success, i.e. if \a axis was a valid axis in this axis rect.
+  Once it's created, it can be added to the legend via \ref QCPLegend::addItem.
   
-  \see addAxis
+  A more convenient way of adding/removing a plottable to/from the legend is via the functions \ref
+  QCPAbstractPlottable::addToLegend and \ref QCPAbstractPlottable::removeFromLegend.
 */
-bool QCPAxisRect::removeAxis(QCPAxis *axis)
+QCPPlottableLegendItem::QCPPlottableLegendItem(QCPLegend *parent, QCPAbstractPlottable *plottable) :
+  QCPAbstractLegendItem(parent),
+  mPlottable(plottable)
 {
-  // don't access axis->axisType() to provide safety when axis is an invalid pointer, rather go through all axis containers:
-  QHashIterator<QCPAxis::AxisType, QList<QCPAxis*> > it(mAxes);
-  while (it.hasNext())
-  {
-    it.next();
-    if (it.value().contains(axis))
-    {
-      mAxes[it.key()].removeOne(axis);
-      if (qobject_cast<QCustomPlot*>(parentPlot())) // make sure this isn't called from QObject dtor when QCustomPlot is already destructed (happens when the axis rect is not in any layout and thus QObject-child of QCustomPlot)
-        parentPlot()->axisRemoved(axis);
-      delete axis;
-      return true;
-    }
-  }
-  qDebug() << Q_FUNC_INFO << "Axis isn't in axis rect:" << reinterpret_cast<quintptr>(axis);
-  return false;
+  setAntialiased(false);
 }
 
-/*!
-  Zooms in (or out) to the passed rectangular region \a pixelRect, given in pixel coordinates.
-
-  All axes of this axis rect will have their range zoomed accordingly. If you only wish to zoom
-  specific axes, use the overloaded version of this method.
+/*! \internal
   
-  \see QCustomPlot::setSelectionRectMode
+  Returns the pen that shall be used to draw the icon border, taking into account the selection
+  state of this item.
 */
-void QCPAxisRect::zoom(const QRectF &pixelRect)
+QPen QCPPlottableLegendItem::getIconBorderPen() const
 {
-  zoom(pixelRect, axes());
+  return mSelected ? mParentLegend->selectedIconBorderPen() : mParentLegend->iconBorderPen();
 }
 
-/*! \overload
+/*! \internal
   
-  Zooms in (or out) to the passed rectangular region \a pixelRect, given in pixel coordinates.
+  Returns the text color that shall be used to draw text, taking into account the selection state
+  of this item.
+*/
+QColor QCPPlottableLegendItem::getTextColor() const
+{
+  return mSelected ? mSelectedTextColor : mTextColor;
+}
+
+/*! \internal
   
-  Only the axes passed in \a affectedAxes will have their ranges zoomed accordingly.
+  Returns the font that shall be used to draw text, taking into account the selection state of this
+  item.
+*/
+QFont QCPPlottableLegendItem::getFont() const
+{
+  return mSelected ? mSelectedFont : mFont;
+}
+
+/*! \internal
   
-  \see QCustomPlot::setSelectionRectMode
+  Draws the item with \a painter. The size and position of the drawn legend item is defined by the
+  parent layout (typically a \ref QCPLegend) and the \ref minimumSizeHint and \ref maximumSizeHint
+  of this legend item.
 */
-void QCPAxisRect::zoom(const QRectF &pixelRect, const QList<QCPAxis*> &affectedAxes)
+void QCPPlottableLegendItem::draw(QCPPainter *painter)
 {
-  foreach (QCPAxis *axis, affectedAxes)
+  if (!mPlottable) return;
+  painter->setFont(getFont());
+  painter->setPen(QPen(getTextColor()));
+  QSizeF iconSize = mParentLegend->iconSize();
+  QRectF textRect = painter->fontMetrics().boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
+  QRectF iconRect(mRect.topLeft(), iconSize);
+  int textHeight = qMax(textRect.height(), iconSize.height());  // if text has smaller height than icon, center text vertically in icon height, else align tops
+  painter->drawText(mRect.x()+iconSize.width()+mParentLegend->iconTextPadding(), mRect.y(), textRect.width(), textHeight, Qt::TextDontClip, mPlottable->name());
+  // draw icon:
+  painter->save();
+  painter->setClipRect(iconRect, Qt::IntersectClip);
+  mPlottable->drawLegendIcon(painter, iconRect);
+  painter->restore();
+  // draw icon border:
+  if (getIconBorderPen().style() != Qt::NoPen)
   {
-    if (!axis)
-    {
-      qDebug() << Q_FUNC_INFO << "a passed axis was zero";
-      continue;
-    }
-    QCPRange pixelRange;
-    if (axis->orientation() == Qt::Horizontal)
-      pixelRange = QCPRange(pixelRect.left(), pixelRect.right());
-    else
-      pixelRange = QCPRange(pixelRect.top(), pixelRect.bottom());
-    axis->setRange(axis->pixelToCoord(pixelRange.lower), axis->pixelToCoord(pixelRange.upper));
+    painter->setPen(getIconBorderPen());
+    painter->setBrush(Qt::NoBrush);
+    int halfPen = qCeil(painter->pen().widthF()*0.5)+1;
+    painter->setClipRect(mOuterRect.adjusted(-halfPen, -halfPen, halfPen, halfPen)); // extend default clip rect so thicker pens (especially during selection) are not clipped
+    painter->drawRect(iconRect);
   }
 }
 
-/*!
-  Convenience function to create an axis on each side that doesn't have any axes yet and set their
-  visibility to true. Further, the top/right axes are assigned the following properties of the
-  bottom/left axes:
+/*! \internal
+  
+  Calculates and returns the size of this item. This includes the icon, the text and the padding in
+  between.
+  
+  \seebaseclassmethod
+*/
+QSize QCPPlottableLegendItem::minimumSizeHint() const
+{
+  if (!mPlottable) return QSize();
+  QSize result(0, 0);
+  QRect textRect;
+  QFontMetrics fontMetrics(getFont());
+  QSize iconSize = mParentLegend->iconSize();
+  textRect = fontMetrics.boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
+  result.setWidth(iconSize.width() + mParentLegend->iconTextPadding() + textRect.width() + mMargins.left() + mMargins.right());
+  result.setHeight(qMax(textRect.height(), iconSize.height()) + mMargins.top() + mMargins.bottom());
+  return result;
+}
 
-  \li range (\ref QCPAxis::setRange)
-  \li range reversed (\ref QCPAxis::setRangeReversed)
-  \li scale type (\ref QCPAxis::setScaleType)
-  \li tick visibility (\ref QCPAxis::setTicks)
-  \li number format (\ref QCPAxis::setNumberFormat)
-  \li number precision (\ref QCPAxis::setNumberPrecision)
-  \li tick count of ticker (\ref QCPAxisTicker::setTickCount)
-  \li tick origin of ticker (\ref QCPAxisTicker::setTickOrigin)
 
-  Tick label visibility (\ref QCPAxis::setTickLabels) of the right and top axes are set to false.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLegend
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  If \a connectRanges is true, the \ref QCPAxis::rangeChanged "rangeChanged" signals of the bottom
-  and left axes are connected to the \ref QCPAxis::setRange slots of the top and right axes.
+/*! \class QCPLegend
+  \brief Manages a legend inside a QCustomPlot.
+
+  A legend is a small box somewhere in the plot which lists plottables with their name and icon.
+
+  Normally, the legend is populated by calling \ref QCPAbstractPlottable::addToLegend. The
+  respective legend item can be removed with \ref QCPAbstractPlottable::removeFromLegend. However,
+  QCPLegend also offers an interface to add and manipulate legend items directly: \ref item, \ref
+  itemWithPlottable, \ref itemCount, \ref addItem, \ref removeItem, etc.
+
+  Since \ref QCPLegend derives from \ref QCPLayoutGrid, it can be placed in any position a \ref
+  QCPLayoutElement may be positioned. The legend items are themselves \ref QCPLayoutElement
+  "QCPLayoutElements" which are placed in the grid layout of the legend. \ref QCPLegend only adds
+  an interface specialized for handling child elements of type \ref QCPAbstractLegendItem, as
+  mentioned above. In principle, any other layout elements may also be added to a legend via the
+  normal \ref QCPLayoutGrid interface. See the special page about \link thelayoutsystem The Layout
+  System\endlink for examples on how to add other elements to the legend and move it outside the axis
+  rect.
+
+  Use the methods \ref setFillOrder and \ref setWrap inherited from \ref QCPLayoutGrid to control
+  in which order (column first or row first) the legend is filled up when calling \ref addItem, and
+  at which column or row wrapping occurs.
+
+  By default, every QCustomPlot has one legend (\ref QCustomPlot::legend) which is placed in the
+  inset layout of the main axis rect (\ref QCPAxisRect::insetLayout). To move the legend to another
+  position inside the axis rect, use the methods of the \ref QCPLayoutInset. To move the legend
+  outside of the axis rect, place it anywhere else with the \ref QCPLayout/\ref QCPLayoutElement
+  interface.
 */
-void QCPAxisRect::setupFullAxesBox(bool connectRanges)
-{
-  QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
-  if (axisCount(QCPAxis::atBottom) == 0)
-    xAxis = addAxis(QCPAxis::atBottom);
-  else
-    xAxis = axis(QCPAxis::atBottom);
-  
-  if (axisCount(QCPAxis::atLeft) == 0)
-    yAxis = addAxis(QCPAxis::atLeft);
-  else
-    yAxis = axis(QCPAxis::atLeft);
-  
-  if (axisCount(QCPAxis::atTop) == 0)
-    xAxis2 = addAxis(QCPAxis::atTop);
-  else
-    xAxis2 = axis(QCPAxis::atTop);
+
+/* start of documentation of signals */
+
+/*! \fn void QCPLegend::selectionChanged(QCPLegend::SelectableParts selection);
+
+  This signal is emitted when the selection state of this legend has changed.
   
-  if (axisCount(QCPAxis::atRight) == 0)
-    yAxis2 = addAxis(QCPAxis::atRight);
-  else
-    yAxis2 = axis(QCPAxis::atRight);
+  \see setSelectedParts, setSelectableParts
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Constructs a new QCPLegend instance with default values.
   
-  xAxis->setVisible(true);
-  yAxis->setVisible(true);
-  xAxis2->setVisible(true);
-  yAxis2->setVisible(true);
-  xAxis2->setTickLabels(false);
-  yAxis2->setTickLabels(false);
+  Note that by default, QCustomPlot already contains a legend ready to be used as \ref
+  QCustomPlot::legend
+*/
+QCPLegend::QCPLegend()
+{
+  setFillOrder(QCPLayoutGrid::foRowsFirst);
+  setWrap(0);
   
-  xAxis2->setRange(xAxis->range());
-  xAxis2->setRangeReversed(xAxis->rangeReversed());
-  xAxis2->setScaleType(xAxis->scaleType());
-  xAxis2->setTicks(xAxis->ticks());
-  xAxis2->setNumberFormat(xAxis->numberFormat());
-  xAxis2->setNumberPrecision(xAxis->numberPrecision());
-  xAxis2->ticker()->setTickCount(xAxis->ticker()->tickCount());
-  xAxis2->ticker()->setTickOrigin(xAxis->ticker()->tickOrigin());
+  setRowSpacing(3);
+  setColumnSpacing(8);
+  setMargins(QMargins(7, 5, 7, 4));
+  setAntialiased(false);
+  setIconSize(32, 18);
   
-  yAxis2->setRange(yAxis->range());
-  yAxis2->setRangeReversed(yAxis->rangeReversed());
-  yAxis2->setScaleType(yAxis->scaleType());
-  yAxis2->setTicks(yAxis->ticks());
-  yAxis2->setNumberFormat(yAxis->numberFormat());
-  yAxis2->setNumberPrecision(yAxis->numberPrecision());
-  yAxis2->ticker()->setTickCount(yAxis->ticker()->tickCount());
-  yAxis2->ticker()->setTickOrigin(yAxis->ticker()->tickOrigin());
+  setIconTextPadding(7);
   
-  if (connectRanges)
+  setSelectableParts(spLegendBox | spItems);
+  setSelectedParts(spNone);
+  
+  setBorderPen(QPen(Qt::black, 0));
+  setSelectedBorderPen(QPen(Qt::blue, 2));
+  setIconBorderPen(Qt::NoPen);
+  setSelectedIconBorderPen(QPen(Qt::blue, 2));
+  setBrush(Qt::white);
+  setSelectedBrush(Qt::white);
+  setTextColor(Qt::black);
+  setSelectedTextColor(Qt::blue);
+}
+
+QCPLegend::~QCPLegend()
+{
+  clearItems();
+  if (qobject_cast<QCustomPlot*>(mParentPlot)) // make sure this isn't called from QObject dtor when QCustomPlot is already destructed (happens when the legend is not in any layout and thus QObject-child of QCustomPlot)
+    mParentPlot->legendRemoved(this);
+}
+
+/* no doc for getter, see setSelectedParts */
+QCPLegend::SelectableParts QCPLegend::selectedParts() const
+{
+  // check whether any legend elements selected, if yes, add spItems to return value
+  bool hasSelectedItems = false;
+  for (int i=0; i<itemCount(); ++i)
   {
-    connect(xAxis, SIGNAL(rangeChanged(QCPRange)), xAxis2, SLOT(setRange(QCPRange)));
-    connect(yAxis, SIGNAL(rangeChanged(QCPRange)), yAxis2, SLOT(setRange(QCPRange)));
+    if (item(i) && item(i)->selected())
+    {
+      hasSelectedItems = true;
+      break;
+    }
   }
+  if (hasSelectedItems)
+    return mSelectedParts | spItems;
+  else
+    return mSelectedParts & ~spItems;
 }
 
 /*!
-  Returns a list of all the plottables that are associated with this axis rect.
-  
-  A plottable is considered associated with an axis rect if its key or value axis (or both) is in
-  this axis rect.
-  
-  \see graphs, items
+  Sets the pen, the border of the entire legend is drawn with.
 */
-QList<QCPAbstractPlottable*> QCPAxisRect::plottables() const
+void QCPLegend::setBorderPen(const QPen &pen)
 {
-  // Note: don't append all QCPAxis::plottables() into a list, because we might get duplicate entries
-  QList<QCPAbstractPlottable*> result;
-  for (int i=0; i<mParentPlot->mPlottables.size(); ++i)
-  {
-    if (mParentPlot->mPlottables.at(i)->keyAxis()->axisRect() == this || mParentPlot->mPlottables.at(i)->valueAxis()->axisRect() == this)
-      result.append(mParentPlot->mPlottables.at(i));
-  }
-  return result;
+  mBorderPen = pen;
 }
 
 /*!
-  Returns a list of all the graphs that are associated with this axis rect.
-  
-  A graph is considered associated with an axis rect if its key or value axis (or both) is in
-  this axis rect.
-  
-  \see plottables, items
+  Sets the brush of the legend background.
 */
-QList<QCPGraph*> QCPAxisRect::graphs() const
+void QCPLegend::setBrush(const QBrush &brush)
 {
-  // Note: don't append all QCPAxis::graphs() into a list, because we might get duplicate entries
-  QList<QCPGraph*> result;
-  for (int i=0; i<mParentPlot->mGraphs.size(); ++i)
-  {
-    if (mParentPlot->mGraphs.at(i)->keyAxis()->axisRect() == this || mParentPlot->mGraphs.at(i)->valueAxis()->axisRect() == this)
-      result.append(mParentPlot->mGraphs.at(i));
-  }
-  return result;
+  mBrush = brush;
 }
 
 /*!
-  Returns a list of all the items that are associated with this axis rect.
+  Sets the default font of legend text. Legend items that draw text (e.g. the name of a graph) will
+  use this font by default. However, a different font can be specified on a per-item-basis by
+  accessing the specific legend item.
   
-  An item is considered associated with an axis rect if any of its positions has key or value axis
-  set to an axis that is in this axis rect, or if any of its positions has \ref
-  QCPItemPosition::setAxisRect set to the axis rect, or if the clip axis rect (\ref
-  QCPAbstractItem::setClipAxisRect) is set to this axis rect.
+  This function will also set \a font on all already existing legend items.
   
-  \see plottables, graphs
+  \see QCPAbstractLegendItem::setFont
 */
-QList<QCPAbstractItem *> QCPAxisRect::items() const
+void QCPLegend::setFont(const QFont &font)
 {
-  // Note: don't just append all QCPAxis::items() into a list, because we might get duplicate entries
-  //       and miss those items that have this axis rect as clipAxisRect.
-  QList<QCPAbstractItem*> result;
-  for (int itemId=0; itemId<mParentPlot->mItems.size(); ++itemId)
+  mFont = font;
+  for (int i=0; i<itemCount(); ++i)
   {
-    if (mParentPlot->mItems.at(itemId)->clipAxisRect() == this)
-    {
-      result.append(mParentPlot->mItems.at(itemId));
-      continue;
-    }
-    QList<QCPItemPosition*> positions = mParentPlot->mItems.at(itemId)->positions();
-    for (int posId=0; posId<positions.size(); ++posId)
-    {
-      if (positions.at(posId)->axisRect() == this ||
-          positions.at(posId)->keyAxis()->axisRect() == this ||
-          positions.at(posId)->valueAxis()->axisRect() == this)
-      {
-        result.append(mParentPlot->mItems.at(itemId));
-        break;
-      }
-    }
+    if (item(i))
+      item(i)->setFont(mFont);
   }
-  return result;
 }
 
 /*!
-  This method is called automatically upon replot and doesn't need to be called by users of
-  QCPAxisRect.
+  Sets the default color of legend text. Legend items that draw text (e.g. the name of a graph)
+  will use this color by default. However, a different colors can be specified on a per-item-basis
+  by accessing the specific legend item.
   
-  Calls the base class implementation to update the margins (see \ref QCPLayoutElement::update),
-  and finally passes the \ref rect to the inset layout (\ref insetLayout) and calls its
-  QCPInsetLayout::update function.
+  This function will also set \a color on all already existing legend items.
   
-  \seebaseclassmethod
+  \see QCPAbstractLegendItem::setTextColor
 */
-void QCPAxisRect::update(UpdatePhase phase)
-{
-  QCPLayoutElement::update(phase);
-  
-  switch (phase)
-  {
-    case upPreparation:
-    {
-      QList<QCPAxis*> allAxes = axes();
-      for (int i=0; i<allAxes.size(); ++i)
-        allAxes.at(i)->setupTickVectors();
-      break;
-    }
-    case upLayout:
-    {
-      mInsetLayout->setOuterRect(rect());
-      break;
-    }
-    default: break;
-  }
-  
-  // pass update call on to inset layout (doesn't happen automatically, because QCPAxisRect doesn't derive from QCPLayout):
-  mInsetLayout->update(phase);
-}
-
-/* inherits documentation from base class */
-QList<QCPLayoutElement*> QCPAxisRect::elements(bool recursive) const
+void QCPLegend::setTextColor(const QColor &color)
 {
-  QList<QCPLayoutElement*> result;
-  if (mInsetLayout)
+  mTextColor = color;
+  for (int i=0; i<itemCount(); ++i)
   {
-    result << mInsetLayout;
-    if (recursive)
-      result << mInsetLayout->elements(recursive);
+    if (item(i))
+      item(i)->setTextColor(color);
   }
-  return result;
-}
-
-/* inherits documentation from base class */
-void QCPAxisRect::applyDefaultAntialiasingHint(QCPPainter *painter) const
-{
-  painter->setAntialiasing(false);
-}
-
-/* inherits documentation from base class */
-void QCPAxisRect::draw(QCPPainter *painter)
-{
-  drawBackground(painter);
 }
 
 /*!
-  Sets \a pm as the axis background pixmap. The axis background pixmap will be drawn inside the
-  axis rect. Since axis rects place themselves on the "background" layer by default, the axis rect
-  backgrounds are usually drawn below everything else.
-
-  For cases where the provided pixmap doesn't have the same size as the axis rect, scaling can be
-  enabled with \ref setBackgroundScaled and the scaling mode (i.e. whether and how the aspect ratio
-  is preserved) can be set with \ref setBackgroundScaledMode. To set all these options in one call,
-  consider using the overloaded version of this function.
-
-  Below the pixmap, the axis rect may be optionally filled with a brush, if specified with \ref
-  setBackground(const QBrush &brush).
-  
-  \see setBackgroundScaled, setBackgroundScaledMode, setBackground(const QBrush &brush)
+  Sets the size of legend icons. Legend items that draw an icon (e.g. a visual
+  representation of the graph) will use this size by default.
 */
-void QCPAxisRect::setBackground(const QPixmap &pm)
+void QCPLegend::setIconSize(const QSize &size)
 {
-  mBackgroundPixmap = pm;
-  mScaledBackgroundPixmap = QPixmap();
+  mIconSize = size;
 }
 
 /*! \overload
-  
-  Sets \a brush as the background brush. The axis rect background will be filled with this brush.
-  Since axis rects place themselves on the "background" layer by default, the axis rect backgrounds
-  are usually drawn below everything else.
-
-  The brush will be drawn before (under) any background pixmap, which may be specified with \ref
-  setBackground(const QPixmap &pm).
+*/
+void QCPLegend::setIconSize(int width, int height)
+{
+  mIconSize.setWidth(width);
+  mIconSize.setHeight(height);
+}
 
-  To disable drawing of a background brush, set \a brush to Qt::NoBrush.
-  
-  \see setBackground(const QPixmap &pm)
+/*!
+  Sets the horizontal space in pixels between the legend icon and the text next to it.
+  Legend items that draw an icon (e.g. a visual representation of the graph) and text (e.g. the
+  name of the graph) will use this space by default.
 */
-void QCPAxisRect::setBackground(const QBrush &brush)
+void QCPLegend::setIconTextPadding(int padding)
 {
-  mBackgroundBrush = brush;
+  mIconTextPadding = padding;
 }
 
-/*! \overload
+/*!
+  Sets the pen used to draw a border around each legend icon. Legend items that draw an
+  icon (e.g. a visual representation of the graph) will use this pen by default.
   
-  Allows setting the background pixmap of the axis rect, whether it shall be scaled and how it
-  shall be scaled in one call.
-
-  \see setBackground(const QPixmap &pm), setBackgroundScaled, setBackgroundScaledMode
+  If no border is wanted, set this to \a Qt::NoPen.
 */
-void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioMode mode)
+void QCPLegend::setIconBorderPen(const QPen &pen)
 {
-  mBackgroundPixmap = pm;
-  mScaledBackgroundPixmap = QPixmap();
-  mBackgroundScaled = scaled;
-  mBackgroundScaledMode = mode;
+  mIconBorderPen = pen;
 }
 
 /*!
-  Sets whether the axis background pixmap shall be scaled to fit the axis rect or not. If \a scaled
-  is set to true, you may control whether and how the aspect ratio of the original pixmap is
-  preserved with \ref setBackgroundScaledMode.
+  Sets whether the user can (de-)select the parts in \a selectable by clicking on the QCustomPlot surface.
+  (When \ref QCustomPlot::setInteractions contains \ref QCP::iSelectLegend.)
   
-  Note that the scaled version of the original pixmap is buffered, so there is no performance
-  penalty on replots. (Except when the axis rect dimensions are changed continuously.)
+  However, even when \a selectable is set to a value not allowing the selection of a specific part,
+  it is still possible to set the selection of this part manually, by calling \ref setSelectedParts
+  directly.
   
-  \see setBackground, setBackgroundScaledMode
+  \see SelectablePart, setSelectedParts
 */
-void QCPAxisRect::setBackgroundScaled(bool scaled)
+void QCPLegend::setSelectableParts(const SelectableParts &selectable)
 {
-  mBackgroundScaled = scaled;
+  if (mSelectableParts != selectable)
+  {
+    mSelectableParts = selectable;
+    emit selectableChanged(mSelectableParts);
+  }
 }
 
 /*!
-  If scaling of the axis background pixmap is enabled (\ref setBackgroundScaled), use this function to
-  define whether and how the aspect ratio of the original pixmap passed to \ref setBackground is preserved.
-  \see setBackground, setBackgroundScaled
+  Sets the selected state of the respective legend parts described by \ref SelectablePart. When a part
+  is selected, it uses a different pen/font and brush. If some legend items are selected and \a selected
+  doesn't contain \ref spItems, those items become deselected.
+  
+  The entire selection mechanism is handled automatically when \ref QCustomPlot::setInteractions
+  contains iSelectLegend. You only need to call this function when you wish to change the selection
+  state manually.
+  
+  This function can change the selection state of a part even when \ref setSelectableParts was set to a
+  value that actually excludes the part.
+  
+  emits the \ref selectionChanged signal when \a selected is different from the previous selection state.
+  
+  Note that it doesn't make sense to set the selected state \ref spItems here when it wasn't set
+  before, because there's no way to specify which exact items to newly select. Do this by calling
+  \ref QCPAbstractLegendItem::setSelected directly on the legend item you wish to select.
+  
+  \see SelectablePart, setSelectableParts, selectTest, setSelectedBorderPen, setSelectedIconBorderPen, setSelectedBrush,
+  setSelectedFont
 */
-void QCPAxisRect::setBackgroundScaledMode(Qt::AspectRatioMode mode)
+void QCPLegend::setSelectedParts(const SelectableParts &selected)
 {
-  mBackgroundScaledMode = mode;
+  SelectableParts newSelected = selected;
+  mSelectedParts = this->selectedParts(); // update mSelectedParts in case item selection changed
+
+  if (mSelectedParts != newSelected)
+  {
+    if (!mSelectedParts.testFlag(spItems) && newSelected.testFlag(spItems)) // attempt to set spItems flag (can't do that)
+    {
+      qDebug() << Q_FUNC_INFO << "spItems flag can not be set, it can only be unset with this function";
+      newSelected &= ~spItems;
+    }
+    if (mSelectedParts.testFlag(spItems) && !newSelected.testFlag(spItems)) // spItems flag was unset, so clear item selection
+    {
+      for (int i=0; i<itemCount(); ++i)
+      {
+        if (item(i))
+          item(i)->setSelected(false);
+      }
+    }
+    mSelectedParts = newSelected;
+    emit selectionChanged(mSelectedParts);
+  }
 }
 
 /*!
-  Returns the range drag axis of the \a orientation provided. If multiple axes were set, returns
-  the first one (use \ref rangeDragAxes to retrieve a list with all set axes).
+  When the legend box is selected, this pen is used to draw the border instead of the normal pen
+  set via \ref setBorderPen.
 
-  \see setRangeDragAxes
+  \see setSelectedParts, setSelectableParts, setSelectedBrush
 */
-QCPAxis *QCPAxisRect::rangeDragAxis(Qt::Orientation orientation)
+void QCPLegend::setSelectedBorderPen(const QPen &pen)
 {
-  if (orientation == Qt::Horizontal)
-    return mRangeDragHorzAxis.isEmpty() ? 0 : mRangeDragHorzAxis.first().data();
-  else
-    return mRangeDragVertAxis.isEmpty() ? 0 : mRangeDragVertAxis.first().data();
+  mSelectedBorderPen = pen;
 }
 
 /*!
-  Returns the range zoom axis of the \a orientation provided. If multiple axes were set, returns
-  the first one (use \ref rangeZoomAxes to retrieve a list with all set axes).
+  Sets the pen legend items will use to draw their icon borders, when they are selected.
 
-  \see setRangeZoomAxes
+  \see setSelectedParts, setSelectableParts, setSelectedFont
 */
-QCPAxis *QCPAxisRect::rangeZoomAxis(Qt::Orientation orientation)
+void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 {
-  if (orientation == Qt::Horizontal)
-    return mRangeZoomHorzAxis.isEmpty() ? 0 : mRangeZoomHorzAxis.first().data();
-  else
-    return mRangeZoomVertAxis.isEmpty() ? 0 : mRangeZoomVertAxis.first().data();
+  mSelectedIconBorderPen = pen;
 }
 
 /*!
-  Returns all range drag axes of the \a orientation provided.
+  When the legend box is selected, this brush is used to draw the legend background instead of the normal brush
+  set via \ref setBrush.
 
-  \see rangeZoomAxis, setRangeZoomAxes
+  \see setSelectedParts, setSelectableParts, setSelectedBorderPen
 */
-QList<QCPAxis*> QCPAxisRect::rangeDragAxes(Qt::Orientation orientation)
+void QCPLegend::setSelectedBrush(const QBrush &brush)
 {
-  QList<QCPAxis*> result;
-  if (orientation == Qt::Horizontal)
-  {
-    for (int i=0; i<mRangeDragHorzAxis.size(); ++i)
-    {
-      if (!mRangeDragHorzAxis.at(i).isNull())
-        result.append(mRangeDragHorzAxis.at(i).data());
-    }
-  } else
-  {
-    for (int i=0; i<mRangeDragVertAxis.size(); ++i)
-    {
-      if (!mRangeDragVertAxis.at(i).isNull())
-        result.append(mRangeDragVertAxis.at(i).data());
-    }
-  }
-  return result;
+  mSelectedBrush = brush;
 }
 
 /*!
-  Returns all range zoom axes of the \a orientation provided.
+  Sets the default font that is used by legend items when they are selected.
+  
+  This function will also set \a font on all already existing legend items.
 
-  \see rangeDragAxis, setRangeDragAxes
+  \see setFont, QCPAbstractLegendItem::setSelectedFont
 */
-QList<QCPAxis*> QCPAxisRect::rangeZoomAxes(Qt::Orientation orientation)
+void QCPLegend::setSelectedFont(const QFont &font)
 {
-  QList<QCPAxis*> result;
-  if (orientation == Qt::Horizontal)
-  {
-    for (int i=0; i<mRangeZoomHorzAxis.size(); ++i)
-    {
-      if (!mRangeZoomHorzAxis.at(i).isNull())
-        result.append(mRangeZoomHorzAxis.at(i).data());
-    }
-  } else
+  mSelectedFont = font;
+  for (int i=0; i<itemCount(); ++i)
   {
-    for (int i=0; i<mRangeZoomVertAxis.size(); ++i)
-    {
-      if (!mRangeZoomVertAxis.at(i).isNull())
-        result.append(mRangeZoomVertAxis.at(i).data());
-    }
+    if (item(i))
+      item(i)->setSelectedFont(font);
   }
-  return result;
 }
 
 /*!
-  Returns the range zoom factor of the \a orientation provided.
+  Sets the default text color that is used by legend items when they are selected.
   
-  \see setRangeZoomFactor
-*/
-double QCPAxisRect::rangeZoomFactor(Qt::Orientation orientation)
-{
-  return (orientation == Qt::Horizontal ? mRangeZoomFactorHorz : mRangeZoomFactorVert);
-}
+  This function will also set \a color on all already existing legend items.
 
-/*!
-  Sets which axis orientation may be range dragged by the user with mouse interaction.
-  What orientation corresponds to which specific axis can be set with
-  \ref setRangeDragAxes(QCPAxis *horizontal, QCPAxis *vertical). By
-  default, the horizontal axis is the bottom axis (xAxis) and the vertical axis
-  is the left axis (yAxis).
-  
-  To disable range dragging entirely, pass 0 as \a orientations or remove \ref QCP::iRangeDrag from \ref
-  QCustomPlot::setInteractions. To enable range dragging for both directions, pass <tt>Qt::Horizontal |
-  Qt::Vertical</tt> as \a orientations.
-  
-  In addition to setting \a orientations to a non-zero value, make sure \ref QCustomPlot::setInteractions
-  contains \ref QCP::iRangeDrag to enable the range dragging interaction.
-  
-  \see setRangeZoom, setRangeDragAxes, QCustomPlot::setNoAntialiasingOnDrag
+  \see setTextColor, QCPAbstractLegendItem::setSelectedTextColor
 */
-void QCPAxisRect::setRangeDrag(Qt::Orientations orientations)
+void QCPLegend::setSelectedTextColor(const QColor &color)
 {
-  mRangeDrag = orientations;
+  mSelectedTextColor = color;
+  for (int i=0; i<itemCount(); ++i)
+  {
+    if (item(i))
+      item(i)->setSelectedTextColor(color);
+  }
 }
 
 /*!
-  Sets which axis orientation may be zoomed by the user with the mouse wheel. What orientation
-  corresponds to which specific axis can be set with \ref setRangeZoomAxes(QCPAxis *horizontal,
-  QCPAxis *vertical). By default, the horizontal axis is the bottom axis (xAxis) and the vertical
-  axis is the left axis (yAxis).
+  Returns the item with index \a i.
 
-  To disable range zooming entirely, pass 0 as \a orientations or remove \ref QCP::iRangeZoom from \ref
-  QCustomPlot::setInteractions. To enable range zooming for both directions, pass <tt>Qt::Horizontal |
-  Qt::Vertical</tt> as \a orientations.
-  
-  In addition to setting \a orientations to a non-zero value, make sure \ref QCustomPlot::setInteractions
-  contains \ref QCP::iRangeZoom to enable the range zooming interaction.
-  
-  \see setRangeZoomFactor, setRangeZoomAxes, setRangeDrag
+  Note that the linear index depends on the current fill order (\ref setFillOrder).
+
+  \see itemCount, addItem, itemWithPlottable
 */
-void QCPAxisRect::setRangeZoom(Qt::Orientations orientations)
+QCPAbstractLegendItem *QCPLegend::item(int index) const
 {
-  mRangeZoom = orientations;
+  return qobject_cast<QCPAbstractLegendItem*>(elementAt(index));
 }
 
-/*! \overload
+/*!
+  Returns the QCPPlottableLegendItem which is associated with \a plottable (e.g. a \ref QCPGraph*).
+  If such an item isn't in the legend, returns 0.
   
-  Sets the axes whose range will be dragged when \ref setRangeDrag enables mouse range dragging on
-  the QCustomPlot widget. Pass 0 if no axis shall be dragged in the respective orientation.
-
-  Use the overload taking a list of axes, if multiple axes (more than one per orientation) shall
-  react to dragging interactions.
-
-  \see setRangeZoomAxes
+  \see hasItemWithPlottable
 */
-void QCPAxisRect::setRangeDragAxes(QCPAxis *horizontal, QCPAxis *vertical)
+QCPPlottableLegendItem *QCPLegend::itemWithPlottable(const QCPAbstractPlottable *plottable) const
 {
-  QList<QCPAxis*> horz, vert;
-  if (horizontal)
-    horz.append(horizontal);
-  if (vertical)
-    vert.append(vertical);
-  setRangeDragAxes(horz, vert);
+  for (int i=0; i<itemCount(); ++i)
+  {
+    if (QCPPlottableLegendItem *pli = qobject_cast<QCPPlottableLegendItem*>(item(i)))
+    {
+      if (pli->plottable() == plottable)
+        return pli;
+    }
+  }
+  return 0;
 }
 
-/*! \overload
+/*!
+  Returns the number of items currently in the legend.
+
+  Note that if empty cells are in the legend (e.g. by calling methods of the \ref QCPLayoutGrid
+  base class which allows creating empty cells), they are included in the returned count.
 
-  This method allows to set up multiple axes to react to horizontal and vertical dragging. The drag
-  orientation that the respective axis will react to is deduced from its orientation (\ref
-  QCPAxis::orientation).
+  \see item
+*/
+int QCPLegend::itemCount() const
+{
+  return elementCount();
+}
 
-  In the unusual case that you wish to e.g. drag a vertically oriented axis with a horizontal drag
-  motion, use the overload taking two separate lists for horizontal and vertical dragging.
+/*!
+  Returns whether the legend contains \a item.
+  
+  \see hasItemWithPlottable
 */
-void QCPAxisRect::setRangeDragAxes(QList<QCPAxis*> axes)
+bool QCPLegend::hasItem(QCPAbstractLegendItem *item) const
 {
-  QList<QCPAxis*> horz, vert;
-  foreach (QCPAxis *ax, axes)
+  for (int i=0; i<itemCount(); ++i)
   {
-    if (ax->orientation() == Qt::Horizontal)
-      horz.append(ax);
-    else
-      vert.append(ax);
+    if (item == this->item(i))
+        return true;
   }
-  setRangeDragAxes(horz, vert);
+  return false;
 }
 
-/*! \overload
-
-  This method allows to set multiple axes up to react to horizontal and vertical dragging, and
-  define specifically which axis reacts to which drag orientation (irrespective of the axis
-  orientation).
+/*!
+  Returns whether the legend contains a QCPPlottableLegendItem which is associated with \a plottable (e.g. a \ref QCPGraph*).
+  If such an item isn't in the legend, returns false.
+  
+  \see itemWithPlottable
 */
-void QCPAxisRect::setRangeDragAxes(QList<QCPAxis*> horizontal, QList<QCPAxis*> vertical)
+bool QCPLegend::hasItemWithPlottable(const QCPAbstractPlottable *plottable) const
 {
-  mRangeDragHorzAxis.clear();
-  foreach (QCPAxis *ax, horizontal)
-  {
-    QPointer<QCPAxis> axPointer(ax);
-    if (!axPointer.isNull())
-      mRangeDragHorzAxis.append(axPointer);
-    else
-      qDebug() << Q_FUNC_INFO << "invalid axis passed in horizontal list:" << reinterpret_cast<quintptr>(ax);
-  }
-  mRangeDragVertAxis.clear();
-  foreach (QCPAxis *ax, vertical)
-  {
-    QPointer<QCPAxis> axPointer(ax);
-    if (!axPointer.isNull())
-      mRangeDragVertAxis.append(axPointer);
-    else
-      qDebug() << Q_FUNC_INFO << "invalid axis passed in vertical list:" << reinterpret_cast<quintptr>(ax);
-  }
+  return itemWithPlottable(plottable);
 }
 
 /*!
-  Sets the axes whose range will be zoomed when \ref setRangeZoom enables mouse wheel zooming on
-  the QCustomPlot widget. Pass 0 if no axis shall be zoomed in the respective orientation.
+  Adds \a item to the legend, if it's not present already. The element is arranged according to the
+  current fill order (\ref setFillOrder) and wrapping (\ref setWrap).
 
-  The two axes can be zoomed with different strengths, when different factors are passed to \ref
-  setRangeZoomFactor(double horizontalFactor, double verticalFactor).
+  Returns true on sucess, i.e. if the item wasn't in the list already and has been successfuly added.
 
-  Use the overload taking a list of axes, if multiple axes (more than one per orientation) shall
-  react to zooming interactions.
+  The legend takes ownership of the item.
 
-  \see setRangeDragAxes
+  \see removeItem, item, hasItem
 */
-void QCPAxisRect::setRangeZoomAxes(QCPAxis *horizontal, QCPAxis *vertical)
+bool QCPLegend::addItem(QCPAbstractLegendItem *item)
 {
-  QList<QCPAxis*> horz, vert;
-  if (horizontal)
-    horz.append(horizontal);
-  if (vertical)
-    vert.append(vertical);
-  setRangeZoomAxes(horz, vert);
+  return addElement(item);
 }
 
 /*! \overload
 
-  This method allows to set up multiple axes to react to horizontal and vertical range zooming. The
-  zoom orientation that the respective axis will react to is deduced from its orientation (\ref
-  QCPAxis::orientation).
+  Removes the item with the specified \a index from the legend and deletes it.
 
-  In the unusual case that you wish to e.g. zoom a vertically oriented axis with a horizontal zoom
-  interaction, use the overload taking two separate lists for horizontal and vertical zooming.
+  After successful removal, the legend is reordered according to the current fill order (\ref
+  setFillOrder) and wrapping (\ref setWrap), so no empty cell remains where the removed \a item
+  was. If you don't want this, rather use the raw element interface of \ref QCPLayoutGrid.
+
+  Returns true, if successful. Unlike \ref QCPLayoutGrid::removeAt, this method only removes
+  elements derived from \ref QCPAbstractLegendItem.
+
+  \see itemCount, clearItems
 */
-void QCPAxisRect::setRangeZoomAxes(QList<QCPAxis*> axes)
+bool QCPLegend::removeItem(int index)
 {
-  QList<QCPAxis*> horz, vert;
-  foreach (QCPAxis *ax, axes)
+  if (QCPAbstractLegendItem *ali = item(index))
   {
-    if (ax->orientation() == Qt::Horizontal)
-      horz.append(ax);
-    else
-      vert.append(ax);
-  }
-  setRangeZoomAxes(horz, vert);
+    bool success = remove(ali);
+    if (success)
+      setFillOrder(fillOrder(), true); // gets rid of empty cell by reordering
+    return success;
+  } else
+    return false;
 }
 
 /*! \overload
 
-  This method allows to set multiple axes up to react to horizontal and vertical zooming, and
-  define specifically which axis reacts to which zoom orientation (irrespective of the axis
-  orientation).
-*/
-void QCPAxisRect::setRangeZoomAxes(QList<QCPAxis*> horizontal, QList<QCPAxis*> vertical)
-{
-  mRangeZoomHorzAxis.clear();
-  foreach (QCPAxis *ax, horizontal)
-  {
-    QPointer<QCPAxis> axPointer(ax);
-    if (!axPointer.isNull())
-      mRangeZoomHorzAxis.append(axPointer);
-    else
-      qDebug() << Q_FUNC_INFO << "invalid axis passed in horizontal list:" << reinterpret_cast<quintptr>(ax);
-  }
-  mRangeZoomVertAxis.clear();
-  foreach (QCPAxis *ax, vertical)
-  {
-    QPointer<QCPAxis> axPointer(ax);
-    if (!axPointer.isNull())
-      mRangeZoomVertAxis.append(axPointer);
-    else
-      qDebug() << Q_FUNC_INFO << "invalid axis passed in vertical list:" << reinterpret_cast<quintptr>(ax);
-  }
-}
+  Removes \a item from the legend and deletes it.
 
-/*!
-  Sets how strong one rotation step of the mouse wheel zooms, when range zoom was activated with
-  \ref setRangeZoom. The two parameters \a horizontalFactor and \a verticalFactor provide a way to
-  let the horizontal axis zoom at different rates than the vertical axis. Which axis is horizontal
-  and which is vertical, can be set with \ref setRangeZoomAxes.
+  After successful removal, the legend is reordered according to the current fill order (\ref
+  setFillOrder) and wrapping (\ref setWrap), so no empty cell remains where the removed \a item
+  was. If you don't want this, rather use the raw element interface of \ref QCPLayoutGrid.
 
-  When the zoom factor is greater than one, scrolling the mouse wheel backwards (towards the user)
-  will zoom in (make the currently visible range smaller). For zoom factors smaller than one, the
-  same scrolling direction will zoom out.
-*/
-void QCPAxisRect::setRangeZoomFactor(double horizontalFactor, double verticalFactor)
-{
-  mRangeZoomFactorHorz = horizontalFactor;
-  mRangeZoomFactorVert = verticalFactor;
-}
+  Returns true, if successful.
 
-/*! \overload
-  
-  Sets both the horizontal and vertical zoom \a factor.
+  \see clearItems
 */
-void QCPAxisRect::setRangeZoomFactor(double factor)
+bool QCPLegend::removeItem(QCPAbstractLegendItem *item)
 {
-  mRangeZoomFactorHorz = factor;
-  mRangeZoomFactorVert = factor;
+  bool success = remove(item);
+  if (success)
+    setFillOrder(fillOrder(), true); // gets rid of empty cell by reordering
+  return success;
 }
 
-/*! \internal
-  
-  Draws the background of this axis rect. It may consist of a background fill (a QBrush) and a
-  pixmap.
-  
-  If a brush was given via \ref setBackground(const QBrush &brush), this function first draws an
-  according filling inside the axis rect with the provided \a painter.
-  
-  Then, if a pixmap was provided via \ref setBackground, this function buffers the scaled version
-  depending on \ref setBackgroundScaled and \ref setBackgroundScaledMode and then draws it inside
-  the axis rect with the provided \a painter. The scaled version is buffered in
-  mScaledBackgroundPixmap to prevent expensive rescaling at every redraw. It is only updated, when
-  the axis rect has changed in a way that requires a rescale of the background pixmap (this is
-  dependent on the \ref setBackgroundScaledMode), or when a differend axis background pixmap was
-  set.
-  
-  \see setBackground, setBackgroundScaled, setBackgroundScaledMode
+/*!
+  Removes all items from the legend.
 */
-void QCPAxisRect::drawBackground(QCPPainter *painter)
+void QCPLegend::clearItems()
 {
-  // draw background fill:
-  if (mBackgroundBrush != Qt::NoBrush)
-    painter->fillRect(mRect, mBackgroundBrush);
-  
-  // draw background pixmap (on top of fill, if brush specified):
-  if (!mBackgroundPixmap.isNull())
-  {
-    if (mBackgroundScaled)
-    {
-      // check whether mScaledBackground needs to be updated:
-      QSize scaledSize(mBackgroundPixmap.size());
-      scaledSize.scale(mRect.size(), mBackgroundScaledMode);
-      if (mScaledBackgroundPixmap.size() != scaledSize)
-        mScaledBackgroundPixmap = mBackgroundPixmap.scaled(mRect.size(), mBackgroundScaledMode, Qt::SmoothTransformation);
-      painter->drawPixmap(mRect.topLeft()+QPoint(0, -1), mScaledBackgroundPixmap, QRect(0, 0, mRect.width(), mRect.height()) & mScaledBackgroundPixmap.rect());
-    } else
-    {
-      painter->drawPixmap(mRect.topLeft()+QPoint(0, -1), mBackgroundPixmap, QRect(0, 0, mRect.width(), mRect.height()));
-    }
-  }
+  for (int i=itemCount()-1; i>=0; --i)
+    removeItem(i);
 }
 
-/*! \internal
-  
-  This function makes sure multiple axes on the side specified with \a type don't collide, but are
-  distributed according to their respective space requirement (QCPAxis::calculateMargin).
-  
-  It does this by setting an appropriate offset (\ref QCPAxis::setOffset) on all axes except the
-  one with index zero.
+/*!
+  Returns the legend items that are currently selected. If no items are selected,
+  the list is empty.
   
-  This function is called by \ref calculateAutoMargin.
+  \see QCPAbstractLegendItem::setSelected, setSelectable
 */
-void QCPAxisRect::updateAxesOffset(QCPAxis::AxisType type)
-{
-  const QList<QCPAxis*> axesList = mAxes.value(type);
-  if (axesList.isEmpty())
-    return;
-  
-  bool isFirstVisible = !axesList.first()->visible(); // if the first axis is visible, the second axis (which is where the loop starts) isn't the first visible axis, so initialize with false
-  for (int i=1; i<axesList.size(); ++i)
-  {
-    int offset = axesList.at(i-1)->offset() + axesList.at(i-1)->calculateMargin();
-    if (axesList.at(i)->visible()) // only add inner tick length to offset if this axis is visible and it's not the first visible one (might happen if true first axis is invisible)
-    {
-      if (!isFirstVisible)
-        offset += axesList.at(i)->tickLengthIn();
-      isFirstVisible = false;
-    }
-    axesList.at(i)->setOffset(offset);
-  }
-}
-
-/* inherits documentation from base class */
-int QCPAxisRect::calculateAutoMargin(QCP::MarginSide side)
+QList<QCPAbstractLegendItem *> QCPLegend::selectedItems() const
 {
-  if (!mAutoMargins.testFlag(side))
-    qDebug() << Q_FUNC_INFO << "Called with side that isn't specified as auto margin";
-  
-  updateAxesOffset(QCPAxis::marginSideToAxisType(side));
-  
-  // note: only need to look at the last (outer most) axis to determine the total margin, due to updateAxisOffset call
-  const QList<QCPAxis*> axesList = mAxes.value(QCPAxis::marginSideToAxisType(side));
-  if (axesList.size() > 0)
-    return axesList.last()->offset() + axesList.last()->calculateMargin();
-  else
-    return 0;
+  QList<QCPAbstractLegendItem*> result;
+  for (int i=0; i<itemCount(); ++i)
+  {
+    if (QCPAbstractLegendItem *ali = item(i))
+    {
+      if (ali->selected())
+        result.append(ali);
+    }
+  }
+  return result;
 }
 
 /*! \internal
+
+  A convenience function to easily set the QPainter::Antialiased hint on the provided \a painter
+  before drawing main legend elements.
+
+  This is the antialiasing state the painter passed to the \ref draw method is in by default.
   
-  Reacts to a change in layout to potentially set the convenience axis pointers \ref
-  QCustomPlot::xAxis, \ref QCustomPlot::yAxis, etc. of the parent QCustomPlot to the respective
-  axes of this axis rect. This is only done if the respective convenience pointer is currently zero
-  and if there is no QCPAxisRect at position (0, 0) of the plot layout.
+  This function takes into account the local setting of the antialiasing flag as well as the
+  overrides set with \ref QCustomPlot::setAntialiasedElements and \ref
+  QCustomPlot::setNotAntialiasedElements.
   
-  This automation makes it simpler to replace the main axis rect with a newly created one, without
-  the need to manually reset the convenience pointers.
+  \seebaseclassmethod
+  
+  \see setAntialiased
 */
-void QCPAxisRect::layoutChanged()
+void QCPLegend::applyDefaultAntialiasingHint(QCPPainter *painter) const
 {
-  if (mParentPlot && mParentPlot->axisRectCount() > 0 && mParentPlot->axisRect(0) == this)
-  {
-    if (axisCount(QCPAxis::atBottom) > 0 && !mParentPlot->xAxis)
-      mParentPlot->xAxis = axis(QCPAxis::atBottom);
-    if (axisCount(QCPAxis::atLeft) > 0 && !mParentPlot->yAxis)
-      mParentPlot->yAxis = axis(QCPAxis::atLeft);
-    if (axisCount(QCPAxis::atTop) > 0 && !mParentPlot->xAxis2)
-      mParentPlot->xAxis2 = axis(QCPAxis::atTop);
-    if (axisCount(QCPAxis::atRight) > 0 && !mParentPlot->yAxis2)
-      mParentPlot->yAxis2 = axis(QCPAxis::atRight);
-  }
+  applyAntialiasingHint(painter, mAntialiased, QCP::aeLegend);
 }
 
 /*! \internal
   
-  Event handler for when a mouse button is pressed on the axis rect. If the left mouse button is
-  pressed, the range dragging interaction is initialized (the actual range manipulation happens in
-  the \ref mouseMoveEvent).
+  Returns the pen used to paint the border of the legend, taking into account the selection state
+  of the legend box.
+*/
+QPen QCPLegend::getBorderPen() const
+{
+  return mSelectedParts.testFlag(spLegendBox) ? mSelectedBorderPen : mBorderPen;
+}
 
-  The mDragging flag is set to true and some anchor points are set that are needed to determine the
-  distance the mouse was dragged in the mouse move/release events later.
+/*! \internal
   
-  \see mouseMoveEvent, mouseReleaseEvent
+  Returns the brush used to paint the background of the legend, taking into account the selection
+  state of the legend box.
 */
-void QCPAxisRect::mousePressEvent(QMouseEvent *event, const QVariant &details)
+QBrush QCPLegend::getBrush() const
 {
-  Q_UNUSED(details)
-  mDragStart = event->pos(); // need this even when not LeftButton is pressed, to determine in releaseEvent whether it was a full click (no position change between press and release)
-  if (event->buttons() & Qt::LeftButton)
-  {
-    mDragging = true;
-    // initialize antialiasing backup in case we start dragging:
-    if (mParentPlot->noAntialiasingOnDrag())
-    {
-      mAADragBackup = mParentPlot->antialiasedElements();
-      mNotAADragBackup = mParentPlot->notAntialiasedElements();
-    }
-    // Mouse range dragging interaction:
-    if (mParentPlot->interactions().testFlag(QCP::iRangeDrag))
-    {
-      mDragStartHorzRange.clear();
-      for (int i=0; i<mRangeDragHorzAxis.size(); ++i)
-        mDragStartHorzRange.append(mRangeDragHorzAxis.at(i).isNull() ? QCPRange() : mRangeDragHorzAxis.at(i)->range());
-      mDragStartVertRange.clear();
-      for (int i=0; i<mRangeDragVertAxis.size(); ++i)
-        mDragStartVertRange.append(mRangeDragVertAxis.at(i).isNull() ? QCPRange() : mRangeDragVertAxis.at(i)->range());
-    }
-  }
+  return mSelectedParts.testFlag(spLegendBox) ? mSelectedBrush : mBrush;
 }
 
 /*! \internal
   
-  Event handler for when the mouse is moved on the axis rect. If range dragging was activated in a
-  preceding \ref mousePressEvent, the range is moved accordingly.
-  
-  \see mousePressEvent, mouseReleaseEvent
+  Draws the legend box with the provided \a painter. The individual legend items are layerables
+  themselves, thus are drawn independently.
 */
-void QCPAxisRect::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
+void QCPLegend::draw(QCPPainter *painter)
 {
-  Q_UNUSED(startPos)
-  // Mouse range dragging interaction:
-  if (mDragging && mParentPlot->interactions().testFlag(QCP::iRangeDrag))
+  // draw background rect:
+  painter->setBrush(getBrush());
+  painter->setPen(getBorderPen());
+  painter->drawRect(mOuterRect);
+}
+
+/* inherits documentation from base class */
+double QCPLegend::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  if (!mParentPlot) return -1;
+  if (onlySelectable && !mSelectableParts.testFlag(spLegendBox))
+    return -1;
+  
+  if (mOuterRect.contains(pos.toPoint()))
   {
-    
-    if (mRangeDrag.testFlag(Qt::Horizontal))
-    {
-      for (int i=0; i<mRangeDragHorzAxis.size(); ++i)
-      {
-        QCPAxis *ax = mRangeDragHorzAxis.at(i).data();
-        if (!ax)
-          continue;
-        if (i >= mDragStartHorzRange.size())
-          break;
-        if (ax->mScaleType == QCPAxis::stLinear)
-        {
-          double diff = ax->pixelToCoord(mDragStart.x()) - ax->pixelToCoord(event->pos().x());
-          ax->setRange(mDragStartHorzRange.at(i).lower+diff, mDragStartHorzRange.at(i).upper+diff);
-        } else if (ax->mScaleType == QCPAxis::stLogarithmic)
-        {
-          double diff = ax->pixelToCoord(mDragStart.x()) / ax->pixelToCoord(event->pos().x());
-          ax->setRange(mDragStartHorzRange.at(i).lower*diff, mDragStartHorzRange.at(i).upper*diff);
-        }
-      }
-    }
-    
-    if (mRangeDrag.testFlag(Qt::Vertical))
-    {
-      for (int i=0; i<mRangeDragVertAxis.size(); ++i)
-      {
-        QCPAxis *ax = mRangeDragVertAxis.at(i).data();
-        if (!ax)
-          continue;
-        if (i >= mDragStartVertRange.size())
-          break;
-        if (ax->mScaleType == QCPAxis::stLinear)
-        {
-          double diff = ax->pixelToCoord(mDragStart.y()) - ax->pixelToCoord(event->pos().y());
-          ax->setRange(mDragStartVertRange.at(i).lower+diff, mDragStartVertRange.at(i).upper+diff);
-        } else if (ax->mScaleType == QCPAxis::stLogarithmic)
-        {
-          double diff = ax->pixelToCoord(mDragStart.y()) / ax->pixelToCoord(event->pos().y());
-          ax->setRange(mDragStartVertRange.at(i).lower*diff, mDragStartVertRange.at(i).upper*diff);
-        }
-      }
-    }
-    
-    if (mRangeDrag != 0) // if either vertical or horizontal drag was enabled, do a replot
-    {
-      if (mParentPlot->noAntialiasingOnDrag())
-        mParentPlot->setNotAntialiasedElements(QCP::aeAll);
-      mParentPlot->replot();
-    }
-    
+    if (details) details->setValue(spLegendBox);
+    return mParentPlot->selectionTolerance()*0.99;
   }
+  return -1;
 }
 
 /* inherits documentation from base class */
-void QCPAxisRect::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
+void QCPLegend::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
 {
   Q_UNUSED(event)
-  Q_UNUSED(startPos)
-  mDragging = false;
-  if (mParentPlot->noAntialiasingOnDrag())
+  mSelectedParts = selectedParts(); // in case item selection has changed
+  if (details.value<SelectablePart>() == spLegendBox && mSelectableParts.testFlag(spLegendBox))
   {
-    mParentPlot->setAntialiasedElements(mAADragBackup);
-    mParentPlot->setNotAntialiasedElements(mNotAADragBackup);
+    SelectableParts selBefore = mSelectedParts;
+    setSelectedParts(additive ? mSelectedParts^spLegendBox : mSelectedParts|spLegendBox); // no need to unset spItems in !additive case, because they will be deselected by QCustomPlot (they're normal QCPLayerables with own deselectEvent)
+    if (selectionStateChanged)
+      *selectionStateChanged = mSelectedParts != selBefore;
   }
 }
 
-/*! \internal
-  
-  Event handler for mouse wheel events. If rangeZoom is Qt::Horizontal, Qt::Vertical or both, the
-  ranges of the axes defined as rangeZoomHorzAxis and rangeZoomVertAxis are scaled. The center of
-  the scaling operation is the current cursor position inside the axis rect. The scaling factor is
-  dependent on the mouse wheel delta (which direction the wheel was rotated) to provide a natural
-  zooming feel. The Strength of the zoom can be controlled via \ref setRangeZoomFactor.
-  
-  Note, that event->delta() is usually +/-120 for single rotation steps. However, if the mouse
-  wheel is turned rapidly, many steps may bunch up to one event, so the event->delta() may then be
-  multiples of 120. This is taken into account here, by calculating \a wheelSteps and using it as
-  exponent of the range zoom factor. This takes care of the wheel direction automatically, by
-  inverting the factor, when the wheel step is negative (f^-1 = 1/f).
-*/
-void QCPAxisRect::wheelEvent(QWheelEvent *event)
+/* inherits documentation from base class */
+void QCPLegend::deselectEvent(bool *selectionStateChanged)
 {
-  // Mouse range zooming interaction:
-  if (mParentPlot->interactions().testFlag(QCP::iRangeZoom))
+  mSelectedParts = selectedParts(); // in case item selection has changed
+  if (mSelectableParts.testFlag(spLegendBox))
   {
-    if (mRangeZoom != 0)
-    {
-      double factor;
-      double wheelSteps = event->delta()/120.0; // a single step delta is +/-120 usually
-      if (mRangeZoom.testFlag(Qt::Horizontal))
-      {
-        factor = qPow(mRangeZoomFactorHorz, wheelSteps);
-        for (int i=0; i<mRangeZoomHorzAxis.size(); ++i)
-        {
-          if (!mRangeZoomHorzAxis.at(i).isNull())
-            mRangeZoomHorzAxis.at(i)->scaleRange(factor, mRangeZoomHorzAxis.at(i)->pixelToCoord(event->pos().x()));
-        }
-      }
-      if (mRangeZoom.testFlag(Qt::Vertical))
-      {
-        factor = qPow(mRangeZoomFactorVert, wheelSteps);
-        for (int i=0; i<mRangeZoomVertAxis.size(); ++i)
-        {
-          if (!mRangeZoomVertAxis.at(i).isNull())
-            mRangeZoomVertAxis.at(i)->scaleRange(factor, mRangeZoomVertAxis.at(i)->pixelToCoord(event->pos().y()));
-        }
-      }
-      mParentPlot->replot();
-    }
+    SelectableParts selBefore = mSelectedParts;
+    setSelectedParts(selectedParts() & ~spLegendBox);
+    if (selectionStateChanged)
+      *selectionStateChanged = mSelectedParts != selBefore;
   }
 }
-/* end of 'src/layoutelements/layoutelement-axisrect.cpp' */
 
+/* inherits documentation from base class */
+QCP::Interaction QCPLegend::selectionCategory() const
+{
+  return QCP::iSelectLegend;
+}
+
+/* inherits documentation from base class */
+QCP::Interaction QCPAbstractLegendItem::selectionCategory() const
+{
+  return QCP::iSelectLegend;
+}
 
-/* including file 'src/layoutelements/layoutelement-legend.cpp', size 30933  */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
+/* inherits documentation from base class */
+void QCPLegend::parentPlotInitialized(QCustomPlot *parentPlot)
+{
+  if (parentPlot && !parentPlot->legend)
+    parentPlot->legend = this;
+}
+/* end of 'src/layoutelements/layoutelement-legend.cpp' */
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPAbstractLegendItem
-////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPAbstractLegendItem
-  \brief The abstract base class for all entries in a QCPLegend.
-  
-  It defines a very basic interface for entries in a QCPLegend. For representing plottables in the
-  legend, the subclass \ref QCPPlottableLegendItem is more suitable.
-  
-  Only derive directly from this class when you need absolute freedom (e.g. a custom legend entry
-  that's not even associated with a plottable).
+/* including file 'src/layoutelements/layoutelement-textelement.cpp', size 12759 */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200     */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPTextElement
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  You must implement the following pure virtual functions:
-  \li \ref draw (from QCPLayerable)
-  
-  You inherit the following members you may use:
-  <table>
-    <tr>
-      <td>QCPLegend *\b mParentLegend</td>
-      <td>A pointer to the parent QCPLegend.</td>
-    </tr><tr>
-      <td>QFont \b mFont</td>
-      <td>The generic font of the item. You should use this font for all or at least the most prominent text of the item.</td>
-    </tr>
-  </table>
+/*! \class QCPTextElement
+  \brief A layout element displaying a text
+
+  The text may be specified with \ref setText, the formatting can be controlled with \ref setFont,
+  \ref setTextColor, and \ref setTextFlags.
+
+  A text element can be added as follows:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcptextelement-creation
 */
 
-/* start of documentation of signals */
+/* start documentation of signals */
 
-/*! \fn void QCPAbstractLegendItem::selectionChanged(bool selected)
+/*! \fn void QCPTextElement::selectionChanged(bool selected)
   
-  This signal is emitted when the selection state of this legend item has changed, either by user
+  This signal is emitted when the selection state has changed to \a selected, either by user
   interaction or by a direct call to \ref setSelected.
+  
+  \see setSelected, setSelectable
 */
 
-/* end of documentation of signals */
+/*! \fn void QCPTextElement::clicked(QMouseEvent *event)
 
-/*!
-  Constructs a QCPAbstractLegendItem and associates it with the QCPLegend \a parent. This does not
-  cause the item to be added to \a parent, so \ref QCPLegend::addItem must be called separately.
-*/
-QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
-  QCPLayoutElement(parent->parentPlot()),
-  mParentLegend(parent),
-  mFont(parent->font()),
-  mTextColor(parent->textColor()),
-  mSelectedFont(parent->selectedFont()),
-  mSelectedTextColor(parent->selectedTextColor()),
-  mSelectable(true),
-  mSelected(false)
-{
-  setLayer(QLatin1String("legend"));
-  setMargins(QMargins(0, 0, 0, 0));
-}
+  This signal is emitted when the text element is clicked.
 
-/*!
-  Sets the default font of this specific legend item to \a font.
-  
-  \see setTextColor, QCPLegend::setFont
+  \see doubleClicked, selectTest
 */
-void QCPAbstractLegendItem::setFont(const QFont &font)
-{
-  mFont = font;
-}
 
-/*!
-  Sets the default text color of this specific legend item to \a color.
-  
-  \see setFont, QCPLegend::setTextColor
-*/
-void QCPAbstractLegendItem::setTextColor(const QColor &color)
-{
-  mTextColor = color;
-}
+/*! \fn void QCPTextElement::doubleClicked(QMouseEvent *event)
 
-/*!
-  When this legend item is selected, \a font is used to draw generic text, instead of the normal
-  font set with \ref setFont.
-  
-  \see setFont, QCPLegend::setSelectedFont
-*/
-void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
-{
-  mSelectedFont = font;
-}
+  This signal is emitted when the text element is double clicked.
 
-/*!
-  When this legend item is selected, \a color is used to draw generic text, instead of the normal
-  color set with \ref setTextColor.
-  
-  \see setTextColor, QCPLegend::setSelectedTextColor
+  \see clicked, selectTest
 */
-void QCPAbstractLegendItem::setSelectedTextColor(const QColor &color)
-{
-  mSelectedTextColor = color;
-}
 
-/*!
-  Sets whether this specific legend item is selectable.
+/* end documentation of signals */
+
+/*! \overload
   
-  \see setSelectedParts, QCustomPlot::setInteractions
+  Creates a new QCPTextElement instance and sets default values. The initial text is empty (\ref
+  setText).
 */
-void QCPAbstractLegendItem::setSelectable(bool selectable)
+QCPTextElement::QCPTextElement(QCustomPlot *parentPlot) :
+  QCPLayoutElement(parentPlot),
+  mText(),
+  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
+  mFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
+  mTextColor(Qt::black),
+  mSelectedFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
+  mSelectedTextColor(Qt::blue),
+  mSelectable(false),
+  mSelected(false)
 {
-  if (mSelectable != selectable)
+  if (parentPlot)
   {
-    mSelectable = selectable;
-    emit selectableChanged(mSelectable);
+    mFont = parentPlot->font();
+    mSelectedFont = parentPlot->font();
   }
+  setMargins(QMargins(2, 2, 2, 2));
 }
 
-/*!
-  Sets whether this specific legend item is selected.
-  
-  It is possible to set the selection state of this item by calling this function directly, even if
-  setSelectable is set to false.
+/*! \overload
   
-  \see setSelectableParts, QCustomPlot::setInteractions
+  Creates a new QCPTextElement instance and sets default values.
+
+  The initial text is set to \a text.
 */
-void QCPAbstractLegendItem::setSelected(bool selected)
+QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text) :
+  QCPLayoutElement(parentPlot),
+  mText(text),
+  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
+  mFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
+  mTextColor(Qt::black),
+  mSelectedFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
+  mSelectedTextColor(Qt::blue),
+  mSelectable(false),
+  mSelected(false)
 {
-  if (mSelected != selected)
+  if (parentPlot)
   {
-    mSelected = selected;
-    emit selectionChanged(mSelected);
+    mFont = parentPlot->font();
+    mSelectedFont = parentPlot->font();
   }
+  setMargins(QMargins(2, 2, 2, 2));
 }
 
-/* inherits documentation from base class */
-double QCPAbstractLegendItem::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
-{
-  Q_UNUSED(details)
-  if (!mParentPlot) return -1;
-  if (onlySelectable && (!mSelectable || !mParentLegend->selectableParts().testFlag(QCPLegend::spItems)))
-    return -1;
+/*! \overload
   
-  if (mRect.contains(pos.toPoint()))
-    return mParentPlot->selectionTolerance()*0.99;
-  else
-    return -1;
-}
-
-/* inherits documentation from base class */
-void QCPAbstractLegendItem::applyDefaultAntialiasingHint(QCPPainter *painter) const
-{
-  applyAntialiasingHint(painter, mAntialiased, QCP::aeLegendItems);
-}
-
-/* inherits documentation from base class */
-QRect QCPAbstractLegendItem::clipRect() const
-{
-  return mOuterRect;
-}
+  Creates a new QCPTextElement instance and sets default values.
 
-/* inherits documentation from base class */
-void QCPAbstractLegendItem::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
+  The initial text is set to \a text with \a pointSize.
+*/
+QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, double pointSize) :
+  QCPLayoutElement(parentPlot),
+  mText(text),
+  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
+  mFont(QFont(QLatin1String("sans serif"), pointSize)), // will be taken from parentPlot if available, see below
+  mTextColor(Qt::black),
+  mSelectedFont(QFont(QLatin1String("sans serif"), pointSize)), // will be taken from parentPlot if available, see below
+  mSelectedTextColor(Qt::blue),
+  mSelectable(false),
+  mSelected(false)
 {
-  Q_UNUSED(event)
-  Q_UNUSED(details)
-  if (mSelectable && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
+  if (parentPlot)
   {
-    bool selBefore = mSelected;
-    setSelected(additive ? !mSelected : true);
-    if (selectionStateChanged)
-      *selectionStateChanged = mSelected != selBefore;
+    mFont = parentPlot->font();
+    mFont.setPointSizeF(pointSize);
+    mSelectedFont = parentPlot->font();
+    mSelectedFont.setPointSizeF(pointSize);
   }
+  setMargins(QMargins(2, 2, 2, 2));
 }
 
-/* inherits documentation from base class */
-void QCPAbstractLegendItem::deselectEvent(bool *selectionStateChanged)
+/*! \overload
+  
+  Creates a new QCPTextElement instance and sets default values.
+
+  The initial text is set to \a text with \a pointSize and the specified \a fontFamily.
+*/
+QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, const QString &fontFamily, double pointSize) :
+  QCPLayoutElement(parentPlot),
+  mText(text),
+  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
+  mFont(QFont(fontFamily, pointSize)),
+  mTextColor(Qt::black),
+  mSelectedFont(QFont(fontFamily, pointSize)),
+  mSelectedTextColor(Qt::blue),
+  mSelectable(false),
+  mSelected(false)
 {
-  if (mSelectable && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
-  {
-    bool selBefore = mSelected;
-    setSelected(false);
-    if (selectionStateChanged)
-      *selectionStateChanged = mSelected != selBefore;
-  }
+  setMargins(QMargins(2, 2, 2, 2));
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPPlottableLegendItem
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPPlottableLegendItem
-  \brief A legend item representing a plottable with an icon and the plottable name.
-  
-  This is the standard legend item for plottables. It displays an icon of the plottable next to the
-  plottable name. The icon is drawn by the respective plottable itself (\ref
-  QCPAbstractPlottable::drawLegendIcon), and tries to give an intuitive symbol for the plottable.
-  For example, the QCPGraph draws a centered horizontal line and/or a single scatter point in the
-  middle.
+/*! \overload
   
-  Legend items of this type are always associated with one plottable (retrievable via the
-  plottable() function and settable with the constructor). You may change the font of the plottable
-  name with \ref setFont. Icon padding and border pen is taken from the parent QCPLegend, see \ref
-  QCPLegend::setIconBorderPen and \ref QCPLegend::setIconTextPadding.
+  Creates a new QCPTextElement instance and sets default values.
 
-  The function \ref QCPAbstractPlottable::addToLegend/\ref QCPAbstractPlottable::removeFromLegend
-  creates/removes legend items of this type in the default implementation. However, these functions
-  may be reimplemented such that a different kind of legend item (e.g a direct subclass of
-  QCPAbstractLegendItem) is used for that plottable.
-  
-  Since QCPLegend is based on QCPLayoutGrid, a legend item itself is just a subclass of
-  QCPLayoutElement. While it could be added to a legend (or any other layout) via the normal layout
-  interface, QCPLegend has specialized functions for handling legend items conveniently, see the
-  documentation of \ref QCPLegend.
+  The initial text is set to \a text with the specified \a font.
 */
+QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, const QFont &font) :
+  QCPLayoutElement(parentPlot),
+  mText(text),
+  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
+  mFont(font),
+  mTextColor(Qt::black),
+  mSelectedFont(font),
+  mSelectedTextColor(Qt::blue),
+  mSelectable(false),
+  mSelected(false)
+{
+  setMargins(QMargins(2, 2, 2, 2));
+}
 
 /*!
-  Creates a new legend item associated with \a plottable.
-  
-  Once it's created, it can be added to the legend via \ref QCPLegend::addItem.
+  Sets the text that will be displayed to \a text. Multiple lines can be created by insertion of "\n".
   
-  A more convenient way of adding/removing a plottable to/from the legend is via the functions \ref
-  QCPAbstractPlottable::addToLegend and \ref QCPAbstractPlottable::removeFromLegend.
+  \see setFont, setTextColor, setTextFlags
 */
-QCPPlottableLegendItem::QCPPlottableLegendItem(QCPLegend *parent, QCPAbstractPlottable *plottable) :
-  QCPAbstractLegendItem(parent),
-  mPlottable(plottable)
+void QCPTextElement::setText(const QString &text)
 {
-  setAntialiased(false);
+  mText = text;
 }
 
-/*! \internal
+/*!
+  Sets options for text alignment and wrapping behaviour. \a flags is a bitwise OR-combination of
+  \c Qt::AlignmentFlag and \c Qt::TextFlag enums.
   
-  Returns the pen that shall be used to draw the icon border, taking into account the selection
-  state of this item.
+  Possible enums are:
+  - Qt::AlignLeft
+  - Qt::AlignRight
+  - Qt::AlignHCenter
+  - Qt::AlignJustify
+  - Qt::AlignTop
+  - Qt::AlignBottom
+  - Qt::AlignVCenter
+  - Qt::AlignCenter
+  - Qt::TextDontClip
+  - Qt::TextSingleLine
+  - Qt::TextExpandTabs
+  - Qt::TextShowMnemonic
+  - Qt::TextWordWrap
+  - Qt::TextIncludeTrailingSpaces
 */
-QPen QCPPlottableLegendItem::getIconBorderPen() const
+void QCPTextElement::setTextFlags(int flags)
 {
-  return mSelected ? mParentLegend->selectedIconBorderPen() : mParentLegend->iconBorderPen();
+  mTextFlags = flags;
 }
 
-/*! \internal
+/*!
+  Sets the \a font of the text.
   
-  Returns the text color that shall be used to draw text, taking into account the selection state
-  of this item.
+  \see setTextColor, setSelectedFont
 */
-QColor QCPPlottableLegendItem::getTextColor() const
+void QCPTextElement::setFont(const QFont &font)
 {
-  return mSelected ? mSelectedTextColor : mTextColor;
+  mFont = font;
 }
 
-/*! \internal
+/*!
+  Sets the \a color of the text.
   
-  Returns the font that shall be used to draw text, taking into account the selection state of this
-  item.
+  \see setFont, setSelectedTextColor
 */
-QFont QCPPlottableLegendItem::getFont() const
+void QCPTextElement::setTextColor(const QColor &color)
 {
-  return mSelected ? mSelectedFont : mFont;
+  mTextColor = color;
 }
 
-/*! \internal
+/*!
+  Sets the \a font of the text that will be used if the text element is selected (\ref setSelected).
   
-  Draws the item with \a painter. The size and position of the drawn legend item is defined by the
-  parent layout (typically a \ref QCPLegend) and the \ref minimumSizeHint and \ref maximumSizeHint
-  of this legend item.
+  \see setFont
 */
-void QCPPlottableLegendItem::draw(QCPPainter *painter)
+void QCPTextElement::setSelectedFont(const QFont &font)
 {
-  if (!mPlottable) return;
-  painter->setFont(getFont());
-  painter->setPen(QPen(getTextColor()));
-  QSizeF iconSize = mParentLegend->iconSize();
-  QRectF textRect = painter->fontMetrics().boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
-  QRectF iconRect(mRect.topLeft(), iconSize);
-  int textHeight = qMax(textRect.height(), iconSize.height());  // if text has smaller height than icon, center text vertically in icon height, else align tops
-  painter->drawText(mRect.x()+iconSize.width()+mParentLegend->iconTextPadding(), mRect.y(), textRect.width(), textHeight, Qt::TextDontClip, mPlottable->name());
-  // draw icon:
-  painter->save();
-  painter->setClipRect(iconRect, Qt::IntersectClip);
-  mPlottable->drawLegendIcon(painter, iconRect);
-  painter->restore();
-  // draw icon border:
-  if (getIconBorderPen().style() != Qt::NoPen)
-  {
-    painter->setPen(getIconBorderPen());
-    painter->setBrush(Qt::NoBrush);
-    int halfPen = qCeil(painter->pen().widthF()*0.5)+1;
-    painter->setClipRect(mOuterRect.adjusted(-halfPen, -halfPen, halfPen, halfPen)); // extend default clip rect so thicker pens (especially during selection) are not clipped
-    painter->drawRect(iconRect);
-  }
+  mSelectedFont = font;
 }
 
-/*! \internal
-  
-  Calculates and returns the size of this item. This includes the icon, the text and the padding in
-  between.
+/*!
+  Sets the \a color of the text that will be used if the text element is selected (\ref setSelected).
   
-  \seebaseclassmethod
+  \see setTextColor
 */
-QSize QCPPlottableLegendItem::minimumSizeHint() const
+void QCPTextElement::setSelectedTextColor(const QColor &color)
 {
-  if (!mPlottable) return QSize();
-  QSize result(0, 0);
-  QRect textRect;
-  QFontMetrics fontMetrics(getFont());
-  QSize iconSize = mParentLegend->iconSize();
-  textRect = fontMetrics.boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
-  result.setWidth(iconSize.width() + mParentLegend->iconTextPadding() + textRect.width() + mMargins.left() + mMargins.right());
-  result.setHeight(qMax(textRect.height(), iconSize.height()) + mMargins.top() + mMargins.bottom());
-  return result;
+  mSelectedTextColor = color;
 }
 
+/*!
+  Sets whether the user may select this text element.
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPLegend
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPLegend
-  \brief Manages a legend inside a QCustomPlot.
-
-  A legend is a small box somewhere in the plot which lists plottables with their name and icon.
-
-  Normally, the legend is populated by calling \ref QCPAbstractPlottable::addToLegend. The
-  respective legend item can be removed with \ref QCPAbstractPlottable::removeFromLegend. However,
-  QCPLegend also offers an interface to add and manipulate legend items directly: \ref item, \ref
-  itemWithPlottable, \ref itemCount, \ref addItem, \ref removeItem, etc.
-
-  Since \ref QCPLegend derives from \ref QCPLayoutGrid, it can be placed in any position a \ref
-  QCPLayoutElement may be positioned. The legend items are themselves \ref QCPLayoutElement
-  "QCPLayoutElements" which are placed in the grid layout of the legend. \ref QCPLegend only adds
-  an interface specialized for handling child elements of type \ref QCPAbstractLegendItem, as
-  mentioned above. In principle, any other layout elements may also be added to a legend via the
-  normal \ref QCPLayoutGrid interface. See the special page about \link thelayoutsystem The Layout
-  System\endlink for examples on how to add other elements to the legend and move it outside the axis
-  rect.
-
-  Use the methods \ref setFillOrder and \ref setWrap inherited from \ref QCPLayoutGrid to control
-  in which order (column first or row first) the legend is filled up when calling \ref addItem, and
-  at which column or row wrapping occurs.
-
-  By default, every QCustomPlot has one legend (\ref QCustomPlot::legend) which is placed in the
-  inset layout of the main axis rect (\ref QCPAxisRect::insetLayout). To move the legend to another
-  position inside the axis rect, use the methods of the \ref QCPLayoutInset. To move the legend
-  outside of the axis rect, place it anywhere else with the \ref QCPLayout/\ref QCPLayoutElement
-  interface.
-*/
-
-/* start of documentation of signals */
-
-/*! \fn void QCPLegend::selectionChanged(QCPLegend::SelectableParts selection);
-
-  This signal is emitted when the selection state of this legend has changed.
-  
-  \see setSelectedParts, setSelectableParts
+  Note that even when \a selectable is set to <tt>false</tt>, the selection state may be changed
+  programmatically via \ref setSelected.
 */
-
-/* end of documentation of signals */
+void QCPTextElement::setSelectable(bool selectable)
+{
+  if (mSelectable != selectable)
+  {
+    mSelectable = selectable;
+    emit selectableChanged(mSelectable);
+  }
+}
 
 /*!
-  Constructs a new QCPLegend instance with default values.
+  Sets the selection state of this text element to \a selected. If the selection has changed, \ref
+  selectionChanged is emitted.
   
-  Note that by default, QCustomPlot already contains a legend ready to be used as \ref
-  QCustomPlot::legend
+  Note that this function can change the selection state independently of the current \ref
+  setSelectable state.
 */
-QCPLegend::QCPLegend()
+void QCPTextElement::setSelected(bool selected)
 {
-  setFillOrder(QCPLayoutGrid::foRowsFirst);
-  setWrap(0);
-  
-  setRowSpacing(3);
-  setColumnSpacing(8);
-  setMargins(QMargins(7, 5, 7, 4));
-  setAntialiased(false);
-  setIconSize(32, 18);
-  
-  setIconTextPadding(7);
-  
-  setSelectableParts(spLegendBox | spItems);
-  setSelectedParts(spNone);
-  
-  setBorderPen(QPen(Qt::black, 0));
-  setSelectedBorderPen(QPen(Qt::blue, 2));
-  setIconBorderPen(Qt::NoPen);
-  setSelectedIconBorderPen(QPen(Qt::blue, 2));
-  setBrush(Qt::white);
-  setSelectedBrush(Qt::white);
-  setTextColor(Qt::black);
-  setSelectedTextColor(Qt::blue);
+  if (mSelected != selected)
+  {
+    mSelected = selected;
+    emit selectionChanged(mSelected);
+  }
 }
 
-QCPLegend::~QCPLegend()
+/* inherits documentation from base class */
+void QCPTextElement::applyDefaultAntialiasingHint(QCPPainter *painter) const
 {
-  clearItems();
-  if (qobject_cast<QCustomPlot*>(mParentPlot)) // make sure this isn't called from QObject dtor when QCustomPlot is already destructed (happens when the legend is not in any layout and thus QObject-child of QCustomPlot)
-    mParentPlot->legendRemoved(this);
+  applyAntialiasingHint(painter, mAntialiased, QCP::aeOther);
 }
 
-/* no doc for getter, see setSelectedParts */
-QCPLegend::SelectableParts QCPLegend::selectedParts() const
+/* inherits documentation from base class */
+void QCPTextElement::draw(QCPPainter *painter)
 {
-  // check whether any legend elements selected, if yes, add spItems to return value
-  bool hasSelectedItems = false;
-  for (int i=0; i<itemCount(); ++i)
-  {
-    if (item(i) && item(i)->selected())
-    {
-      hasSelectedItems = true;
-      break;
-    }
-  }
-  if (hasSelectedItems)
-    return mSelectedParts | spItems;
-  else
-    return mSelectedParts & ~spItems;
+  painter->setFont(mainFont());
+  painter->setPen(QPen(mainTextColor()));
+  painter->drawText(mRect, Qt::AlignCenter, mText, &mTextBoundingRect);
 }
 
-/*!
-  Sets the pen, the border of the entire legend is drawn with.
-*/
-void QCPLegend::setBorderPen(const QPen &pen)
+/* inherits documentation from base class */
+QSize QCPTextElement::minimumSizeHint() const
 {
-  mBorderPen = pen;
+  QFontMetrics metrics(mFont);
+  QSize result = metrics.boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
+  result.rwidth() += mMargins.left() + mMargins.right();
+  result.rheight() += mMargins.top() + mMargins.bottom();
+  return result;
+}
+
+/* inherits documentation from base class */
+QSize QCPTextElement::maximumSizeHint() const
+{
+  QFontMetrics metrics(mFont);
+  QSize result = metrics.boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
+  result.rheight() += mMargins.top() + mMargins.bottom();
+  result.setWidth(QWIDGETSIZE_MAX);
+  return result;
 }
 
-/*!
-  Sets the brush of the legend background.
-*/
-void QCPLegend::setBrush(const QBrush &brush)
+/* inherits documentation from base class */
+void QCPTextElement::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
 {
-  mBrush = brush;
+  Q_UNUSED(event)
+  Q_UNUSED(details)
+  if (mSelectable)
+  {
+    bool selBefore = mSelected;
+    setSelected(additive ? !mSelected : true);
+    if (selectionStateChanged)
+      *selectionStateChanged = mSelected != selBefore;
+  }
 }
 
-/*!
-  Sets the default font of legend text. Legend items that draw text (e.g. the name of a graph) will
-  use this font by default. However, a different font can be specified on a per-item-basis by
-  accessing the specific legend item.
-  
-  This function will also set \a font on all already existing legend items.
-  
-  \see QCPAbstractLegendItem::setFont
-*/
-void QCPLegend::setFont(const QFont &font)
+/* inherits documentation from base class */
+void QCPTextElement::deselectEvent(bool *selectionStateChanged)
 {
-  mFont = font;
-  for (int i=0; i<itemCount(); ++i)
+  if (mSelectable)
   {
-    if (item(i))
-      item(i)->setFont(mFont);
+    bool selBefore = mSelected;
+    setSelected(false);
+    if (selectionStateChanged)
+      *selectionStateChanged = mSelected != selBefore;
   }
 }
 
 /*!
-  Sets the default color of legend text. Legend items that draw text (e.g. the name of a graph)
-  will use this color by default. However, a different colors can be specified on a per-item-basis
-  by accessing the specific legend item.
-  
-  This function will also set \a color on all already existing legend items.
-  
-  \see QCPAbstractLegendItem::setTextColor
+  Returns 0.99*selectionTolerance (see \ref QCustomPlot::setSelectionTolerance) when \a pos is
+  within the bounding box of the text element's text. Note that this bounding box is updated in the
+  draw call.
+
+  If \a pos is outside the text's bounding box or if \a onlySelectable is true and this text
+  element is not selectable (\ref setSelectable), returns -1.
+
+  \seebaseclassmethod
 */
-void QCPLegend::setTextColor(const QColor &color)
+double QCPTextElement::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
-  mTextColor = color;
-  for (int i=0; i<itemCount(); ++i)
-  {
-    if (item(i))
-      item(i)->setTextColor(color);
-  }
+  Q_UNUSED(details)
+  if (onlySelectable && !mSelectable)
+    return -1;
+  
+  if (mTextBoundingRect.contains(pos.toPoint()))
+    return mParentPlot->selectionTolerance()*0.99;
+  else
+    return -1;
 }
 
 /*!
-  Sets the size of legend icons. Legend items that draw an icon (e.g. a visual
-  representation of the graph) will use this size by default.
+  Accepts the mouse event in order to emit the according click signal in the \ref
+  mouseReleaseEvent.
+
+  \seebaseclassmethod
 */
-void QCPLegend::setIconSize(const QSize &size)
+void QCPTextElement::mousePressEvent(QMouseEvent *event, const QVariant &details)
 {
-  mIconSize = size;
+  Q_UNUSED(details)
+  event->accept();
 }
 
-/*! \overload
+/*!
+  Emits the \ref clicked signal if the cursor hasn't moved by more than a few pixels since the \ref
+  mousePressEvent.
+
+  \seebaseclassmethod
 */
-void QCPLegend::setIconSize(int width, int height)
+void QCPTextElement::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
 {
-  mIconSize.setWidth(width);
-  mIconSize.setHeight(height);
+  if ((QPointF(event->pos())-startPos).manhattanLength() <= 3)
+    emit clicked(event);
 }
 
 /*!
-  Sets the horizontal space in pixels between the legend icon and the text next to it.
-  Legend items that draw an icon (e.g. a visual representation of the graph) and text (e.g. the
-  name of the graph) will use this space by default.
+  Emits the \ref doubleClicked signal.
+
+  \seebaseclassmethod
 */
-void QCPLegend::setIconTextPadding(int padding)
+void QCPTextElement::mouseDoubleClickEvent(QMouseEvent *event, const QVariant &details)
 {
-  mIconTextPadding = padding;
+  Q_UNUSED(details)
+  emit doubleClicked(event);
 }
 
-/*!
-  Sets the pen used to draw a border around each legend icon. Legend items that draw an
-  icon (e.g. a visual representation of the graph) will use this pen by default.
+/*! \internal
   
-  If no border is wanted, set this to \a Qt::NoPen.
+  Returns the main font to be used. This is mSelectedFont if \ref setSelected is set to
+  <tt>true</tt>, else mFont is returned.
 */
-void QCPLegend::setIconBorderPen(const QPen &pen)
+QFont QCPTextElement::mainFont() const
 {
-  mIconBorderPen = pen;
+  return mSelected ? mSelectedFont : mFont;
 }
 
-/*!
-  Sets whether the user can (de-)select the parts in \a selectable by clicking on the QCustomPlot surface.
-  (When \ref QCustomPlot::setInteractions contains \ref QCP::iSelectLegend.)
-  
-  However, even when \a selectable is set to a value not allowing the selection of a specific part,
-  it is still possible to set the selection of this part manually, by calling \ref setSelectedParts
-  directly.
+/*! \internal
   
-  \see SelectablePart, setSelectedParts
+  Returns the main color to be used. This is mSelectedTextColor if \ref setSelected is set to
+  <tt>true</tt>, else mTextColor is returned.
 */
-void QCPLegend::setSelectableParts(const SelectableParts &selectable)
+QColor QCPTextElement::mainTextColor() const
 {
-  if (mSelectableParts != selectable)
-  {
-    mSelectableParts = selectable;
-    emit selectableChanged(mSelectableParts);
-  }
+  return mSelected ? mSelectedTextColor : mTextColor;
 }
+/* end of 'src/layoutelements/layoutelement-textelement.cpp' */
 
-/*!
-  Sets the selected state of the respective legend parts described by \ref SelectablePart. When a part
-  is selected, it uses a different pen/font and brush. If some legend items are selected and \a selected
-  doesn't contain \ref spItems, those items become deselected.
+
+/* including file 'src/layoutelements/layoutelement-colorscale.cpp', size 25910 */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200    */
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorScale
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorScale
+  \brief A color scale for use with color coding data such as QCPColorMap
   
-  The entire selection mechanism is handled automatically when \ref QCustomPlot::setInteractions
-  contains iSelectLegend. You only need to call this function when you wish to change the selection
-  state manually.
+  This layout element can be placed on the plot to correlate a color gradient with data values. It
+  is usually used in combination with one or multiple \ref QCPColorMap "QCPColorMaps".
+
+  \image html QCPColorScale.png
   
-  This function can change the selection state of a part even when \ref setSelectableParts was set to a
-  value that actually excludes the part.
+  The color scale can be either horizontal or vertical, as shown in the image above. The
+  orientation and the side where the numbers appear is controlled with \ref setType.
   
-  emits the \ref selectionChanged signal when \a selected is different from the previous selection state.
+  Use \ref QCPColorMap::setColorScale to connect a color map with a color scale. Once they are
+  connected, they share their gradient, data range and data scale type (\ref setGradient, \ref
+  setDataRange, \ref setDataScaleType). Multiple color maps may be associated with a single color
+  scale, to make them all synchronize these properties.
   
-  Note that it doesn't make sense to set the selected state \ref spItems here when it wasn't set
-  before, because there's no way to specify which exact items to newly select. Do this by calling
-  \ref QCPAbstractLegendItem::setSelected directly on the legend item you wish to select.
+  To have finer control over the number display and axis behaviour, you can directly access the
+  \ref axis. See the documentation of QCPAxis for details about configuring axes. For example, if
+  you want to change the number of automatically generated ticks, call
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorscale-tickcount
   
-  \see SelectablePart, setSelectableParts, selectTest, setSelectedBorderPen, setSelectedIconBorderPen, setSelectedBrush,
-  setSelectedFont
+  Placing a color scale next to the main axis rect works like with any other layout element:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorscale-creation
+  In this case we have placed it to the right of the default axis rect, so it wasn't necessary to
+  call \ref setType, since \ref QCPAxis::atRight is already the default. The text next to the color
+  scale can be set with \ref setLabel.
+  
+  For optimum appearance (like in the image above), it may be desirable to line up the axis rect and
+  the borders of the color scale. Use a \ref QCPMarginGroup to achieve this:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorscale-margingroup
+  
+  Color scales are initialized with a non-zero minimum top and bottom margin (\ref
+  setMinimumMargins), because vertical color scales are most common and the minimum top/bottom
+  margin makes sure it keeps some distance to the top/bottom widget border. So if you change to a
+  horizontal color scale by setting \ref setType to \ref QCPAxis::atBottom or \ref QCPAxis::atTop, you
+  might want to also change the minimum margins accordingly, e.g. <tt>setMinimumMargins(QMargins(6, 0, 6, 0))</tt>.
 */
-void QCPLegend::setSelectedParts(const SelectableParts &selected)
-{
-  SelectableParts newSelected = selected;
-  mSelectedParts = this->selectedParts(); // update mSelectedParts in case item selection changed
 
-  if (mSelectedParts != newSelected)
-  {
-    if (!mSelectedParts.testFlag(spItems) && newSelected.testFlag(spItems)) // attempt to set spItems flag (can't do that)
-    {
-      qDebug() << Q_FUNC_INFO << "spItems flag can not be set, it can only be unset with this function";
-      newSelected &= ~spItems;
-    }
-    if (mSelectedParts.testFlag(spItems) && !newSelected.testFlag(spItems)) // spItems flag was unset, so clear item selection
-    {
-      for (int i=0; i<itemCount(); ++i)
-      {
-        if (item(i))
-          item(i)->setSelected(false);
-      }
-    }
-    mSelectedParts = newSelected;
-    emit selectionChanged(mSelectedParts);
-  }
-}
+/* start documentation of inline functions */
 
-/*!
-  When the legend box is selected, this pen is used to draw the border instead of the normal pen
-  set via \ref setBorderPen.
+/*! \fn QCPAxis *QCPColorScale::axis() const
+  
+  Returns the internal \ref QCPAxis instance of this color scale. You can access it to alter the
+  appearance and behaviour of the axis. \ref QCPColorScale duplicates some properties in its
+  interface for convenience. Those are \ref setDataRange (\ref QCPAxis::setRange), \ref
+  setDataScaleType (\ref QCPAxis::setScaleType), and the method \ref setLabel (\ref
+  QCPAxis::setLabel). As they each are connected, it does not matter whether you use the method on
+  the QCPColorScale or on its QCPAxis.
+  
+  If the type of the color scale is changed with \ref setType, the axis returned by this method
+  will change, too, to either the left, right, bottom or top axis, depending on which type was set.
+*/
 
-  \see setSelectedParts, setSelectableParts, setSelectedBrush
+/* end documentation of signals */
+/* start documentation of signals */
+
+/*! \fn void QCPColorScale::dataRangeChanged(const QCPRange &newRange);
+  
+  This signal is emitted when the data range changes.
+  
+  \see setDataRange
+*/
+
+/*! \fn void QCPColorScale::dataScaleTypeChanged(QCPAxis::ScaleType scaleType);
+  
+  This signal is emitted when the data scale type changes.
+  
+  \see setDataScaleType
+*/
+
+/*! \fn void QCPColorScale::gradientChanged(const QCPColorGradient &newGradient);
+  
+  This signal is emitted when the gradient changes.
+  
+  \see setGradient
 */
-void QCPLegend::setSelectedBorderPen(const QPen &pen)
-{
-  mSelectedBorderPen = pen;
-}
 
-/*!
-  Sets the pen legend items will use to draw their icon borders, when they are selected.
+/* end documentation of signals */
 
-  \see setSelectedParts, setSelectableParts, setSelectedFont
+/*!
+  Constructs a new QCPColorScale.
 */
-void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
+QCPColorScale::QCPColorScale(QCustomPlot *parentPlot) :
+  QCPLayoutElement(parentPlot),
+  mType(QCPAxis::atTop), // set to atTop such that setType(QCPAxis::atRight) below doesn't skip work because it thinks it's already atRight
+  mDataScaleType(QCPAxis::stLinear),
+  mBarWidth(20),
+  mAxisRect(new QCPColorScaleAxisRectPrivate(this))
 {
-  mSelectedIconBorderPen = pen;
+  setMinimumMargins(QMargins(0, 6, 0, 6)); // for default right color scale types, keep some room at bottom and top (important if no margin group is used)
+  setType(QCPAxis::atRight);
+  setDataRange(QCPRange(0, 6));
 }
 
-/*!
-  When the legend box is selected, this brush is used to draw the legend background instead of the normal brush
-  set via \ref setBrush.
-
-  \see setSelectedParts, setSelectableParts, setSelectedBorderPen
-*/
-void QCPLegend::setSelectedBrush(const QBrush &brush)
+QCPColorScale::~QCPColorScale()
 {
-  mSelectedBrush = brush;
+  delete mAxisRect;
 }
 
-/*!
-  Sets the default font that is used by legend items when they are selected.
-  
-  This function will also set \a font on all already existing legend items.
-
-  \see setFont, QCPAbstractLegendItem::setSelectedFont
-*/
-void QCPLegend::setSelectedFont(const QFont &font)
+/* undocumented getter */
+QString QCPColorScale::label() const
 {
-  mSelectedFont = font;
-  for (int i=0; i<itemCount(); ++i)
+  if (!mColorAxis)
   {
-    if (item(i))
-      item(i)->setSelectedFont(font);
+    qDebug() << Q_FUNC_INFO << "internal color axis undefined";
+    return QString();
   }
-}
-
-/*!
-  Sets the default text color that is used by legend items when they are selected.
   
-  This function will also set \a color on all already existing legend items.
+  return mColorAxis.data()->label();
+}
 
-  \see setTextColor, QCPAbstractLegendItem::setSelectedTextColor
-*/
-void QCPLegend::setSelectedTextColor(const QColor &color)
+/* undocumented getter */
+bool QCPColorScale::rangeDrag() const
 {
-  mSelectedTextColor = color;
-  for (int i=0; i<itemCount(); ++i)
+  if (!mAxisRect)
   {
-    if (item(i))
-      item(i)->setSelectedTextColor(color);
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return false;
   }
+  
+  return mAxisRect.data()->rangeDrag().testFlag(QCPAxis::orientation(mType)) &&
+      mAxisRect.data()->rangeDragAxis(QCPAxis::orientation(mType)) &&
+      mAxisRect.data()->rangeDragAxis(QCPAxis::orientation(mType))->orientation() == QCPAxis::orientation(mType);
 }
 
-/*!
-  Returns the item with index \a i.
-
-  Note that the linear index depends on the current fill order (\ref setFillOrder).
-
-  \see itemCount, addItem, itemWithPlottable
-*/
-QCPAbstractLegendItem *QCPLegend::item(int index) const
+/* undocumented getter */
+bool QCPColorScale::rangeZoom() const
 {
-  return qobject_cast<QCPAbstractLegendItem*>(elementAt(index));
+  if (!mAxisRect)
+  {
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return false;
+  }
+  
+  return mAxisRect.data()->rangeZoom().testFlag(QCPAxis::orientation(mType)) &&
+      mAxisRect.data()->rangeZoomAxis(QCPAxis::orientation(mType)) &&
+      mAxisRect.data()->rangeZoomAxis(QCPAxis::orientation(mType))->orientation() == QCPAxis::orientation(mType);
 }
 
 /*!
-  Returns the QCPPlottableLegendItem which is associated with \a plottable (e.g. a \ref QCPGraph*).
-  If such an item isn't in the legend, returns 0.
+  Sets at which side of the color scale the axis is placed, and thus also its orientation.
   
-  \see hasItemWithPlottable
+  Note that after setting \a type to a different value, the axis returned by \ref axis() will
+  be a different one. The new axis will adopt the following properties from the previous axis: The
+  range, scale type, label and ticker (the latter will be shared and not copied).
 */
-QCPPlottableLegendItem *QCPLegend::itemWithPlottable(const QCPAbstractPlottable *plottable) const
+void QCPColorScale::setType(QCPAxis::AxisType type)
 {
-  for (int i=0; i<itemCount(); ++i)
+  if (!mAxisRect)
   {
-    if (QCPPlottableLegendItem *pli = qobject_cast<QCPPlottableLegendItem*>(item(i)))
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
+  }
+  if (mType != type)
+  {
+    mType = type;
+    QCPRange rangeTransfer(0, 6);
+    QString labelTransfer;
+    QSharedPointer<QCPAxisTicker> tickerTransfer;
+    // transfer/revert some settings on old axis if it exists:
+    bool doTransfer = (bool)mColorAxis;
+    if (doTransfer)
     {
-      if (pli->plottable() == plottable)
-        return pli;
+      rangeTransfer = mColorAxis.data()->range();
+      labelTransfer = mColorAxis.data()->label();
+      tickerTransfer = mColorAxis.data()->ticker();
+      mColorAxis.data()->setLabel(QString());
+      disconnect(mColorAxis.data(), SIGNAL(rangeChanged(QCPRange)), this, SLOT(setDataRange(QCPRange)));
+      disconnect(mColorAxis.data(), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
+    }
+    QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atLeft << QCPAxis::atRight << QCPAxis::atBottom << QCPAxis::atTop;
+    foreach (QCPAxis::AxisType atype, allAxisTypes)
+    {
+      mAxisRect.data()->axis(atype)->setTicks(atype == mType);
+      mAxisRect.data()->axis(atype)->setTickLabels(atype== mType);
+    }
+    // set new mColorAxis pointer:
+    mColorAxis = mAxisRect.data()->axis(mType);
+    // transfer settings to new axis:
+    if (doTransfer)
+    {
+      mColorAxis.data()->setRange(rangeTransfer); // range transfer necessary if axis changes from vertical to horizontal or vice versa (axes with same orientation are synchronized via signals)
+      mColorAxis.data()->setLabel(labelTransfer);
+      mColorAxis.data()->setTicker(tickerTransfer);
     }
+    connect(mColorAxis.data(), SIGNAL(rangeChanged(QCPRange)), this, SLOT(setDataRange(QCPRange)));
+    connect(mColorAxis.data(), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
+    mAxisRect.data()->setRangeDragAxes(QList<QCPAxis*>() << mColorAxis.data());
   }
-  return 0;
-}
-
-/*!
-  Returns the number of items currently in the legend.
-
-  Note that if empty cells are in the legend (e.g. by calling methods of the \ref QCPLayoutGrid
-  base class which allows creating empty cells), they are included in the returned count.
-
-  \see item
-*/
-int QCPLegend::itemCount() const
-{
-  return elementCount();
 }
 
 /*!
-  Returns whether the legend contains \a item.
+  Sets the range spanned by the color gradient and that is shown by the axis in the color scale.
   
-  \see hasItemWithPlottable
+  It is equivalent to calling QCPColorMap::setDataRange on any of the connected color maps. It is
+  also equivalent to directly accessing the \ref axis and setting its range with \ref
+  QCPAxis::setRange.
+  
+  \see setDataScaleType, setGradient, rescaleDataRange
 */
-bool QCPLegend::hasItem(QCPAbstractLegendItem *item) const
+void QCPColorScale::setDataRange(const QCPRange &dataRange)
 {
-  for (int i=0; i<itemCount(); ++i)
+  if (mDataRange.lower != dataRange.lower || mDataRange.upper != dataRange.upper)
   {
-    if (item == this->item(i))
-        return true;
+    mDataRange = dataRange;
+    if (mColorAxis)
+      mColorAxis.data()->setRange(mDataRange);
+    emit dataRangeChanged(mDataRange);
   }
-  return false;
 }
 
 /*!
-  Returns whether the legend contains a QCPPlottableLegendItem which is associated with \a plottable (e.g. a \ref QCPGraph*).
-  If such an item isn't in the legend, returns false.
+  Sets the scale type of the color scale, i.e. whether values are linearly associated with colors
+  or logarithmically.
   
-  \see itemWithPlottable
-*/
-bool QCPLegend::hasItemWithPlottable(const QCPAbstractPlottable *plottable) const
-{
-  return itemWithPlottable(plottable);
-}
-
-/*!
-  Adds \a item to the legend, if it's not present already. The element is arranged according to the
-  current fill order (\ref setFillOrder) and wrapping (\ref setWrap).
-
-  Returns true on sucess, i.e. if the item wasn't in the list already and has been successfuly added.
-
-  The legend takes ownership of the item.
-
-  \see removeItem, item, hasItem
-*/
-bool QCPLegend::addItem(QCPAbstractLegendItem *item)
-{
-  return addElement(item);
-}
-
-/*! \overload
-
-  Removes the item with the specified \a index from the legend and deletes it.
-
-  After successful removal, the legend is reordered according to the current fill order (\ref
-  setFillOrder) and wrapping (\ref setWrap), so no empty cell remains where the removed \a item
-  was. If you don't want this, rather use the raw element interface of \ref QCPLayoutGrid.
-
-  Returns true, if successful. Unlike \ref QCPLayoutGrid::removeAt, this method only removes
-  elements derived from \ref QCPAbstractLegendItem.
-
-  \see itemCount, clearItems
-*/
-bool QCPLegend::removeItem(int index)
-{
-  if (QCPAbstractLegendItem *ali = item(index))
-  {
-    bool success = remove(ali);
-    if (success)
-      setFillOrder(fillOrder(), true); // gets rid of empty cell by reordering
-    return success;
-  } else
-    return false;
-}
-
-/*! \overload
-
-  Removes \a item from the legend and deletes it.
-
-  After successful removal, the legend is reordered according to the current fill order (\ref
-  setFillOrder) and wrapping (\ref setWrap), so no empty cell remains where the removed \a item
-  was. If you don't want this, rather use the raw element interface of \ref QCPLayoutGrid.
-
-  Returns true, if successful.
-
-  \see clearItems
-*/
-bool QCPLegend::removeItem(QCPAbstractLegendItem *item)
-{
-  bool success = remove(item);
-  if (success)
-    setFillOrder(fillOrder(), true); // gets rid of empty cell by reordering
-  return success;
-}
-
-/*!
-  Removes all items from the legend.
-*/
-void QCPLegend::clearItems()
-{
-  for (int i=itemCount()-1; i>=0; --i)
-    removeItem(i);
-}
-
-/*!
-  Returns the legend items that are currently selected. If no items are selected,
-  the list is empty.
+  It is equivalent to calling QCPColorMap::setDataScaleType on any of the connected color maps. It is
+  also equivalent to directly accessing the \ref axis and setting its scale type with \ref
+  QCPAxis::setScaleType.
   
-  \see QCPAbstractLegendItem::setSelected, setSelectable
+  \see setDataRange, setGradient
 */
-QList<QCPAbstractLegendItem *> QCPLegend::selectedItems() const
+void QCPColorScale::setDataScaleType(QCPAxis::ScaleType scaleType)
 {
-  QList<QCPAbstractLegendItem*> result;
-  for (int i=0; i<itemCount(); ++i)
+  if (mDataScaleType != scaleType)
   {
-    if (QCPAbstractLegendItem *ali = item(i))
-    {
-      if (ali->selected())
-        result.append(ali);
-    }
+    mDataScaleType = scaleType;
+    if (mColorAxis)
+      mColorAxis.data()->setScaleType(mDataScaleType);
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      setDataRange(mDataRange.sanitizedForLogScale());
+    emit dataScaleTypeChanged(mDataScaleType);
   }
-  return result;
 }
 
-/*! \internal
-
-  A convenience function to easily set the QPainter::Antialiased hint on the provided \a painter
-  before drawing main legend elements.
-
-  This is the antialiasing state the painter passed to the \ref draw method is in by default.
-  
-  This function takes into account the local setting of the antialiasing flag as well as the
-  overrides set with \ref QCustomPlot::setAntialiasedElements and \ref
-  QCustomPlot::setNotAntialiasedElements.
+/*!
+  Sets the color gradient that will be used to represent data values.
   
-  \seebaseclassmethod
+  It is equivalent to calling QCPColorMap::setGradient on any of the connected color maps.
   
-  \see setAntialiased
+  \see setDataRange, setDataScaleType
 */
-void QCPLegend::applyDefaultAntialiasingHint(QCPPainter *painter) const
+void QCPColorScale::setGradient(const QCPColorGradient &gradient)
 {
-  applyAntialiasingHint(painter, mAntialiased, QCP::aeLegend);
+  if (mGradient != gradient)
+  {
+    mGradient = gradient;
+    if (mAxisRect)
+      mAxisRect.data()->mGradientImageInvalidated = true;
+    emit gradientChanged(mGradient);
+  }
 }
 
-/*! \internal
-  
-  Returns the pen used to paint the border of the legend, taking into account the selection state
-  of the legend box.
+/*!
+  Sets the axis label of the color scale. This is equivalent to calling \ref QCPAxis::setLabel on
+  the internal \ref axis.
 */
-QPen QCPLegend::getBorderPen() const
+void QCPColorScale::setLabel(const QString &str)
 {
-  return mSelectedParts.testFlag(spLegendBox) ? mSelectedBorderPen : mBorderPen;
+  if (!mColorAxis)
+  {
+    qDebug() << Q_FUNC_INFO << "internal color axis undefined";
+    return;
+  }
+  
+  mColorAxis.data()->setLabel(str);
 }
 
-/*! \internal
-  
-  Returns the brush used to paint the background of the legend, taking into account the selection
-  state of the legend box.
+/*!
+  Sets the width (or height, for horizontal color scales) the bar where the gradient is displayed
+  will have.
 */
-QBrush QCPLegend::getBrush() const
+void QCPColorScale::setBarWidth(int width)
 {
-  return mSelectedParts.testFlag(spLegendBox) ? mSelectedBrush : mBrush;
+  mBarWidth = width;
 }
 
-/*! \internal
+/*!
+  Sets whether the user can drag the data range (\ref setDataRange).
   
-  Draws the legend box with the provided \a painter. The individual legend items are layerables
-  themselves, thus are drawn independently.
+  Note that \ref QCP::iRangeDrag must be in the QCustomPlot's interactions (\ref
+  QCustomPlot::setInteractions) to allow range dragging.
 */
-void QCPLegend::draw(QCPPainter *painter)
-{
-  // draw background rect:
-  painter->setBrush(getBrush());
-  painter->setPen(getBorderPen());
-  painter->drawRect(mOuterRect);
-}
-
-/* inherits documentation from base class */
-double QCPLegend::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+void QCPColorScale::setRangeDrag(bool enabled)
 {
-  if (!mParentPlot) return -1;
-  if (onlySelectable && !mSelectableParts.testFlag(spLegendBox))
-    return -1;
-  
-  if (mOuterRect.contains(pos.toPoint()))
+  if (!mAxisRect)
   {
-    if (details) details->setValue(spLegendBox);
-    return mParentPlot->selectionTolerance()*0.99;
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
   }
-  return -1;
+  
+  if (enabled)
+    mAxisRect.data()->setRangeDrag(QCPAxis::orientation(mType));
+  else
+    mAxisRect.data()->setRangeDrag(0);
 }
 
-/* inherits documentation from base class */
-void QCPLegend::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
+/*!
+  Sets whether the user can zoom the data range (\ref setDataRange) by scrolling the mouse wheel.
+  
+  Note that \ref QCP::iRangeZoom must be in the QCustomPlot's interactions (\ref
+  QCustomPlot::setInteractions) to allow range dragging.
+*/
+void QCPColorScale::setRangeZoom(bool enabled)
 {
-  Q_UNUSED(event)
-  mSelectedParts = selectedParts(); // in case item selection has changed
-  if (details.value<SelectablePart>() == spLegendBox && mSelectableParts.testFlag(spLegendBox))
+  if (!mAxisRect)
   {
-    SelectableParts selBefore = mSelectedParts;
-    setSelectedParts(additive ? mSelectedParts^spLegendBox : mSelectedParts|spLegendBox); // no need to unset spItems in !additive case, because they will be deselected by QCustomPlot (they're normal QCPLayerables with own deselectEvent)
-    if (selectionStateChanged)
-      *selectionStateChanged = mSelectedParts != selBefore;
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
   }
+  
+  if (enabled)
+    mAxisRect.data()->setRangeZoom(QCPAxis::orientation(mType));
+  else
+    mAxisRect.data()->setRangeZoom(0);
 }
 
-/* inherits documentation from base class */
-void QCPLegend::deselectEvent(bool *selectionStateChanged)
+/*!
+  Returns a list of all the color maps associated with this color scale.
+*/
+QList<QCPColorMap*> QCPColorScale::colorMaps() const
 {
-  mSelectedParts = selectedParts(); // in case item selection has changed
-  if (mSelectableParts.testFlag(spLegendBox))
+  QList<QCPColorMap*> result;
+  for (int i=0; i<mParentPlot->plottableCount(); ++i)
   {
-    SelectableParts selBefore = mSelectedParts;
-    setSelectedParts(selectedParts() & ~spLegendBox);
-    if (selectionStateChanged)
-      *selectionStateChanged = mSelectedParts != selBefore;
+    if (QCPColorMap *cm = qobject_cast<QCPColorMap*>(mParentPlot->plottable(i)))
+      if (cm->colorScale() == this)
+        result.append(cm);
   }
+  return result;
 }
 
-/* inherits documentation from base class */
-QCP::Interaction QCPLegend::selectionCategory() const
-{
-  return QCP::iSelectLegend;
-}
-
-/* inherits documentation from base class */
-QCP::Interaction QCPAbstractLegendItem::selectionCategory() const
+/*!
+  Changes the data range such that all color maps associated with this color scale are fully mapped
+  to the gradient in the data dimension.
+  
+  \see setDataRange
+*/
+void QCPColorScale::rescaleDataRange(bool onlyVisibleMaps)
 {
-  return QCP::iSelectLegend;
+  QList<QCPColorMap*> maps = colorMaps();
+  QCPRange newRange;
+  bool haveRange = false;
+  QCP::SignDomain sign = QCP::sdBoth;
+  if (mDataScaleType == QCPAxis::stLogarithmic)
+    sign = (mDataRange.upper < 0 ? QCP::sdNegative : QCP::sdPositive);
+  for (int i=0; i<maps.size(); ++i)
+  {
+    if (!maps.at(i)->realVisibility() && onlyVisibleMaps)
+      continue;
+    QCPRange mapRange;
+    if (maps.at(i)->colorScale() == this)
+    {
+      bool currentFoundRange = true;
+      mapRange = maps.at(i)->data()->dataBounds();
+      if (sign == QCP::sdPositive)
+      {
+        if (mapRange.lower <= 0 && mapRange.upper > 0)
+          mapRange.lower = mapRange.upper*1e-3;
+        else if (mapRange.lower <= 0 && mapRange.upper <= 0)
+          currentFoundRange = false;
+      } else if (sign == QCP::sdNegative)
+      {
+        if (mapRange.upper >= 0 && mapRange.lower < 0)
+          mapRange.upper = mapRange.lower*1e-3;
+        else if (mapRange.upper >= 0 && mapRange.lower >= 0)
+          currentFoundRange = false;
+      }
+      if (currentFoundRange)
+      {
+        if (!haveRange)
+          newRange = mapRange;
+        else
+          newRange.expand(mapRange);
+        haveRange = true;
+      }
+    }
+  }
+  if (haveRange)
+  {
+    if (!QCPRange::validRange(newRange)) // likely due to range being zero (plottable has only constant data in this dimension), shift current range to at least center the data
+    {
+      double center = (newRange.lower+newRange.upper)*0.5; // upper and lower should be equal anyway, but just to make sure, incase validRange returned false for other reason
+      if (mDataScaleType == QCPAxis::stLinear)
+      {
+        newRange.lower = center-mDataRange.size()/2.0;
+        newRange.upper = center+mDataRange.size()/2.0;
+      } else // mScaleType == stLogarithmic
+      {
+        newRange.lower = center/qSqrt(mDataRange.upper/mDataRange.lower);
+        newRange.upper = center*qSqrt(mDataRange.upper/mDataRange.lower);
+      }
+    }
+    setDataRange(newRange);
+  }
 }
 
 /* inherits documentation from base class */
-void QCPLegend::parentPlotInitialized(QCustomPlot *parentPlot)
+void QCPColorScale::update(UpdatePhase phase)
 {
-  if (parentPlot && !parentPlot->legend)
-    parentPlot->legend = this;
-}
-/* end of 'src/layoutelements/layoutelement-legend.cpp' */
-
-
-/* including file 'src/layoutelements/layoutelement-textelement.cpp', size 12759 */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200     */
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPTextElement
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPTextElement
-  \brief A layout element displaying a text
-
-  The text may be specified with \ref setText, the formatting can be controlled with \ref setFont,
-  \ref setTextColor, and \ref setTextFlags.
-
-  A text element can be added as follows:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcptextelement-creation
-*/
-
-/* start documentation of signals */
-
-/*! \fn void QCPTextElement::selectionChanged(bool selected)
+  QCPLayoutElement::update(phase);
+  if (!mAxisRect)
+  {
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
+  }
   
-  This signal is emitted when the selection state has changed to \a selected, either by user
-  interaction or by a direct call to \ref setSelected.
+  mAxisRect.data()->update(phase);
   
-  \see setSelected, setSelectable
-*/
-
-/*! \fn void QCPTextElement::clicked(QMouseEvent *event)
-
-  This signal is emitted when the text element is clicked.
-
-  \see doubleClicked, selectTest
-*/
-
-/*! \fn void QCPTextElement::doubleClicked(QMouseEvent *event)
-
-  This signal is emitted when the text element is double clicked.
-
-  \see clicked, selectTest
-*/
+  switch (phase)
+  {
+    case upMargins:
+    {
+      if (mType == QCPAxis::atBottom || mType == QCPAxis::atTop)
+      {
+        setMaximumSize(QWIDGETSIZE_MAX, mBarWidth+mAxisRect.data()->margins().top()+mAxisRect.data()->margins().bottom()+margins().top()+margins().bottom());
+        setMinimumSize(0,               mBarWidth+mAxisRect.data()->margins().top()+mAxisRect.data()->margins().bottom()+margins().top()+margins().bottom());
+      } else
+      {
+        setMaximumSize(mBarWidth+mAxisRect.data()->margins().left()+mAxisRect.data()->margins().right()+margins().left()+margins().right(), QWIDGETSIZE_MAX);
+        setMinimumSize(mBarWidth+mAxisRect.data()->margins().left()+mAxisRect.data()->margins().right()+margins().left()+margins().right(), 0);
+      }
+      break;
+    }
+    case upLayout:
+    {
+      mAxisRect.data()->setOuterRect(rect());
+      break;
+    }
+    default: break;
+  }
+}
 
-/* end documentation of signals */
+/* inherits documentation from base class */
+void QCPColorScale::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+  painter->setAntialiasing(false);
+}
 
-/*! \overload
-  
-  Creates a new QCPTextElement instance and sets default values. The initial text is empty (\ref
-  setText).
-*/
-QCPTextElement::QCPTextElement(QCustomPlot *parentPlot) :
-  QCPLayoutElement(parentPlot),
-  mText(),
-  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
-  mFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
-  mTextColor(Qt::black),
-  mSelectedFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
-  mSelectedTextColor(Qt::blue),
-  mSelectable(false),
-  mSelected(false)
+/* inherits documentation from base class */
+void QCPColorScale::mousePressEvent(QMouseEvent *event, const QVariant &details)
 {
-  if (parentPlot)
+  if (!mAxisRect)
   {
-    mFont = parentPlot->font();
-    mSelectedFont = parentPlot->font();
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
   }
-  setMargins(QMargins(2, 2, 2, 2));
+  mAxisRect.data()->mousePressEvent(event, details);
 }
 
-/*! \overload
-  
-  Creates a new QCPTextElement instance and sets default values.
-
-  The initial text is set to \a text.
-*/
-QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text) :
-  QCPLayoutElement(parentPlot),
-  mText(text),
-  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
-  mFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
-  mTextColor(Qt::black),
-  mSelectedFont(QFont(QLatin1String("sans serif"), 12)), // will be taken from parentPlot if available, see below
-  mSelectedTextColor(Qt::blue),
-  mSelectable(false),
-  mSelected(false)
+/* inherits documentation from base class */
+void QCPColorScale::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
 {
-  if (parentPlot)
+  if (!mAxisRect)
   {
-    mFont = parentPlot->font();
-    mSelectedFont = parentPlot->font();
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
   }
-  setMargins(QMargins(2, 2, 2, 2));
+  mAxisRect.data()->mouseMoveEvent(event, startPos);
 }
 
-/*! \overload
-  
-  Creates a new QCPTextElement instance and sets default values.
-
-  The initial text is set to \a text with \a pointSize.
-*/
-QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, double pointSize) :
-  QCPLayoutElement(parentPlot),
-  mText(text),
-  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
-  mFont(QFont(QLatin1String("sans serif"), pointSize)), // will be taken from parentPlot if available, see below
-  mTextColor(Qt::black),
-  mSelectedFont(QFont(QLatin1String("sans serif"), pointSize)), // will be taken from parentPlot if available, see below
-  mSelectedTextColor(Qt::blue),
-  mSelectable(false),
-  mSelected(false)
+/* inherits documentation from base class */
+void QCPColorScale::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
 {
-  if (parentPlot)
+  if (!mAxisRect)
   {
-    mFont = parentPlot->font();
-    mFont.setPointSizeF(pointSize);
-    mSelectedFont = parentPlot->font();
-    mSelectedFont.setPointSizeF(pointSize);
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
   }
-  setMargins(QMargins(2, 2, 2, 2));
+  mAxisRect.data()->mouseReleaseEvent(event, startPos);
 }
 
-/*! \overload
-  
-  Creates a new QCPTextElement instance and sets default values.
-
-  The initial text is set to \a text with \a pointSize and the specified \a fontFamily.
-*/
-QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, const QString &fontFamily, double pointSize) :
-  QCPLayoutElement(parentPlot),
-  mText(text),
-  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
-  mFont(QFont(fontFamily, pointSize)),
-  mTextColor(Qt::black),
-  mSelectedFont(QFont(fontFamily, pointSize)),
-  mSelectedTextColor(Qt::blue),
-  mSelectable(false),
-  mSelected(false)
+/* inherits documentation from base class */
+void QCPColorScale::wheelEvent(QWheelEvent *event)
 {
-  setMargins(QMargins(2, 2, 2, 2));
+  if (!mAxisRect)
+  {
+    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    return;
+  }
+  mAxisRect.data()->wheelEvent(event);
 }
 
-/*! \overload
-  
-  Creates a new QCPTextElement instance and sets default values.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorScaleAxisRectPrivate
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  The initial text is set to \a text with the specified \a font.
-*/
-QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, const QFont &font) :
-  QCPLayoutElement(parentPlot),
-  mText(text),
-  mTextFlags(Qt::AlignCenter|Qt::TextWordWrap),
-  mFont(font),
-  mTextColor(Qt::black),
-  mSelectedFont(font),
-  mSelectedTextColor(Qt::blue),
-  mSelectable(false),
-  mSelected(false)
-{
-  setMargins(QMargins(2, 2, 2, 2));
-}
+/*! \class QCPColorScaleAxisRectPrivate
 
-/*!
-  Sets the text that will be displayed to \a text. Multiple lines can be created by insertion of "\n".
+  \internal
+  \brief An axis rect subclass for use in a QCPColorScale
   
-  \see setFont, setTextColor, setTextFlags
-*/
-void QCPTextElement::setText(const QString &text)
-{
-  mText = text;
-}
-
-/*!
-  Sets options for text alignment and wrapping behaviour. \a flags is a bitwise OR-combination of
-  \c Qt::AlignmentFlag and \c Qt::TextFlag enums.
+  This is a private class and not part of the public QCustomPlot interface.
   
-  Possible enums are:
-  - Qt::AlignLeft
-  - Qt::AlignRight
-  - Qt::AlignHCenter
-  - Qt::AlignJustify
-  - Qt::AlignTop
-  - Qt::AlignBottom
-  - Qt::AlignVCenter
-  - Qt::AlignCenter
-  - Qt::TextDontClip
-  - Qt::TextSingleLine
-  - Qt::TextExpandTabs
-  - Qt::TextShowMnemonic
-  - Qt::TextWordWrap
-  - Qt::TextIncludeTrailingSpaces
+  It provides the axis rect functionality for the QCPColorScale class.
 */
-void QCPTextElement::setTextFlags(int flags)
-{
-  mTextFlags = flags;
-}
 
-/*!
-  Sets the \a font of the text.
-  
-  \see setTextColor, setSelectedFont
-*/
-void QCPTextElement::setFont(const QFont &font)
-{
-  mFont = font;
-}
 
 /*!
-  Sets the \a color of the text.
-  
-  \see setFont, setSelectedTextColor
+  Creates a new instance, as a child of \a parentColorScale.
 */
-void QCPTextElement::setTextColor(const QColor &color)
+QCPColorScaleAxisRectPrivate::QCPColorScaleAxisRectPrivate(QCPColorScale *parentColorScale) :
+  QCPAxisRect(parentColorScale->parentPlot(), true),
+  mParentColorScale(parentColorScale),
+  mGradientImageInvalidated(true)
 {
-  mTextColor = color;
-}
+  setParentLayerable(parentColorScale);
+  setMinimumMargins(QMargins(0, 0, 0, 0));
+  QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atBottom << QCPAxis::atTop << QCPAxis::atLeft << QCPAxis::atRight;
+  foreach (QCPAxis::AxisType type, allAxisTypes)
+  {
+    axis(type)->setVisible(true);
+    axis(type)->grid()->setVisible(false);
+    axis(type)->setPadding(0);
+    connect(axis(type), SIGNAL(selectionChanged(QCPAxis::SelectableParts)), this, SLOT(axisSelectionChanged(QCPAxis::SelectableParts)));
+    connect(axis(type), SIGNAL(selectableChanged(QCPAxis::SelectableParts)), this, SLOT(axisSelectableChanged(QCPAxis::SelectableParts)));
+  }
 
-/*!
-  Sets the \a font of the text that will be used if the text element is selected (\ref setSelected).
+  connect(axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atRight), SLOT(setRange(QCPRange)));
+  connect(axis(QCPAxis::atRight), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atLeft), SLOT(setRange(QCPRange)));
+  connect(axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atTop), SLOT(setRange(QCPRange)));
+  connect(axis(QCPAxis::atTop), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atBottom), SLOT(setRange(QCPRange)));
+  connect(axis(QCPAxis::atLeft), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atRight), SLOT(setScaleType(QCPAxis::ScaleType)));
+  connect(axis(QCPAxis::atRight), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atLeft), SLOT(setScaleType(QCPAxis::ScaleType)));
+  connect(axis(QCPAxis::atBottom), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atTop), SLOT(setScaleType(QCPAxis::ScaleType)));
+  connect(axis(QCPAxis::atTop), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atBottom), SLOT(setScaleType(QCPAxis::ScaleType)));
   
-  \see setFont
-*/
-void QCPTextElement::setSelectedFont(const QFont &font)
-{
-  mSelectedFont = font;
+  // make layer transfers of color scale transfer to axis rect and axes
+  // the axes must be set after axis rect, such that they appear above color gradient drawn by axis rect:
+  connect(parentColorScale, SIGNAL(layerChanged(QCPLayer*)), this, SLOT(setLayer(QCPLayer*)));
+  foreach (QCPAxis::AxisType type, allAxisTypes)
+    connect(parentColorScale, SIGNAL(layerChanged(QCPLayer*)), axis(type), SLOT(setLayer(QCPLayer*)));
 }
 
-/*!
-  Sets the \a color of the text that will be used if the text element is selected (\ref setSelected).
+/*! \internal
   
-  \see setTextColor
+  Updates the color gradient image if necessary, by calling \ref updateGradientImage, then draws
+  it. Then the axes are drawn by calling the \ref QCPAxisRect::draw base class implementation.
+  
+  \seebaseclassmethod
 */
-void QCPTextElement::setSelectedTextColor(const QColor &color)
+void QCPColorScaleAxisRectPrivate::draw(QCPPainter *painter)
 {
-  mSelectedTextColor = color;
+  if (mGradientImageInvalidated)
+    updateGradientImage();
+  
+  bool mirrorHorz = false;
+  bool mirrorVert = false;
+  if (mParentColorScale->mColorAxis)
+  {
+    mirrorHorz = mParentColorScale->mColorAxis.data()->rangeReversed() && (mParentColorScale->type() == QCPAxis::atBottom || mParentColorScale->type() == QCPAxis::atTop);
+    mirrorVert = mParentColorScale->mColorAxis.data()->rangeReversed() && (mParentColorScale->type() == QCPAxis::atLeft || mParentColorScale->type() == QCPAxis::atRight);
+  }
+  
+  painter->drawImage(rect().adjusted(0, -1, 0, -1), mGradientImage.mirrored(mirrorHorz, mirrorVert));
+  QCPAxisRect::draw(painter);
 }
 
-/*!
-  Sets whether the user may select this text element.
+/*! \internal
 
-  Note that even when \a selectable is set to <tt>false</tt>, the selection state may be changed
-  programmatically via \ref setSelected.
+  Uses the current gradient of the parent \ref QCPColorScale (specified in the constructor) to
+  generate a gradient image. This gradient image will be used in the \ref draw method.
 */
-void QCPTextElement::setSelectable(bool selectable)
+void QCPColorScaleAxisRectPrivate::updateGradientImage()
 {
-  if (mSelectable != selectable)
+  if (rect().isEmpty())
+    return;
+  
+  const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+  int n = mParentColorScale->mGradient.levelCount();
+  int w, h;
+  QVector<double> data(n);
+  for (int i=0; i<n; ++i)
+    data[i] = i;
+  if (mParentColorScale->mType == QCPAxis::atBottom || mParentColorScale->mType == QCPAxis::atTop)
   {
-    mSelectable = selectable;
-    emit selectableChanged(mSelectable);
+    w = n;
+    h = rect().height();
+    mGradientImage = QImage(w, h, format);
+    QVector<QRgb*> pixels;
+    for (int y=0; y<h; ++y)
+      pixels.append(reinterpret_cast<QRgb*>(mGradientImage.scanLine(y)));
+    mParentColorScale->mGradient.colorize(data.constData(), QCPRange(0, n-1), pixels.first(), n);
+    for (int y=1; y<h; ++y)
+      memcpy(pixels.at(y), pixels.first(), n*sizeof(QRgb));
+  } else
+  {
+    w = rect().width();
+    h = n;
+    mGradientImage = QImage(w, h, format);
+    for (int y=0; y<h; ++y)
+    {
+      QRgb *pixels = reinterpret_cast<QRgb*>(mGradientImage.scanLine(y));
+      const QRgb lineColor = mParentColorScale->mGradient.color(data[h-1-y], QCPRange(0, n-1));
+      for (int x=0; x<w; ++x)
+        pixels[x] = lineColor;
+    }
   }
+  mGradientImageInvalidated = false;
 }
 
-/*!
-  Sets the selection state of this text element to \a selected. If the selection has changed, \ref
-  selectionChanged is emitted.
-  
-  Note that this function can change the selection state independently of the current \ref
-  setSelectable state.
+/*! \internal
+
+  This slot is connected to the selectionChanged signals of the four axes in the constructor. It
+  synchronizes the selection state of the axes.
 */
-void QCPTextElement::setSelected(bool selected)
+void QCPColorScaleAxisRectPrivate::axisSelectionChanged(QCPAxis::SelectableParts selectedParts)
 {
-  if (mSelected != selected)
+  // axis bases of four axes shall always (de-)selected synchronously:
+  QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atBottom << QCPAxis::atTop << QCPAxis::atLeft << QCPAxis::atRight;
+  foreach (QCPAxis::AxisType type, allAxisTypes)
   {
-    mSelected = selected;
-    emit selectionChanged(mSelected);
+    if (QCPAxis *senderAxis = qobject_cast<QCPAxis*>(sender()))
+      if (senderAxis->axisType() == type)
+        continue;
+    
+    if (axis(type)->selectableParts().testFlag(QCPAxis::spAxis))
+    {
+      if (selectedParts.testFlag(QCPAxis::spAxis))
+        axis(type)->setSelectedParts(axis(type)->selectedParts() | QCPAxis::spAxis);
+      else
+        axis(type)->setSelectedParts(axis(type)->selectedParts() & ~QCPAxis::spAxis);
+    }
   }
 }
 
-/* inherits documentation from base class */
-void QCPTextElement::applyDefaultAntialiasingHint(QCPPainter *painter) const
-{
-  applyAntialiasingHint(painter, mAntialiased, QCP::aeOther);
-}
+/*! \internal
 
-/* inherits documentation from base class */
-void QCPTextElement::draw(QCPPainter *painter)
+  This slot is connected to the selectableChanged signals of the four axes in the constructor. It
+  synchronizes the selectability of the axes.
+*/
+void QCPColorScaleAxisRectPrivate::axisSelectableChanged(QCPAxis::SelectableParts selectableParts)
 {
-  painter->setFont(mainFont());
-  painter->setPen(QPen(mainTextColor()));
-  painter->drawText(mRect, Qt::AlignCenter, mText, &mTextBoundingRect);
+  // synchronize axis base selectability:
+  QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atBottom << QCPAxis::atTop << QCPAxis::atLeft << QCPAxis::atRight;
+  foreach (QCPAxis::AxisType type, allAxisTypes)
+  {
+    if (QCPAxis *senderAxis = qobject_cast<QCPAxis*>(sender()))
+      if (senderAxis->axisType() == type)
+        continue;
+    
+    if (axis(type)->selectableParts().testFlag(QCPAxis::spAxis))
+    {
+      if (selectableParts.testFlag(QCPAxis::spAxis))
+        axis(type)->setSelectableParts(axis(type)->selectableParts() | QCPAxis::spAxis);
+      else
+        axis(type)->setSelectableParts(axis(type)->selectableParts() & ~QCPAxis::spAxis);
+    }
+  }
 }
+/* end of 'src/layoutelements/layoutelement-colorscale.cpp' */
 
-/* inherits documentation from base class */
-QSize QCPTextElement::minimumSizeHint() const
-{
-  QFontMetrics metrics(mFont);
-  QSize result = metrics.boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
-  result.rwidth() += mMargins.left() + mMargins.right();
-  result.rheight() += mMargins.top() + mMargins.bottom();
-  return result;
-}
 
-/* inherits documentation from base class */
-QSize QCPTextElement::maximumSizeHint() const
-{
-  QFontMetrics metrics(mFont);
-  QSize result = metrics.boundingRect(0, 0, 0, 0, Qt::AlignCenter, mText).size();
-  result.rheight() += mMargins.top() + mMargins.bottom();
-  result.setWidth(QWIDGETSIZE_MAX);
-  return result;
-}
+/* including file 'src/plottables/plottable-graph.cpp', size 72363           */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
-/* inherits documentation from base class */
-void QCPTextElement::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
-{
-  Q_UNUSED(event)
-  Q_UNUSED(details)
-  if (mSelectable)
-  {
-    bool selBefore = mSelected;
-    setSelected(additive ? !mSelected : true);
-    if (selectionStateChanged)
-      *selectionStateChanged = mSelected != selBefore;
-  }
-}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphData
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/* inherits documentation from base class */
-void QCPTextElement::deselectEvent(bool *selectionStateChanged)
-{
-  if (mSelectable)
-  {
-    bool selBefore = mSelected;
-    setSelected(false);
-    if (selectionStateChanged)
-      *selectionStateChanged = mSelected != selBefore;
-  }
-}
+/*! \class QCPGraphData
+  \brief Holds the data of one single data point for QCPGraph.
+  
+  The stored data is:
+  \li \a key: coordinate on the key axis of this data point (this is the \a mainKey and the \a sortKey)
+  \li \a value: coordinate on the value axis of this data point (this is the \a mainValue)
+  
+  The container for storing multiple data points is \ref QCPGraphDataContainer. It is a typedef for
+  \ref QCPDataContainer with \ref QCPGraphData as the DataType template parameter. See the
+  documentation there for an explanation regarding the data type's generic methods.
+  
+  \see QCPGraphDataContainer
+*/
 
-/*!
-  Returns 0.99*selectionTolerance (see \ref QCustomPlot::setSelectionTolerance) when \a pos is
-  within the bounding box of the text element's text. Note that this bounding box is updated in the
-  draw call.
+/* start documentation of inline functions */
 
-  If \a pos is outside the text's bounding box or if \a onlySelectable is true and this text
-  element is not selectable (\ref setSelectable), returns -1.
+/*! \fn double QCPGraphData::sortKey() const
+  
+  Returns the \a key member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
 
-  \seebaseclassmethod
+/*! \fn static QCPGraphData QCPGraphData::fromSortKey(double sortKey)
+  
+  Returns a data point with the specified \a sortKey. All other members are set to zero.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
 */
-double QCPTextElement::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
-{
-  Q_UNUSED(details)
-  if (onlySelectable && !mSelectable)
-    return -1;
+
+/*! \fn static static bool QCPGraphData::sortKeyIsMainKey()
   
-  if (mTextBoundingRect.contains(pos.toPoint()))
-    return mParentPlot->selectionTolerance()*0.99;
-  else
-    return -1;
-}
+  Since the member \a key is both the data point key coordinate and the data ordering parameter,
+  this method returns true.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn double QCPGraphData::mainKey() const
+  
+  Returns the \a key member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn double QCPGraphData::mainValue() const
+  
+  Returns the \a value member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn QCPRange QCPGraphData::valueRange() const
+  
+  Returns a QCPRange with both lower and upper boundary set to \a value of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
 
-/*!
-  Accepts the mouse event in order to emit the according click signal in the \ref
-  mouseReleaseEvent.
+/* end documentation of inline functions */
 
-  \seebaseclassmethod
+/*!
+  Constructs a data point with key and value set to zero.
 */
-void QCPTextElement::mousePressEvent(QMouseEvent *event, const QVariant &details)
+QCPGraphData::QCPGraphData() :
+  key(0),
+  value(0)
 {
-  Q_UNUSED(details)
-  event->accept();
 }
 
 /*!
-  Emits the \ref clicked signal if the cursor hasn't moved by more than a few pixels since the \ref
-  mousePressEvent.
-
-  \seebaseclassmethod
+  Constructs a data point with the specified \a key and \a value.
 */
-void QCPTextElement::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
+QCPGraphData::QCPGraphData(double key, double value) :
+  key(key),
+  value(value)
 {
-  if ((QPointF(event->pos())-startPos).manhattanLength() <= 3)
-    emit clicked(event);
 }
 
-/*!
-  Emits the \ref doubleClicked signal.
 
-  \seebaseclassmethod
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphDataSource
+  \brief Read-only interface to data that a QCPGraph renders in place, without copying it
+
+  A data source gives a graph direct access to key and value arrays owned by someone else, e.g.
+  columns of an application side table, a memory mapped file or a key array that is shared by
+  several graphs. Assign it to a graph with \ref QCPGraph::setDataSource. The graph then reads the
+  arrays returned by \ref keys and \ref values during each replot, instead of holding its own copy
+  in a \ref QCPGraphDataContainer.
+
+  To create a data source, subclass QCPGraphDataSource and reimplement \ref size, \ref keys and
+  \ref values. The keys must be sorted ascending, and both arrays must hold at least \ref size
+  elements and stay valid as long as the data source is assigned to a graph. For the common case
+  of keys and values residing in QVectors, \ref QCPVectorGraphDataSource is provided.
+
+  Whenever the underlying data is modified, call \ref dataChanged. This increments the \ref
+  revision, which lets graphs know that information they derived from the data is outdated.
 */
-void QCPTextElement::mouseDoubleClickEvent(QMouseEvent *event, const QVariant &details)
+
+/* start documentation of inline functions */
+
+/*! \fn int QCPGraphDataSource::revision() const
+
+  Returns the current revision of the data. It is incremented by each call to \ref dataChanged.
+*/
+
+/*! \fn virtual int QCPGraphDataSource::size() const = 0
+
+  Returns the number of data points, i.e. the number of elements that can be read from \ref keys
+  and \ref values.
+*/
+
+/*! \fn virtual const double *QCPGraphDataSource::keys() const = 0
+
+  Returns a pointer to the first element of the key array. The keys must be sorted ascending.
+*/
+
+/*! \fn virtual const double *QCPGraphDataSource::values() const = 0
+
+  Returns a pointer to the first element of the value array. NaN values create gaps in the graph
+  line, just like for data held in a \ref QCPGraphDataContainer.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs the data source with a revision of zero.
+*/
+QCPGraphDataSource::QCPGraphDataSource() :
+  mRevision(0)
 {
-  Q_UNUSED(details)
-  emit doubleClicked(event);
 }
 
-/*! \internal
-  
-  Returns the main font to be used. This is mSelectedFont if \ref setSelected is set to
-  <tt>true</tt>, else mFont is returned.
-*/
-QFont QCPTextElement::mainFont() const
+QCPGraphDataSource::~QCPGraphDataSource()
 {
-  return mSelected ? mSelectedFont : mFont;
 }
 
-/*! \internal
-  
-  Returns the main color to be used. This is mSelectedTextColor if \ref setSelected is set to
-  <tt>true</tt>, else mTextColor is returned.
+/*!
+  Notifies the data source that the underlying data was modified, by incrementing the \ref
+  revision. Call this after changing the data, and before the next replot of graphs using this
+  data source.
 */
-QColor QCPTextElement::mainTextColor() const
+void QCPGraphDataSource::dataChanged()
 {
-  return mSelected ? mSelectedTextColor : mTextColor;
+  ++mRevision;
 }
-/* end of 'src/layoutelements/layoutelement-textelement.cpp' */
 
 
-/* including file 'src/layoutelements/layoutelement-colorscale.cpp', size 25910 */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200    */
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPVectorGraphDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPVectorGraphDataSource
+  \brief A graph data source reading keys and values from two caller-owned QVectors
+
+  The vectors are referenced, not copied, so they must outlive the data source. Several data sources
+  may reference the same key vector, so multiple graphs sharing their keys only store them once:
+  \code
+  QSharedPointer<QCPVectorGraphDataSource> source(new QCPVectorGraphDataSource(&x, &y));
+  customPlot->graph(0)->setDataSource(source);
+  \endcode
+  If the vectors have different sizes, the number of data points is the size of the smaller one.
+  Note that modifying a vector may reallocate its data, so call \ref dataChanged after each
+  modification.
+
+  \see QCPGraphDataSource
+*/
+
+/*!
+  Constructs a data source for the vectors \a keys and \a values. Both vectors are referenced by
+  pointer and must stay alive as long as the data source is used.
+*/
+QCPVectorGraphDataSource::QCPVectorGraphDataSource(const QVector<double> *keys, const QVector<double> *values) :
+  mKeys(keys),
+  mValues(values)
+{
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPColorScale
+//////////////////// QCPGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPColorScale
-  \brief A color scale for use with color coding data such as QCPColorMap
+/*! \class QCPGraph
+  \brief A plottable representing a graph in a plot.
+
+  \image html QCPGraph.png
   
-  This layout element can be placed on the plot to correlate a color gradient with data values. It
-  is usually used in combination with one or multiple \ref QCPColorMap "QCPColorMaps".
+  Usually you create new graphs by calling QCustomPlot::addGraph. The resulting instance can be
+  accessed via QCustomPlot::graph.
 
-  \image html QCPColorScale.png
+  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
+  also access and modify the data via the \ref data method, which returns a pointer to the internal
+  \ref QCPGraphDataContainer. If the data already resides in memory owned by the application, a
+  \ref QCPGraphDataSource can be assigned with \ref setDataSource instead, so the graph renders it
+  in place without copying.
   
-  The color scale can be either horizontal or vertical, as shown in the image above. The
-  orientation and the side where the numbers appear is controlled with \ref setType.
+  Graphs are used to display single-valued data. Single-valued means that there should only be one
+  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
+  want to plot non-single-valued curves, rather use the QCPCurve plottable.
   
-  Use \ref QCPColorMap::setColorScale to connect a color map with a color scale. Once they are
-  connected, they share their gradient, data range and data scale type (\ref setGradient, \ref
-  setDataRange, \ref setDataScaleType). Multiple color maps may be associated with a single color
-  scale, to make them all synchronize these properties.
+  Gaps in the graph line can be created by adding data points with NaN as value
+  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
+  separated.
   
-  To have finer control over the number display and axis behaviour, you can directly access the
-  \ref axis. See the documentation of QCPAxis for details about configuring axes. For example, if
-  you want to change the number of automatically generated ticks, call
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorscale-tickcount
+  \section qcpgraph-appearance Changing the appearance
   
-  Placing a color scale next to the main axis rect works like with any other layout element:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorscale-creation
-  In this case we have placed it to the right of the default axis rect, so it wasn't necessary to
-  call \ref setType, since \ref QCPAxis::atRight is already the default. The text next to the color
-  scale can be set with \ref setLabel.
+  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
+  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
   
-  For optimum appearance (like in the image above), it may be desirable to line up the axis rect and
-  the borders of the color scale. Use a \ref QCPMarginGroup to achieve this:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolorscale-margingroup
+  \subsection filling Filling under or between graphs
   
-  Color scales are initialized with a non-zero minimum top and bottom margin (\ref
-  setMinimumMargins), because vertical color scales are most common and the minimum top/bottom
-  margin makes sure it keeps some distance to the top/bottom widget border. So if you change to a
-  horizontal color scale by setting \ref setType to \ref QCPAxis::atBottom or \ref QCPAxis::atTop, you
-  might want to also change the minimum margins accordingly, e.g. <tt>setMinimumMargins(QMargins(6, 0, 6, 0))</tt>.
+  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
+  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
+  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
+  
+  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
+  between this graph and another one, call \ref setChannelFillGraph with the other graph as
+  parameter.
+
+  \see QCustomPlot::addGraph, QCustomPlot::graph
 */
 
-/* start documentation of inline functions */
+/* start of documentation of inline functions */
 
-/*! \fn QCPAxis *QCPColorScale::axis() const
+/*! \fn QSharedPointer<QCPGraphDataContainer> QCPGraph::data() const
   
-  Returns the internal \ref QCPAxis instance of this color scale. You can access it to alter the
-  appearance and behaviour of the axis. \ref QCPColorScale duplicates some properties in its
-  interface for convenience. Those are \ref setDataRange (\ref QCPAxis::setRange), \ref
-  setDataScaleType (\ref QCPAxis::setScaleType), and the method \ref setLabel (\ref
-  QCPAxis::setLabel). As they each are connected, it does not matter whether you use the method on
-  the QCPColorScale or on its QCPAxis.
+  Returns a shared pointer to the internal data storage of type \ref QCPGraphDataContainer. You may
+  use it to directly manipulate the data, which may be more convenient and faster than using the
+  regular \ref setData or \ref addData methods.
   
-  If the type of the color scale is changed with \ref setType, the axis returned by this method
-  will change, too, to either the left, right, bottom or top axis, depending on which type was set.
+  While a data source is set (\ref setDataSource), the returned container is empty and not used by
+  the graph.
 */
 
-/* end documentation of signals */
-/* start documentation of signals */
-
-/*! \fn void QCPColorScale::dataRangeChanged(const QCPRange &newRange);
+/*! \fn QSharedPointer<QCPGraphDataSource> QCPGraph::dataSource() const
   
-  This signal is emitted when the data range changes.
+  Returns the data source the graph renders from, or a null pointer if the graph uses its internal
+  data container.
   
-  \see setDataRange
+  \see setDataSource
 */
 
-/*! \fn void QCPColorScale::dataScaleTypeChanged(QCPAxis::ScaleType scaleType);
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
+  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
+  the same orientation. If either of these restrictions is violated, a corresponding message is
+  printed to the debug output (qDebug), the construction is not aborted, though.
   
-  This signal is emitted when the data scale type changes.
+  The created QCPGraph is automatically registered with the QCustomPlot instance inferred from \a
+  keyAxis. This QCustomPlot instance takes ownership of the QCPGraph, so do not delete it manually
+  but use QCustomPlot::removePlottable() instead.
   
-  \see setDataScaleType
+  To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
 */
+QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
+  mDataSourceRevision(-1)
+{
+  // special handling for QCPGraphs to maintain the simple graph interface:
+  mParentPlot->registerGraph(this);
 
-/*! \fn void QCPColorScale::gradientChanged(const QCPColorGradient &newGradient);
-  
-  This signal is emitted when the gradient changes.
+  setPen(QPen(Qt::blue, 0));
+  setBrush(Qt::NoBrush);
   
-  \see setGradient
-*/
+  setLineStyle(lsLine);
+  setScatterSkip(0);
+  setChannelFillGraph(0);
+  setAdaptiveSampling(true);
+}
 
-/* end documentation of signals */
+QCPGraph::~QCPGraph()
+{
+}
 
-/*!
-  Constructs a new QCPColorScale.
+/*! \overload
+  
+  Replaces the current data container with the provided \a data container.
+  
+  Since a QSharedPointer is used, multiple QCPGraphs may share the same data container safely.
+  Modifying the data in the container will then affect all graphs that share the container. Sharing
+  can be achieved by simply exchanging the data containers wrapped in shared pointers:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-1
+  
+  If you do not wish to share containers, but create a copy from an existing container, rather use
+  the \ref QCPDataContainer<DataType>::set method on the graph's data container directly:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-2
+  
+  \see addData
 */
-QCPColorScale::QCPColorScale(QCustomPlot *parentPlot) :
-  QCPLayoutElement(parentPlot),
-  mType(QCPAxis::atTop), // set to atTop such that setType(QCPAxis::atRight) below doesn't skip work because it thinks it's already atRight
-  mDataScaleType(QCPAxis::stLinear),
-  mBarWidth(20),
-  mAxisRect(new QCPColorScaleAxisRectPrivate(this))
+void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
 {
-  setMinimumMargins(QMargins(0, 6, 0, 6)); // for default right color scale types, keep some room at bottom and top (important if no margin group is used)
-  setType(QCPAxis::atRight);
-  setDataRange(QCPRange(0, 6));
+  mDataSource.clear();
+  mDataContainer = data;
 }
 
-QCPColorScale::~QCPColorScale()
+/*! \overload
+  
+  Replaces the current data with the provided points in \a keys and \a values. The provided
+  vectors should have equal length. Else, the number of added points will be the size of the
+  smallest vector.
+  
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  
+  \see addData
+*/
+void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
 {
-  delete mAxisRect;
+  mDataContainer->clear();
+  addData(keys, values, alreadySorted);
 }
 
-/* undocumented getter */
-QString QCPColorScale::label() const
+/*!
+  Makes the graph render the data provided by \a source, instead of the data in its internal
+  container. The graph reads the key and value arrays of \a source directly during each replot, so
+  no copy of the data is made. This is useful if the data already exists in memory owned by the
+  application, or if multiple graphs share the same keys. Visible data points are found by binary
+  search on the keys, and if adaptive sampling is enabled (\ref setAdaptiveSampling), dense data is
+  reduced to the first, lowest, highest and last point per pixel column while it is being read.
+  
+  Selection, rescaling and the 1D data interface (\ref interface1D) work on the data of \a source
+  as well, data indices refer to positions in its arrays.
+  
+  The internal data container of the graph is replaced by a new, empty one. Calling \ref setData or
+  \ref addData afterwards removes the data source again, and the graph continues with its internal
+  container. Pass a null pointer as \a source to only remove the data source.
+  
+  \see QCPGraphDataSource, QCPVectorGraphDataSource
+*/
+void QCPGraph::setDataSource(QSharedPointer<QCPGraphDataSource> source)
 {
-  if (!mColorAxis)
-  {
-    qDebug() << Q_FUNC_INFO << "internal color axis undefined";
-    return QString();
-  }
+  mDataSource = source;
+  mDataSourceRevision = -1;
+  if (mDataSource)
+    mDataContainer = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
+}
+
+/*!
+  Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
+  \ref lsNone and \ref setScatterStyle to the desired scatter style.
   
-  return mColorAxis.data()->label();
+  \see setScatterStyle
+*/
+void QCPGraph::setLineStyle(LineStyle ls)
+{
+  mLineStyle = ls;
 }
 
-/* undocumented getter */
-bool QCPColorScale::rangeDrag() const
-{
-  if (!mAxisRect)
-  {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return false;
-  }
+/*!
+  Sets the visual appearance of single data points in the plot. If set to \ref QCPScatterStyle::ssNone, no scatter points
+  are drawn (e.g. for line-only-plots with appropriate line style).
   
-  return mAxisRect.data()->rangeDrag().testFlag(QCPAxis::orientation(mType)) &&
-      mAxisRect.data()->rangeDragAxis(QCPAxis::orientation(mType)) &&
-      mAxisRect.data()->rangeDragAxis(QCPAxis::orientation(mType))->orientation() == QCPAxis::orientation(mType);
+  \see QCPScatterStyle, setLineStyle
+*/
+void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
+{
+  mScatterStyle = style;
 }
 
-/* undocumented getter */
-bool QCPColorScale::rangeZoom() const
+/*!
+  If scatters are displayed (scatter style not \ref QCPScatterStyle::ssNone), \a skip number of
+  scatter points are skipped/not drawn after every drawn scatter point.
+
+  This can be used to make the data appear sparser while for example still having a smooth line,
+  and to improve performance for very high density plots.
+
+  If \a skip is set to 0 (default), all scatter points are drawn.
+
+  \see setScatterStyle
+*/
+void QCPGraph::setScatterSkip(int skip)
 {
-  if (!mAxisRect)
-  {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return false;
-  }
-  
-  return mAxisRect.data()->rangeZoom().testFlag(QCPAxis::orientation(mType)) &&
-      mAxisRect.data()->rangeZoomAxis(QCPAxis::orientation(mType)) &&
-      mAxisRect.data()->rangeZoomAxis(QCPAxis::orientation(mType))->orientation() == QCPAxis::orientation(mType);
+  mScatterSkip = qMax(0, skip);
 }
 
 /*!
-  Sets at which side of the color scale the axis is placed, and thus also its orientation.
+  Sets the target graph for filling the area between this graph and \a targetGraph with the current
+  brush (\ref setBrush).
   
-  Note that after setting \a type to a different value, the axis returned by \ref axis() will
-  be a different one. The new axis will adopt the following properties from the previous axis: The
-  range, scale type, label and ticker (the latter will be shared and not copied).
+  When \a targetGraph is set to 0, a normal graph fill to the zero-value-line will be shown. To
+  disable any filling, set the brush to Qt::NoBrush.
+
+  \see setBrush
 */
-void QCPColorScale::setType(QCPAxis::AxisType type)
+void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 {
-  if (!mAxisRect)
+  // prevent setting channel target to this graph itself:
+  if (targetGraph == this)
   {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
+    qDebug() << Q_FUNC_INFO << "targetGraph is this graph itself";
+    mChannelFillGraph = 0;
     return;
   }
-  if (mType != type)
+  // prevent setting channel target to a graph not in the plot:
+  if (targetGraph && targetGraph->mParentPlot != mParentPlot)
   {
-    mType = type;
-    QCPRange rangeTransfer(0, 6);
-    QString labelTransfer;
-    QSharedPointer<QCPAxisTicker> tickerTransfer;
-    // transfer/revert some settings on old axis if it exists:
-    bool doTransfer = (bool)mColorAxis;
-    if (doTransfer)
-    {
-      rangeTransfer = mColorAxis.data()->range();
-      labelTransfer = mColorAxis.data()->label();
-      tickerTransfer = mColorAxis.data()->ticker();
-      mColorAxis.data()->setLabel(QString());
-      disconnect(mColorAxis.data(), SIGNAL(rangeChanged(QCPRange)), this, SLOT(setDataRange(QCPRange)));
-      disconnect(mColorAxis.data(), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
-    }
-    QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atLeft << QCPAxis::atRight << QCPAxis::atBottom << QCPAxis::atTop;
-    foreach (QCPAxis::AxisType atype, allAxisTypes)
-    {
-      mAxisRect.data()->axis(atype)->setTicks(atype == mType);
-      mAxisRect.data()->axis(atype)->setTickLabels(atype== mType);
-    }
-    // set new mColorAxis pointer:
-    mColorAxis = mAxisRect.data()->axis(mType);
-    // transfer settings to new axis:
-    if (doTransfer)
-    {
-      mColorAxis.data()->setRange(rangeTransfer); // range transfer necessary if axis changes from vertical to horizontal or vice versa (axes with same orientation are synchronized via signals)
-      mColorAxis.data()->setLabel(labelTransfer);
-      mColorAxis.data()->setTicker(tickerTransfer);
-    }
-    connect(mColorAxis.data(), SIGNAL(rangeChanged(QCPRange)), this, SLOT(setDataRange(QCPRange)));
-    connect(mColorAxis.data(), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
-    mAxisRect.data()->setRangeDragAxes(QList<QCPAxis*>() << mColorAxis.data());
+    qDebug() << Q_FUNC_INFO << "targetGraph not in same plot";
+    mChannelFillGraph = 0;
+    return;
   }
+  
+  mChannelFillGraph = targetGraph;
 }
 
 /*!
-  Sets the range spanned by the color gradient and that is shown by the axis in the color scale.
+  Sets whether adaptive sampling shall be used when plotting this graph. QCustomPlot's adaptive
+  sampling technique can drastically improve the replot performance for graphs with a larger number
+  of points (e.g. above 10,000), without notably changing the appearance of the graph.
   
-  It is equivalent to calling QCPColorMap::setDataRange on any of the connected color maps. It is
-  also equivalent to directly accessing the \ref axis and setting its range with \ref
-  QCPAxis::setRange.
+  By default, adaptive sampling is enabled. Even if enabled, QCustomPlot decides whether adaptive
+  sampling shall actually be used on a per-graph basis. So leaving adaptive sampling enabled has no
+  disadvantage in almost all cases.
   
-  \see setDataScaleType, setGradient, rescaleDataRange
+  \image html adaptive-sampling-line.png "A line plot of 500,000 points without and with adaptive sampling"
+  
+  As can be seen, line plots experience no visual degradation from adaptive sampling. Outliers are
+  reproduced reliably, as well as the overall shape of the data set. The replot time reduces
+  dramatically though. This allows QCustomPlot to display large amounts of data in realtime.
+  
+  \image html adaptive-sampling-scatter.png "A scatter plot of 100,000 points without and with adaptive sampling"
+  
+  Care must be taken when using high-density scatter plots in combination with adaptive sampling.
+  The adaptive sampling algorithm treats scatter plots more carefully than line plots which still
+  gives a significant reduction of replot times, but not quite as much as for line plots. This is
+  because scatter plots inherently need more data points to be preserved in order to still resemble
+  the original, non-adaptive-sampling plot. As shown above, the results still aren't quite
+  identical, as banding occurs for the outer data points. This is in fact intentional, such that
+  the boundaries of the data cloud stay visible to the viewer. How strong the banding appears,
+  depends on the point density, i.e. the number of points in the plot.
+  
+  For some situations with scatter plots it might thus be desirable to manually turn adaptive
+  sampling off. For example, when saving the plot to disk. This can be achieved by setting \a
+  enabled to false before issuing a command like \ref QCustomPlot::savePng, and setting \a enabled
+  back to true afterwards.
 */
-void QCPColorScale::setDataRange(const QCPRange &dataRange)
+void QCPGraph::setAdaptiveSampling(bool enabled)
 {
-  if (mDataRange.lower != dataRange.lower || mDataRange.upper != dataRange.upper)
-  {
-    mDataRange = dataRange;
-    if (mColorAxis)
-      mColorAxis.data()->setRange(mDataRange);
-    emit dataRangeChanged(mDataRange);
-  }
+  mAdaptiveSampling = enabled;
 }
 
-/*!
-  Sets the scale type of the color scale, i.e. whether values are linearly associated with colors
-  or logarithmically.
+/*! \overload
   
-  It is equivalent to calling QCPColorMap::setDataScaleType on any of the connected color maps. It is
-  also equivalent to directly accessing the \ref axis and setting its scale type with \ref
-  QCPAxis::setScaleType.
+  Adds the provided points in \a keys and \a values to the current data. The provided vectors
+  should have equal length. Else, the number of added points will be the size of the smallest
+  vector.
   
-  \see setDataRange, setGradient
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  
+  Alternatively, you can also access and modify the data directly via the \ref data method, which
+  returns a pointer to the internal data container.
 */
-void QCPColorScale::setDataScaleType(QCPAxis::ScaleType scaleType)
+void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
 {
-  if (mDataScaleType != scaleType)
+  mDataSource.clear();
+  if (keys.size() != values.size())
+    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
+  const int n = qMin(keys.size(), values.size());
+  QVector<QCPGraphData> tempData(n);
+  QVector<QCPGraphData>::iterator it = tempData.begin();
+  const QVector<QCPGraphData>::iterator itEnd = tempData.end();
+  int i = 0;
+  while (it != itEnd)
   {
-    mDataScaleType = scaleType;
-    if (mColorAxis)
-      mColorAxis.data()->setScaleType(mDataScaleType);
-    if (mDataScaleType == QCPAxis::stLogarithmic)
-      setDataRange(mDataRange.sanitizedForLogScale());
-    emit dataScaleTypeChanged(mDataScaleType);
+    it->key = keys[i];
+    it->value = values[i];
+    ++it;
+    ++i;
   }
+  mDataContainer->add(tempData, alreadySorted); // don't modify tempData beyond this to prevent copy on write
 }
 
-/*!
-  Sets the color gradient that will be used to represent data values.
+/*! \overload
   
-  It is equivalent to calling QCPColorMap::setGradient on any of the connected color maps.
+  Adds the provided data point as \a key and \a value to the current data.
   
-  \see setDataRange, setDataScaleType
+  Alternatively, you can also access and modify the data directly via the \ref data method, which
+  returns a pointer to the internal data container.
 */
-void QCPColorScale::setGradient(const QCPColorGradient &gradient)
+void QCPGraph::addData(double key, double value)
 {
-  if (mGradient != gradient)
-  {
-    mGradient = gradient;
-    if (mAxisRect)
-      mAxisRect.data()->mGradientImageInvalidated = true;
-    emit gradientChanged(mGradient);
-  }
+  mDataSource.clear();
+  mDataContainer->add(QCPGraphData(key, value));
 }
 
-/*!
-  Sets the axis label of the color scale. This is equivalent to calling \ref QCPAxis::setLabel on
-  the internal \ref axis.
-*/
-void QCPColorScale::setLabel(const QString &str)
+/* inherits documentation from base class */
+double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
-  if (!mColorAxis)
-  {
-    qDebug() << Q_FUNC_INFO << "internal color axis undefined";
-    return;
-  }
+  if ((onlySelectable && mSelectable == QCP::stNone) || dataCount() == 0)
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
   
-  mColorAxis.data()->setLabel(str);
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+  {
+    int pointIndex;
+    double result;
+    if (mDataSource)
+    {
+      result = sourcePointDistance(pos, pointIndex);
+    } else
+    {
+      QCPGraphDataContainer::const_iterator closestDataPoint = mDataContainer->constEnd();
+      result = pointDistance(pos, closestDataPoint);
+      pointIndex = closestDataPoint-mDataContainer->constBegin();
+    }
+    if (details)
+      details->setValue(QCPDataSelection(QCPDataRange(pointIndex, pointIndex+1)));
+    return result;
+  } else
+    return -1;
 }
 
-/*!
-  Sets the width (or height, for horizontal color scales) the bar where the gradient is displayed
-  will have.
-*/
-void QCPColorScale::setBarWidth(int width)
+/* inherits documentation from base class */
+QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  if (!mDataSource)
+    return mDataContainer->keyRange(foundRange, inSignDomain);
+  
+  // keys of a data source are sorted, so the range spans from the first to the last key in the sign domain with a non-NaN value:
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  int begin = 0;
+  int end = mDataSource->size();
+  if (inSignDomain == QCP::sdNegative)
+    end = std::lower_bound(keys, keys+end, 0.0)-keys;
+  else if (inSignDomain == QCP::sdPositive)
+    begin = std::upper_bound(keys, keys+end, 0.0)-keys;
+  while (begin < end && qIsNaN(values[begin]))
+    ++begin;
+  while (end > begin && qIsNaN(values[end-1]))
+    --end;
+  foundRange = begin < end;
+  return foundRange ? QCPRange(keys[begin], keys[end-1]) : QCPRange();
+}
+
+/* inherits documentation from base class */
+QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  if (!mDataSource)
+    return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
+  
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  int begin = 0;
+  int end = mDataSource->size();
+  if (inKeyRange != QCPRange())
+  {
+    begin = std::lower_bound(keys, keys+end, inKeyRange.lower)-keys;
+    end = std::upper_bound(keys, keys+end, inKeyRange.upper)-keys;
+  }
+  QCPRange range;
+  foundRange = false;
+  for (int i=begin; i<end; ++i)
+  {
+    const double current = values[i];
+    if (qIsNaN(current) || (inSignDomain == QCP::sdNegative && current >= 0) || (inSignDomain == QCP::sdPositive && current <= 0))
+      continue;
+    if (!foundRange)
+    {
+      range.lower = current;
+      range.upper = current;
+      foundRange = true;
+    } else if (current < range.lower)
+      range.lower = current;
+    else if (current > range.upper)
+      range.upper = current;
+  }
+  return range;
+}
+
+/* inherits documentation from base class */
+int QCPGraph::dataCount() const
 {
-  mBarWidth = width;
+  return mDataSource ? mDataSource->size() : QCPAbstractPlottable1D<QCPGraphData>::dataCount();
 }
 
-/*!
-  Sets whether the user can drag the data range (\ref setDataRange).
-  
-  Note that \ref QCP::iRangeDrag must be in the QCustomPlot's interactions (\ref
-  QCustomPlot::setInteractions) to allow range dragging.
-*/
-void QCPColorScale::setRangeDrag(bool enabled)
+/* inherits documentation from base class */
+double QCPGraph::dataMainKey(int index) const
 {
-  if (!mAxisRect)
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainKey(index);
+  
+  if (index >= 0 && index < mDataSource->size())
   {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
+    return mDataSource->keys()[index];
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
   }
-  
-  if (enabled)
-    mAxisRect.data()->setRangeDrag(QCPAxis::orientation(mType));
-  else
-    mAxisRect.data()->setRangeDrag(0);
 }
 
-/*!
-  Sets whether the user can zoom the data range (\ref setDataRange) by scrolling the mouse wheel.
-  
-  Note that \ref QCP::iRangeZoom must be in the QCustomPlot's interactions (\ref
-  QCustomPlot::setInteractions) to allow range dragging.
-*/
-void QCPColorScale::setRangeZoom(bool enabled)
+/* inherits documentation from base class */
+double QCPGraph::dataSortKey(int index) const
 {
-  if (!mAxisRect)
-  {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
-  }
-  
-  if (enabled)
-    mAxisRect.data()->setRangeZoom(QCPAxis::orientation(mType));
-  else
-    mAxisRect.data()->setRangeZoom(0);
+  return dataMainKey(index);
 }
 
-/*!
-  Returns a list of all the color maps associated with this color scale.
-*/
-QList<QCPColorMap*> QCPColorScale::colorMaps() const
+/* inherits documentation from base class */
+double QCPGraph::dataMainValue(int index) const
 {
-  QList<QCPColorMap*> result;
-  for (int i=0; i<mParentPlot->plottableCount(); ++i)
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainValue(index);
+  
+  if (index >= 0 && index < mDataSource->size())
   {
-    if (QCPColorMap *cm = qobject_cast<QCPColorMap*>(mParentPlot->plottable(i)))
-      if (cm->colorScale() == this)
-        result.append(cm);
+    return mDataSource->values()[index];
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
   }
-  return result;
 }
 
-/*!
-  Changes the data range such that all color maps associated with this color scale are fully mapped
-  to the gradient in the data dimension.
+/* inherits documentation from base class */
+QCPRange QCPGraph::dataValueRange(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataValueRange(index);
   
-  \see setDataRange
-*/
-void QCPColorScale::rescaleDataRange(bool onlyVisibleMaps)
+  const double value = dataMainValue(index);
+  return QCPRange(value, value);
+}
+
+/* inherits documentation from base class */
+QPointF QCPGraph::dataPixelPosition(int index) const
 {
-  QList<QCPColorMap*> maps = colorMaps();
-  QCPRange newRange;
-  bool haveRange = false;
-  QCP::SignDomain sign = QCP::sdBoth;
-  if (mDataScaleType == QCPAxis::stLogarithmic)
-    sign = (mDataRange.upper < 0 ? QCP::sdNegative : QCP::sdPositive);
-  for (int i=0; i<maps.size(); ++i)
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataPixelPosition(index);
+  
+  if (index >= 0 && index < mDataSource->size())
   {
-    if (!maps.at(i)->realVisibility() && onlyVisibleMaps)
-      continue;
-    QCPRange mapRange;
-    if (maps.at(i)->colorScale() == this)
-    {
-      bool currentFoundRange = true;
-      mapRange = maps.at(i)->data()->dataBounds();
-      if (sign == QCP::sdPositive)
-      {
-        if (mapRange.lower <= 0 && mapRange.upper > 0)
-          mapRange.lower = mapRange.upper*1e-3;
-        else if (mapRange.lower <= 0 && mapRange.upper <= 0)
-          currentFoundRange = false;
-      } else if (sign == QCP::sdNegative)
-      {
-        if (mapRange.upper >= 0 && mapRange.lower < 0)
-          mapRange.upper = mapRange.lower*1e-3;
-        else if (mapRange.upper >= 0 && mapRange.lower >= 0)
-          currentFoundRange = false;
-      }
-      if (currentFoundRange)
-      {
-        if (!haveRange)
-          newRange = mapRange;
-        else
-          newRange.expand(mapRange);
-        haveRange = true;
-      }
-    }
-  }
-  if (haveRange)
+    return coordsToPixels(mDataSource->keys()[index], mDataSource->values()[index]);
+  } else
   {
-    if (!QCPRange::validRange(newRange)) // likely due to range being zero (plottable has only constant data in this dimension), shift current range to at least center the data
-    {
-      double center = (newRange.lower+newRange.upper)*0.5; // upper and lower should be equal anyway, but just to make sure, incase validRange returned false for other reason
-      if (mDataScaleType == QCPAxis::stLinear)
-      {
-        newRange.lower = center-mDataRange.size()/2.0;
-        newRange.upper = center+mDataRange.size()/2.0;
-      } else // mScaleType == stLogarithmic
-      {
-        newRange.lower = center/qSqrt(mDataRange.upper/mDataRange.lower);
-        newRange.upper = center*qSqrt(mDataRange.upper/mDataRange.lower);
-      }
-    }
-    setDataRange(newRange);
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return QPointF();
   }
 }
 
 /* inherits documentation from base class */
-void QCPColorScale::update(UpdatePhase phase)
+QCPDataSelection QCPGraph::selectTestRect(const QRectF &rect, bool onlySelectable) const
 {
-  QCPLayoutElement::update(phase);
-  if (!mAxisRect)
-  {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
-  }
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::selectTestRect(rect, onlySelectable);
   
-  mAxisRect.data()->update(phase);
+  QCPDataSelection result;
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataSource->size() == 0)
+    return result;
+  if (!mKeyAxis || !mValueAxis)
+    return result;
   
-  switch (phase)
+  // convert rect given in pixels to ranges given in plot coordinates:
+  double key1, value1, key2, value2;
+  pixelsToCoords(rect.topLeft(), key1, value1);
+  pixelsToCoords(rect.bottomRight(), key2, value2);
+  QCPRange keyRange(key1, key2); // QCPRange normalizes internally so we don't have to care about whether key1 < key2
+  QCPRange valueRange(value1, value2);
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  const int end = findEnd(keyRange.upper, false);
+  int currentSegmentBegin = -1; // -1 means we're currently not in a segment that's contained in rect
+  for (int i=findBegin(keyRange.lower, false); i<end; ++i)
   {
-    case upMargins:
+    const bool contained = keyRange.contains(keys[i]) && valueRange.contains(values[i]);
+    if (contained && currentSegmentBegin == -1) // start segment
     {
-      if (mType == QCPAxis::atBottom || mType == QCPAxis::atTop)
-      {
-        setMaximumSize(QWIDGETSIZE_MAX, mBarWidth+mAxisRect.data()->margins().top()+mAxisRect.data()->margins().bottom()+margins().top()+margins().bottom());
-        setMinimumSize(0,               mBarWidth+mAxisRect.data()->margins().top()+mAxisRect.data()->margins().bottom()+margins().top()+margins().bottom());
-      } else
-      {
-        setMaximumSize(mBarWidth+mAxisRect.data()->margins().left()+mAxisRect.data()->margins().right()+margins().left()+margins().right(), QWIDGETSIZE_MAX);
-        setMinimumSize(mBarWidth+mAxisRect.data()->margins().left()+mAxisRect.data()->margins().right()+margins().left()+margins().right(), 0);
-      }
-      break;
-    }
-    case upLayout:
+      currentSegmentBegin = i;
+    } else if (!contained && currentSegmentBegin != -1) // segment just ended
     {
-      mAxisRect.data()->setOuterRect(rect());
-      break;
+      result.addDataRange(QCPDataRange(currentSegmentBegin, i), false);
+      currentSegmentBegin = -1;
     }
-    default: break;
   }
+  // process potential last segment:
+  if (currentSegmentBegin != -1)
+    result.addDataRange(QCPDataRange(currentSegmentBegin, end), false);
+  
+  result.simplify();
+  return result;
 }
 
 /* inherits documentation from base class */
-void QCPColorScale::applyDefaultAntialiasingHint(QCPPainter *painter) const
+int QCPGraph::findBegin(double sortKey, bool expandedRange) const
 {
-  painter->setAntialiasing(false);
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::findBegin(sortKey, expandedRange);
+  
+  const double *keys = mDataSource->keys();
+  int index = std::lower_bound(keys, keys+mDataSource->size(), sortKey)-keys;
+  if (expandedRange && index > 0)
+    --index;
+  return index;
 }
 
 /* inherits documentation from base class */
-void QCPColorScale::mousePressEvent(QMouseEvent *event, const QVariant &details)
+int QCPGraph::findEnd(double sortKey, bool expandedRange) const
 {
-  if (!mAxisRect)
-  {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
-  }
-  mAxisRect.data()->mousePressEvent(event, details);
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::findEnd(sortKey, expandedRange);
+  
+  const double *keys = mDataSource->keys();
+  const int size = mDataSource->size();
+  int index = std::upper_bound(keys, keys+size, sortKey)-keys;
+  if (expandedRange && index < size)
+    ++index;
+  return index;
 }
 
 /* inherits documentation from base class */
-void QCPColorScale::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
+void QCPGraph::draw(QCPPainter *painter)
 {
-  if (!mAxisRect)
+  mDataContainer->mergePendingRuns();
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
+  if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
+  checkDataSource();
+  
+  QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
+  
+  // loop over and draw segments of unselected/selected data:
+  QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  allSegments << unselectedSegments << selectedSegments;
+  for (int i=0; i<allSegments.size(); ++i)
   {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
+    bool isSelectedSegment = i >= unselectedSegments.size();
+    // get line pixel points appropriate to line style:
+    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
+    getLines(&lines, lineDataRange);
+    
+    // check data validity if flag set:
+#ifdef QCUSTOMPLOT_CHECK_DATA
+    QCPGraphDataContainer::const_iterator it;
+    for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd(); ++it)
+    {
+      if (QCP::isInvalidData(it->key, it->value))
+        qDebug() << Q_FUNC_INFO << "Data point at" << it->key << "invalid." << "Plottable name:" << name();
+    }
+#endif
+    
+    // draw fill of graph:
+    if (isSelectedSegment && mSelectionDecorator)
+      mSelectionDecorator->applyBrush(painter);
+    else
+      painter->setBrush(mBrush);
+    painter->setPen(Qt::NoPen);
+    drawFill(painter, &lines);
+    
+    // draw line:
+    if (mLineStyle != lsNone)
+    {
+      if (isSelectedSegment && mSelectionDecorator)
+        mSelectionDecorator->applyPen(painter);
+      else
+        painter->setPen(mPen);
+      painter->setBrush(Qt::NoBrush);
+      if (mLineStyle == lsImpulse)
+        drawImpulsePlot(painter, lines);
+      else
+        drawLinePlot(painter, lines); // also step plots can be drawn as a line plot
+    }
+    
+    // draw scatters:
+    QCPScatterStyle finalScatterStyle = mScatterStyle;
+    if (isSelectedSegment && mSelectionDecorator)
+      finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
+    if (!finalScatterStyle.isNone() && !(mParentPlot->coarseReplot() && mLineStyle != lsNone)) // coarse replots only show the line where there is one
+    {
+      getScatters(&scatters, allSegments.at(i));
+      drawScatterPlot(painter, scatters, finalScatterStyle);
+    }
   }
-  mAxisRect.data()->mouseMoveEvent(event, startPos);
+  
+  // draw other selection decoration that isn't just line/scatter pens and brushes:
+  if (mSelectionDecorator)
+    mSelectionDecorator->drawDecoration(painter, selection());
 }
 
 /* inherits documentation from base class */
-void QCPColorScale::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
+void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
-  if (!mAxisRect)
+  // draw fill:
+  if (mBrush.style() != Qt::NoBrush)
   {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
+    applyFillAntialiasingHint(painter);
+    painter->fillRect(QRectF(rect.left(), rect.top()+rect.height()/2.0, rect.width(), rect.height()/3.0), mBrush);
   }
-  mAxisRect.data()->mouseReleaseEvent(event, startPos);
-}
-
-/* inherits documentation from base class */
-void QCPColorScale::wheelEvent(QWheelEvent *event)
-{
-  if (!mAxisRect)
+  // draw line vertically centered:
+  if (mLineStyle != lsNone)
+  {
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()/2.0, rect.right()+5, rect.top()+rect.height()/2.0)); // +5 on x2 else last segment is missing from dashed/dotted pens
+  }
+  // draw scatter symbol:
+  if (!mScatterStyle.isNone())
   {
-    qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
-    return;
+    applyScattersAntialiasingHint(painter);
+    // scale scatter pixmap if it's too large to fit in legend icon rect:
+    if (mScatterStyle.shape() == QCPScatterStyle::ssPixmap && (mScatterStyle.pixmap().size().width() > rect.width() || mScatterStyle.pixmap().size().height() > rect.height()))
+    {
+      QCPScatterStyle scaledStyle(mScatterStyle);
+      scaledStyle.setPixmap(scaledStyle.pixmap().scaled(rect.size().toSize(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+      scaledStyle.applyTo(painter, mPen);
+      scaledStyle.drawShape(painter, QRectF(rect).center());
+    } else
+    {
+      mScatterStyle.applyTo(painter, mPen);
+      mScatterStyle.drawShape(painter, QRectF(rect).center());
+    }
   }
-  mAxisRect.data()->wheelEvent(event);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPColorScaleAxisRectPrivate
-////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \internal
 
-/*! \class QCPColorScaleAxisRectPrivate
+  This method retrieves an optimized set of data points via \ref getOptimizedLineData, an branches
+  out to the line style specific functions such as \ref dataToLines, \ref dataToStepLeftLines, etc.
+  according to the line style of the graph.
 
-  \internal
-  \brief An axis rect subclass for use in a QCPColorScale
-  
-  This is a private class and not part of the public QCustomPlot interface.
-  
-  It provides the axis rect functionality for the QCPColorScale class.
-*/
+  \a lines will be filled with points in pixel coordinates, that can be drawn with the according
+  draw functions like \ref drawLinePlot and \ref drawImpulsePlot. The points returned in \a lines
+  aren't necessarily the original data points. For example, step line styles require additional
+  points to form the steps when drawn. If the line style of the graph is \ref lsNone, the \a
+  lines vector will be empty.
 
+  \a dataRange specifies the beginning and ending data indices that will be taken into account for
+  conversion. In this function, the specified range may exceed the total data bounds without harm:
+  a correspondingly trimmed data range will be used. This takes the burden off the user of this
+  function to check for valid indices in \a dataRange, e.g. when extending ranges coming from \ref
+  getDataSegments.
+  
+  If a data source is set (\ref setDataSource), the data points are read from it via \ref
+  getSourceData.
 
-/*!
-  Creates a new instance, as a child of \a parentColorScale.
+  \see getScatters
 */
-QCPColorScaleAxisRectPrivate::QCPColorScaleAxisRectPrivate(QCPColorScale *parentColorScale) :
-  QCPAxisRect(parentColorScale->parentPlot(), true),
-  mParentColorScale(parentColorScale),
-  mGradientImageInvalidated(true)
+void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
 {
-  setParentLayerable(parentColorScale);
-  setMinimumMargins(QMargins(0, 0, 0, 0));
-  QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atBottom << QCPAxis::atTop << QCPAxis::atLeft << QCPAxis::atRight;
-  foreach (QCPAxis::AxisType type, allAxisTypes)
+  if (!lines) return;
+  QVector<QCPGraphData> lineData;
+  if (mDataSource)
   {
-    axis(type)->setVisible(true);
-    axis(type)->grid()->setVisible(false);
-    axis(type)->setPadding(0);
-    connect(axis(type), SIGNAL(selectionChanged(QCPAxis::SelectableParts)), this, SLOT(axisSelectionChanged(QCPAxis::SelectableParts)));
-    connect(axis(type), SIGNAL(selectableChanged(QCPAxis::SelectableParts)), this, SLOT(axisSelectableChanged(QCPAxis::SelectableParts)));
+    QVector<QCPGraphData> sourceData;
+    getSourceData(&sourceData, dataRange, 1);
+    if (sourceData.isEmpty())
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getOptimizedLineData(&lineData, sourceData.constBegin(), sourceData.constEnd());
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getOptimizedLineData(&lineData, begin, end);
   }
 
-  connect(axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atRight), SLOT(setRange(QCPRange)));
-  connect(axis(QCPAxis::atRight), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atLeft), SLOT(setRange(QCPRange)));
-  connect(axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atTop), SLOT(setRange(QCPRange)));
-  connect(axis(QCPAxis::atTop), SIGNAL(rangeChanged(QCPRange)), axis(QCPAxis::atBottom), SLOT(setRange(QCPRange)));
-  connect(axis(QCPAxis::atLeft), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atRight), SLOT(setScaleType(QCPAxis::ScaleType)));
-  connect(axis(QCPAxis::atRight), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atLeft), SLOT(setScaleType(QCPAxis::ScaleType)));
-  connect(axis(QCPAxis::atBottom), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atTop), SLOT(setScaleType(QCPAxis::ScaleType)));
-  connect(axis(QCPAxis::atTop), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), axis(QCPAxis::atBottom), SLOT(setScaleType(QCPAxis::ScaleType)));
-  
-  // make layer transfers of color scale transfer to axis rect and axes
-  // the axes must be set after axis rect, such that they appear above color gradient drawn by axis rect:
-  connect(parentColorScale, SIGNAL(layerChanged(QCPLayer*)), this, SLOT(setLayer(QCPLayer*)));
-  foreach (QCPAxis::AxisType type, allAxisTypes)
-    connect(parentColorScale, SIGNAL(layerChanged(QCPLayer*)), axis(type), SLOT(setLayer(QCPLayer*)));
+  switch (mLineStyle)
+  {
+    case lsNone: lines->clear(); break;
+    case lsLine: *lines = dataToLines(lineData); break;
+    case lsStepLeft: *lines = dataToStepLeftLines(lineData); break;
+    case lsStepRight: *lines = dataToStepRightLines(lineData); break;
+    case lsStepCenter: *lines = dataToStepCenterLines(lineData); break;
+    case lsImpulse: *lines = dataToImpulseLines(lineData); break;
+  }
 }
 
 /*! \internal
-  
-  Updates the color gradient image if necessary, by calling \ref updateGradientImage, then draws
-  it. Then the axes are drawn by calling the \ref QCPAxisRect::draw base class implementation.
-  
-  \seebaseclassmethod
+
+  This method retrieves an optimized set of data points via \ref getOptimizedScatterData and then
+  converts them to pixel coordinates. The resulting points are returned in \a scatters, and can be
+  passed to \ref drawScatterPlot.
+
+  \a dataRange specifies the beginning and ending data indices that will be taken into account for
+  conversion. In this function, the specified range may exceed the total data bounds without harm:
+  a correspondingly trimmed data range will be used. This takes the burden off the user of this
+  function to check for valid indices in \a dataRange, e.g. when extending ranges coming from \ref
+  getDataSegments.
 */
-void QCPColorScaleAxisRectPrivate::draw(QCPPainter *painter)
+void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const
 {
-  if (mGradientImageInvalidated)
-    updateGradientImage();
+  if (!scatters) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; scatters->clear(); return; }
   
-  bool mirrorHorz = false;
-  bool mirrorVert = false;
-  if (mParentColorScale->mColorAxis)
+  QVector<QCPGraphData> data;
+  if (mDataSource)
   {
-    mirrorHorz = mParentColorScale->mColorAxis.data()->rangeReversed() && (mParentColorScale->type() == QCPAxis::atBottom || mParentColorScale->type() == QCPAxis::atTop);
-    mirrorVert = mParentColorScale->mColorAxis.data()->rangeReversed() && (mParentColorScale->type() == QCPAxis::atLeft || mParentColorScale->type() == QCPAxis::atRight);
+    getSourceData(&data, dataRange, mScatterSkip+1);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getOptimizedScatterData(&data, begin, end);
+  }
+  scatters->resize(data.size());
+  if (keyAxis->orientation() == Qt::Vertical)
+  {
+    for (int i=0; i<data.size(); ++i)
+    {
+      if (!qIsNaN(data.at(i).value))
+      {
+        (*scatters)[i].setX(valueAxis->coordToPixel(data.at(i).value));
+        (*scatters)[i].setY(keyAxis->coordToPixel(data.at(i).key));
+      }
+    }
+  } else
+  {
+    for (int i=0; i<data.size(); ++i)
+    {
+      if (!qIsNaN(data.at(i).value))
+      {
+        (*scatters)[i].setX(keyAxis->coordToPixel(data.at(i).key));
+        (*scatters)[i].setY(valueAxis->coordToPixel(data.at(i).value));
+      }
+    }
   }
-  
-  painter->drawImage(rect().adjusted(0, -1, 0, -1), mGradientImage.mirrored(mirrorHorz, mirrorVert));
-  QCPAxisRect::draw(painter);
 }
 
 /*! \internal
 
-  Uses the current gradient of the parent \ref QCPColorScale (specified in the constructor) to
-  generate a gradient image. This gradient image will be used in the \ref draw method.
+  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
+  coordinate points which are suitable for drawing the line style \ref lsLine.
+  
+  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
+  getLines if the line style is set accordingly.
+
+  \see dataToStepLeftLines, dataToStepRightLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
 */
-void QCPColorScaleAxisRectPrivate::updateGradientImage()
+QVector<QPointF> QCPGraph::dataToLines(const QVector<QCPGraphData> &data) const
 {
-  if (rect().isEmpty())
-    return;
+  QVector<QPointF> result;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+
+  result.reserve(data.size()+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  result.resize(data.size());
   
-  const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
-  int n = mParentColorScale->mGradient.levelCount();
-  int w, h;
-  QVector<double> data(n);
-  for (int i=0; i<n; ++i)
-    data[i] = i;
-  if (mParentColorScale->mType == QCPAxis::atBottom || mParentColorScale->mType == QCPAxis::atTop)
+  // transform data points to pixels:
+  if (keyAxis->orientation() == Qt::Vertical)
   {
-    w = n;
-    h = rect().height();
-    mGradientImage = QImage(w, h, format);
-    QVector<QRgb*> pixels;
-    for (int y=0; y<h; ++y)
-      pixels.append(reinterpret_cast<QRgb*>(mGradientImage.scanLine(y)));
-    mParentColorScale->mGradient.colorize(data.constData(), QCPRange(0, n-1), pixels.first(), n);
-    for (int y=1; y<h; ++y)
-      memcpy(pixels.at(y), pixels.first(), n*sizeof(QRgb));
-  } else
+    for (int i=0; i<data.size(); ++i)
+    {
+      result[i].setX(valueAxis->coordToPixel(data.at(i).value));
+      result[i].setY(keyAxis->coordToPixel(data.at(i).key));
+    }
+  } else // key axis is horizontal
   {
-    w = rect().width();
-    h = n;
-    mGradientImage = QImage(w, h, format);
-    for (int y=0; y<h; ++y)
+    for (int i=0; i<data.size(); ++i)
     {
-      QRgb *pixels = reinterpret_cast<QRgb*>(mGradientImage.scanLine(y));
-      const QRgb lineColor = mParentColorScale->mGradient.color(data[h-1-y], QCPRange(0, n-1));
-      for (int x=0; x<w; ++x)
-        pixels[x] = lineColor;
+      result[i].setX(keyAxis->coordToPixel(data.at(i).key));
+      result[i].setY(valueAxis->coordToPixel(data.at(i).value));
     }
   }
-  mGradientImageInvalidated = false;
+  return result;
 }
 
 /*! \internal
 
-  This slot is connected to the selectionChanged signals of the four axes in the constructor. It
-  synchronizes the selection state of the axes.
+  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
+  coordinate points which are suitable for drawing the line style \ref lsStepLeft.
+  
+  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
+  getLines if the line style is set accordingly.
+
+  \see dataToLines, dataToStepRightLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
 */
-void QCPColorScaleAxisRectPrivate::axisSelectionChanged(QCPAxis::SelectableParts selectedParts)
+QVector<QPointF> QCPGraph::dataToStepLeftLines(const QVector<QCPGraphData> &data) const
 {
-  // axis bases of four axes shall always (de-)selected synchronously:
-  QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atBottom << QCPAxis::atTop << QCPAxis::atLeft << QCPAxis::atRight;
-  foreach (QCPAxis::AxisType type, allAxisTypes)
+  QVector<QPointF> result;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  
+  result.reserve(data.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  result.resize(data.size()*2);
+  
+  // calculate steps from data and transform to pixel coordinates:
+  if (keyAxis->orientation() == Qt::Vertical)
   {
-    if (QCPAxis *senderAxis = qobject_cast<QCPAxis*>(sender()))
-      if (senderAxis->axisType() == type)
-        continue;
-    
-    if (axis(type)->selectableParts().testFlag(QCPAxis::spAxis))
+    double lastValue = valueAxis->coordToPixel(data.first().value);
+    for (int i=0; i<data.size(); ++i)
+    {
+      const double key = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+0].setX(lastValue);
+      result[i*2+0].setY(key);
+      lastValue = valueAxis->coordToPixel(data.at(i).value);
+      result[i*2+1].setX(lastValue);
+      result[i*2+1].setY(key);
+    }
+  } else // key axis is horizontal
+  {
+    double lastValue = valueAxis->coordToPixel(data.first().value);
+    for (int i=0; i<data.size(); ++i)
     {
-      if (selectedParts.testFlag(QCPAxis::spAxis))
-        axis(type)->setSelectedParts(axis(type)->selectedParts() | QCPAxis::spAxis);
-      else
-        axis(type)->setSelectedParts(axis(type)->selectedParts() & ~QCPAxis::spAxis);
+      const double key = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+0].setX(key);
+      result[i*2+0].setY(lastValue);
+      lastValue = valueAxis->coordToPixel(data.at(i).value);
+      result[i*2+1].setX(key);
+      result[i*2+1].setY(lastValue);
     }
   }
+  return result;
 }
 
 /*! \internal
 
-  This slot is connected to the selectableChanged signals of the four axes in the constructor. It
-  synchronizes the selectability of the axes.
+  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
+  coordinate points which are suitable for drawing the line style \ref lsStepRight.
+  
+  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
+  getLines if the line style is set accordingly.
+
+  \see dataToLines, dataToStepLeftLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
 */
-void QCPColorScaleAxisRectPrivate::axisSelectableChanged(QCPAxis::SelectableParts selectableParts)
+QVector<QPointF> QCPGraph::dataToStepRightLines(const QVector<QCPGraphData> &data) const
 {
-  // synchronize axis base selectability:
-  QList<QCPAxis::AxisType> allAxisTypes = QList<QCPAxis::AxisType>() << QCPAxis::atBottom << QCPAxis::atTop << QCPAxis::atLeft << QCPAxis::atRight;
-  foreach (QCPAxis::AxisType type, allAxisTypes)
+  QVector<QPointF> result;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  
+  result.reserve(data.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  result.resize(data.size()*2);
+  
+  // calculate steps from data and transform to pixel coordinates:
+  if (keyAxis->orientation() == Qt::Vertical)
   {
-    if (QCPAxis *senderAxis = qobject_cast<QCPAxis*>(sender()))
-      if (senderAxis->axisType() == type)
-        continue;
-    
-    if (axis(type)->selectableParts().testFlag(QCPAxis::spAxis))
+    double lastKey = keyAxis->coordToPixel(data.first().key);
+    for (int i=0; i<data.size(); ++i)
     {
-      if (selectableParts.testFlag(QCPAxis::spAxis))
-        axis(type)->setSelectableParts(axis(type)->selectableParts() | QCPAxis::spAxis);
-      else
-        axis(type)->setSelectableParts(axis(type)->selectableParts() & ~QCPAxis::spAxis);
+      const double value = valueAxis->coordToPixel(data.at(i).value);
+      result[i*2+0].setX(value);
+      result[i*2+0].setY(lastKey);
+      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+1].setX(value);
+      result[i*2+1].setY(lastKey);
+    }
+  } else // key axis is horizontal
+  {
+    double lastKey = keyAxis->coordToPixel(data.first().key);
+    for (int i=0; i<data.size(); ++i)
+    {
+      const double value = valueAxis->coordToPixel(data.at(i).value);
+      result[i*2+0].setX(lastKey);
+      result[i*2+0].setY(value);
+      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+1].setX(lastKey);
+      result[i*2+1].setY(value);
     }
   }
+  return result;
 }
-/* end of 'src/layoutelements/layoutelement-colorscale.cpp' */
-
-
-/* including file 'src/plottables/plottable-graph.cpp', size 72363           */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPGraphData
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPGraphData
-  \brief Holds the data of one single data point for QCPGraph.
-  
-  The stored data is:
-  \li \a key: coordinate on the key axis of this data point (this is the \a mainKey and the \a sortKey)
-  \li \a value: coordinate on the value axis of this data point (this is the \a mainValue)
-  
-  The container for storing multiple data points is \ref QCPGraphDataContainer. It is a typedef for
-  \ref QCPDataContainer with \ref QCPGraphData as the DataType template parameter. See the
-  documentation there for an explanation regarding the data type's generic methods.
-  
-  \see QCPGraphDataContainer
-*/
-
-/* start documentation of inline functions */
 
-/*! \fn double QCPGraphData::sortKey() const
-  
-  Returns the \a key member of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+/*! \internal
 
-/*! \fn static QCPGraphData QCPGraphData::fromSortKey(double sortKey)
-  
-  Returns a data point with the specified \a sortKey. All other members are set to zero.
+  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
+  coordinate points which are suitable for drawing the line style \ref lsStepCenter.
   
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
+  getLines if the line style is set accordingly.
 
-/*! \fn static static bool QCPGraphData::sortKeyIsMainKey()
-  
-  Since the member \a key is both the data point key coordinate and the data ordering parameter,
-  this method returns true.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
+  \see dataToLines, dataToStepLeftLines, dataToStepRightLines, dataToImpulseLines, getLines, drawLinePlot
 */
-
-/*! \fn double QCPGraphData::mainKey() const
+QVector<QPointF> QCPGraph::dataToStepCenterLines(const QVector<QCPGraphData> &data) const
+{
+  QVector<QPointF> result;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
   
-  Returns the \a key member of this data point.
+  result.reserve(data.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  result.resize(data.size()*2);
   
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+  // calculate steps from data and transform to pixel coordinates:
+  if (keyAxis->orientation() == Qt::Vertical)
+  {
+    double lastKey = keyAxis->coordToPixel(data.first().key);
+    double lastValue = valueAxis->coordToPixel(data.first().value);
+    result[0].setX(lastValue);
+    result[0].setY(lastKey);
+    for (int i=1; i<data.size(); ++i)
+    {
+      const double key = (keyAxis->coordToPixel(data.at(i).key)+lastKey)*0.5;
+      result[i*2-1].setX(lastValue);
+      result[i*2-1].setY(key);
+      lastValue = valueAxis->coordToPixel(data.at(i).value);
+      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+0].setX(lastValue);
+      result[i*2+0].setY(key);
+    }
+    result[data.size()*2-1].setX(lastValue);
+    result[data.size()*2-1].setY(lastKey);
+  } else // key axis is horizontal
+  {
+    double lastKey = keyAxis->coordToPixel(data.first().key);
+    double lastValue = valueAxis->coordToPixel(data.first().value);
+    result[0].setX(lastKey);
+    result[0].setY(lastValue);
+    for (int i=1; i<data.size(); ++i)
+    {
+      const double key = (keyAxis->coordToPixel(data.at(i).key)+lastKey)*0.5;
+      result[i*2-1].setX(key);
+      result[i*2-1].setY(lastValue);
+      lastValue = valueAxis->coordToPixel(data.at(i).value);
+      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+0].setX(key);
+      result[i*2+0].setY(lastValue);
+    }
+    result[data.size()*2-1].setX(lastKey);
+    result[data.size()*2-1].setY(lastValue);
+  }
+  return result;
+}
 
-/*! \fn double QCPGraphData::mainValue() const
-  
-  Returns the \a value member of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+/*! \internal
 
-/*! \fn QCPRange QCPGraphData::valueRange() const
-  
-  Returns a QCPRange with both lower and upper boundary set to \a value of this data point.
+  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
+  coordinate points which are suitable for drawing the line style \ref lsImpulse.
   
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
-
-/* end documentation of inline functions */
-
-/*!
-  Constructs a data point with key and value set to zero.
-*/
-QCPGraphData::QCPGraphData() :
-  key(0),
-  value(0)
-{
-}
+  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
+  getLines if the line style is set accordingly.
 
-/*!
-  Constructs a data point with the specified \a key and \a value.
+  \see dataToLines, dataToStepLeftLines, dataToStepRightLines, dataToStepCenterLines, getLines, drawImpulsePlot
 */
-QCPGraphData::QCPGraphData(double key, double value) :
-  key(key),
-  value(value)
+QVector<QPointF> QCPGraph::dataToImpulseLines(const QVector<QCPGraphData> &data) const
 {
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPGraph
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPGraph
-  \brief A plottable representing a graph in a plot.
-
-  \image html QCPGraph.png
-  
-  Usually you create new graphs by calling QCustomPlot::addGraph. The resulting instance can be
-  accessed via QCustomPlot::graph.
-
-  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
-  also access and modify the data via the \ref data method, which returns a pointer to the internal
-  \ref QCPGraphDataContainer.
-  
-  Graphs are used to display single-valued data. Single-valued means that there should only be one
-  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
-  want to plot non-single-valued curves, rather use the QCPCurve plottable.
-  
-  Gaps in the graph line can be created by adding data points with NaN as value
-  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
-  separated.
-  
-  \section qcpgraph-appearance Changing the appearance
-  
-  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
-  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
-  
-  \subsection filling Filling under or between graphs
+  QVector<QPointF> result;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
   
-  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
-  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
-  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
+  result.resize(data.size()*2); // no need to reserve 2 extra points because impulse plot has no fill
   
-  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
-  between this graph and another one, call \ref setChannelFillGraph with the other graph as
-  parameter.
-
-  \see QCustomPlot::addGraph, QCustomPlot::graph
-*/
+  // transform data points to pixels:
+  if (keyAxis->orientation() == Qt::Vertical)
+  {
+    for (int i=0; i<data.size(); ++i)
+    {
+      const double key = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+0].setX(valueAxis->coordToPixel(0));
+      result[i*2+0].setY(key);
+      result[i*2+1].setX(valueAxis->coordToPixel(data.at(i).value));
+      result[i*2+1].setY(key);
+    }
+  } else // key axis is horizontal
+  {
+    for (int i=0; i<data.size(); ++i)
+    {
+      const double key = keyAxis->coordToPixel(data.at(i).key);
+      result[i*2+0].setX(key);
+      result[i*2+0].setY(valueAxis->coordToPixel(0));
+      result[i*2+1].setX(key);
+      result[i*2+1].setY(valueAxis->coordToPixel(data.at(i).value));
+    }
+  }
+  return result;
+}
 
-/* start of documentation of inline functions */
+/*! \internal
 
-/*! \fn QSharedPointer<QCPGraphDataContainer> QCPGraph::data() const
+  Draws the fill of the graph using the specified \a painter, with the currently set brush.
   
-  Returns a shared pointer to the internal data storage of type \ref QCPGraphDataContainer. You may
-  use it to directly manipulate the data, which may be more convenient and faster than using the
-  regular \ref setData or \ref addData methods.
-*/
+  \a lines contains the points of the graph line, in pixel coordinates.
 
-/* end of documentation of inline functions */
+  If the fill is a normal fill towards the zero-value-line, only the points in \a lines are
+  required and two extra points at the zero-value-line, which are added by \ref addFillBasePoints
+  and removed by \ref removeFillBasePoints after the fill drawing is done.
 
-/*!
-  Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
-  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
-  the same orientation. If either of these restrictions is violated, a corresponding message is
-  printed to the debug output (qDebug), the construction is not aborted, though.
-  
-  The created QCPGraph is automatically registered with the QCustomPlot instance inferred from \a
-  keyAxis. This QCustomPlot instance takes ownership of the QCPGraph, so do not delete it manually
-  but use QCustomPlot::removePlottable() instead.
-  
-  To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
+  On the other hand if the fill is a channel fill between this QCPGraph and another QCPGraph (\a
+  mChannelFillGraph), the more complex polygon is calculated with the \ref getChannelFillPolygon
+  function, and then drawn.
+
+  \see drawLinePlot, drawImpulsePlot, drawScatterPlot
 */
-QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis)
+void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lines) const
 {
-  // special handling for QCPGraphs to maintain the simple graph interface:
-  mParentPlot->registerGraph(this);
-
-  setPen(QPen(Qt::blue, 0));
-  setBrush(Qt::NoBrush);
+  if (mLineStyle == lsImpulse) return; // fill doesn't make sense for impulse plot
+  if (painter->brush().style() == Qt::NoBrush || painter->brush().color().alpha() == 0) return;
   
-  setLineStyle(lsLine);
-  setScatterSkip(0);
-  setChannelFillGraph(0);
-  setAdaptiveSampling(true);
+  applyFillAntialiasingHint(painter);
+  if (!mChannelFillGraph)
+  {
+    // draw base fill under graph, fill goes all the way to the zero-value-line:
+    addFillBasePoints(lines);
+    painter->drawPolygon(QPolygonF(*lines));
+    removeFillBasePoints(lines);
+  } else
+  {
+    // draw channel fill between this graph and mChannelFillGraph:
+    painter->drawPolygon(getChannelFillPolygon(lines));
+  }
 }
 
-QCPGraph::~QCPGraph()
-{
-}
+/*! \internal
 
-/*! \overload
-  
-  Replaces the current data container with the provided \a data container.
-  
-  Since a QSharedPointer is used, multiple QCPGraphs may share the same data container safely.
-  Modifying the data in the container will then affect all graphs that share the container. Sharing
-  can be achieved by simply exchanging the data containers wrapped in shared pointers:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-1
-  
-  If you do not wish to share containers, but create a copy from an existing container, rather use
-  the \ref QCPDataContainer<DataType>::set method on the graph's data container directly:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-2
-  
-  \see addData
+  Draws scatter symbols at every point passed in \a scatters, given in pixel coordinates. The
+  scatters will be drawn with \a painter and have the appearance as specified in \a style.
+
+  \see drawLinePlot, drawImpulsePlot
 */
-void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
+void QCPGraph::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const
 {
-  mDataContainer = data;
+  applyScattersAntialiasingHint(painter);
+  style.applyTo(painter, mPen);
+  for (int i=0; i<scatters.size(); ++i)
+    style.drawShape(painter, scatters.at(i).x(), scatters.at(i).y());
 }
 
-/*! \overload
-  
-  Replaces the current data with the provided points in \a keys and \a values. The provided
-  vectors should have equal length. Else, the number of added points will be the size of the
-  smallest vector.
+/*!  \internal
   
-  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
-  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  Draws lines between the points in \a lines, given in pixel coordinates.
   
-  \see addData
+  \see drawScatterPlot, drawImpulsePlot, QCPAbstractPlottable1D::drawPolyline
 */
-void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+void QCPGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
 {
-  mDataContainer->clear();
-  addData(keys, values, alreadySorted);
+  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
+  {
+    applyDefaultAntialiasingHint(painter);
+    drawPolyline(painter, lines);
+  }
 }
 
-/*!
-  Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
-  \ref lsNone and \ref setScatterStyle to the desired scatter style.
-  
-  \see setScatterStyle
+/*! \internal
+
+  Draws impulses from the provided data, i.e. it connects all line pairs in \a lines, given in
+  pixel coordinates. The \a lines necessary for impulses are generated by \ref dataToImpulseLines
+  from the regular graph data points.
+
+  \see drawLinePlot, drawScatterPlot
 */
-void QCPGraph::setLineStyle(LineStyle ls)
+void QCPGraph::drawImpulsePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
 {
-  mLineStyle = ls;
+  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
+  {
+    applyDefaultAntialiasingHint(painter);
+    QPen oldPen = painter->pen();
+    QPen newPen = painter->pen();
+    newPen.setCapStyle(Qt::FlatCap); // so impulse line doesn't reach beyond zero-line
+    painter->setPen(newPen);
+    painter->drawLines(lines);
+    painter->setPen(oldPen);
+  }
 }
 
-/*!
-  Sets the visual appearance of single data points in the plot. If set to \ref QCPScatterStyle::ssNone, no scatter points
-  are drawn (e.g. for line-only-plots with appropriate line style).
+/*! \internal
+
+  Returns via \a lineData the data points that need to be visualized for this graph when plotting
+  graph lines, taking into consideration the currently visible axis ranges and, if \ref
+  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
+  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
+  getDataSegments).
+
+  This method is used by \ref getLines to retrieve the basic working set of data.
   
-  \see QCPScatterStyle, setLineStyle
+  During a coarse replot (\ref QCustomPlot::replotCoarse) with adaptive sampling enabled, only
+  every n-th data point is visited, such that the number of visited points per pixel stays within
+  the density the parent plot adapted to its frame time budget.
+
+  \see getOptimizedScatterData
 */
-void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
+void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
 {
-  mScatterStyle = style;
-}
-
-/*!
-  If scatters are displayed (scatter style not \ref QCPScatterStyle::ssNone), \a skip number of
-  scatter points are skipped/not drawn after every drawn scatter point.
-
-  This can be used to make the data appear sparser while for example still having a smooth line,
-  and to improve performance for very high density plots.
+  if (!lineData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (begin == end) return;
+  
+  int dataCount = end-begin;
+  int maxCount = std::numeric_limits<int>::max();
+  if (mAdaptiveSampling)
+  {
+    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+    if (2*keyPixelSpan+2 < (double)std::numeric_limits<int>::max())
+      maxCount = 2*keyPixelSpan+2;
+    // coarse replots decimate the data by a fixed stride before sampling it:
+    const double coarseCount = (keyPixelSpan+1)*mParentPlot->mCoarseSampleDensity;
+    if (mParentPlot->mCoarseReplot && dataCount > 2*coarseCount)
+    {
+      const int stride = dataCount/coarseCount;
+      QVector<QCPGraphData> decimated;
+      decimated.reserve(dataCount/stride+2);
+      for (int i=0; i<dataCount; i+=stride)
+        decimated.append(*(begin+i));
+      if ((dataCount-1)%stride != 0)
+        decimated.append(*(end-1));
+      getOptimizedLineData(lineData, decimated.constBegin(), decimated.constEnd());
+      return;
+    }
+  }
+  
+  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  {
+    QCPGraphDataContainer::const_iterator it = begin;
+    double minValue = it->value;
+    double maxValue = it->value;
+    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
+    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+    double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
+    double lastIntervalEndKey = currentIntervalStartKey;
+    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+    int intervalDataCount = 1;
+    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
+    while (it != end)
+    {
+      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
+      {
+        if (it->value < minValue)
+          minValue = it->value;
+        else if (it->value > maxValue)
+          maxValue = it->value;
+        ++intervalDataCount;
+      } else // new pixel interval started
+      {
+        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+        {
+          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
+        } else
+          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+        lastIntervalEndKey = (it-1)->key;
+        minValue = it->value;
+        maxValue = it->value;
+        currentIntervalFirstPoint = it;
+        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+        intervalDataCount = 1;
+      }
+      ++it;
+    }
+    // handle last interval:
+    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+    {
+      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+    } else
+      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+    
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  {
+    QCPGraphDataContainer::const_iterator it = begin;
+    lineData->reserve(dataCount+2); // +2 for possible fill end points
+    while (it != end)
+    {
+      lineData->append(*it);
+      ++it;
+    }
+  }
+}
 
-  If \a skip is set to 0 (default), all scatter points are drawn.
+/*! \internal
 
-  \see setScatterStyle
-*/
-void QCPGraph::setScatterSkip(int skip)
-{
-  mScatterSkip = qMax(0, skip);
-}
+  Returns via \a scatterData the data points that need to be visualized for this graph when
+  plotting scatter points, taking into consideration the currently visible axis ranges and, if \ref
+  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
+  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
+  getDataSegments).
 
-/*!
-  Sets the target graph for filling the area between this graph and \a targetGraph with the current
-  brush (\ref setBrush).
-  
-  When \a targetGraph is set to 0, a normal graph fill to the zero-value-line will be shown. To
-  disable any filling, set the brush to Qt::NoBrush.
+  This method is used by \ref getScatters to retrieve the basic working set of data.
 
-  \see setBrush
+  \see getOptimizedLineData
 */
-void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
+void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const
 {
-  // prevent setting channel target to this graph itself:
-  if (targetGraph == this)
+  if (!scatterData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const int scatterModulo = mScatterSkip+1;
+  const bool doScatterSkip = mScatterSkip > 0;
+  int beginIndex = begin-mDataContainer->constBegin();
+  int endIndex = end-mDataContainer->constBegin();
+  while (doScatterSkip && begin != end && beginIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
   {
-    qDebug() << Q_FUNC_INFO << "targetGraph is this graph itself";
-    mChannelFillGraph = 0;
-    return;
+    ++beginIndex;
+    ++begin;
   }
-  // prevent setting channel target to a graph not in the plot:
-  if (targetGraph && targetGraph->mParentPlot != mParentPlot)
+  if (begin == end) return;
+  int dataCount = end-begin;
+  int maxCount = std::numeric_limits<int>::max();
+  if (mAdaptiveSampling)
   {
-    qDebug() << Q_FUNC_INFO << "targetGraph not in same plot";
-    mChannelFillGraph = 0;
-    return;
+    int keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+    maxCount = 2*keyPixelSpan+2;
   }
   
-  mChannelFillGraph = targetGraph;
+  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  {
+    double valueMaxRange = valueAxis->range().upper;
+    double valueMinRange = valueAxis->range().lower;
+    QCPGraphDataContainer::const_iterator it = begin;
+    int itIndex = beginIndex;
+    double minValue = it->value;
+    double maxValue = it->value;
+    QCPGraphDataContainer::const_iterator minValueIt = it;
+    QCPGraphDataContainer::const_iterator maxValueIt = it;
+    QCPGraphDataContainer::const_iterator currentIntervalStart = it;
+    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+    double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
+    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+    int intervalDataCount = 1;
+    // advance iterator to second (non-skipped) data point because adaptive sampling works in 1 point retrospect:
+    if (!doScatterSkip)
+      ++it;
+    else
+    {
+      itIndex += scatterModulo;
+      if (itIndex < endIndex) // make sure we didn't jump over end
+        it += scatterModulo;
+      else
+      {
+        it = end;
+        itIndex = endIndex;
+      }
+    }
+    // main loop over data points:
+    while (it != end)
+    {
+      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this pixel if necessary
+      {
+        if (it->value < minValue && it->value > valueMinRange && it->value < valueMaxRange)
+        {
+          minValue = it->value;
+          minValueIt = it;
+        } else if (it->value > maxValue && it->value > valueMinRange && it->value < valueMaxRange)
+        {
+          maxValue = it->value;
+          maxValueIt = it;
+        }
+        ++intervalDataCount;
+      } else // new pixel started
+      {
+        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
+        {
+          // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
+          double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+          int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
+          QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
+          int c = 0;
+          while (intervalIt != it)
+          {
+            if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt->value > valueMinRange && intervalIt->value < valueMaxRange)
+              scatterData->append(*intervalIt);
+            ++c;
+            if (!doScatterSkip)
+              ++intervalIt;
+            else
+              intervalIt += scatterModulo; // since we know indices of "currentIntervalStart", "intervalIt" and "it" are multiples of scatterModulo, we can't accidentally jump over "it" here
+          }
+        } else if (currentIntervalStart->value > valueMinRange && currentIntervalStart->value < valueMaxRange)
+          scatterData->append(*currentIntervalStart);
+        minValue = it->value;
+        maxValue = it->value;
+        currentIntervalStart = it;
+        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+        intervalDataCount = 1;
+      }
+      // advance to next data point:
+      if (!doScatterSkip)
+        ++it;
+      else
+      {
+        itIndex += scatterModulo;
+        if (itIndex < endIndex) // make sure we didn't jump over end
+          it += scatterModulo;
+        else
+        {
+          it = end;
+          itIndex = endIndex;
+        }
+      }
+    }
+    // handle last interval:
+    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
+    {
+      // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
+      double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+      int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
+      QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
+      int intervalItIndex = intervalIt-mDataContainer->constBegin();
+      int c = 0;
+      while (intervalIt != it)
+      {
+        if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt->value > valueMinRange && intervalIt->value < valueMaxRange)
+          scatterData->append(*intervalIt);
+        ++c;
+        if (!doScatterSkip)
+          ++intervalIt;
+        else // here we can't guarantee that adding scatterModulo doesn't exceed "it" (because "it" is equal to "end" here, and "end" isn't scatterModulo-aligned), so check via index comparison:
+        {
+          intervalItIndex += scatterModulo;
+          if (intervalItIndex < itIndex)
+            intervalIt += scatterModulo;
+          else
+          {
+            intervalIt = it;
+            intervalItIndex = itIndex;
+          }
+        }
+      }
+    } else if (currentIntervalStart->value > valueMinRange && currentIntervalStart->value < valueMaxRange)
+      scatterData->append(*currentIntervalStart);
+    
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  {
+    QCPGraphDataContainer::const_iterator it = begin;
+    int itIndex = beginIndex;
+    scatterData->reserve(dataCount);
+    while (it != end)
+    {
+      scatterData->append(*it);
+      // advance to next data point:
+      if (!doScatterSkip)
+        ++it;
+      else
+      {
+        itIndex += scatterModulo;
+        if (itIndex < endIndex)
+          it += scatterModulo;
+        else
+        {
+          it = end;
+          itIndex = endIndex;
+        }
+      }
+    }
+  }
 }
 
 /*!
-  Sets whether adaptive sampling shall be used when plotting this graph. QCustomPlot's adaptive
-  sampling technique can drastically improve the replot performance for graphs with a larger number
-  of points (e.g. above 10,000), without notably changing the appearance of the graph.
-  
-  By default, adaptive sampling is enabled. Even if enabled, QCustomPlot decides whether adaptive
-  sampling shall actually be used on a per-graph basis. So leaving adaptive sampling enabled has no
-  disadvantage in almost all cases.
-  
-  \image html adaptive-sampling-line.png "A line plot of 500,000 points without and with adaptive sampling"
-  
-  As can be seen, line plots experience no visual degradation from adaptive sampling. Outliers are
-  reproduced reliably, as well as the overall shape of the data set. The replot time reduces
-  dramatically though. This allows QCustomPlot to display large amounts of data in realtime.
-  
-  \image html adaptive-sampling-scatter.png "A scatter plot of 100,000 points without and with adaptive sampling"
-  
-  Care must be taken when using high-density scatter plots in combination with adaptive sampling.
-  The adaptive sampling algorithm treats scatter plots more carefully than line plots which still
-  gives a significant reduction of replot times, but not quite as much as for line plots. This is
-  because scatter plots inherently need more data points to be preserved in order to still resemble
-  the original, non-adaptive-sampling plot. As shown above, the results still aren't quite
-  identical, as banding occurs for the outer data points. This is in fact intentional, such that
-  the boundaries of the data cloud stay visible to the viewer. How strong the banding appears,
-  depends on the point density, i.e. the number of points in the plot.
-  
-  For some situations with scatter plots it might thus be desirable to manually turn adaptive
-  sampling off. For example, when saving the plot to disk. This can be achieved by setting \a
-  enabled to false before issuing a command like \ref QCustomPlot::savePng, and setting \a enabled
-  back to true afterwards.
+  This method outputs the currently visible data range via \a begin and \a end. The returned range
+  will also never exceed \a rangeRestriction.
+
+  This method takes into account that the drawing of data lines at the axis rect border always
+  requires the points just outside the visible axis range. So \a begin and \a end may actually
+  indicate a range that contains one additional data point to the left and right of the visible
+  axis range.
 */
-void QCPGraph::setAdaptiveSampling(bool enabled)
+void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const
 {
-  mAdaptiveSampling = enabled;
+  if (rangeRestriction.isEmpty())
+  {
+    end = mDataContainer->constEnd();
+    begin = end;
+  } else
+  {
+    QCPAxis *keyAxis = mKeyAxis.data();
+    QCPAxis *valueAxis = mValueAxis.data();
+    if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+    // get visible data range:
+    begin = mDataContainer->findBegin(keyAxis->range().lower);
+    end = mDataContainer->findEnd(keyAxis->range().upper);
+    // limit lower/upperEnd to rangeRestriction:
+    mDataContainer->limitIteratorsToDataRange(begin, end, rangeRestriction); // this also ensures rangeRestriction outside data bounds doesn't break anything
+  }
 }
 
-/*! \overload
-  
-  Adds the provided points in \a keys and \a values to the current data. The provided vectors
-  should have equal length. Else, the number of added points will be the size of the smallest
-  vector.
+/*! \internal
   
-  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
-  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  The line vector generated by e.g. \ref getLines describes only the line that connects the data
+  points. If the graph needs to be filled, two additional points need to be added at the
+  value-zero-line in the lower and upper key positions of the graph. This function calculates these
+  points and adds them to the end of \a lineData. Since the fill is typically drawn before the line
+  stroke, these added points need to be removed again after the fill is done, with the
+  removeFillBasePoints function.
+
+  The expanding of \a lines by two points will not cause unnecessary memory reallocations, because
+  the data vector generation functions (e.g. \ref getLines) reserve two extra points when they
+  allocate memory for \a lines.
   
-  Alternatively, you can also access and modify the data directly via the \ref data method, which
-  returns a pointer to the internal data container.
+  \see removeFillBasePoints, lowerFillBasePoint, upperFillBasePoint
 */
-void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+void QCPGraph::addFillBasePoints(QVector<QPointF> *lines) const
 {
-  if (keys.size() != values.size())
-    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
-  const int n = qMin(keys.size(), values.size());
-  QVector<QCPGraphData> tempData(n);
-  QVector<QCPGraphData>::iterator it = tempData.begin();
-  const QVector<QCPGraphData>::iterator itEnd = tempData.end();
-  int i = 0;
-  while (it != itEnd)
+  if (!mKeyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  if (!lines) { qDebug() << Q_FUNC_INFO << "passed null as lineData"; return; }
+  if (lines->isEmpty()) return;
+  
+  // append points that close the polygon fill at the key axis:
+  if (mKeyAxis.data()->orientation() == Qt::Vertical)
   {
-    it->key = keys[i];
-    it->value = values[i];
-    ++it;
-    ++i;
+    *lines << upperFillBasePoint(lines->last().y());
+    *lines << lowerFillBasePoint(lines->first().y());
+  } else
+  {
+    *lines << upperFillBasePoint(lines->last().x());
+    *lines << lowerFillBasePoint(lines->first().x());
   }
-  mDataContainer->add(tempData, alreadySorted); // don't modify tempData beyond this to prevent copy on write
 }
 
-/*! \overload
+/*! \internal
   
-  Adds the provided data point as \a key and \a value to the current data.
+  removes the two points from \a lines that were added by \ref addFillBasePoints.
   
-  Alternatively, you can also access and modify the data directly via the \ref data method, which
-  returns a pointer to the internal data container.
+  \see addFillBasePoints, lowerFillBasePoint, upperFillBasePoint
 */
-void QCPGraph::addData(double key, double value)
-{
-  mDataContainer->add(QCPGraphData(key, value));
-}
-
-/* inherits documentation from base class */
-double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+void QCPGraph::removeFillBasePoints(QVector<QPointF> *lines) const
 {
-  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
-    return -1;
-  if (!mKeyAxis || !mValueAxis)
-    return -1;
+  if (!lines) { qDebug() << Q_FUNC_INFO << "passed null as lineData"; return; }
+  if (lines->isEmpty()) return;
   
-  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
-  {
-    QCPGraphDataContainer::const_iterator closestDataPoint = mDataContainer->constEnd();
-    double result = pointDistance(pos, closestDataPoint);
-    if (details)
-    {
-      int pointIndex = closestDataPoint-mDataContainer->constBegin();
-      details->setValue(QCPDataSelection(QCPDataRange(pointIndex, pointIndex+1)));
-    }
-    return result;
-  } else
-    return -1;
-}
-
-/* inherits documentation from base class */
-QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
-{
-  return mDataContainer->keyRange(foundRange, inSignDomain);
-}
-
-/* inherits documentation from base class */
-QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
-{
-  return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
+  lines->remove(lines->size()-2, 2);
 }
 
-/* inherits documentation from base class */
-void QCPGraph::draw(QCPPainter *painter)
-{
-  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
-  if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
+/*! \internal
   
-  QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
+  called by \ref addFillBasePoints to conveniently assign the point which closes the fill polygon
+  on the lower side of the zero-value-line parallel to the key axis. The logarithmic axis scale
+  case is a bit special, since the zero-value-line in pixel coordinates is in positive or negative
+  infinity. So this case is handled separately by just closing the fill polygon on the axis which
+  lies in the direction towards the zero value.
   
-  // loop over and draw segments of unselected/selected data:
-  QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
-  getDataSegments(selectedSegments, unselectedSegments);
-  allSegments << unselectedSegments << selectedSegments;
-  for (int i=0; i<allSegments.size(); ++i)
+  \a lowerKey will be the the key (in pixels) of the returned point. Depending on whether the key
+  axis is horizontal or vertical, \a lowerKey will end up as the x or y value of the returned
+  point, respectively.
+  
+  \see upperFillBasePoint, addFillBasePoints
+*/
+QPointF QCPGraph::lowerFillBasePoint(double lowerKey) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(); }
+  
+  QPointF point;
+  if (valueAxis->scaleType() == QCPAxis::stLinear)
   {
-    bool isSelectedSegment = i >= unselectedSegments.size();
-    // get line pixel points appropriate to line style:
-    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
-    getLines(&lines, lineDataRange);
-    
-    // check data validity if flag set:
-#ifdef QCUSTOMPLOT_CHECK_DATA
-    QCPGraphDataContainer::const_iterator it;
-    for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd(); ++it)
+    if (keyAxis->axisType() == QCPAxis::atLeft)
     {
-      if (QCP::isInvalidData(it->key, it->value))
-        qDebug() << Q_FUNC_INFO << "Data point at" << it->key << "invalid." << "Plottable name:" << name();
+      point.setX(valueAxis->coordToPixel(0));
+      point.setY(lowerKey);
+    } else if (keyAxis->axisType() == QCPAxis::atRight)
+    {
+      point.setX(valueAxis->coordToPixel(0));
+      point.setY(lowerKey);
+    } else if (keyAxis->axisType() == QCPAxis::atTop)
+    {
+      point.setX(lowerKey);
+      point.setY(valueAxis->coordToPixel(0));
+    } else if (keyAxis->axisType() == QCPAxis::atBottom)
+    {
+      point.setX(lowerKey);
+      point.setY(valueAxis->coordToPixel(0));
     }
-#endif
-    
-    // draw fill of graph:
-    if (isSelectedSegment && mSelectionDecorator)
-      mSelectionDecorator->applyBrush(painter);
-    else
-      painter->setBrush(mBrush);
-    painter->setPen(Qt::NoPen);
-    drawFill(painter, &lines);
-    
-    // draw line:
-    if (mLineStyle != lsNone)
+  } else // valueAxis->mScaleType == QCPAxis::stLogarithmic
+  {
+    // In logarithmic scaling we can't just draw to value zero so we just fill all the way
+    // to the axis which is in the direction towards zero
+    if (keyAxis->orientation() == Qt::Vertical)
     {
-      if (isSelectedSegment && mSelectionDecorator)
-        mSelectionDecorator->applyPen(painter);
-      else
-        painter->setPen(mPen);
-      painter->setBrush(Qt::NoBrush);
-      if (mLineStyle == lsImpulse)
-        drawImpulsePlot(painter, lines);
+      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
+          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
+        point.setX(keyAxis->axisRect()->right());
       else
-        drawLinePlot(painter, lines); // also step plots can be drawn as a line plot
-    }
-    
-    // draw scatters:
-    QCPScatterStyle finalScatterStyle = mScatterStyle;
-    if (isSelectedSegment && mSelectionDecorator)
-      finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
-    if (!finalScatterStyle.isNone())
+        point.setX(keyAxis->axisRect()->left());
+      point.setY(lowerKey);
+    } else if (keyAxis->axisType() == QCPAxis::atTop || keyAxis->axisType() == QCPAxis::atBottom)
     {
-      getScatters(&scatters, allSegments.at(i));
-      drawScatterPlot(painter, scatters, finalScatterStyle);
+      point.setX(lowerKey);
+      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
+          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
+        point.setY(keyAxis->axisRect()->top());
+      else
+        point.setY(keyAxis->axisRect()->bottom());
     }
   }
-  
-  // draw other selection decoration that isn't just line/scatter pens and brushes:
-  if (mSelectionDecorator)
-    mSelectionDecorator->drawDecoration(painter, selection());
+  return point;
 }
 
-/* inherits documentation from base class */
-void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+/*! \internal
+  
+  called by \ref addFillBasePoints to conveniently assign the point which closes the fill
+  polygon on the upper side of the zero-value-line parallel to the key axis. The logarithmic axis
+  scale case is a bit special, since the zero-value-line in pixel coordinates is in positive or
+  negative infinity. So this case is handled separately by just closing the fill polygon on the
+  axis which lies in the direction towards the zero value.
+
+  \a upperKey will be the the key (in pixels) of the returned point. Depending on whether the key
+  axis is horizontal or vertical, \a upperKey will end up as the x or y value of the returned
+  point, respectively.
+  
+  \see lowerFillBasePoint, addFillBasePoints
+*/
+QPointF QCPGraph::upperFillBasePoint(double upperKey) const
 {
-  // draw fill:
-  if (mBrush.style() != Qt::NoBrush)
-  {
-    applyFillAntialiasingHint(painter);
-    painter->fillRect(QRectF(rect.left(), rect.top()+rect.height()/2.0, rect.width(), rect.height()/3.0), mBrush);
-  }
-  // draw line vertically centered:
-  if (mLineStyle != lsNone)
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(); }
+  
+  QPointF point;
+  if (valueAxis->scaleType() == QCPAxis::stLinear)
   {
-    applyDefaultAntialiasingHint(painter);
-    painter->setPen(mPen);
-    painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()/2.0, rect.right()+5, rect.top()+rect.height()/2.0)); // +5 on x2 else last segment is missing from dashed/dotted pens
-  }
-  // draw scatter symbol:
-  if (!mScatterStyle.isNone())
+    if (keyAxis->axisType() == QCPAxis::atLeft)
+    {
+      point.setX(valueAxis->coordToPixel(0));
+      point.setY(upperKey);
+    } else if (keyAxis->axisType() == QCPAxis::atRight)
+    {
+      point.setX(valueAxis->coordToPixel(0));
+      point.setY(upperKey);
+    } else if (keyAxis->axisType() == QCPAxis::atTop)
+    {
+      point.setX(upperKey);
+      point.setY(valueAxis->coordToPixel(0));
+    } else if (keyAxis->axisType() == QCPAxis::atBottom)
+    {
+      point.setX(upperKey);
+      point.setY(valueAxis->coordToPixel(0));
+    }
+  } else // valueAxis->mScaleType == QCPAxis::stLogarithmic
   {
-    applyScattersAntialiasingHint(painter);
-    // scale scatter pixmap if it's too large to fit in legend icon rect:
-    if (mScatterStyle.shape() == QCPScatterStyle::ssPixmap && (mScatterStyle.pixmap().size().width() > rect.width() || mScatterStyle.pixmap().size().height() > rect.height()))
+    // In logarithmic scaling we can't just draw to value 0 so we just fill all the way
+    // to the axis which is in the direction towards 0
+    if (keyAxis->orientation() == Qt::Vertical)
     {
-      QCPScatterStyle scaledStyle(mScatterStyle);
-      scaledStyle.setPixmap(scaledStyle.pixmap().scaled(rect.size().toSize(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-      scaledStyle.applyTo(painter, mPen);
-      scaledStyle.drawShape(painter, QRectF(rect).center());
-    } else
+      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
+          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
+        point.setX(keyAxis->axisRect()->right());
+      else
+        point.setX(keyAxis->axisRect()->left());
+      point.setY(upperKey);
+    } else if (keyAxis->axisType() == QCPAxis::atTop || keyAxis->axisType() == QCPAxis::atBottom)
     {
-      mScatterStyle.applyTo(painter, mPen);
-      mScatterStyle.drawShape(painter, QRectF(rect).center());
+      point.setX(upperKey);
+      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
+          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
+        point.setY(keyAxis->axisRect()->top());
+      else
+        point.setY(keyAxis->axisRect()->bottom());
     }
   }
+  return point;
 }
 
 /*! \internal
+  
+  Generates the polygon needed for drawing channel fills between this graph and the graph specified
+  in \a mChannelFillGraph (see \ref setChannelFillGraph). The data points representing the line of
+  this graph in pixel coordinates must be passed in \a lines, the corresponding points of the other
+  graph are generated by calling its \ref getLines method.
+  
+  Both lines are cropped to the key interval in which they overlap, by binary search on their
+  (sorted) pixel keys, and then written into the polygon in a single pass each, with the other
+  line reversed. The polygon's buffer is kept between calls, so regular replots don't reallocate
+  it. The cost is thus linear in the number of visible line points.
 
-  This method retrieves an optimized set of data points via \ref getOptimizedLineData, an branches
-  out to the line style specific functions such as \ref dataToLines, \ref dataToStepLeftLines, etc.
-  according to the line style of the graph.
-
-  \a lines will be filled with points in pixel coordinates, that can be drawn with the according
-  draw functions like \ref drawLinePlot and \ref drawImpulsePlot. The points returned in \a lines
-  aren't necessarily the original data points. For example, step line styles require additional
-  points to form the steps when drawn. If the line style of the graph is \ref lsNone, the \a
-  lines vector will be empty.
-
-  \a dataRange specifies the beginning and ending data indices that will be taken into account for
-  conversion. In this function, the specified range may exceed the total data bounds without harm:
-  a correspondingly trimmed data range will be used. This takes the burden off the user of this
-  function to check for valid indices in \a dataRange, e.g. when extending ranges coming from \ref
-  getDataSegments.
-
-  \see getScatters
+  This method may return an empty polygon if the key ranges of the two graphs have no overlap of if
+  they don't have the same orientation (e.g. one key axis vertical, the other horizontal). For
+  increased performance (due to implicit sharing), it is recommended to keep the returned QPolygonF
+  const.
 */
-void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
+const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lines) const
 {
-  if (!lines) return;
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
-  {
-    lines->clear();
-    return;
-  }
+  if (!mChannelFillGraph)
+    return QPolygonF();
   
-  QVector<QCPGraphData> lineData;
-  if (mLineStyle != lsNone)
-    getOptimizedLineData(&lineData, begin, end);
-
-  switch (mLineStyle)
-  {
-    case lsNone: lines->clear(); break;
-    case lsLine: *lines = dataToLines(lineData); break;
-    case lsStepLeft: *lines = dataToStepLeftLines(lineData); break;
-    case lsStepRight: *lines = dataToStepRightLines(lineData); break;
-    case lsStepCenter: *lines = dataToStepCenterLines(lineData); break;
-    case lsImpulse: *lines = dataToImpulseLines(lineData); break;
-  }
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPolygonF(); }
+  if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; return QPolygonF(); }
+  
+  if (mChannelFillGraph.data()->mKeyAxis.data()->orientation() != keyAxis->orientation())
+    return QPolygonF(); // don't have same axis orientation, can't fill that (Note: if keyAxis fits, valueAxis will fit too, because it's always orthogonal to keyAxis)
+  
+  if (lines->isEmpty()) return QPolygonF();
+  QVector<QPointF> otherLines;
+  mChannelFillGraph.data()->getLines(&otherLines, QCPDataRange(0, mChannelFillGraph.data()->dataCount()));
+  if (otherLines.isEmpty()) return QPolygonF();
+  
+  // the key is the x pixel coordinate for horizontal key axes. For vertical ones it's the negative y
+  // pixel coordinate, since in pixel coordinates y increases from top to bottom:
+  const bool keyIsX = keyAxis->orientation() == Qt::Horizontal;
+  // if an axis range is reversed, the line point keys will be descending. Reverse them, since following algorithm assumes ascending keys:
+  QVector<QPointF> reversedLines;
+  if ((keyIsX ? lines->first().x() : -lines->first().y()) > (keyIsX ? lines->last().x() : -lines->last().y()))
+  {
+    reversedLines = *lines;
+    std::reverse(reversedLines.begin(), reversedLines.end());
+    lines = &reversedLines;
+  }
+  if ((keyIsX ? otherLines.first().x() : -otherLines.first().y()) > (keyIsX ? otherLines.last().x() : -otherLines.last().y()))
+    std::reverse(otherLines.begin(), otherLines.end());
+  
+  // key interval in which both lines overlap:
+  const double lowKey = qMax(keyIsX ? lines->first().x() : -lines->first().y(), keyIsX ? otherLines.first().x() : -otherLines.first().y());
+  const double highKey = qMin(keyIsX ? lines->last().x() : -lines->last().y(), keyIsX ? otherLines.last().x() : -otherLines.last().y());
+  if (lowKey > highKey)
+    return QPolygonF(); // key ranges have no overlap
+  
+  // join both lines, the other one reversed, otherwise the polygon will be twisted:
+  mChannelFillPolygon.resize(0); // keeps the capacity of previous replots
+  mChannelFillPolygon.reserve(lines->size()+otherLines.size());
+  if (!appendChannelFillLine(&mChannelFillPolygon, *lines, lowKey, highKey, keyIsX, false) ||
+      !appendChannelFillLine(&mChannelFillPolygon, otherLines, lowKey, highKey, keyIsX, true))
+    return QPolygonF();
+  return mChannelFillPolygon;
 }
 
 /*! \internal
-
-  This method retrieves an optimized set of data points via \ref getOptimizedScatterData and then
-  converts them to pixel coordinates. The resulting points are returned in \a scatters, and can be
-  passed to \ref drawScatterPlot.
-
-  \a dataRange specifies the beginning and ending data indices that will be taken into account for
-  conversion. In this function, the specified range may exceed the total data bounds without harm:
-  a correspondingly trimmed data range will be used. This takes the burden off the user of this
-  function to check for valid indices in \a dataRange, e.g. when extending ranges coming from \ref
-  getDataSegments.
+  
+  Appends the part of \a line (in pixel coordinates, with ascending keys) that lies in the key
+  interval from \a lowKey to \a highKey to \a polygon. The first and last appended points are
+  linearly interpolated to lie exactly at \a lowKey and \a highKey. If \a reversed is true, the
+  points are appended in descending key order.
+  
+  \a keyIsX specifies whether the key is the x pixel coordinate, or the negative y pixel coordinate
+  (vertical key axis). The interval bounds are found by binary search, so apart from the appended
+  points, this method has logarithmic cost.
+  
+  Returns false if \a line has less than two points, so no interpolation is possible.
+  
+  Used to calculate the channel fill polygon, see \ref getChannelFillPolygon.
 */
-void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const
+bool QCPGraph::appendChannelFillLine(QPolygonF *polygon, const QVector<QPointF> &line, double lowKey, double highKey, bool keyIsX, bool reversed) const
 {
-  if (!scatters) return;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; scatters->clear(); return; }
+  const int size = line.size();
+  if (size < 2)
+    return false; // need at least two points for interpolation
   
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  // find first point with key above lowKey, and first point with key at or above highKey:
+  int begin = 0;
+  int high = size;
+  while (begin < high)
   {
-    scatters->clear();
-    return;
+    const int mid = (begin+high)/2;
+    if ((keyIsX ? line.at(mid).x() : -line.at(mid).y()) > lowKey)
+      high = mid;
+    else
+      begin = mid+1;
+  }
+  int end = 0;
+  high = size;
+  while (end < high)
+  {
+    const int mid = (end+high)/2;
+    if ((keyIsX ? line.at(mid).x() : -line.at(mid).y()) >= highKey)
+      high = mid;
+    else
+      end = mid+1;
   }
   
-  QVector<QCPGraphData> data;
-  getOptimizedScatterData(&data, begin, end);
-  scatters->resize(data.size());
-  if (keyAxis->orientation() == Qt::Vertical)
+  // interpolate the points at lowKey and highKey on the line segments crossing them:
+  QPointF boundPoints[2];
+  const double boundKeys[2] = {lowKey, highKey};
+  const int segmentEnds[2] = {qBound(1, begin, size-1), qBound(1, end, size-1)};
+  for (int i=0; i<2; ++i)
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      if (!qIsNaN(data.at(i).value))
-      {
-        (*scatters)[i].setX(valueAxis->coordToPixel(data.at(i).value));
-        (*scatters)[i].setY(keyAxis->coordToPixel(data.at(i).key));
-      }
-    }
+    const QPointF &p0 = line.at(segmentEnds[i]-1);
+    const QPointF &p1 = line.at(segmentEnds[i]);
+    const double key0 = keyIsX ? p0.x() : -p0.y();
+    const double key1 = keyIsX ? p1.x() : -p1.y();
+    if (key1 != key0)
+      boundPoints[i] = p0+(p1-p0)*((boundKeys[i]-key0)/(key1-key0));
+    else // avoid division by zero in step plots
+      boundPoints[i] = keyIsX ? QPointF(boundKeys[i], p0.y()) : QPointF(p0.x(), -boundKeys[i]);
+  }
+  
+  if (!reversed)
+  {
+    *polygon << boundPoints[0];
+    for (int i=begin; i<end; ++i)
+      *polygon << line.at(i);
+    *polygon << boundPoints[1];
   } else
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      if (!qIsNaN(data.at(i).value))
-      {
-        (*scatters)[i].setX(keyAxis->coordToPixel(data.at(i).key));
-        (*scatters)[i].setY(valueAxis->coordToPixel(data.at(i).value));
-      }
-    }
+    *polygon << boundPoints[1];
+    for (int i=end-1; i>=begin; --i)
+      *polygon << line.at(i);
+    *polygon << boundPoints[0];
   }
+  return true;
 }
 
 /*! \internal
-
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsLine.
   
-  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
-  getLines if the line style is set accordingly.
-
-  \see dataToStepLeftLines, dataToStepRightLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
+  Calculates the minimum distance in pixels the graph's representation has from the given \a
+  pixelPoint. This is used to determine whether the graph was clicked or not, e.g. in \ref
+  selectTest. The closest data point to \a pixelPoint is returned in \a closestData. Note that if
+  the graph has a line representation, the returned distance may be smaller than the distance to
+  the \a closestData point, since the distance to the graph line is also taken into account.
+  
+  If either the graph has no data or if the line style is \ref lsNone and the scatter style's shape
+  is \ref QCPScatterStyle::ssNone (i.e. there is no visual representation of the graph), returns -1.0.
 */
-QVector<QPointF> QCPGraph::dataToLines(const QVector<QCPGraphData> &data) const
+double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const
 {
-  QVector<QPointF> result;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
-
-  result.reserve(data.size()+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  result.resize(data.size());
+  closestData = mDataContainer->constEnd();
+  if (mDataContainer->isEmpty())
+    return -1.0;
+  if (mLineStyle == lsNone && mScatterStyle.isNone())
+    return -1.0;
   
-  // transform data points to pixels:
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    for (int i=0; i<data.size(); ++i)
-    {
-      result[i].setX(valueAxis->coordToPixel(data.at(i).value));
-      result[i].setY(keyAxis->coordToPixel(data.at(i).key));
-    }
-  } else // key axis is horizontal
+  // calculate minimum distances to graph data points and find closestData iterator:
+  double minDistSqr = std::numeric_limits<double>::max();
+  // determine which key range comes into question, taking selection tolerance around pos into account:
+  double posKeyMin, posKeyMax, dummy;
+  pixelsToCoords(pixelPoint-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
+  pixelsToCoords(pixelPoint+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
+  if (posKeyMin > posKeyMax)
+    qSwap(posKeyMin, posKeyMax);
+  // iterate over found data points and then choose the one with the shortest distance to pos:
+  QCPGraphDataContainer::const_iterator begin = mDataContainer->findBegin(posKeyMin, true);
+  QCPGraphDataContainer::const_iterator end = mDataContainer->findEnd(posKeyMax, true);
+  for (QCPGraphDataContainer::const_iterator it=begin; it!=end; ++it)
   {
-    for (int i=0; i<data.size(); ++i)
+    const double currentDistSqr = QCPVector2D(coordsToPixels(it->key, it->value)-pixelPoint).lengthSquared();
+    if (currentDistSqr < minDistSqr)
     {
-      result[i].setX(keyAxis->coordToPixel(data.at(i).key));
-      result[i].setY(valueAxis->coordToPixel(data.at(i).value));
+      minDistSqr = currentDistSqr;
+      closestData = it;
     }
   }
-  return result;
+    
+  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
+  if (mLineStyle != lsNone)
+    minDistSqr = qMin(minDistSqr, lineDistanceSqr(pixelPoint));
+  
+  return qSqrt(minDistSqr);
 }
 
 /*! \internal
-
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsStepLeft.
   
-  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
-  getLines if the line style is set accordingly.
-
-  \see dataToLines, dataToStepRightLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
+  Equivalent to \ref pointDistance, for graphs that render the data of a data source (\ref
+  setDataSource). Since there are no container iterators in that case, the closest data point is
+  returned as its index \a closestIndex in the data source.
 */
-QVector<QPointF> QCPGraph::dataToStepLeftLines(const QVector<QCPGraphData> &data) const
+double QCPGraph::sourcePointDistance(const QPointF &pixelPoint, int &closestIndex) const
 {
-  QVector<QPointF> result;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
-  
-  result.reserve(data.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  result.resize(data.size()*2);
+  closestIndex = mDataSource->size();
+  if (mDataSource->size() == 0)
+    return -1.0;
+  if (mLineStyle == lsNone && mScatterStyle.isNone())
+    return -1.0;
   
-  // calculate steps from data and transform to pixel coordinates:
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    double lastValue = valueAxis->coordToPixel(data.first().value);
-    for (int i=0; i<data.size(); ++i)
-    {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(lastValue);
-      result[i*2+0].setY(key);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
-      result[i*2+1].setX(lastValue);
-      result[i*2+1].setY(key);
-    }
-  } else // key axis is horizontal
+  // calculate minimum distances to graph data points and find closestIndex:
+  double minDistSqr = std::numeric_limits<double>::max();
+  // determine which key range comes into question, taking selection tolerance around pos into account:
+  double posKeyMin, posKeyMax, dummy;
+  pixelsToCoords(pixelPoint-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
+  pixelsToCoords(pixelPoint+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
+  if (posKeyMin > posKeyMax)
+    qSwap(posKeyMin, posKeyMax);
+  // iterate over found data points and then choose the one with the shortest distance to pos:
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  const int end = findEnd(posKeyMax, true);
+  for (int i=findBegin(posKeyMin, true); i<end; ++i)
   {
-    double lastValue = valueAxis->coordToPixel(data.first().value);
-    for (int i=0; i<data.size(); ++i)
+    const double currentDistSqr = QCPVector2D(coordsToPixels(keys[i], values[i])-pixelPoint).lengthSquared();
+    if (currentDistSqr < minDistSqr)
     {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(key);
-      result[i*2+0].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
-      result[i*2+1].setX(key);
-      result[i*2+1].setY(lastValue);
+      minDistSqr = currentDistSqr;
+      closestIndex = i;
     }
   }
-  return result;
+  
+  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
+  if (mLineStyle != lsNone)
+    minDistSqr = qMin(minDistSqr, lineDistanceSqr(pixelPoint));
+  
+  return qSqrt(minDistSqr);
+}
+
+/*! \internal
+  
+  Returns the squared distance in pixels of \a pixelPoint to the graph line, as it is drawn with
+  the current line style. Used by \ref pointDistance and \ref sourcePointDistance.
+*/
+double QCPGraph::lineDistanceSqr(const QPointF &pixelPoint) const
+{
+  double minDistSqr = std::numeric_limits<double>::max();
+  QVector<QPointF> lineData;
+  getLines(&lineData, QCPDataRange(0, dataCount()));
+  QCPVector2D p(pixelPoint);
+  const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
+  for (int i=0; i<lineData.size()-1; i+=step)
+  {
+    const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
+    if (currentDistSqr < minDistSqr)
+      minDistSqr = currentDistSqr;
+  }
+  return minDistSqr;
 }
 
 /*! \internal
-
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsStepRight.
   
-  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
-  getLines if the line style is set accordingly.
-
-  \see dataToLines, dataToStepLeftLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
+  Reads the visible data points of the data source (\ref setDataSource) into \a data, restricted to
+  \a dataRange. Like \ref getVisibleDataBounds, the points just outside the visible key range are
+  included, so lines reach up to the axis rect border. The visible range is found by binary search
+  on the sorted keys, so the cost only depends on the number of visible points.
+  
+  Only every \a indexModulo-th point is read (aligned to index zero), which implements the scatter
+  skip (\ref setScatterSkip). Pass 1 to read all points.
+  
+  If adaptive sampling is enabled and there are considerably more points than pixels along the key
+  axis, the points falling into the same pixel column are reduced to the first, lowest, highest and
+  last point of that column, in key order. NaN values are skipped for the lowest and highest point.
+  This preserves the drawn line shape as well as outliers,
+  while the resulting vector stays proportional to the pixel width of the axis rect, rather than
+  to the number of data points.
 */
-QVector<QPointF> QCPGraph::dataToStepRightLines(const QVector<QCPGraphData> &data) const
+void QCPGraph::getSourceData(QVector<QCPGraphData> *data, const QCPDataRange &dataRange, int indexModulo) const
 {
-  QVector<QPointF> result;
+  data->clear();
   QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
   
-  result.reserve(data.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  result.resize(data.size()*2);
+  // get visible data range and limit it to dataRange:
+  const QCPDataRange visibleRange(findBegin(keyAxis->range().lower), findEnd(keyAxis->range().upper));
+  const QCPDataRange range = visibleRange.bounded(dataRange.bounded(QCPDataRange(0, mDataSource->size())));
+  int begin = range.begin();
+  const int end = range.end();
+  if (begin%indexModulo != 0) // align to the skip pattern, so skipped points don't change while panning
+    begin += indexModulo-begin%indexModulo;
+  if (begin >= end)
+    return;
   
-  // calculate steps from data and transform to pixel coordinates:
-  if (keyAxis->orientation() == Qt::Vertical)
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  const int count = (end-begin+indexModulo-1)/indexModulo;
+  const double keyPixelSpan = qAbs(keyAxis->coordToPixel(keys[begin])-keyAxis->coordToPixel(keys[end-1]));
+  if (!mAdaptiveSampling || count < 4*(keyPixelSpan+1))
   {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    for (int i=0; i<data.size(); ++i)
+    data->reserve(count);
+    for (int i=begin; i<end; i+=indexModulo)
+      data->append(QCPGraphData(keys[i], values[i]));
+    return;
+  }
+  
+  // reduce the points of each pixel column to the first, lowest, highest and last one:
+  data->reserve(4*(int(keyPixelSpan)+2));
+  int i = begin;
+  while (i < end)
+  {
+    const int column = qFloor(keyAxis->coordToPixel(keys[i]));
+    const int firstIndex = i;
+    int minIndex = i;
+    int maxIndex = i;
+    int lastIndex = i;
+    for (i+=indexModulo; i<end && qFloor(keyAxis->coordToPixel(keys[i])) == column; i+=indexModulo)
     {
-      const double value = valueAxis->coordToPixel(data.at(i).value);
-      result[i*2+0].setX(value);
-      result[i*2+0].setY(lastKey);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+1].setX(value);
-      result[i*2+1].setY(lastKey);
+      if (values[i] < values[minIndex] || qIsNaN(values[minIndex])) // NaN values are gaps, they mustn't hide the extremes of the column
+        minIndex = i;
+      if (values[i] > values[maxIndex] || qIsNaN(values[maxIndex]))
+        maxIndex = i;
+      lastIndex = i;
     }
-  } else // key axis is horizontal
-  {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    for (int i=0; i<data.size(); ++i)
+    const int columnIndices[4] = {firstIndex, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), lastIndex};
+    for (int k=0; k<4; ++k)
     {
-      const double value = valueAxis->coordToPixel(data.at(i).value);
-      result[i*2+0].setX(lastKey);
-      result[i*2+0].setY(value);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+1].setX(lastKey);
-      result[i*2+1].setY(value);
+      if (k == 0 || columnIndices[k] != columnIndices[k-1])
+        data->append(QCPGraphData(keys[columnIndices[k]], values[columnIndices[k]]));
     }
   }
-  return result;
 }
 
 /*! \internal
+  
+  Checks the keys of the data source (\ref setDataSource) for ascending order, and prints a
+  warning to the debug output if they aren't. The check is only repeated when the revision of the
+  data source changed (\ref QCPGraphDataSource::dataChanged), so regular replots don't pay for it.
+*/
+void QCPGraph::checkDataSource() const
+{
+  if (!mDataSource || mDataSource->revision() == mDataSourceRevision)
+    return;
+  mDataSourceRevision = mDataSource->revision();
+  const double *keys = mDataSource->keys();
+  if (!std::is_sorted(keys, keys+mDataSource->size()))
+    qDebug() << Q_FUNC_INFO << "Keys of data source aren't sorted ascending, graph may be displayed incorrectly. Plottable name:" << name();
+}
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsStepCenter.
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBandData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBandData
+  \brief Holds the data of one single data point for QCPBand.
   
-  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
-  getLines if the line style is set accordingly.
+  The stored data is:
+  \li \a key: coordinate on the key axis of this data point (this is the \a mainKey and the \a sortKey)
+  \li \a value: coordinate on the value axis of the center line (this is the \a mainValue)
+  \li \a lower: lower bound of the band at this key
+  \li \a upper: upper bound of the band at this key
+  
+  The container for storing multiple data points is \ref QCPBandDataContainer. It is a typedef for
+  \ref QCPDataContainer with \ref QCPBandData as the DataType template parameter. See the
+  documentation there for an explanation regarding the data type's generic methods.
+  
+  \see QCPBandDataContainer
+*/
 
-  \see dataToLines, dataToStepLeftLines, dataToStepRightLines, dataToImpulseLines, getLines, drawLinePlot
+/* start documentation of inline functions */
+
+/*! \fn double QCPBandData::sortKey() const
+  
+  Returns the \a key member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
 */
-QVector<QPointF> QCPGraph::dataToStepCenterLines(const QVector<QCPGraphData> &data) const
-{
-  QVector<QPointF> result;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+
+/*! \fn static QCPBandData QCPBandData::fromSortKey(double sortKey)
   
-  result.reserve(data.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  result.resize(data.size()*2);
+  Returns a data point with the specified \a sortKey. All other members are set to zero.
   
-  // calculate steps from data and transform to pixel coordinates:
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    double lastValue = valueAxis->coordToPixel(data.first().value);
-    result[0].setX(lastValue);
-    result[0].setY(lastKey);
-    for (int i=1; i<data.size(); ++i)
-    {
-      const double key = (keyAxis->coordToPixel(data.at(i).key)+lastKey)*0.5;
-      result[i*2-1].setX(lastValue);
-      result[i*2-1].setY(key);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(lastValue);
-      result[i*2+0].setY(key);
-    }
-    result[data.size()*2-1].setX(lastValue);
-    result[data.size()*2-1].setY(lastKey);
-  } else // key axis is horizontal
-  {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    double lastValue = valueAxis->coordToPixel(data.first().value);
-    result[0].setX(lastKey);
-    result[0].setY(lastValue);
-    for (int i=1; i<data.size(); ++i)
-    {
-      const double key = (keyAxis->coordToPixel(data.at(i).key)+lastKey)*0.5;
-      result[i*2-1].setX(key);
-      result[i*2-1].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(key);
-      result[i*2+0].setY(lastValue);
-    }
-    result[data.size()*2-1].setX(lastKey);
-    result[data.size()*2-1].setY(lastValue);
-  }
-  return result;
-}
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
 
-/*! \internal
+/*! \fn static static bool QCPBandData::sortKeyIsMainKey()
+  
+  Since the member \a key is both the data point key coordinate and the data ordering parameter,
+  this method returns true.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsImpulse.
+/*! \fn double QCPBandData::mainKey() const
   
-  The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
-  getLines if the line style is set accordingly.
+  Returns the \a key member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
 
-  \see dataToLines, dataToStepLeftLines, dataToStepRightLines, dataToStepCenterLines, getLines, drawImpulsePlot
+/*! \fn double QCPBandData::mainValue() const
+  
+  Returns the \a value member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
 */
-QVector<QPointF> QCPGraph::dataToImpulseLines(const QVector<QCPGraphData> &data) const
-{
-  QVector<QPointF> result;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+
+/*! \fn QCPRange QCPBandData::valueRange() const
   
-  result.resize(data.size()*2); // no need to reserve 2 extra points because impulse plot has no fill
+  Returns a QCPRange spanning from \a lower to \a upper, expanded to include \a value.
   
-  // transform data points to pixels:
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    for (int i=0; i<data.size(); ++i)
-    {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(valueAxis->coordToPixel(0));
-      result[i*2+0].setY(key);
-      result[i*2+1].setX(valueAxis->coordToPixel(data.at(i).value));
-      result[i*2+1].setY(key);
-    }
-  } else // key axis is horizontal
-  {
-    for (int i=0; i<data.size(); ++i)
-    {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(key);
-      result[i*2+0].setY(valueAxis->coordToPixel(0));
-      result[i*2+1].setX(key);
-      result[i*2+1].setY(valueAxis->coordToPixel(data.at(i).value));
-    }
-  }
-  return result;
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs a data point with key, value, lower and upper set to zero.
+*/
+QCPBandData::QCPBandData() :
+  key(0),
+  value(0),
+  lower(0),
+  upper(0)
+{
+}
+
+/*!
+  Constructs a data point with the specified \a key, \a value, \a lower and \a upper.
+*/
+QCPBandData::QCPBandData(double key, double value, double lower, double upper) :
+  key(key),
+  value(value),
+  lower(lower),
+  upper(upper)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBandDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBandDataSource
+  \brief Read-only interface to data that a QCPBand renders in place, without copying it
+
+  This extends \ref QCPGraphDataSource by the arrays of the lower and upper bounds, so a band can
+  render four caller-owned columns that share one key column. Assign it to a band with \ref
+  QCPBand::setDataSource.
+
+  To create a data source, subclass QCPBandDataSource and reimplement \ref size, \ref keys, \ref
+  values, \ref lower and \ref upper. The same requirements as for \ref QCPGraphDataSource apply:
+  the keys must be sorted ascending, all arrays must hold at least \ref size elements, and \ref
+  dataChanged must be called whenever the underlying data is modified. For the common case of the
+  columns residing in QVectors, \ref QCPVectorBandDataSource is provided.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn virtual const double *QCPBandDataSource::lower() const = 0
+
+  Returns a pointer to the first element of the lower bound array.
+*/
+
+/*! \fn virtual const double *QCPBandDataSource::upper() const = 0
+
+  Returns a pointer to the first element of the upper bound array.
+*/
+
+/* end documentation of inline functions */
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPVectorBandDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPVectorBandDataSource
+  \brief A band data source reading keys, values and bounds from four caller-owned QVectors
+
+  Like \ref QCPVectorGraphDataSource, the vectors are referenced, not copied, so they must outlive
+  the data source. If the vectors have different sizes, the number of data points is the size of
+  the smallest one. Call \ref dataChanged after each modification of the vectors.
+
+  \see QCPBandDataSource
+*/
+
+/*!
+  Constructs a data source for the vectors \a keys, \a values, \a lower and \a upper. All vectors
+  are referenced by pointer and must stay alive as long as the data source is used.
+*/
+QCPVectorBandDataSource::QCPVectorBandDataSource(const QVector<double> *keys, const QVector<double> *values, const QVector<double> *lower, const QVector<double> *upper) :
+  mKeys(keys),
+  mValues(values),
+  mLower(lower),
+  mUpper(upper)
+{
 }
 
-/*! \internal
 
-  Draws the fill of the graph using the specified \a painter, with the currently set brush.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBand
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBand
+  \brief A plottable representing a center line with a band of lower and upper bounds around it.
+  
+  Typical uses are a mean with its confidence interval, or a measurement with its minimum and
+  maximum. Instead of three separate QCPGraphs that each store the keys and each search and sample
+  their data on every replot, a QCPBand stores the key once per data point (\ref QCPBandData) and
+  converts all three columns in a single pass.
+  
+  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
+  also access and modify the data via the \ref data method, which returns a pointer to the internal
+  \ref QCPBandDataContainer. Data which is already held by the application can be rendered in
+  place with \ref setDataSource.
+  
+  \section qcpband-appearance Changing the appearance
+  
+  The center line is drawn with the pen (\ref setPen), and the data points on it with the scatter
+  style (\ref setScatterStyle). The lower and upper bound lines are drawn with the bounds pen (\ref
+  setBoundsPen), and the area between them is filled with the brush (\ref setBrush). Set the
+  respective pen or brush to Qt::NoPen or Qt::NoBrush to hide a part.
+  
+  NaN values in any column create a gap in the corresponding line, NaN bounds additionally
+  interrupt the fill.
+  
+  Like QCPGraph, the band uses adaptive sampling (\ref setAdaptiveSampling) when there are many
+  more data points than pixels along the key axis.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QSharedPointer<QCPBandDataContainer> QCPBand::data() const
+  
+  Returns a shared pointer to the internal data storage of type \ref QCPBandDataContainer. You may
+  use it to directly manipulate the data, which may be more convenient and faster than using the
+  regular \ref setData or \ref addData methods.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a band which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value axis
+  ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have the
+  same orientation. If either of these restrictions is violated, a corresponding message is printed
+  to the debug output (qDebug), the construction is not aborted, though.
   
-  \a lines contains the points of the graph line, in pixel coordinates.
-
-  If the fill is a normal fill towards the zero-value-line, only the points in \a lines are
-  required and two extra points at the zero-value-line, which are added by \ref addFillBasePoints
-  and removed by \ref removeFillBasePoints after the fill drawing is done.
+  The created QCPBand is automatically registered with the QCustomPlot instance inferred from \a
+  keyAxis. This QCustomPlot instance takes ownership of the QCPBand, so do not delete it manually
+  but use QCustomPlot::removePlottable() instead.
+*/
+QCPBand::QCPBand(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable1D<QCPBandData>(keyAxis, valueAxis),
+  mBoundsPen(Qt::gray),
+  mAdaptiveSampling(true),
+  mDataSourceRevision(-1)
+{
+  setPen(QPen(Qt::blue, 0));
+  setBrush(QColor(0, 0, 255, 30));
+}
 
-  On the other hand if the fill is a channel fill between this QCPGraph and another QCPGraph (\a
-  mChannelFillGraph), the more complex polygon is calculated with the \ref getChannelFillPolygon
-  function, and then drawn.
+/*! \overload
+  
+  Replaces the current data container with the provided \a data container.
+  
+  Since a QSharedPointer is used, multiple QCPBands may share the same data container safely.
+  Modifying the data in the container will then affect all bands that share the container.
+  
+  If you do not wish to share containers, but create a copy from an existing container, rather use
+  the \ref QCPDataContainer<DataType>::set method on the band's data container directly.
+  
+  \see addData
+*/
+void QCPBand::setData(QSharedPointer<QCPBandDataContainer> data)
+{
+  mDataSource.clear();
+  mDataContainer = data;
+}
 
-  \see drawLinePlot, drawImpulsePlot, drawScatterPlot
+/*! \overload
+  
+  Replaces the current data with the provided points in \a keys, \a values, \a lower and \a upper.
+  The provided vectors should have equal length. Else, the number of added points will be the size
+  of the smallest vector.
+  
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  
+  \see addData
 */
-void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lines) const
+void QCPBand::setData(const QVector<double> &keys, const QVector<double> &values, const QVector<double> &lower, const QVector<double> &upper, bool alreadySorted)
 {
-  if (mLineStyle == lsImpulse) return; // fill doesn't make sense for impulse plot
-  if (painter->brush().style() == Qt::NoBrush || painter->brush().color().alpha() == 0) return;
+  mDataContainer->clear();
+  addData(keys, values, lower, upper, alreadySorted);
+}
+
+/*!
+  Makes the band render the data provided by \a source, instead of the data in its internal
+  container. Like \ref QCPGraph::setDataSource, the band reads the arrays of \a source directly
+  during each replot: the visible data points are found by one binary search on the shared keys,
+  and all four columns are read and, if adaptive sampling is enabled, reduced per pixel column in
+  the same pass. No copy of the data is made.
   
-  applyFillAntialiasingHint(painter);
-  if (!mChannelFillGraph)
-  {
-    // draw base fill under graph, fill goes all the way to the zero-value-line:
-    addFillBasePoints(lines);
-    painter->drawPolygon(QPolygonF(*lines));
-    removeFillBasePoints(lines);
-  } else
-  {
-    // draw channel fill between this graph and mChannelFillGraph:
-    painter->drawPolygon(getChannelFillPolygon(lines));
-  }
+  Selection, rescaling and the 1D data interface (\ref interface1D) work on the data of \a source
+  as well, data indices refer to positions in its arrays.
+  
+  The internal data container of the band is replaced by a new, empty one. Calling \ref setData or
+  \ref addData afterwards removes the data source again. Pass a null pointer as \a source to only
+  remove the data source.
+  
+  \see QCPBandDataSource, QCPVectorBandDataSource
+*/
+void QCPBand::setDataSource(QSharedPointer<QCPBandDataSource> source)
+{
+  mDataSource = source;
+  mDataSourceRevision = -1;
+  if (mDataSource)
+    mDataContainer = QSharedPointer<QCPBandDataContainer>(new QCPBandDataContainer);
 }
 
-/*! \internal
+/*!
+  Sets the pen with which the lower and upper bound lines are drawn. Set it to Qt::NoPen to only
+  show the fill between the bounds.
+  
+  \see setPen, setBrush
+*/
+void QCPBand::setBoundsPen(const QPen &pen)
+{
+  mBoundsPen = pen;
+}
 
-  Draws scatter symbols at every point passed in \a scatters, given in pixel coordinates. The
-  scatters will be drawn with \a painter and have the appearance as specified in \a style.
+/*!
+  Sets the visual appearance of the data points on the center line. If set to \ref
+  QCPScatterStyle::ssNone (the default), no scatter points are drawn.
+*/
+void QCPBand::setScatterStyle(const QCPScatterStyle &style)
+{
+  mScatterStyle = style;
+}
 
-  \see drawLinePlot, drawImpulsePlot
+/*!
+  Sets whether adaptive sampling shall be used when plotting this band. If enabled and there are
+  considerably more visible data points than pixels along the key axis, the data points of each
+  pixel column are combined into the first and last point of the column and the envelope of all
+  three columns in between. This keeps the shape of the lines and the extent of the band intact,
+  while the replot time only depends on the pixel width of the plot.
+  
+  \see QCPGraph::setAdaptiveSampling
 */
-void QCPGraph::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const
+void QCPBand::setAdaptiveSampling(bool enabled)
 {
-  applyScattersAntialiasingHint(painter);
-  style.applyTo(painter, mPen);
-  for (int i=0; i<scatters.size(); ++i)
-    style.drawShape(painter, scatters.at(i).x(), scatters.at(i).y());
+  mAdaptiveSampling = enabled;
 }
 
-/*!  \internal
+/*! \overload
   
-  Draws lines between the points in \a lines, given in pixel coordinates.
+  Adds the provided points in \a keys, \a values, \a lower and \a upper to the current data. The
+  provided vectors should have equal length. Else, the number of added points will be the size of
+  the smallest vector.
   
-  \see drawScatterPlot, drawImpulsePlot, QCPAbstractPlottable1D::drawPolyline
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  
+  Alternatively, you can also access and modify the data directly via the \ref data method, which
+  returns a pointer to the internal data container.
 */
-void QCPGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
+void QCPBand::addData(const QVector<double> &keys, const QVector<double> &values, const QVector<double> &lower, const QVector<double> &upper, bool alreadySorted)
 {
-  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
+  mDataSource.clear();
+  if (keys.size() != values.size() || values.size() != lower.size() || lower.size() != upper.size())
+    qDebug() << Q_FUNC_INFO << "keys, values, lower and upper have different sizes:" << keys.size() << values.size() << lower.size() << upper.size();
+  const int n = qMin(qMin(keys.size(), values.size()), qMin(lower.size(), upper.size()));
+  QVector<QCPBandData> tempData(n);
+  QVector<QCPBandData>::iterator it = tempData.begin();
+  const QVector<QCPBandData>::iterator itEnd = tempData.end();
+  int i = 0;
+  while (it != itEnd)
   {
-    applyDefaultAntialiasingHint(painter);
-    drawPolyline(painter, lines);
+    it->key = keys[i];
+    it->value = values[i];
+    it->lower = lower[i];
+    it->upper = upper[i];
+    ++it;
+    ++i;
   }
+  mDataContainer->add(tempData, alreadySorted); // don't modify tempData beyond this to prevent copy on write
 }
 
-/*! \internal
-
-  Draws impulses from the provided data, i.e. it connects all line pairs in \a lines, given in
-  pixel coordinates. The \a lines necessary for impulses are generated by \ref dataToImpulseLines
-  from the regular graph data points.
+/*! \overload
+  
+  Adds the provided data point as \a key, \a value, \a lower and \a upper to the current data.
+  
+  Alternatively, you can also access and modify the data directly via the \ref data method, which
+  returns a pointer to the internal data container.
+*/
+void QCPBand::addData(double key, double value, double lower, double upper)
+{
+  mDataSource.clear();
+  mDataContainer->add(QCPBandData(key, value, lower, upper));
+}
 
-  \see drawLinePlot, drawScatterPlot
+/*!
+  Returns the distance of \a pos to the closest data point on the center line, or to the center
+  line itself if it is shorter. Positions inside the band count as a hit, with a distance just
+  below the selection tolerance, so the band can be clicked anywhere and the closest data point is
+  selected.
+  
+  \seebaseclassmethod
 */
-void QCPGraph::drawImpulsePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
+double QCPBand::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
-  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
+  if ((onlySelectable && mSelectable == QCP::stNone) || dataCount() == 0)
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
+  if (!mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+    return -1;
+  
+  // determine which key range comes into question, taking selection tolerance around pos into account:
+  double posKeyMin, posKeyMax, dummy;
+  pixelsToCoords(pos-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
+  pixelsToCoords(pos+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
+  if (posKeyMin > posKeyMax)
+    qSwap(posKeyMin, posKeyMax);
+  // iterate over found data points (of the container or the data source) and then choose the one with the shortest distance to pos:
+  int closestIndex = dataCount();
+  double minDistSqr = std::numeric_limits<double>::max();
+  const int end = findEnd(posKeyMax, true);
+  for (int i=findBegin(posKeyMin, true); i<end; ++i)
   {
-    applyDefaultAntialiasingHint(painter);
-    QPen oldPen = painter->pen();
-    QPen newPen = painter->pen();
-    newPen.setCapStyle(Qt::FlatCap); // so impulse line doesn't reach beyond zero-line
-    painter->setPen(newPen);
-    painter->drawLines(lines);
-    painter->setPen(oldPen);
+    const double currentDistSqr = QCPVector2D(dataPixelPosition(i)-pos).lengthSquared();
+    if (currentDistSqr < minDistSqr)
+    {
+      minDistSqr = currentDistSqr;
+      closestIndex = i;
+    }
   }
+  
+  QVector<QPointF> valueLine, lowerLine, upperLine;
+  getLines(&valueLine, &lowerLine, &upperLine, QCPDataRange(0, dataCount()));
+  // distance to center line segments:
+  if (mPen.style() != Qt::NoPen)
+  {
+    QCPVector2D p(pos);
+    for (int i=0; i<valueLine.size()-1; ++i)
+    {
+      const double currentDistSqr = p.distanceSquaredToLine(valueLine.at(i), valueLine.at(i+1));
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+  }
+  // inside of band:
+  if (mBrush.style() != Qt::NoBrush)
+  {
+    const double bandDistSqr = mParentPlot->selectionTolerance()*0.99 * mParentPlot->selectionTolerance()*0.99;
+    const QVector<QPolygonF> polygons = getFillPolygons(lowerLine, upperLine);
+    for (int i=0; i<polygons.size() && bandDistSqr < minDistSqr; ++i)
+    {
+      if (polygons.at(i).containsPoint(pos, Qt::OddEvenFill))
+        minDistSqr = bandDistSqr;
+    }
+  }
+  
+  if (details)
+    details->setValue(QCPDataSelection(QCPDataRange(closestIndex, closestIndex+1)));
+  return qSqrt(minDistSqr);
 }
 
-/*! \internal
-
-  Returns via \a lineData the data points that need to be visualized for this graph when plotting
-  graph lines, taking into consideration the currently visible axis ranges and, if \ref
-  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
-  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
-  getDataSegments).
-
-  This method is used by \ref getLines to retrieve the basic working set of data.
+/* inherits documentation from base class */
+QCPRange QCPBand::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  if (!mDataSource)
+    return mDataContainer->keyRange(foundRange, inSignDomain);
+  
+  // keys of a data source are sorted, so the range spans from the first to the last key in the sign domain with a non-NaN value:
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  int begin = 0;
+  int end = mDataSource->size();
+  if (inSignDomain == QCP::sdNegative)
+    end = std::lower_bound(keys, keys+end, 0.0)-keys;
+  else if (inSignDomain == QCP::sdPositive)
+    begin = std::upper_bound(keys, keys+end, 0.0)-keys;
+  while (begin < end && qIsNaN(values[begin]))
+    ++begin;
+  while (end > begin && qIsNaN(values[end-1]))
+    --end;
+  foundRange = begin < end;
+  return foundRange ? QCPRange(keys[begin], keys[end-1]) : QCPRange();
+}
 
-  \see getOptimizedScatterData
-*/
-void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+/* inherits documentation from base class */
+QCPRange QCPBand::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
-  if (!lineData) return;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (begin == end) return;
+  if (!mDataSource)
+    return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
   
-  int dataCount = end-begin;
-  int maxCount = std::numeric_limits<int>::max();
-  if (mAdaptiveSampling)
+  const double *keys = mDataSource->keys();
+  const double *columns[3] = {mDataSource->values(), mDataSource->lower(), mDataSource->upper()};
+  int begin = 0;
+  int end = mDataSource->size();
+  if (inKeyRange != QCPRange())
   {
-    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
-    if (2*keyPixelSpan+2 < (double)std::numeric_limits<int>::max())
-      maxCount = 2*keyPixelSpan+2;
+    begin = std::lower_bound(keys, keys+end, inKeyRange.lower)-keys;
+    end = std::upper_bound(keys, keys+end, inKeyRange.upper)-keys;
   }
-  
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  QCPRange range;
+  foundRange = false;
+  for (int i=begin; i<end; ++i)
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-    while (it != end)
+    for (int c=0; c<3; ++c)
     {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
-      {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
+      const double current = columns[c][i];
+      if (qIsNaN(current) || (inSignDomain == QCP::sdNegative && current >= 0) || (inSignDomain == QCP::sdPositive && current <= 0))
+        continue;
+      if (!foundRange)
       {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      ++it;
+        range.lower = current;
+        range.upper = current;
+        foundRange = true;
+      } else if (current < range.lower)
+        range.lower = current;
+      else if (current > range.upper)
+        range.upper = current;
     }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-    {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-    } else
-      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-    
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  }
+  return range;
+}
+
+/* inherits documentation from base class */
+int QCPBand::dataCount() const
+{
+  return mDataSource ? mDataSource->size() : QCPAbstractPlottable1D<QCPBandData>::dataCount();
+}
+
+/* inherits documentation from base class */
+double QCPBand::dataMainKey(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::dataMainKey(index);
+  
+  if (index >= 0 && index < mDataSource->size())
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    lineData->reserve(dataCount+2); // +2 for possible fill end points
-    while (it != end)
-    {
-      lineData->append(*it);
-      ++it;
-    }
+    return mDataSource->keys()[index];
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
   }
 }
 
-/*! \internal
+/* inherits documentation from base class */
+double QCPBand::dataSortKey(int index) const
+{
+  return dataMainKey(index);
+}
 
-  Returns via \a scatterData the data points that need to be visualized for this graph when
-  plotting scatter points, taking into consideration the currently visible axis ranges and, if \ref
-  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
-  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
-  getDataSegments).
+/* inherits documentation from base class */
+double QCPBand::dataMainValue(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::dataMainValue(index);
+  
+  if (index >= 0 && index < mDataSource->size())
+  {
+    return mDataSource->values()[index];
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
+  }
+}
 
-  This method is used by \ref getScatters to retrieve the basic working set of data.
+/* inherits documentation from base class */
+QCPRange QCPBand::dataValueRange(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::dataValueRange(index);
+  
+  if (index >= 0 && index < mDataSource->size())
+  {
+    return QCPBandData(mDataSource->keys()[index], mDataSource->values()[index], mDataSource->lower()[index], mDataSource->upper()[index]).valueRange();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return QCPRange(0, 0);
+  }
+}
 
-  \see getOptimizedLineData
-*/
-void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const
+/* inherits documentation from base class */
+QPointF QCPBand::dataPixelPosition(int index) const
 {
-  if (!scatterData) return;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::dataPixelPosition(index);
   
-  const int scatterModulo = mScatterSkip+1;
-  const bool doScatterSkip = mScatterSkip > 0;
-  int beginIndex = begin-mDataContainer->constBegin();
-  int endIndex = end-mDataContainer->constBegin();
-  while (doScatterSkip && begin != end && beginIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
+  if (index >= 0 && index < mDataSource->size())
   {
-    ++beginIndex;
-    ++begin;
+    return coordsToPixels(mDataSource->keys()[index], mDataSource->values()[index]);
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return QPointF();
   }
-  if (begin == end) return;
-  int dataCount = end-begin;
-  int maxCount = std::numeric_limits<int>::max();
-  if (mAdaptiveSampling)
+}
+
+/* inherits documentation from base class */
+QCPDataSelection QCPBand::selectTestRect(const QRectF &rect, bool onlySelectable) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::selectTestRect(rect, onlySelectable);
+  
+  QCPDataSelection result;
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataSource->size() == 0)
+    return result;
+  if (!mKeyAxis || !mValueAxis)
+    return result;
+  
+  // convert rect given in pixels to ranges given in plot coordinates:
+  double key1, value1, key2, value2;
+  pixelsToCoords(rect.topLeft(), key1, value1);
+  pixelsToCoords(rect.bottomRight(), key2, value2);
+  QCPRange keyRange(key1, key2); // QCPRange normalizes internally so we don't have to care about whether key1 < key2
+  QCPRange valueRange(value1, value2);
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  const int end = findEnd(keyRange.upper, false);
+  int currentSegmentBegin = -1; // -1 means we're currently not in a segment that's contained in rect
+  for (int i=findBegin(keyRange.lower, false); i<end; ++i)
   {
-    int keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
-    maxCount = 2*keyPixelSpan+2;
+    const bool contained = keyRange.contains(keys[i]) && valueRange.contains(values[i]);
+    if (contained && currentSegmentBegin == -1) // start segment
+    {
+      currentSegmentBegin = i;
+    } else if (!contained && currentSegmentBegin != -1) // segment just ended
+    {
+      result.addDataRange(QCPDataRange(currentSegmentBegin, i), false);
+      currentSegmentBegin = -1;
+    }
   }
+  // process potential last segment:
+  if (currentSegmentBegin != -1)
+    result.addDataRange(QCPDataRange(currentSegmentBegin, end), false);
   
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  result.simplify();
+  return result;
+}
+
+/* inherits documentation from base class */
+int QCPBand::findBegin(double sortKey, bool expandedRange) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::findBegin(sortKey, expandedRange);
+  
+  const double *keys = mDataSource->keys();
+  int index = std::lower_bound(keys, keys+mDataSource->size(), sortKey)-keys;
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/* inherits documentation from base class */
+int QCPBand::findEnd(double sortKey, bool expandedRange) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPBandData>::findEnd(sortKey, expandedRange);
+  
+  const double *keys = mDataSource->keys();
+  const int size = mDataSource->size();
+  int index = std::upper_bound(keys, keys+size, sortKey)-keys;
+  if (expandedRange && index < size)
+    ++index;
+  return index;
+}
+
+/* inherits documentation from base class */
+void QCPBand::draw(QCPPainter *painter)
+{
+  mDataContainer->mergePendingRuns();
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
+  checkDataSource();
+  
+  QVector<QPointF> valueLine, lowerLine, upperLine; // pixel coordinates of the three lines will be stored here while iterating over segments
+  
+  // loop over and draw segments of unselected/selected data:
+  QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  allSegments << unselectedSegments << selectedSegments;
+  for (int i=0; i<allSegments.size(); ++i)
   {
-    double valueMaxRange = valueAxis->range().upper;
-    double valueMinRange = valueAxis->range().lower;
-    QCPGraphDataContainer::const_iterator it = begin;
-    int itIndex = beginIndex;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator minValueIt = it;
-    QCPGraphDataContainer::const_iterator maxValueIt = it;
-    QCPGraphDataContainer::const_iterator currentIntervalStart = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    // advance iterator to second (non-skipped) data point because adaptive sampling works in 1 point retrospect:
-    if (!doScatterSkip)
-      ++it;
+    bool isSelectedSegment = i >= unselectedSegments.size();
+    // get pixel points of all three lines in one pass over the data:
+    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
+    getLines(&valueLine, &lowerLine, &upperLine, lineDataRange);
+    
+    // draw fill between bounds:
+    if (isSelectedSegment && mSelectionDecorator)
+      mSelectionDecorator->applyBrush(painter);
     else
+      painter->setBrush(mBrush);
+    painter->setPen(Qt::NoPen);
+    drawFill(painter, lowerLine, upperLine);
+    
+    // draw bound lines:
+    painter->setBrush(Qt::NoBrush);
+    if (mBoundsPen.style() != Qt::NoPen && mBoundsPen.color().alpha() != 0)
     {
-      itIndex += scatterModulo;
-      if (itIndex < endIndex) // make sure we didn't jump over end
-        it += scatterModulo;
-      else
-      {
-        it = end;
-        itIndex = endIndex;
-      }
+      applyDefaultAntialiasingHint(painter);
+      painter->setPen(mBoundsPen);
+      drawPolyline(painter, lowerLine);
+      drawPolyline(painter, upperLine);
     }
-    // main loop over data points:
-    while (it != end)
+    
+    // draw center line:
+    if (isSelectedSegment && mSelectionDecorator)
+      mSelectionDecorator->applyPen(painter);
+    else
+      painter->setPen(mPen);
+    if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
     {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this pixel if necessary
-      {
-        if (it->value < minValue && it->value > valueMinRange && it->value < valueMaxRange)
-        {
-          minValue = it->value;
-          minValueIt = it;
-        } else if (it->value > maxValue && it->value > valueMinRange && it->value < valueMaxRange)
-        {
-          maxValue = it->value;
-          maxValueIt = it;
-        }
-        ++intervalDataCount;
-      } else // new pixel started
-      {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
-        {
-          // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-          double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
-          int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-          QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
-          int c = 0;
-          while (intervalIt != it)
-          {
-            if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt->value > valueMinRange && intervalIt->value < valueMaxRange)
-              scatterData->append(*intervalIt);
-            ++c;
-            if (!doScatterSkip)
-              ++intervalIt;
-            else
-              intervalIt += scatterModulo; // since we know indices of "currentIntervalStart", "intervalIt" and "it" are multiples of scatterModulo, we can't accidentally jump over "it" here
-          }
-        } else if (currentIntervalStart->value > valueMinRange && currentIntervalStart->value < valueMaxRange)
-          scatterData->append(*currentIntervalStart);
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalStart = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      // advance to next data point:
-      if (!doScatterSkip)
-        ++it;
-      else
-      {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex) // make sure we didn't jump over end
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
-      }
+      applyDefaultAntialiasingHint(painter);
+      drawPolyline(painter, valueLine);
     }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
-    {
-      // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-      double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
-      int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-      QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
-      int intervalItIndex = intervalIt-mDataContainer->constBegin();
-      int c = 0;
-      while (intervalIt != it)
-      {
-        if ((c % dataModulo == 0 || intervalIt == minValueIt || intervalIt == maxValueIt) && intervalIt->value > valueMinRange && intervalIt->value < valueMaxRange)
-          scatterData->append(*intervalIt);
-        ++c;
-        if (!doScatterSkip)
-          ++intervalIt;
-        else // here we can't guarantee that adding scatterModulo doesn't exceed "it" (because "it" is equal to "end" here, and "end" isn't scatterModulo-aligned), so check via index comparison:
-        {
-          intervalItIndex += scatterModulo;
-          if (intervalItIndex < itIndex)
-            intervalIt += scatterModulo;
-          else
-          {
-            intervalIt = it;
-            intervalItIndex = itIndex;
-          }
-        }
-      }
-    } else if (currentIntervalStart->value > valueMinRange && currentIntervalStart->value < valueMaxRange)
-      scatterData->append(*currentIntervalStart);
     
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
-  {
-    QCPGraphDataContainer::const_iterator it = begin;
-    int itIndex = beginIndex;
-    scatterData->reserve(dataCount);
-    while (it != end)
+    // draw scatters on center line:
+    QCPScatterStyle finalScatterStyle = mScatterStyle;
+    if (isSelectedSegment && mSelectionDecorator)
+      finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
+    if (!finalScatterStyle.isNone() && !(mParentPlot->coarseReplot() && mPen.style() != Qt::NoPen)) // coarse replots only show the line where there is one
     {
-      scatterData->append(*it);
-      // advance to next data point:
-      if (!doScatterSkip)
-        ++it;
-      else
+      QVector<QCPBandData> scatterData;
+      if (mDataSource)
       {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex)
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
+        getSourceData(&scatterData, allSegments.at(i), true);
+      } else
+      {
+        QCPBandDataContainer::const_iterator begin, end;
+        getVisibleDataBounds(begin, end, allSegments.at(i));
+        getOptimizedScatterData(&scatterData, begin, end);
+      }
+      applyScattersAntialiasingHint(painter);
+      finalScatterStyle.applyTo(painter, mPen);
+      for (int k=0; k<scatterData.size(); ++k)
+      {
+        if (!qIsNaN(scatterData.at(k).value))
+          finalScatterStyle.drawShape(painter, coordsToPixels(scatterData.at(k).key, scatterData.at(k).value));
       }
     }
   }
+  
+  // draw other selection decoration that isn't just line/scatter pens and brushes:
+  if (mSelectionDecorator)
+    mSelectionDecorator->drawDecoration(painter, selection());
 }
 
-/*!
-  This method outputs the currently visible data range via \a begin and \a end. The returned range
-  will also never exceed \a rangeRestriction.
-
-  This method takes into account that the drawing of data lines at the axis rect border always
-  requires the points just outside the visible axis range. So \a begin and \a end may actually
-  indicate a range that contains one additional data point to the left and right of the visible
-  axis range.
-*/
-void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const
+/* inherits documentation from base class */
+void QCPBand::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
-  if (rangeRestriction.isEmpty())
+  const QRectF bandRect(rect.left(), rect.top()+rect.height()*0.25, rect.width(), rect.height()*0.5);
+  // draw fill:
+  if (mBrush.style() != Qt::NoBrush)
   {
-    end = mDataContainer->constEnd();
-    begin = end;
-  } else
+    applyFillAntialiasingHint(painter);
+    painter->fillRect(bandRect, mBrush);
+  }
+  // draw bound lines at top and bottom of fill:
+  if (mBoundsPen.style() != Qt::NoPen)
   {
-    QCPAxis *keyAxis = mKeyAxis.data();
-    QCPAxis *valueAxis = mValueAxis.data();
-    if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-    // get visible data range:
-    begin = mDataContainer->findBegin(keyAxis->range().lower);
-    end = mDataContainer->findEnd(keyAxis->range().upper);
-    // limit lower/upperEnd to rangeRestriction:
-    mDataContainer->limitIteratorsToDataRange(begin, end, rangeRestriction); // this also ensures rangeRestriction outside data bounds doesn't break anything
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mBoundsPen);
+    painter->drawLine(QLineF(bandRect.topLeft(), bandRect.topRight()));
+    painter->drawLine(QLineF(bandRect.bottomLeft(), bandRect.bottomRight()));
   }
-}
-
-/*! \internal
-  
-  The line vector generated by e.g. \ref getLines describes only the line that connects the data
-  points. If the graph needs to be filled, two additional points need to be added at the
-  value-zero-line in the lower and upper key positions of the graph. This function calculates these
-  points and adds them to the end of \a lineData. Since the fill is typically drawn before the line
-  stroke, these added points need to be removed again after the fill is done, with the
-  removeFillBasePoints function.
-
-  The expanding of \a lines by two points will not cause unnecessary memory reallocations, because
-  the data vector generation functions (e.g. \ref getLines) reserve two extra points when they
-  allocate memory for \a lines.
-  
-  \see removeFillBasePoints, lowerFillBasePoint, upperFillBasePoint
-*/
-void QCPGraph::addFillBasePoints(QVector<QPointF> *lines) const
-{
-  if (!mKeyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
-  if (!lines) { qDebug() << Q_FUNC_INFO << "passed null as lineData"; return; }
-  if (lines->isEmpty()) return;
-  
-  // append points that close the polygon fill at the key axis:
-  if (mKeyAxis.data()->orientation() == Qt::Vertical)
+  // draw center line vertically centered:
+  if (mPen.style() != Qt::NoPen)
   {
-    *lines << upperFillBasePoint(lines->last().y());
-    *lines << lowerFillBasePoint(lines->first().y());
-  } else
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()/2.0, rect.right()+5, rect.top()+rect.height()/2.0)); // +5 on x2 else last segment is missing from dashed/dotted pens
+  }
+  // draw scatter symbol:
+  if (!mScatterStyle.isNone())
   {
-    *lines << upperFillBasePoint(lines->last().x());
-    *lines << lowerFillBasePoint(lines->first().x());
+    applyScattersAntialiasingHint(painter);
+    mScatterStyle.applyTo(painter, mPen);
+    mScatterStyle.drawShape(painter, QRectF(rect).center());
   }
 }
 
 /*! \internal
   
-  removes the two points from \a lines that were added by \ref addFillBasePoints.
-  
-  \see addFillBasePoints, lowerFillBasePoint, upperFillBasePoint
+  Fills the area between \a lowerLine and \a upperLine (in pixel coordinates, as returned by \ref
+  getLines) with the current brush of \a painter. Gaps caused by NaN bounds split the fill into
+  multiple polygons, see \ref getFillPolygons.
 */
-void QCPGraph::removeFillBasePoints(QVector<QPointF> *lines) const
+void QCPBand::drawFill(QCPPainter *painter, const QVector<QPointF> &lowerLine, const QVector<QPointF> &upperLine) const
 {
-  if (!lines) { qDebug() << Q_FUNC_INFO << "passed null as lineData"; return; }
-  if (lines->isEmpty()) return;
+  if (painter->brush().style() == Qt::NoBrush || painter->brush().color().alpha() == 0) return;
   
-  lines->remove(lines->size()-2, 2);
+  applyFillAntialiasingHint(painter);
+  const QVector<QPolygonF> polygons = getFillPolygons(lowerLine, upperLine);
+  for (int i=0; i<polygons.size(); ++i)
+    painter->drawPolygon(polygons.at(i));
 }
 
 /*! \internal
   
-  called by \ref addFillBasePoints to conveniently assign the point which closes the fill polygon
-  on the lower side of the zero-value-line parallel to the key axis. The logarithmic axis scale
-  case is a bit special, since the zero-value-line in pixel coordinates is in positive or negative
-  infinity. So this case is handled separately by just closing the fill polygon on the axis which
-  lies in the direction towards the zero value.
-  
-  \a lowerKey will be the the key (in pixels) of the returned point. Depending on whether the key
-  axis is horizontal or vertical, \a lowerKey will end up as the x or y value of the returned
-  point, respectively.
+  Returns in \a data the points of the visible range \a begin to \a end that are needed to draw
+  the band. This is the equivalent of \ref QCPGraph::getOptimizedLineData for all three columns at
+  once.
   
-  \see upperFillBasePoint, addFillBasePoints
+  If adaptive sampling is disabled or there are few points per pixel column, all points are
+  returned. Otherwise the points of each pixel column are reduced to its first and last point, and
+  in between two points at the middle key of the column that carry the envelope of the column:
+  the lowest and highest center value, the lowest lower bound and the highest upper bound. Drawn
+  in sequence, they reproduce the vertical extent of all three lines within the column.
 */
-QPointF QCPGraph::lowerFillBasePoint(double lowerKey) const
+void QCPBand::getOptimizedData(QVector<QCPBandData> *data, const QCPBandDataContainer::const_iterator &begin, const QCPBandDataContainer::const_iterator &end) const
 {
+  data->clear();
   QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(); }
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  if (begin == end) return;
   
-  QPointF point;
-  if (valueAxis->scaleType() == QCPAxis::stLinear)
+  const int dataCount = end-begin;
+  const double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+  if (!mAdaptiveSampling || dataCount < 4*(keyPixelSpan+1))
   {
-    if (keyAxis->axisType() == QCPAxis::atLeft)
-    {
-      point.setX(valueAxis->coordToPixel(0));
-      point.setY(lowerKey);
-    } else if (keyAxis->axisType() == QCPAxis::atRight)
-    {
-      point.setX(valueAxis->coordToPixel(0));
-      point.setY(lowerKey);
-    } else if (keyAxis->axisType() == QCPAxis::atTop)
-    {
-      point.setX(lowerKey);
-      point.setY(valueAxis->coordToPixel(0));
-    } else if (keyAxis->axisType() == QCPAxis::atBottom)
-    {
-      point.setX(lowerKey);
-      point.setY(valueAxis->coordToPixel(0));
-    }
-  } else // valueAxis->mScaleType == QCPAxis::stLogarithmic
+    data->reserve(dataCount);
+    for (QCPBandDataContainer::const_iterator it=begin; it!=end; ++it)
+      data->append(*it);
+    return;
+  }
+  
+  data->reserve(4*(int(keyPixelSpan)+2));
+  QCPBandDataContainer::const_iterator it = begin;
+  while (it != end)
   {
-    // In logarithmic scaling we can't just draw to value zero so we just fill all the way
-    // to the axis which is in the direction towards zero
-    if (keyAxis->orientation() == Qt::Vertical)
+    const int column = qFloor(keyAxis->coordToPixel(it->key));
+    const QCPBandDataContainer::const_iterator first = it;
+    double minValue = first->value, maxValue = first->value, minLower = first->lower, maxUpper = first->upper;
+    for (++it; it != end && qFloor(keyAxis->coordToPixel(it->key)) == column; ++it)
     {
-      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
-          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
-        point.setX(keyAxis->axisRect()->right());
-      else
-        point.setX(keyAxis->axisRect()->left());
-      point.setY(lowerKey);
-    } else if (keyAxis->axisType() == QCPAxis::atTop || keyAxis->axisType() == QCPAxis::atBottom)
+      if (it->value < minValue || qIsNaN(minValue))
+        minValue = it->value;
+      if (it->value > maxValue || qIsNaN(maxValue))
+        maxValue = it->value;
+      if (it->lower < minLower || qIsNaN(minLower))
+        minLower = it->lower;
+      if (it->upper > maxUpper || qIsNaN(maxUpper))
+        maxUpper = it->upper;
+    }
+    const int columnCount = it-first;
+    data->append(*first);
+    if (columnCount > 2)
     {
-      point.setX(lowerKey);
-      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
-          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
-        point.setY(keyAxis->axisRect()->top());
-      else
-        point.setY(keyAxis->axisRect()->bottom());
+      const double centerKey = (first+columnCount/2)->key;
+      data->append(QCPBandData(centerKey, minValue, minLower, maxUpper));
+      data->append(QCPBandData(centerKey, maxValue, minLower, maxUpper));
     }
+    if (columnCount > 1)
+      data->append(*(it-1));
   }
-  return point;
 }
 
 /*! \internal
   
-  called by \ref addFillBasePoints to conveniently assign the point which closes the fill
-  polygon on the upper side of the zero-value-line parallel to the key axis. The logarithmic axis
-  scale case is a bit special, since the zero-value-line in pixel coordinates is in positive or
-  negative infinity. So this case is handled separately by just closing the fill polygon on the
-  axis which lies in the direction towards the zero value.
-
-  \a upperKey will be the the key (in pixels) of the returned point. Depending on whether the key
-  axis is horizontal or vertical, \a upperKey will end up as the x or y value of the returned
-  point, respectively.
-  
-  \see lowerFillBasePoint, addFillBasePoints
+  Returns in \a data the points of the visible range \a begin to \a end on which scatters are
+  drawn. Unlike \ref getOptimizedData, these are always actual data points: all of them, or, if
+  adaptive sampling is enabled and there are at least two points per pixel column on average, the
+  points with the lowest and highest center value of each pixel column. NaN values are skipped for
+  the lowest and highest point.
 */
-QPointF QCPGraph::upperFillBasePoint(double upperKey) const
+void QCPBand::getOptimizedScatterData(QVector<QCPBandData> *data, const QCPBandDataContainer::const_iterator &begin, const QCPBandDataContainer::const_iterator &end) const
 {
+  data->clear();
   QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(); }
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  if (begin == end) return;
   
-  QPointF point;
-  if (valueAxis->scaleType() == QCPAxis::stLinear)
+  const int dataCount = end-begin;
+  const double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+  if (!mAdaptiveSampling || dataCount < 2*(keyPixelSpan+1))
   {
-    if (keyAxis->axisType() == QCPAxis::atLeft)
-    {
-      point.setX(valueAxis->coordToPixel(0));
-      point.setY(upperKey);
-    } else if (keyAxis->axisType() == QCPAxis::atRight)
-    {
-      point.setX(valueAxis->coordToPixel(0));
-      point.setY(upperKey);
-    } else if (keyAxis->axisType() == QCPAxis::atTop)
-    {
-      point.setX(upperKey);
-      point.setY(valueAxis->coordToPixel(0));
-    } else if (keyAxis->axisType() == QCPAxis::atBottom)
-    {
-      point.setX(upperKey);
-      point.setY(valueAxis->coordToPixel(0));
-    }
-  } else // valueAxis->mScaleType == QCPAxis::stLogarithmic
+    data->reserve(dataCount);
+    for (QCPBandDataContainer::const_iterator it=begin; it!=end; ++it)
+      data->append(*it);
+    return;
+  }
+  
+  data->reserve(2*(int(keyPixelSpan)+2));
+  QCPBandDataContainer::const_iterator it = begin;
+  while (it != end)
   {
-    // In logarithmic scaling we can't just draw to value 0 so we just fill all the way
-    // to the axis which is in the direction towards 0
-    if (keyAxis->orientation() == Qt::Vertical)
-    {
-      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
-          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
-        point.setX(keyAxis->axisRect()->right());
-      else
-        point.setX(keyAxis->axisRect()->left());
-      point.setY(upperKey);
-    } else if (keyAxis->axisType() == QCPAxis::atTop || keyAxis->axisType() == QCPAxis::atBottom)
+    const int column = qFloor(keyAxis->coordToPixel(it->key));
+    QCPBandDataContainer::const_iterator minIt = it, maxIt = it;
+    for (++it; it != end && qFloor(keyAxis->coordToPixel(it->key)) == column; ++it)
     {
-      point.setX(upperKey);
-      if ((valueAxis->range().upper < 0 && !valueAxis->rangeReversed()) ||
-          (valueAxis->range().upper > 0 && valueAxis->rangeReversed())) // if range is negative, zero is on opposite side of key axis
-        point.setY(keyAxis->axisRect()->top());
-      else
-        point.setY(keyAxis->axisRect()->bottom());
+      if (it->value < minIt->value || qIsNaN(minIt->value))
+        minIt = it;
+      if (it->value > maxIt->value || qIsNaN(maxIt->value))
+        maxIt = it;
     }
+    data->append(*(minIt < maxIt ? minIt : maxIt)); // keep key order within the column
+    if (minIt != maxIt)
+      data->append(*(minIt < maxIt ? maxIt : minIt));
   }
-  return point;
 }
 
 /*! \internal
   
-  Generates the polygon needed for drawing channel fills between this graph and the graph specified
-  in \a mChannelFillGraph (see \ref setChannelFillGraph). The data points representing the line of
-  this graph in pixel coordinates must be passed in \a lines, the corresponding points of the other
-  graph are generated by calling its \ref getLines method.
-
-  This method may return an empty polygon if the key ranges of the two graphs have no overlap of if
-  they don't have the same orientation (e.g. one key axis vertical, the other horizontal). For
-  increased performance (due to implicit sharing), it is recommended to keep the returned QPolygonF
-  const.
+  This method outputs the currently visible data range via \a begin and \a end. The returned range
+  will also never exceed \a rangeRestriction. Like \ref QCPGraph::getVisibleDataBounds, the range
+  includes the data points just outside the visible key range, so lines reach the axis rect border.
 */
-const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lines) const
+void QCPBand::getVisibleDataBounds(QCPBandDataContainer::const_iterator &begin, QCPBandDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const
 {
-  if (!mChannelFillGraph)
-    return QPolygonF();
-  
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPolygonF(); }
-  if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; return QPolygonF(); }
-  
-  if (mChannelFillGraph.data()->mKeyAxis.data()->orientation() != keyAxis->orientation())
-    return QPolygonF(); // don't have same axis orientation, can't fill that (Note: if keyAxis fits, valueAxis will fit too, because it's always orthogonal to keyAxis)
-  
-  if (lines->isEmpty()) return QPolygonF();
-  QVector<QPointF> otherData;
-  mChannelFillGraph.data()->getLines(&otherData, QCPDataRange(0, mChannelFillGraph.data()->dataCount()));
-  if (otherData.isEmpty()) return QPolygonF();
-  QVector<QPointF> thisData;
-  thisData.reserve(lines->size()+otherData.size()); // because we will join both vectors at end of this function
-  for (int i=0; i<lines->size(); ++i) // don't use the vector<<(vector),  it squeezes internally, which ruins the performance tuning with reserve()
-    thisData << lines->at(i);
-  
-  // pointers to be able to swap them, depending which data range needs cropping:
-  QVector<QPointF> *staticData = &thisData;
-  QVector<QPointF> *croppedData = &otherData;
-  
-  // crop both vectors to ranges in which the keys overlap (which coord is key, depends on axisType):
-  if (keyAxis->orientation() == Qt::Horizontal)
+  if (rangeRestriction.isEmpty() || !mKeyAxis)
   {
-    // x is key
-    // if an axis range is reversed, the data point keys will be descending. Reverse them, since following algorithm assumes ascending keys:
-    if (staticData->first().x() > staticData->last().x())
-    {
-      int size = staticData->size();
-      for (int i=0; i<size/2; ++i)
-        qSwap((*staticData)[i], (*staticData)[size-1-i]);
-    }
-    if (croppedData->first().x() > croppedData->last().x())
-    {
-      int size = croppedData->size();
-      for (int i=0; i<size/2; ++i)
-        qSwap((*croppedData)[i], (*croppedData)[size-1-i]);
-    }
-    // crop lower bound:
-    if (staticData->first().x() < croppedData->first().x()) // other one must be cropped
-      qSwap(staticData, croppedData);
-    int lowBound = findIndexBelowX(croppedData, staticData->first().x());
-    if (lowBound == -1) return QPolygonF(); // key ranges have no overlap
-    croppedData->remove(0, lowBound);
-    // set lowest point of cropped data to fit exactly key position of first static data
-    // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
-    double slope;
-    if (croppedData->at(1).x()-croppedData->at(0).x() != 0)
-      slope = (croppedData->at(1).y()-croppedData->at(0).y())/(croppedData->at(1).x()-croppedData->at(0).x());
-    else
-      slope = 0;
-    (*croppedData)[0].setY(croppedData->at(0).y()+slope*(staticData->first().x()-croppedData->at(0).x()));
-    (*croppedData)[0].setX(staticData->first().x());
-    
-    // crop upper bound:
-    if (staticData->last().x() > croppedData->last().x()) // other one must be cropped
-      qSwap(staticData, croppedData);
-    int highBound = findIndexAboveX(croppedData, staticData->last().x());
-    if (highBound == -1) return QPolygonF(); // key ranges have no overlap
-    croppedData->remove(highBound+1, croppedData->size()-(highBound+1));
-    // set highest point of cropped data to fit exactly key position of last static data
-    // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
-    int li = croppedData->size()-1; // last index
-    if (croppedData->at(li).x()-croppedData->at(li-1).x() != 0)
-      slope = (croppedData->at(li).y()-croppedData->at(li-1).y())/(croppedData->at(li).x()-croppedData->at(li-1).x());
-    else
-      slope = 0;
-    (*croppedData)[li].setY(croppedData->at(li-1).y()+slope*(staticData->last().x()-croppedData->at(li-1).x()));
-    (*croppedData)[li].setX(staticData->last().x());
-  } else // mKeyAxis->orientation() == Qt::Vertical
-  {
-    // y is key
-    // similar to "x is key" but switched x,y. Further, lower/upper meaning is inverted compared to x,
-    // because in pixel coordinates, y increases from top to bottom, not bottom to top like data coordinate.
-    // if an axis range is reversed, the data point keys will be descending. Reverse them, since following algorithm assumes ascending keys:
-    if (staticData->first().y() < staticData->last().y())
-    {
-      int size = staticData->size();
-      for (int i=0; i<size/2; ++i)
-        qSwap((*staticData)[i], (*staticData)[size-1-i]);
-    }
-    if (croppedData->first().y() < croppedData->last().y())
-    {
-      int size = croppedData->size();
-      for (int i=0; i<size/2; ++i)
-        qSwap((*croppedData)[i], (*croppedData)[size-1-i]);
-    }
-    // crop lower bound:
-    if (staticData->first().y() > croppedData->first().y()) // other one must be cropped
-      qSwap(staticData, croppedData);
-    int lowBound = findIndexAboveY(croppedData, staticData->first().y());
-    if (lowBound == -1) return QPolygonF(); // key ranges have no overlap
-    croppedData->remove(0, lowBound);
-    // set lowest point of cropped data to fit exactly key position of first static data
-    // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
-    double slope;
-    if (croppedData->at(1).y()-croppedData->at(0).y() != 0) // avoid division by zero in step plots
-      slope = (croppedData->at(1).x()-croppedData->at(0).x())/(croppedData->at(1).y()-croppedData->at(0).y());
-    else
-      slope = 0;
-    (*croppedData)[0].setX(croppedData->at(0).x()+slope*(staticData->first().y()-croppedData->at(0).y()));
-    (*croppedData)[0].setY(staticData->first().y());
-    
-    // crop upper bound:
-    if (staticData->last().y() < croppedData->last().y()) // other one must be cropped
-      qSwap(staticData, croppedData);
-    int highBound = findIndexBelowY(croppedData, staticData->last().y());
-    if (highBound == -1) return QPolygonF(); // key ranges have no overlap
-    croppedData->remove(highBound+1, croppedData->size()-(highBound+1));
-    // set highest point of cropped data to fit exactly key position of last static data
-    // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
-    int li = croppedData->size()-1; // last index
-    if (croppedData->at(li).y()-croppedData->at(li-1).y() != 0) // avoid division by zero in step plots
-      slope = (croppedData->at(li).x()-croppedData->at(li-1).x())/(croppedData->at(li).y()-croppedData->at(li-1).y());
-    else
-      slope = 0;
-    (*croppedData)[li].setX(croppedData->at(li-1).x()+slope*(staticData->last().y()-croppedData->at(li-1).y()));
-    (*croppedData)[li].setY(staticData->last().y());
+    end = mDataContainer->constEnd();
+    begin = end;
+  } else
+  {
+    begin = mDataContainer->findBegin(mKeyAxis.data()->range().lower);
+    end = mDataContainer->findEnd(mKeyAxis.data()->range().upper);
+    mDataContainer->limitIteratorsToDataRange(begin, end, rangeRestriction); // this also ensures rangeRestriction outside data bounds doesn't break anything
   }
-  
-  // return joined:
-  for (int i=otherData.size()-1; i>=0; --i) // insert reversed, otherwise the polygon will be twisted
-    thisData << otherData.at(i);
-  return QPolygonF(thisData);
 }
 
 /*! \internal
   
-  Finds the smallest index of \a data, whose points x value is just above \a x. Assumes x values in
-  \a data points are ordered ascending, as is the case when plotting with horizontal key axis.
-
-  Used to calculate the channel fill polygon, see \ref getChannelFillPolygon.
+  Converts the visible data within \a dataRange to pixel coordinates of the center line (\a
+  valueLine), the lower bound line (\a lowerLine) and the upper bound line (\a upperLine). All three
+  are produced from one pass over the data returned by \ref getOptimizedData (or \ref
+  getSourceData, if a data source is set), and share the key pixel coordinate of each point.
+  
+  \a dataRange may exceed the total data bounds without harm, as with \ref QCPGraph::getLines.
 */
-int QCPGraph::findIndexAboveX(const QVector<QPointF> *data, double x) const
+void QCPBand::getLines(QVector<QPointF> *valueLine, QVector<QPointF> *lowerLine, QVector<QPointF> *upperLine, const QCPDataRange &dataRange) const
 {
-  for (int i=data->size()-1; i>=0; --i)
+  valueLine->clear();
+  lowerLine->clear();
+  upperLine->clear();
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  QVector<QCPBandData> data;
+  if (mDataSource)
   {
-    if (data->at(i).x() < x)
-    {
-      if (i<data->size()-1)
-        return i+1;
-      else
-        return data->size()-1;
-    }
+    getSourceData(&data, dataRange, false);
+  } else
+  {
+    QCPBandDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    getOptimizedData(&data, begin, end);
   }
-  return -1;
-}
-
-/*! \internal
-  
-  Finds the highest index of \a data, whose points x value is just below \a x. Assumes x values in
-  \a data points are ordered ascending, as is the case when plotting with horizontal key axis.
   
-  Used to calculate the channel fill polygon, see \ref getChannelFillPolygon.
-*/
-int QCPGraph::findIndexBelowX(const QVector<QPointF> *data, double x) const
-{
-  for (int i=0; i<data->size(); ++i)
+  const int n = data.size();
+  valueLine->resize(n);
+  lowerLine->resize(n);
+  upperLine->resize(n);
+  const bool verticalKey = keyAxis->orientation() == Qt::Vertical;
+  for (int i=0; i<n; ++i)
   {
-    if (data->at(i).x() > x)
+    const QCPBandData &point = data.at(i);
+    const double keyPixel = keyAxis->coordToPixel(point.key);
+    const double valuePixel = valueAxis->coordToPixel(point.value);
+    const double lowerPixel = valueAxis->coordToPixel(point.lower);
+    const double upperPixel = valueAxis->coordToPixel(point.upper);
+    if (verticalKey)
+    {
+      (*valueLine)[i] = QPointF(valuePixel, keyPixel);
+      (*lowerLine)[i] = QPointF(lowerPixel, keyPixel);
+      (*upperLine)[i] = QPointF(upperPixel, keyPixel);
+    } else
     {
-      if (i>0)
-        return i-1;
-      else
-        return 0;
+      (*valueLine)[i] = QPointF(keyPixel, valuePixel);
+      (*lowerLine)[i] = QPointF(keyPixel, lowerPixel);
+      (*upperLine)[i] = QPointF(keyPixel, upperPixel);
     }
   }
-  return -1;
 }
 
 /*! \internal
   
-  Finds the smallest index of \a data, whose points y value is just above \a y. Assumes y values in
-  \a data points are ordered descending, as is the case when plotting with vertical key axis.
-  
-  Used to calculate the channel fill polygon, see \ref getChannelFillPolygon.
+  Returns the polygons enclosing the area between \a lowerLine and \a upperLine. Each polygon runs
+  along the upper line and back along the lower line. Points where either line is NaN end the
+  current polygon, so gaps in the data also leave gaps in the fill.
 */
-int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
+QVector<QPolygonF> QCPBand::getFillPolygons(const QVector<QPointF> &lowerLine, const QVector<QPointF> &upperLine) const
 {
-  for (int i=0; i<data->size(); ++i)
+  QVector<QPolygonF> result;
+  const int n = qMin(lowerLine.size(), upperLine.size());
+  int segmentStart = 0;
+  for (int i=0; i<=n; ++i)
   {
-    if (data->at(i).y() < y)
+    if (i == n ||
+        qIsNaN(lowerLine.at(i).x()) || qIsNaN(lowerLine.at(i).y()) ||
+        qIsNaN(upperLine.at(i).x()) || qIsNaN(upperLine.at(i).y()))
     {
-      if (i>0)
-        return i-1;
-      else
-        return 0;
+      if (i-segmentStart > 1)
+      {
+        QPolygonF polygon;
+        polygon.reserve(2*(i-segmentStart));
+        for (int k=segmentStart; k<i; ++k)
+          polygon << upperLine.at(k);
+        for (int k=i-1; k>=segmentStart; --k)
+          polygon << lowerLine.at(k);
+        result.append(polygon);
+      }
+      segmentStart = i+1;
     }
   }
-  return -1;
+  return result;
 }
 
 /*! \internal
   
-  Calculates the minimum distance in pixels the graph's representation has from the given \a
-  pixelPoint. This is used to determine whether the graph was clicked or not, e.g. in \ref
-  selectTest. The closest data point to \a pixelPoint is returned in \a closestData. Note that if
-  the graph has a line representation, the returned distance may be smaller than the distance to
-  the \a closestData point, since the distance to the graph line is also taken into account.
+  Reads the visible data points of the data source (\ref setDataSource) into \a data, restricted to
+  \a dataRange. The visible range is found by one binary search on the shared keys, and the four
+  columns are read in the same pass, so the cost only depends on the number of visible points.
   
-  If either the graph has no data or if the line style is \ref lsNone and the scatter style's shape
-  is \ref QCPScatterStyle::ssNone (i.e. there is no visual representation of the graph), returns -1.0.
+  If adaptive sampling is disabled or there are few points per pixel column, all visible points
+  are read. Otherwise, the points of each pixel column are reduced while reading: If \a scatterData
+  is false, to the points \ref getOptimizedData would produce for the lines and the fill. If \a
+  scatterData is true, to the actual data points \ref getOptimizedScatterData would produce for
+  the scatters.
 */
-double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const
+void QCPBand::getSourceData(QVector<QCPBandData> *data, const QCPDataRange &dataRange, bool scatterData) const
 {
-  closestData = mDataContainer->constEnd();
-  if (mDataContainer->isEmpty())
-    return -1.0;
-  if (mLineStyle == lsNone && mScatterStyle.isNone())
-    return -1.0;
+  data->clear();
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
   
-  // calculate minimum distances to graph data points and find closestData iterator:
-  double minDistSqr = std::numeric_limits<double>::max();
-  // determine which key range comes into question, taking selection tolerance around pos into account:
-  double posKeyMin, posKeyMax, dummy;
-  pixelsToCoords(pixelPoint-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
-  pixelsToCoords(pixelPoint+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
-  if (posKeyMin > posKeyMax)
-    qSwap(posKeyMin, posKeyMax);
-  // iterate over found data points and then choose the one with the shortest distance to pos:
-  QCPGraphDataContainer::const_iterator begin = mDataContainer->findBegin(posKeyMin, true);
-  QCPGraphDataContainer::const_iterator end = mDataContainer->findEnd(posKeyMax, true);
-  for (QCPGraphDataContainer::const_iterator it=begin; it!=end; ++it)
+  // get visible data range and limit it to dataRange:
+  const QCPDataRange visibleRange(findBegin(keyAxis->range().lower), findEnd(keyAxis->range().upper));
+  const QCPDataRange range = visibleRange.bounded(dataRange.bounded(QCPDataRange(0, mDataSource->size())));
+  const int begin = range.begin();
+  const int end = range.end();
+  if (begin >= end)
+    return;
+  
+  const double *keys = mDataSource->keys();
+  const double *values = mDataSource->values();
+  const double *lower = mDataSource->lower();
+  const double *upper = mDataSource->upper();
+  const int pointsPerColumn = scatterData ? 2 : 4;
+  const double keyPixelSpan = qAbs(keyAxis->coordToPixel(keys[begin])-keyAxis->coordToPixel(keys[end-1]));
+  if (!mAdaptiveSampling || end-begin < pointsPerColumn*(keyPixelSpan+1))
+  {
+    data->reserve(end-begin);
+    for (int i=begin; i<end; ++i)
+      data->append(QCPBandData(keys[i], values[i], lower[i], upper[i]));
+    return;
+  }
+  
+  data->reserve(pointsPerColumn*(int(keyPixelSpan)+2));
+  int i = begin;
+  while (i < end)
   {
-    const double currentDistSqr = QCPVector2D(coordsToPixels(it->key, it->value)-pixelPoint).lengthSquared();
-    if (currentDistSqr < minDistSqr)
+    const int column = qFloor(keyAxis->coordToPixel(keys[i]));
+    const int first = i;
+    int minIndex = i, maxIndex = i;
+    double minLower = lower[i], maxUpper = upper[i];
+    for (++i; i<end && qFloor(keyAxis->coordToPixel(keys[i])) == column; ++i)
     {
-      minDistSqr = currentDistSqr;
-      closestData = it;
+      if (values[i] < values[minIndex] || qIsNaN(values[minIndex]))
+        minIndex = i;
+      if (values[i] > values[maxIndex] || qIsNaN(values[maxIndex]))
+        maxIndex = i;
+      if (lower[i] < minLower || qIsNaN(minLower))
+        minLower = lower[i];
+      if (upper[i] > maxUpper || qIsNaN(maxUpper))
+        maxUpper = upper[i];
     }
-  }
-    
-  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
-  if (mLineStyle != lsNone)
-  {
-    // line displayed, calculate distance to line segments:
-    QVector<QPointF> lineData;
-    getLines(&lineData, QCPDataRange(0, dataCount()));
-    QCPVector2D p(pixelPoint);
-    const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
-    for (int i=0; i<lineData.size()-1; i+=step)
+    if (scatterData)
     {
-      const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
-      if (currentDistSqr < minDistSqr)
-        minDistSqr = currentDistSqr;
+      const int a = qMin(minIndex, maxIndex), b = qMax(minIndex, maxIndex); // keep key order within the column
+      data->append(QCPBandData(keys[a], values[a], lower[a], upper[a]));
+      if (a != b)
+        data->append(QCPBandData(keys[b], values[b], lower[b], upper[b]));
+    } else
+    {
+      const int columnCount = i-first;
+      data->append(QCPBandData(keys[first], values[first], lower[first], upper[first]));
+      if (columnCount > 2)
+      {
+        const double centerKey = keys[first+columnCount/2];
+        data->append(QCPBandData(centerKey, values[minIndex], minLower, maxUpper));
+        data->append(QCPBandData(centerKey, values[maxIndex], minLower, maxUpper));
+      }
+      if (columnCount > 1)
+        data->append(QCPBandData(keys[i-1], values[i-1], lower[i-1], upper[i-1]));
     }
   }
-  
-  return qSqrt(minDistSqr);
 }
 
 /*! \internal
   
-  Finds the highest index of \a data, whose points y value is just below \a y. Assumes y values in
-  \a data points are ordered descending, as is the case when plotting with vertical key axis (since
-  keys are ordered ascending).
-
-  Used to calculate the channel fill polygon, see \ref getChannelFillPolygon.
+  Checks the keys of the data source (\ref setDataSource) for ascending order, and prints a
+  warning to the debug output if they aren't. Like \ref QCPGraph::checkDataSource, the check is only
+  repeated when the revision of the data source changed.
 */
-int QCPGraph::findIndexBelowY(const QVector<QPointF> *data, double y) const
+void QCPBand::checkDataSource() const
 {
-  for (int i=data->size()-1; i>=0; --i)
-  {
-    if (data->at(i).y() > y)
-    {
-      if (i<data->size()-1)
-        return i+1;
-      else
-        return data->size()-1;
-    }
-  }
-  return -1;
+  if (!mDataSource || mDataSource->revision() == mDataSourceRevision)
+    return;
+  mDataSourceRevision = mDataSource->revision();
+  const double *keys = mDataSource->keys();
+  if (!std::is_sorted(keys, keys+mDataSource->size()))
+    qDebug() << Q_FUNC_INFO << "Keys of data source aren't sorted ascending, band may be displayed incorrectly. Plottable name:" << name();
 }
+
 /* end of 'src/plottables/plottable-graph.cpp' */
 
 
@@ -21453,6 +24439,14 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   
   The appearance of the curve is determined by the pen and the brush (\ref setPen, \ref setBrush).
   
+  \section qcpcurve-performance Performance
+  
+  The curve keeps the bounding boxes of chunks of consecutive data points (see \ref chunkSize).
+  Chunks that lie entirely outside the visible axis rect are skipped as a whole when drawing, so
+  zooming into a small part of a long curve only costs time for the visible portion. When the data
+  points are denser than the pixel grid, adaptive sampling leaves out points closer than one pixel
+  to the previously drawn point (see \ref setAdaptiveSampling).
+  
   \section qcpcurve-usage Usage
   
   Like all data representing objects in QCustomPlot, the QCPCurve is a plottable
@@ -21489,7 +24483,10 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   but use QCustomPlot::removePlottable() instead.
 */
 QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable1D<QCPCurveData>(keyAxis, valueAxis)
+  QCPAbstractPlottable1D<QCPCurveData>(keyAxis, valueAxis),
+  mAdaptiveSampling(true),
+  mChunkBoundsContainer(0),
+  mChunkBoundsRevision(-1)
 {
   // modify inherited properties from abstract plottable:
   setPen(QPen(Qt::blue, 0));
@@ -21598,6 +24595,27 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
   mLineStyle = style;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this curve. If enabled, data points
+  inside the visible axis rect that are closer than one pixel (in both key and value direction) to
+  the previously drawn point are left out of the curve line. The last point before the curve
+  leaves the visible axis rect or ends is always kept, so the curve still connects to its
+  surroundings exactly.
+  
+  This way, curves with many more data points than pixels, e.g. zoomed out parametric curves with
+  millions of points, are drawn with a number of line segments that is bounded by the length of
+  the curve in pixels rather than the number of data points. The visual deviation is below one
+  pixel.
+  
+  By default, adaptive sampling is enabled. Scatters are not affected by this setting.
+  
+  \see QCPGraph::setAdaptiveSampling
+*/
+void QCPCurve::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a t, \a keys and \a values to the current data. The provided vectors
@@ -21733,6 +24751,7 @@ QCPRange QCPCurve::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
 /* inherits documentation from base class */
 void QCPCurve::draw(QCPPainter *painter)
 {
+  mDataContainer->mergePendingRuns();
   if (mDataContainer->isEmpty()) return;
   
   // allocate line vector:
@@ -21786,7 +24805,7 @@ void QCPCurve::draw(QCPPainter *painter)
     QCPScatterStyle finalScatterStyle = mScatterStyle;
     if (isSelectedSegment && mSelectionDecorator)
       finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
-    if (!finalScatterStyle.isNone())
+    if (!finalScatterStyle.isNone() && !(mParentPlot->coarseReplot() && mLineStyle != lsNone)) // coarse replots only show the line where there is one
     {
       getScatters(&scatters, allSegments.at(i), finalScatterStyle.size());
       drawScatterPlot(painter, scatters, finalScatterStyle);
@@ -21891,6 +24910,12 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &poin
   Methods that are also involved in the algorithm are: \ref getRegion, \ref getOptimizedPoint, \ref
   getOptimizedCornerPoints \ref mayTraverse, \ref getTraverse, \ref getTraverseCornerPoints.
 
+  Chunks of data points whose bounding box lies entirely in one of the outer regions (see \ref
+  updateChunkBounds) are skipped after their first point, since the remaining points of such a
+  chunk wouldn't add anything to \a lines. If adaptive sampling is enabled (\ref
+  setAdaptiveSampling), points inside the visible rect closer than one pixel to the previously
+  added point are left out, except for the last one before leaving the visible rect.
+
   \see drawCurveLine, drawScatterPlot
 */
 void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRange, double penWidth) const
@@ -21912,15 +24937,25 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
   mDataContainer->limitIteratorsToDataRange(itBegin, itEnd, dataRange);
   if (itBegin == itEnd)
     return;
+  updateChunkBounds();
+  const QCPCurveDataContainer::const_iterator dataBegin = mDataContainer->constBegin();
+  const int endIndex = itEnd-dataBegin;
   QCPCurveDataContainer::const_iterator it = itBegin;
   QCPCurveDataContainer::const_iterator prevIt = itEnd-1;
   int prevRegion = getRegion(prevIt->key, prevIt->value, keyMin, valueMax, keyMax, valueMin);
   QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
+  QPointF skippedPoint; // the last point in R that was left out by adaptive sampling
+  bool haveSkippedPoint = false;
   while (it != itEnd)
   {
     const int currentRegion = getRegion(it->key, it->value, keyMin, valueMax, keyMax, valueMin);
     if (currentRegion != prevRegion) // changed region, possibly need to add some optimized edge points or original points if entering R
     {
+      if (haveSkippedPoint) // leaving R, so the last point in R must be added to connect to the outside exactly
+      {
+        lines->append(skippedPoint);
+        haveSkippedPoint = false;
+      }
       if (currentRegion != 5) // segment doesn't end in R, so it's a candidate for removal
       {
         QPointF crossA, crossB;
@@ -21963,16 +24998,43 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
     {
       if (currentRegion == 5) // still in R, keep adding original points
       {
-        lines->append(coordsToPixels(it->key, it->value));
+        const QPointF point = coordsToPixels(it->key, it->value);
+        if (mAdaptiveSampling && !lines->isEmpty() && qAbs(point.x()-lines->last().x()) < 1.0 && qAbs(point.y()-lines->last().y()) < 1.0) // closer than a pixel to previous point
+        {
+          skippedPoint = point;
+          haveSkippedPoint = true;
+        } else
+        {
+          if (haveSkippedPoint && (qIsNaN(point.x()) || qIsNaN(point.y()))) // keep the end of the curve before a gap
+            lines->append(skippedPoint);
+          lines->append(point);
+          haveSkippedPoint = false;
+        }
       } else // still outside R, no need to add anything
       {
         // see how this is not doing anything? That's the main optimization...
       }
     }
+    // if the whole chunk of this point lies in the same outer region, its remaining points won't add
+    // anything either, so jump to its last point:
+    if (currentRegion != 5)
+    {
+      const int index = it-dataBegin;
+      if (index % chunkSize == 0 || it == itBegin)
+      {
+        const int chunk = index/chunkSize;
+        const int chunkRegionA = getRegion(mChunkKeyBounds.at(chunk).lower, mChunkValueBounds.at(chunk).lower, keyMin, valueMax, keyMax, valueMin);
+        const int chunkRegionB = getRegion(mChunkKeyBounds.at(chunk).upper, mChunkValueBounds.at(chunk).upper, keyMin, valueMax, keyMax, valueMin);
+        if (chunkRegionA == currentRegion && chunkRegionB == currentRegion)
+          it = dataBegin+qMin((chunk+1)*chunkSize, endIndex)-1;
+      }
+    }
     prevIt = it;
     prevRegion = currentRegion;
     ++it;
   }
+  if (haveSkippedPoint)
+    lines->append(skippedPoint);
   *lines << trailingPoints;
 }
 
@@ -21992,7 +25054,8 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
 
   \a scatterWidth specifies the scatter width that will be used to later draw the scatters at pixel
   coordinates generated by this function. This is needed here to calculate an accordingly wider
-  margin around the axis rect when performing the data point reduction.
+  margin around the axis rect when performing the data point reduction. Chunks of data points
+  whose bounding box lies outside of this margin (see \ref updateChunkBounds) are skipped entirely.
 
   \see draw, drawScatterPlot
 */
@@ -22021,55 +25084,31 @@ void QCPCurve::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   valueRange.lower = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueRange.lower)-scatterWidth*valueAxis->pixelOrientation());
   valueRange.upper = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueRange.upper)+scatterWidth*valueAxis->pixelOrientation());
   
-  QCPCurveDataContainer::const_iterator it = begin;
-  int itIndex = begin-mDataContainer->constBegin();
-  while (doScatterSkip && it != end && itIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
-  {
-    ++itIndex;
-    ++it;
-  }
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    while (it != end)
-    {
-      if (!qIsNaN(it->value) && keyRange.contains(it->key) && valueRange.contains(it->value))
-        scatters->append(QPointF(valueAxis->coordToPixel(it->value), keyAxis->coordToPixel(it->key)));
-      
-      // advance iterator to next (non-skipped) data point:
-      if (!doScatterSkip)
-        ++it;
-      else
-      {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex) // make sure we didn't jump over end
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
-      }
-    }
-  } else
-  {
-    while (it != end)
+  // only visit the chunks whose bounding box intersects the visible range:
+  updateChunkBounds();
+  const QCPCurveDataContainer::const_iterator dataBegin = mDataContainer->constBegin();
+  const int beginIndex = begin-dataBegin;
+  const bool keyIsVertical = keyAxis->orientation() == Qt::Vertical;
+  for (int chunk=beginIndex/chunkSize; chunk*chunkSize<endIndex; ++chunk)
+  {
+    const QCPRange &chunkKeyRange = mChunkKeyBounds.at(chunk);
+    const QCPRange &chunkValueRange = mChunkValueBounds.at(chunk);
+    if (chunkKeyRange.upper < keyRange.lower || chunkKeyRange.lower > keyRange.upper ||
+        chunkValueRange.upper < valueRange.lower || chunkValueRange.lower > valueRange.upper)
+      continue;
+    int index = qMax(chunk*chunkSize, beginIndex);
+    if (doScatterSkip && index % scatterModulo != 0) // advance to first non-skipped scatter
+      index += scatterModulo-index%scatterModulo;
+    const int chunkEndIndex = qMin((chunk+1)*chunkSize, endIndex);
+    for (; index<chunkEndIndex; index+=scatterModulo)
     {
+      const QCPCurveDataContainer::const_iterator it = dataBegin+index;
       if (!qIsNaN(it->value) && keyRange.contains(it->key) && valueRange.contains(it->value))
-        scatters->append(QPointF(keyAxis->coordToPixel(it->key), valueAxis->coordToPixel(it->value)));
-      
-      // advance iterator to next (non-skipped) data point:
-      if (!doScatterSkip)
-        ++it;
-      else
       {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex) // make sure we didn't jump over end
-          it += scatterModulo;
+        if (keyIsVertical)
+          scatters->append(QPointF(valueAxis->coordToPixel(it->value), keyAxis->coordToPixel(it->key)));
         else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
+          scatters->append(QPointF(keyAxis->coordToPixel(it->key), valueAxis->coordToPixel(it->value)));
       }
     }
   }
@@ -22742,6 +25781,55 @@ double QCPCurve::pointDistance(const QPointF &pixelPoint, QCPCurveDataContainer:
   
   return qSqrt(minDistSqr);
 }
+
+/*! \internal
+
+  Makes sure the chunk index used by \ref getCurveLines and \ref getScatters is up to date.
+
+  The index divides the data into chunks of \ref chunkSize consecutive data points and stores the
+  key and value range of each chunk in \a mChunkKeyBounds and \a mChunkValueBounds. A chunk which
+  contains a data point with NaN key or value gets infinite bounds, so it is never skipped, and
+  the gaps in the curve are preserved.
+
+  The index is rebuilt only if the data container or its revision (see \ref
+  QCPDataContainer::revision) changed since the last call.
+*/
+void QCPCurve::updateChunkBounds() const
+{
+  if (mChunkBoundsContainer == mDataContainer.data() && mChunkBoundsRevision == mDataContainer->revision())
+    return;
+  
+  const QCPCurveDataContainer::const_iterator dataBegin = mDataContainer->constBegin();
+  const int dataCount = mDataContainer->size();
+  const int chunkCount = (dataCount+chunkSize-1)/chunkSize;
+  const double inf = std::numeric_limits<double>::infinity();
+  mChunkKeyBounds.resize(chunkCount);
+  mChunkValueBounds.resize(chunkCount);
+  for (int chunk=0; chunk<chunkCount; ++chunk)
+  {
+    QCPCurveDataContainer::const_iterator it = dataBegin+chunk*chunkSize;
+    const QCPCurveDataContainer::const_iterator itEnd = dataBegin+qMin((chunk+1)*chunkSize, dataCount);
+    QCPRange keyBounds(it->key, it->key);
+    QCPRange valueBounds(it->value, it->value);
+    for (; it!=itEnd; ++it)
+    {
+      if (qIsNaN(it->key) || qIsNaN(it->value))
+      {
+        keyBounds = QCPRange(-inf, inf);
+        valueBounds = QCPRange(-inf, inf);
+        break;
+      }
+      if (it->key < keyBounds.lower) keyBounds.lower = it->key;
+      if (it->key > keyBounds.upper) keyBounds.upper = it->key;
+      if (it->value < valueBounds.lower) valueBounds.lower = it->value;
+      if (it->value > valueBounds.upper) valueBounds.upper = it->value;
+    }
+    mChunkKeyBounds[chunk] = keyBounds;
+    mChunkValueBounds[chunk] = valueBounds;
+  }
+  mChunkBoundsContainer = mDataContainer.data();
+  mChunkBoundsRevision = mDataContainer->revision();
+}
 /* end of 'src/plottables/plottable-curve.cpp' */
 
 
@@ -23180,6 +26268,10 @@ QCPBarsData::QCPBarsData(double key, double value) :
   (see \ref QCPBars::moveAbove). So when two bars are at the same key position, they will appear
   stacked.
   
+  The base values of stacked bars are computed for all bars of a stack at once, in a single sweep
+  over their keys, and cached until the data of any bars in the stack changes. Drawing deep stacks
+  thus doesn't require searching the bars below for every single bar.
+  
   If you would like to group multiple QCPBars plottables together so they appear side by side as
   shown below, use QCPBarsGroup.
   
@@ -23240,7 +26332,9 @@ QCPBars::QCPBars(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mWidthType(wtPlotCoords),
   mBarsGroup(0),
   mBaseValue(0),
-  mStackingGap(0)
+  mStackingGap(0),
+  mAdaptiveSampling(true),
+  mStackedBasesBaseValue(0)
 {
   // modify inherited properties from abstract plottable:
   mPen.setColor(Qt::blue);
@@ -23362,6 +26456,23 @@ void QCPBars::setStackingGap(double pixels)
   mStackingGap = pixels;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this bars plottable. If enabled and
+  the bars are narrower than one pixel, all bars whose centers fall into the same pixel column are
+  merged into one rect covering that column, which spans the value envelope (lowest to highest
+  extent) of the merged bars. This way, dense bar charts like histograms with many bins are drawn in
+  time proportional to the pixel width of the axis rect, rather than the number of bars.
+  
+  By default, adaptive sampling is enabled. It has no effect on bars that are at least one pixel
+  wide.
+  
+  \see QCPGraph::setAdaptiveSampling
+*/
+void QCPBars::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -23486,7 +26597,7 @@ QCPDataSelection QCPBars::selectTestRect(const QRectF &rect, bool onlySelectable
   
   for (QCPBarsDataContainer::const_iterator it=visibleBegin; it!=visibleEnd; ++it)
   {
-    if (rect.intersects(getBarRect(it->key, it->value)))
+    if (rect.intersects(getBarRect(it->key, it->value, getStackedBaseValueAt(it-mDataContainer->constBegin()))))
       result.addDataRange(QCPDataRange(it-mDataContainer->constBegin(), it-mDataContainer->constBegin()+1), false);
   }
   result.simplify();
@@ -23509,7 +26620,7 @@ double QCPBars::selectTest(const QPointF &pos, bool onlySelectable, QVariant *de
     getVisibleDataBounds(visibleBegin, visibleEnd);
     for (QCPBarsDataContainer::const_iterator it=visibleBegin; it!=visibleEnd; ++it)
     {
-      if (getBarRect(it->key, it->value).contains(pos))
+      if (getBarRect(it->key, it->value, getStackedBaseValueAt(it-mDataContainer->constBegin())).contains(pos))
       {
         if (details)
         {
@@ -23579,9 +26690,10 @@ QCPRange QCPBars::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
     itBegin = mDataContainer->findBegin(inKeyRange.lower);
     itEnd = mDataContainer->findEnd(inKeyRange.upper);
   }
+  updateStackedBases();
   for (QCPBarsDataContainer::const_iterator it = itBegin; it != itEnd; ++it)
   {
-    const double current = it->value + getStackedBaseValue(it->key, it->value >= 0);
+    const double current = it->value + getStackedBaseValueAt(it-mDataContainer->constBegin());
     if (qIsNaN(current)) continue;
     if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
     {
@@ -23612,7 +26724,8 @@ QPointF QCPBars::dataPixelPosition(int index) const
     if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPointF(); }
     
     const QCPDataContainer<QCPBarsData>::const_iterator it = mDataContainer->constBegin()+index;
-    const double valuePixel = valueAxis->coordToPixel(getStackedBaseValue(it->key, it->value >= 0) + it->value);
+    updateStackedBases();
+    const double valuePixel = valueAxis->coordToPixel(getStackedBaseValueAt(index) + it->value);
     const double keyPixel = keyAxis->coordToPixel(it->key) + (mBarsGroup ? mBarsGroup->keyPixelOffset(this, it->key) : 0);
     if (keyAxis->orientation() == Qt::Horizontal)
       return QPointF(keyPixel, valuePixel);
@@ -23628,11 +26741,13 @@ QPointF QCPBars::dataPixelPosition(int index) const
 /* inherits documentation from base class */
 void QCPBars::draw(QCPPainter *painter)
 {
+  mDataContainer->mergePendingRuns();
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (mDataContainer->isEmpty()) return;
   
   QCPBarsDataContainer::const_iterator visibleBegin, visibleEnd;
   getVisibleDataBounds(visibleBegin, visibleEnd);
+  QVector<QRectF> barRects; // bar pixel rects will be stored here while iterating over segments
   
   // loop over and draw segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
@@ -23647,26 +26762,27 @@ void QCPBars::draw(QCPPainter *painter)
     if (begin == end)
       continue;
     
+    // check data validity if flag set:
+#ifdef QCUSTOMPLOT_CHECK_DATA
     for (QCPBarsDataContainer::const_iterator it=begin; it!=end; ++it)
     {
-      // check data validity if flag set:
-#ifdef QCUSTOMPLOT_CHECK_DATA
       if (QCP::isInvalidData(it->key, it->value))
         qDebug() << Q_FUNC_INFO << "Data point at" << it->key << "of drawn range invalid." << "Plottable name:" << name();
+    }
 #endif
-      // draw bar:
-      if (isSelectedSegment && mSelectionDecorator)
-      {
-        mSelectionDecorator->applyBrush(painter);
-        mSelectionDecorator->applyPen(painter);
-      } else
-      {
-        painter->setBrush(mBrush);
-        painter->setPen(mPen);
-      }
-      applyDefaultAntialiasingHint(painter);
-      painter->drawPolygon(getBarRect(it->key, it->value));
+    // draw all bars of the segment at once:
+    if (isSelectedSegment && mSelectionDecorator)
+    {
+      mSelectionDecorator->applyBrush(painter);
+      mSelectionDecorator->applyPen(painter);
+    } else
+    {
+      painter->setBrush(mBrush);
+      painter->setPen(mPen);
     }
+    applyDefaultAntialiasingHint(painter);
+    getBarRects(&barRects, begin, end);
+    painter->drawRects(barRects);
   }
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
@@ -23699,9 +26815,13 @@ void QCPBars::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   may also lie just outside of the visible range.
   
   if the plottable contains no data, both \a begin and \a end point to constEnd.
+  
+  This method also brings the cached stacked base values up to date (see \ref updateStackedBases),
+  so callers may use \ref getStackedBaseValueAt for the returned data points.
 */
 void QCPBars::getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin, QCPBarsDataContainer::const_iterator &end) const
 {
+  updateStackedBases();
   if (!mKeyAxis)
   {
     qDebug() << Q_FUNC_INFO << "invalid key axis";
@@ -23727,7 +26847,7 @@ void QCPBars::getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin,
   while (it != mDataContainer->constBegin())
   {
     --it;
-    const QRectF barRect = getBarRect(it->key, it->value);
+    const QRectF barRect = getBarRect(it->key, it->value, getStackedBaseValueAt(it-mDataContainer->constBegin()));
     if (mKeyAxis.data()->orientation() == Qt::Horizontal)
       isVisible = ((!mKeyAxis.data()->rangeReversed() && barRect.right() >= lowerPixelBound) || (mKeyAxis.data()->rangeReversed() && barRect.left() <= lowerPixelBound));
     else // keyaxis is vertical
@@ -23741,7 +26861,7 @@ void QCPBars::getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin,
   it = end;
   while (it != mDataContainer->constEnd())
   {
-    const QRectF barRect = getBarRect(it->key, it->value);
+    const QRectF barRect = getBarRect(it->key, it->value, getStackedBaseValueAt(it-mDataContainer->constBegin()));
     if (mKeyAxis.data()->orientation() == Qt::Horizontal)
       isVisible = ((!mKeyAxis.data()->rangeReversed() && barRect.left() <= upperPixelBound) || (mKeyAxis.data()->rangeReversed() && barRect.right() >= upperPixelBound));
     else // keyaxis is vertical
@@ -23761,6 +26881,17 @@ void QCPBars::getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin,
   setBaseValue), and to have non-overlapping border lines with the bars stacked below.
 */
 QRectF QCPBars::getBarRect(double key, double value) const
+{
+  return getBarRect(key, value, getStackedBaseValue(key, value >= 0));
+}
+
+/*! \internal \overload
+  
+  Returns the rect in pixel coordinates of a single bar with the specified \a key and \a value,
+  starting at the already known stacked \a base value. For data points of this bars, the base is
+  provided by \ref getStackedBaseValueAt without searching the bars below.
+*/
+QRectF QCPBars::getBarRect(double key, double value, double base) const
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
@@ -23768,7 +26899,6 @@ QRectF QCPBars::getBarRect(double key, double value) const
   
   double lowerPixelWidth, upperPixelWidth;
   getPixelWidth(key, lowerPixelWidth, upperPixelWidth);
-  double base = getStackedBaseValue(key, value >= 0);
   double basePixel = valueAxis->coordToPixel(base);
   double valuePixel = valueAxis->coordToPixel(base+value);
   double keyPixel = keyAxis->coordToPixel(key);
@@ -23788,6 +26918,66 @@ QRectF QCPBars::getBarRect(double key, double value) const
   }
 }
 
+/*! \internal
+  
+  Returns in \a rects the pixel rects of the bars from \a begin to \a end, as given by \ref
+  getBarRect, so they can be drawn with a single call.
+  
+  If adaptive sampling is enabled (\ref setAdaptiveSampling) and the bars are narrower than one
+  pixel, bars whose centers share a pixel column are merged into one rect. It covers the full
+  column along the key axis, and the envelope of the merged bars along the value axis. The number
+  of returned rects is then bounded by the pixel width of the visible key range.
+*/
+void QCPBars::getBarRects(QVector<QRectF> *rects, const QCPBarsDataContainer::const_iterator &begin, const QCPBarsDataContainer::const_iterator &end) const
+{
+  rects->resize(0);
+  if (begin == end)
+    return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  
+  updateStackedBases();
+  const QCPBarsDataContainer::const_iterator dataBegin = mDataContainer->constBegin();
+  
+  double lowerPixelWidth, upperPixelWidth;
+  getPixelWidth(begin->key, lowerPixelWidth, upperPixelWidth);
+  if (!mAdaptiveSampling || qAbs(upperPixelWidth-lowerPixelWidth) >= 1.0)
+  {
+    rects->reserve(end-begin);
+    for (QCPBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+      rects->append(getBarRect(it->key, it->value, getStackedBaseValueAt(it-dataBegin)));
+    return;
+  }
+  
+  // bars are narrower than a pixel, merge the bars of each pixel column:
+  const bool keyIsX = keyAxis->orientation() == Qt::Horizontal;
+  const double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+  rects->reserve(qMin(int(end-begin), int(keyPixelSpan)+2));
+  int currentColumn = 0;
+  for (QCPBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+  {
+    QRectF columnRect = getBarRect(it->key, it->value, getStackedBaseValueAt(it-dataBegin));
+    const int column = qFloor(keyIsX ? columnRect.center().x() : columnRect.center().y());
+    if (keyIsX)
+    {
+      columnRect.setLeft(column);
+      columnRect.setRight(column+1);
+    } else
+    {
+      columnRect.setTop(column);
+      columnRect.setBottom(column+1);
+    }
+    if (!rects->isEmpty() && column == currentColumn)
+    {
+      rects->last() = rects->last().united(columnRect);
+    } else
+    {
+      rects->append(columnRect);
+      currentColumn = column;
+    }
+  }
+}
+
 /*! \internal
   
   This function is used to determine the width of the bar at coordinate \a key, according to the
@@ -23846,6 +27036,9 @@ void QCPBars::getPixelWidth(double key, double &lower, double &upper) const
   positive and negative bars are separated per stack (positive are stacked above baseValue upwards,
   negative are stacked below baseValue downwards). This can be indicated with \a positive. So if the
   bar for which we need the base value is negative, set \a positive to false.
+  
+  This searches the bars below at every level of the stack. For the data points of this bars, use
+  the cached \ref getStackedBaseValueAt instead.
 */
 double QCPBars::getStackedBaseValue(double key, bool positive) const
 {
@@ -23856,22 +27049,137 @@ double QCPBars::getStackedBaseValue(double key, bool positive) const
     double epsilon = qAbs(key)*(sizeof(key)==4 ? 1e-6 : 1e-14); // should be safe even when changed to use float at some point
     if (key == 0)
       epsilon = (sizeof(key)==4 ? 1e-6 : 1e-14);
-    QCPBarsDataContainer::const_iterator it = mBarBelow.data()->mDataContainer->findBegin(key-epsilon);
-    QCPBarsDataContainer::const_iterator itEnd = mBarBelow.data()->mDataContainer->findEnd(key+epsilon);
-    while (it != itEnd)
-    {
-      if (it->key > key-epsilon && it->key < key+epsilon)
+    QCPBarsDataContainer::const_iterator it = mBarBelow.data()->mDataContainer->findBegin(key-epsilon);
+    QCPBarsDataContainer::const_iterator itEnd = mBarBelow.data()->mDataContainer->findEnd(key+epsilon);
+    while (it != itEnd)
+    {
+      if (it->key > key-epsilon && it->key < key+epsilon)
+      {
+        if ((positive && it->value > max) ||
+            (!positive && it->value < max))
+          max = it->value;
+      }
+      ++it;
+    }
+    // recurse down the bar-stack to find the total height:
+    return max + mBarBelow.data()->getStackedBaseValue(key, positive);
+  } else
+    return mBaseValue;
+}
+
+/*! \internal
+  
+  Returns the value at which the bar of the data point with the specified \a index starts, taking
+  into account the bar stacking. This is the same as \ref getStackedBaseValue for the key and sign
+  of the data point, but is read from the cache of stacked base values in constant time.
+  
+  \ref updateStackedBases must have been called since the data of the stack last changed.
+*/
+double QCPBars::getStackedBaseValueAt(int index) const
+{
+  return mStackedBases.isEmpty() ? mBaseValue : mStackedBases.at(index);
+}
+
+/*! \internal
+  
+  Makes sure the cached stacked base values used by \ref getStackedBaseValueAt are up to date.
+  
+  The cache is valid as long as the bars below this bars, their data containers and the revisions
+  of these containers (see \ref QCPDataContainer::revision) are unchanged, as well as the base
+  value of the bottom-most bars. Checking this only walks down the stack.
+  
+  Otherwise the base values are recomputed for all bars of the stack at once: The sorted keys of
+  all bars are swept in a single merged pass, accumulating the largest positive and the smallest
+  negative value of each bars at every key from the bottom of the stack upwards. This costs O(n*k)
+  for n distinct keys and k stacked bars, instead of O(k log n) per bar for the recursive search
+  of \ref getStackedBaseValue.
+*/
+void QCPBars::updateStackedBases() const
+{
+  if (!mBarBelow)
+  {
+    mStackedBases.clear();
+    mStackedBasesState.clear();
+    return;
+  }
+  
+  // collect the stack from the bottom-most bars up to this bars:
+  QList<const QCPBars*> stack;
+  for (const QCPBars *bars = this; bars; bars = bars->mBarBelow.data())
+    stack.prepend(bars);
+  const double baseValue = stack.first()->mBaseValue;
+  QVector<QPair<const QCPBarsDataContainer*, int> > state;
+  state.reserve(stack.size());
+  for (int i=0; i<stack.size(); ++i)
+    state.append(qMakePair<const QCPBarsDataContainer*, int>(stack.at(i)->mDataContainer.data(), stack.at(i)->mDataContainer->revision()));
+  if (state == mStackedBasesState && baseValue == mStackedBasesBaseValue)
+    return;
+  
+  // extend the stack up to the top-most bars, so the whole stack is updated in one pass:
+  for (const QCPBars *bars = mBarAbove.data(); bars; bars = bars->mBarAbove.data())
+  {
+    stack.append(bars);
+    state.append(qMakePair<const QCPBarsDataContainer*, int>(bars->mDataContainer.data(), bars->mDataContainer->revision()));
+  }
+  const int layerCount = stack.size();
+  QVector<QCPBarsDataContainer::const_iterator> itBegins(layerCount), its(layerCount), itEnds(layerCount);
+  for (int i=0; i<layerCount; ++i)
+  {
+    itBegins[i] = stack.at(i)->mDataContainer->constBegin();
+    its[i] = itBegins.at(i);
+    itEnds[i] = stack.at(i)->mDataContainer->constEnd();
+    stack.at(i)->mStackedBases.fill(baseValue, itEnds.at(i)-itBegins.at(i)); // data points with NaN keys keep the base value
+  }
+  
+  forever
+  {
+    // find the smallest key that wasn't processed yet in any of the bars:
+    bool haveKey = false;
+    double key = 0;
+    for (int i=0; i<layerCount; ++i)
+    {
+      while (its.at(i) != itEnds.at(i) && qIsNaN(its.at(i)->key))
+        ++its[i];
+      if (its.at(i) != itEnds.at(i) && (!haveKey || its.at(i)->key < key))
+      {
+        key = its.at(i)->key;
+        haveKey = true;
+      }
+    }
+    if (!haveKey)
+      break;
+    double epsilon = qAbs(key)*(sizeof(key)==4 ? 1e-6 : 1e-14); // same key tolerance as getStackedBaseValue
+    if (key == 0)
+      epsilon = (sizeof(key)==4 ? 1e-6 : 1e-14);
+    
+    // stack the bars at this key from the bottom upwards, separately for positive and negative values:
+    double positiveBase = baseValue;
+    double negativeBase = baseValue;
+    for (int i=0; i<layerCount; ++i)
+    {
+      double positiveMax = 0;
+      double negativeMax = 0;
+      QVector<double> &bases = stack.at(i)->mStackedBases;
+      QCPBarsDataContainer::const_iterator &it = its[i];
+      while (it != itEnds.at(i) && (it->key <= key || it->key < key+epsilon))
       {
-        if ((positive && it->value > max) ||
-            (!positive && it->value < max))
-          max = it->value;
+        bases[it-itBegins.at(i)] = it->value >= 0 ? positiveBase : negativeBase;
+        if (it->value > positiveMax)
+          positiveMax = it->value;
+        if (it->value < negativeMax)
+          negativeMax = it->value;
+        ++it;
       }
-      ++it;
+      positiveBase += positiveMax;
+      negativeBase += negativeMax;
     }
-    // recurse down the bar-stack to find the total height:
-    return max + mBarBelow.data()->getStackedBaseValue(key, positive);
-  } else
-    return mBaseValue;
+  }
+  
+  for (int i=0; i<layerCount; ++i)
+  {
+    stack.at(i)->mStackedBasesState = state.mid(0, i+1);
+    stack.at(i)->mStackedBasesBaseValue = baseValue;
+  }
 }
 
 /*! \internal
@@ -24038,6 +27346,65 @@ QCPStatisticalBoxData::QCPStatisticalBoxData(double key, double minimum, double
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPStatisticalBoxBuildTask
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPStatisticalBoxBuildTask
+  \brief A chunk of keys whose statistical boxes are computed from raw samples on a worker thread
+  
+  \internal
+  
+  \ref QCPStatisticalBox::samplesToBoxes splits large amounts of samples into chunks of
+  consecutive keys and hands them to the global QThreadPool as instances of this class. Each task
+  copies the valid samples of one key at a time into its own scratch buffer, which is partitioned
+  by \ref QCPStatisticalBox::samplesToBox, and only writes to the boxes of its chunk, so no further
+  synchronization is necessary. When done, the task releases the semaphore it was created with.
+*/
+class QCPStatisticalBoxBuildTask : public QRunnable
+{
+public:
+  QCPStatisticalBoxBuildTask(const double *keys, const QVector<double> *samples, int begin, int end, int firstSample, double whiskerFactor, QCPStatisticalBoxData *boxes, QSemaphore *done) :
+    mKeys(keys),
+    mSamples(samples),
+    mBegin(begin),
+    mEnd(end),
+    mFirstSample(firstSample),
+    mWhiskerFactor(whiskerFactor),
+    mBoxes(boxes),
+    mDone(done)
+  {
+  }
+  
+  virtual void run() Q_DECL_OVERRIDE
+  {
+    QVector<double> scratch;
+    for (int i=mBegin; i<mEnd; ++i)
+    {
+      const QVector<double> &row = mSamples[i];
+      scratch.resize(0);
+      for (int k=mFirstSample; k<row.size(); ++k)
+      {
+        if (!qIsNaN(row.at(k)))
+          scratch.append(row.at(k));
+      }
+      mBoxes[i] = QCPStatisticalBox::samplesToBox(mKeys[i], scratch.data(), scratch.size(), mWhiskerFactor);
+    }
+    if (mDone)
+      mDone->release();
+  }
+  
+private:
+  const double *mKeys;
+  const QVector<double> *mSamples;
+  int mBegin, mEnd;
+  int mFirstSample;
+  double mWhiskerFactor;
+  QCPStatisticalBoxData *mBoxes;
+  QSemaphore *mDone;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPStatisticalBox
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -24389,9 +27756,122 @@ QCPRange QCPStatisticalBox::getValueRange(bool &foundRange, QCP::SignDomain inSi
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
+/*!
+  A convenience function that computes statistical boxes from raw samples. For each index \a i,
+  the samples <tt>samples[i]</tt> are summarized by a box at the key <tt>keys[i]</tt>, see \ref
+  samplesToBox. The return value can then be passed on to \ref QCPStatisticalBoxDataContainer::set(const
+  QCPStatisticalBoxDataContainer&).
+  
+  The first \a firstSample entries of each sample vector are skipped. This allows passing rows
+  which start with other columns, e.g. the key itself, without copying them. NaN samples are
+  ignored, and keys without any valid samples don't produce a box. If \a keys and \a samples
+  differ in size, only the first keys which have samples are used.
+  
+  \a whiskerFactor controls the reach of the whiskers in units of the interquartile range, see \ref
+  samplesToBox.
+  
+  The boxes are computed with selection algorithms in linear time per key, so no sample vector is
+  sorted completely. If there are at least \ref minimumChunkSamples samples in total, the keys are
+  split into chunks which are processed in parallel on the global QThreadPool.
+*/
+QCPStatisticalBoxDataContainer QCPStatisticalBox::samplesToBoxes(const QVector<double> &keys, const QVector<QVector<double> > &samples, int firstSample, double whiskerFactor)
+{
+  QCPStatisticalBoxDataContainer result;
+  const int count = qMin(keys.size(), samples.size());
+  if (count == 0)
+    return result;
+  if (firstSample < 0)
+  {
+    qDebug() << Q_FUNC_INFO << "negative first sample index" << firstSample;
+    firstSample = 0;
+  }
+  
+  qint64 sampleCount = 0;
+  for (int i=0; i<count; ++i)
+    sampleCount += samples.at(i).size();
+  
+  // compute chunks of boxes in parallel, each task writes only to the boxes of its chunk:
+  QVector<QCPStatisticalBoxData> boxes(count);
+  const int chunkCount = (int)qBound(qint64(1), qMin(qint64(QThread::idealThreadCount()), sampleCount/minimumChunkSamples), qint64(count));
+  QSemaphore chunksDone;
+  for (int chunk=1; chunk<chunkCount; ++chunk)
+    QThreadPool::globalInstance()->start(new QCPStatisticalBoxBuildTask(keys.constData(), samples.constData(), chunk*count/chunkCount, (chunk+1)*count/chunkCount, firstSample, whiskerFactor, boxes.data(), &chunksDone));
+  QCPStatisticalBoxBuildTask(keys.constData(), samples.constData(), 0, count/chunkCount, firstSample, whiskerFactor, boxes.data(), 0).run(); // first chunk is processed by this thread
+  chunksDone.acquire(chunkCount-1);
+  
+  // remove boxes of keys without valid samples:
+  int validCount = 0;
+  for (int i=0; i<count; ++i)
+  {
+    if (!qIsNaN(boxes.at(i).median))
+    {
+      if (validCount != i)
+        boxes[validCount] = boxes.at(i);
+      ++validCount;
+    }
+  }
+  boxes.resize(validCount);
+  result.set(boxes);
+  return result;
+}
+
+/*!
+  Computes the statistical box of the \a count samples starting at \a samples and places it at \a
+  key.
+  
+  The quartiles and the median are interpolated linearly between the two closest ranks. The
+  whiskers reach to the smallest and largest sample within \a whiskerFactor times the interquartile
+  range below the lower and above the upper quartile. All samples beyond that are returned as
+  outliers, in no particular order. The default of 1.5 corresponds to the common Tukey box plot. If
+  \a whiskerFactor is infinite, the whiskers span all samples and there are no outliers.
+  
+  The samples are reordered in place by partial selections (std::nth_element), which takes linear
+  time instead of the time of a full sort. They must not contain NaN. If \a count is zero, all
+  values of the returned box are NaN.
+  
+  \see samplesToBoxes
+*/
+QCPStatisticalBoxData QCPStatisticalBox::samplesToBox(double key, double *samples, int count, double whiskerFactor)
+{
+  if (count <= 0)
+  {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    return QCPStatisticalBoxData(key, nan, nan, nan, nan, nan);
+  }
+  
+  // selecting the median places the two middle ranks, so the quartiles only need to select within
+  // the samples below and above them:
+  const double medianPosition = 0.5*(count-1);
+  const int medianRank = (int)medianPosition;
+  const double median = partitionedQuantile(samples, 0, count, medianPosition);
+  const double lowerQuartile = partitionedQuantile(samples, 0, medianRank, 0.25*(count-1));
+  const double upperQuartile = partitionedQuantile(samples, medianRank+1, count, 0.75*(count-1));
+  
+  double lowerFence = -std::numeric_limits<double>::infinity();
+  double upperFence = std::numeric_limits<double>::infinity();
+  if (!qIsInf(whiskerFactor))
+  {
+    lowerFence = lowerQuartile-whiskerFactor*(upperQuartile-lowerQuartile);
+    upperFence = upperQuartile+whiskerFactor*(upperQuartile-lowerQuartile);
+  }
+  QCPStatisticalBoxData result(key, lowerQuartile, lowerQuartile, median, upperQuartile, upperQuartile);
+  for (int i=0; i<count; ++i)
+  {
+    const double sample = samples[i];
+    if (sample < lowerFence || sample > upperFence)
+      result.outliers.append(sample);
+    else if (sample < result.minimum)
+      result.minimum = sample;
+    else if (sample > result.maximum)
+      result.maximum = sample;
+  }
+  return result;
+}
+
 /* inherits documentation from base class */
 void QCPStatisticalBox::draw(QCPPainter *painter)
 {
+  mDataContainer->mergePendingRuns();
   if (mDataContainer->isEmpty()) return;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
@@ -24564,6 +28044,450 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
   result[1].setPoints(coordsToPixels(it->key-mWhiskerWidth*0.5, it->maximum), coordsToPixels(it->key+mWhiskerWidth*0.5, it->maximum)); // max bar
   return result;
 }
+
+/*! \internal
+  
+  Returns the quantile at the fractional rank \a position of \a samples, interpolating linearly
+  between the two closest ranks.
+  
+  The samples with index \a begin to \a end-1 must be exactly those with the ranks \a begin to \a
+  end-1. If the rank of \a position is in this range, the range is partitioned with
+  std::nth_element, and the sample with the following rank is moved in place, too. Otherwise, the
+  samples at the rank of \a position and at the following rank must already be in place from a
+  previous call. This allows selecting further quantiles on both sides of a previous one without
+  touching the samples that were already placed.
+  
+  \see samplesToBox
+*/
+double QCPStatisticalBox::partitionedQuantile(double *samples, int begin, int end, double position)
+{
+  const int rank = (int)position;
+  if (rank >= begin && rank < end)
+  {
+    std::nth_element(samples+begin, samples+rank, samples+end);
+    if (rank+1 < end) // the following rank is the smallest sample above this rank
+      std::iter_swap(samples+rank+1, std::min_element(samples+rank+1, samples+end));
+  }
+  const double fraction = position-rank;
+  if (fraction > 0)
+    return samples[rank]+fraction*(samples[rank+1]-samples[rank]);
+  else
+    return samples[rank];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPQuantileSketch
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPQuantileSketch
+  \brief Approximates the distribution of a stream of values in bounded memory
+  
+  This class summarizes any number of values with a KLL sketch (after Karnin, Lang and Liberty).
+  It keeps a bounded number of values, so its memory doesn't grow with the number of values added.
+  From the kept values, it answers quantile (\ref quantile), rank (\ref rank) and histogram (\ref
+  histogram) queries, and it can directly provide a \ref QCPStatisticalBoxData for a \ref
+  QCPStatisticalBox (\ref box).
+  
+  The kept values are organized in levels. Values added with \ref addValue go to level zero, where
+  each value stands for itself. When a level is full, it is sorted and every other value is moved
+  to the next level, where it stands for two values. The capacity of the levels decreases
+  geometrically towards lower levels, set by \ref accuracy for the highest level. Adding a value
+  costs amortized constant time, apart from the occasional sort of a level.
+  
+  The rank error of the answers is roughly proportional to the inverse of \ref accuracy. With the
+  default accuracy of 200, it is about one percent. As long as fewer values than the accuracy were
+  added, no values are dropped and all answers are exact.
+  
+  Sketches of separate parts of the values, e.g. filled by separate threads, can be combined with
+  \ref merge, which yields a sketch of the union of the values with the same error bounds. The
+  exact minimum and maximum are always kept.
+  
+  QCPQuantileSketch is not thread-safe. Use one sketch per thread and merge them afterwards.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn int QCPQuantileSketch::accuracy() const
+  
+  Returns the accuracy parameter this sketch was created with. It is the capacity of the highest
+  level of kept values.
+*/
+
+/*! \fn qint64 QCPQuantileSketch::count() const
+  
+  Returns the number of values that were added to this sketch, including merged sketches.
+*/
+
+/*! \fn bool QCPQuantileSketch::isEmpty() const
+  
+  Returns whether no values were added to this sketch.
+*/
+
+/*! \fn double QCPQuantileSketch::minimum() const
+  
+  Returns the smallest value added to this sketch. This value is exact.
+*/
+
+/*! \fn double QCPQuantileSketch::maximum() const
+  
+  Returns the largest value added to this sketch. This value is exact.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs an empty sketch. \a accuracy sets the capacity of the highest level of kept values,
+  which determines the error of the answers (see the class description). It is limited to at least
+  8.
+  
+  \a seed initializes the random choice of the kept values when a level is compacted. If it is 0
+  (the default), every sketch gets a different seed, so the errors of sketches which are merged
+  later are independent. Pass a fixed seed for reproducible answers.
+*/
+QCPQuantileSketch::QCPQuantileSketch(int accuracy, quint32 seed) :
+  mAccuracy(qMax(8, accuracy)),
+  mCount(0),
+  mMinimum(std::numeric_limits<double>::quiet_NaN()),
+  mMaximum(std::numeric_limits<double>::quiet_NaN()),
+  mRandomState(seed)
+{
+  static QAtomicInt instanceCounter;
+  if (mRandomState == 0)
+    mRandomState = 2463534242u + quint32(instanceCounter.fetchAndAddRelaxed(1))*2654435769u; // golden ratio increments spread the seeds
+  if (mRandomState == 0) // xorshift needs a non-zero state
+    mRandomState = 2463534242u;
+}
+
+/*!
+  Returns the number of values currently kept by the sketch. This is what determines its memory
+  footprint, and it is bounded by roughly three times \ref accuracy.
+*/
+int QCPQuantileSketch::retainedCount() const
+{
+  int result = 0;
+  for (int level=0; level<mLevels.size(); ++level)
+    result += mLevels.at(level).size();
+  return result;
+}
+
+/*!
+  Adds \a value to the sketch. NaN values are ignored.
+  
+  \see addValues, merge
+*/
+void QCPQuantileSketch::addValue(double value)
+{
+  if (qIsNaN(value))
+    return;
+  if (mCount == 0)
+  {
+    mMinimum = value;
+    mMaximum = value;
+  } else if (value < mMinimum)
+    mMinimum = value;
+  else if (value > mMaximum)
+    mMaximum = value;
+  ++mCount;
+  
+  if (mLevels.isEmpty())
+    mLevels.resize(1);
+  mLevels[0].append(value);
+  if (mLevels.at(0).size() >= levelCapacity(0))
+    compress();
+}
+
+/*! \overload
+  
+  Adds all \a values to the sketch. NaN values are ignored.
+*/
+void QCPQuantileSketch::addValues(const QVector<double> &values)
+{
+  for (int i=0; i<values.size(); ++i)
+    addValue(values.at(i));
+}
+
+/*!
+  Adds the values summarized by the sketch \a other to this sketch. Afterwards, this sketch
+  approximates the distribution of the values of both sketches.
+  
+  The error bounds of the merged sketch are the same as if all values were added to a single
+  sketch, so it's possible to fill one sketch per thread or per part of the data and merge them
+  at the end. If the sketches have different accuracies, the accuracy of this sketch is used.
+*/
+void QCPQuantileSketch::merge(const QCPQuantileSketch &other)
+{
+  if (other.isEmpty())
+    return;
+  if (isEmpty())
+  {
+    mMinimum = other.mMinimum;
+    mMaximum = other.mMaximum;
+  } else
+  {
+    mMinimum = qMin(mMinimum, other.mMinimum);
+    mMaximum = qMax(mMaximum, other.mMaximum);
+  }
+  mCount += other.mCount;
+  
+  if (mLevels.size() < other.mLevels.size())
+    mLevels.resize(other.mLevels.size());
+  for (int level=0; level<other.mLevels.size(); ++level)
+    mLevels[level] << other.mLevels.at(level);
+  compress();
+}
+
+/*!
+  Removes all values from the sketch.
+*/
+void QCPQuantileSketch::clear()
+{
+  mCount = 0;
+  mMinimum = std::numeric_limits<double>::quiet_NaN();
+  mMaximum = std::numeric_limits<double>::quiet_NaN();
+  mLevels.clear();
+}
+
+/*!
+  Returns the approximate quantile at \a fraction of the added values, e.g. the median for a \a
+  fraction of 0.5. Like \ref QCPStatisticalBox::samplesToBox, the value is interpolated linearly
+  between the two closest ranks, so for sketches which didn't drop any values yet, the result is
+  the exact quantile.
+  
+  A \a fraction of 0 and 1 returns the exact \ref minimum and \ref maximum, respectively. If the
+  sketch is empty, returns NaN.
+*/
+double QCPQuantileSketch::quantile(double fraction) const
+{
+  if (isEmpty())
+    return std::numeric_limits<double>::quiet_NaN();
+  return valueAtPosition(cumulativeItems(), qBound(0.0, fraction, 1.0)*(mCount-1));
+}
+
+/*!
+  Returns the approximate fraction of the added values which are smaller than or equal to \a
+  value. If the sketch is empty, returns NaN.
+*/
+double QCPQuantileSketch::rank(double value) const
+{
+  if (isEmpty())
+    return std::numeric_limits<double>::quiet_NaN();
+  qint64 weight = 0;
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    const QVector<double> &items = mLevels.at(level);
+    for (int i=0; i<items.size(); ++i)
+    {
+      if (items.at(i) <= value)
+        weight += qint64(1) << level;
+    }
+  }
+  return weight/double(mCount);
+}
+
+/*!
+  Returns the approximate number of added values in each of \a binCount bins of equal width, which
+  divide \a range. Values at the upper bound of \a range are counted in the last bin, values outside
+  of \a range aren't counted.
+  
+  Since each kept value stands for a power of two added values, this takes time proportional to
+  \ref retainedCount, independent of the number of added values.
+*/
+QVector<double> QCPQuantileSketch::histogram(const QCPRange &range, int binCount) const
+{
+  QVector<double> result(qMax(0, binCount), 0.0);
+  if (binCount <= 0 || range.size() <= 0)
+    return result;
+  const double binsPerValue = binCount/range.size();
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    const QVector<double> &items = mLevels.at(level);
+    const double weight = double(qint64(1) << level);
+    for (int i=0; i<items.size(); ++i)
+    {
+      const double value = items.at(i);
+      if (value < range.lower || value > range.upper)
+        continue;
+      result[qMin(int((value-range.lower)*binsPerValue), binCount-1)] += weight;
+    }
+  }
+  return result;
+}
+
+/*!
+  Returns a statistical box at \a key for the added values, which can be passed to \ref
+  QCPStatisticalBox::addData or its data container.
+  
+  The quartiles and the median are those of \ref quantile. The whiskers and outliers are determined
+  like in \ref QCPStatisticalBox::samplesToBox, with \a whiskerFactor times the interquartile range
+  as reach of the whiskers. Since the sketch doesn't keep all values, the outliers are the kept
+  values beyond the whiskers plus the exact minimum and maximum, if they are beyond the whiskers.
+  So each returned outlier is an actual value, but some outliers may be missing.
+  
+  If the sketch is empty, all values of the returned box are NaN.
+*/
+QCPStatisticalBoxData QCPQuantileSketch::box(double key, double whiskerFactor) const
+{
+  if (isEmpty())
+  {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    return QCPStatisticalBoxData(key, nan, nan, nan, nan, nan);
+  }
+  
+  const QVector<QPair<double, qint64> > items = cumulativeItems();
+  const double lowerQuartile = valueAtPosition(items, 0.25*(mCount-1));
+  const double median = valueAtPosition(items, 0.5*(mCount-1));
+  const double upperQuartile = valueAtPosition(items, 0.75*(mCount-1));
+  double lowerFence = -std::numeric_limits<double>::infinity();
+  double upperFence = std::numeric_limits<double>::infinity();
+  if (!qIsInf(whiskerFactor))
+  {
+    lowerFence = lowerQuartile-whiskerFactor*(upperQuartile-lowerQuartile);
+    upperFence = upperQuartile+whiskerFactor*(upperQuartile-lowerQuartile);
+  }
+  
+  QCPStatisticalBoxData result(key, lowerQuartile, lowerQuartile, median, upperQuartile, upperQuartile);
+  if (mMinimum < lowerFence && items.first().first != mMinimum)
+    result.outliers.append(mMinimum);
+  for (int i=0; i<items.size(); ++i)
+  {
+    const double value = items.at(i).first;
+    if (value < lowerFence || value > upperFence)
+      result.outliers.append(value);
+    else if (value < result.minimum)
+      result.minimum = value;
+    else if (value > result.maximum)
+      result.maximum = value;
+  }
+  if (mMaximum > upperFence && items.last().first != mMaximum)
+    result.outliers.append(mMaximum);
+  // the exact extremes are the whisker ends if they're within reach, even if they were dropped:
+  if (mMinimum >= lowerFence)
+    result.minimum = mMinimum;
+  if (mMaximum <= upperFence)
+    result.maximum = mMaximum;
+  return result;
+}
+
+/*! \internal
+  
+  Returns the number of values the level with index \a level may hold before it is compacted. The
+  highest level may hold \ref accuracy values, each lower level two thirds of the next higher
+  one, but at least two.
+*/
+int QCPQuantileSketch::levelCapacity(int level) const
+{
+  const int depth = mLevels.size()-1-level;
+  return qMax(2, (int)qCeil(mAccuracy*qPow(2.0/3.0, depth)));
+}
+
+/*! \internal
+  
+  Compacts all levels which reached their capacity, from the lowest level upwards. Compacting a
+  level may add a new highest level, which lowers the capacities of all other levels, so they are
+  compacted on the next call if needed.
+*/
+void QCPQuantileSketch::compress()
+{
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    if (mLevels.at(level).size() >= levelCapacity(level))
+      compactLevel(level);
+  }
+}
+
+/*! \internal
+  
+  Sorts the values of the level with index \a level and moves every other value to the next higher
+  level, where it stands for twice as many added values. Whether the values at even or odd
+  positions are moved is chosen at random, which keeps the rank estimates unbiased. If the level
+  holds an odd number of values, its largest value stays, so the total weight is preserved.
+*/
+void QCPQuantileSketch::compactLevel(int level)
+{
+  if (level+1 >= mLevels.size())
+    mLevels.resize(level+2);
+  QVector<double> &items = mLevels[level];
+  std::sort(items.begin(), items.end());
+  const int pairCount = items.size()/2;
+  
+  // xorshift32, cheap and good enough to pick one of two offsets:
+  mRandomState ^= mRandomState << 13;
+  mRandomState ^= mRandomState >> 17;
+  mRandomState ^= mRandomState << 5;
+  const int offset = mRandomState & 1;
+  
+  QVector<double> &nextItems = mLevels[level+1];
+  nextItems.reserve(nextItems.size()+pairCount);
+  for (int i=0; i<pairCount; ++i)
+    nextItems.append(items.at(2*i+offset));
+  if (items.size() % 2 == 1)
+  {
+    const double remaining = items.last();
+    items.resize(1);
+    items[0] = remaining;
+  } else
+    items.resize(0);
+}
+
+/*! \internal
+  
+  Returns all kept values sorted ascending, each paired with the number of added values which are
+  represented by it and all smaller kept values. The last pair thus holds \ref count.
+*/
+QVector<QPair<double, qint64> > QCPQuantileSketch::cumulativeItems() const
+{
+  QVector<QPair<double, qint64> > result;
+  result.reserve(retainedCount());
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    const QVector<double> &items = mLevels.at(level);
+    for (int i=0; i<items.size(); ++i)
+      result.append(qMakePair(items.at(i), qint64(1) << level));
+  }
+  std::sort(result.begin(), result.end());
+  for (int i=1; i<result.size(); ++i)
+    result[i].second += result.at(i-1).second;
+  return result;
+}
+
+/*! \internal
+  
+  Returns the value at the fractional rank \a position, interpolating linearly between the values
+  at the two closest ranks. \a items must be the result of \ref cumulativeItems.
+  
+  \see valueAtRank
+*/
+double QCPQuantileSketch::valueAtPosition(const QVector<QPair<double, qint64> > &items, double position) const
+{
+  const qint64 rank = qint64(position);
+  const double fraction = position-rank;
+  const double lower = valueAtRank(items, rank);
+  if (fraction > 0)
+    return lower+fraction*(valueAtRank(items, rank+1)-lower);
+  else
+    return lower;
+}
+
+/*! \internal
+  
+  Returns the kept value which represents the added value with the integer rank \a rank. \a items
+  must be the result of \ref cumulativeItems. The rank zero and the highest rank return the exact
+  \ref minimum and \ref maximum.
+*/
+double QCPQuantileSketch::valueAtRank(const QVector<QPair<double, qint64> > &items, qint64 rank) const
+{
+  if (rank <= 0)
+    return mMinimum;
+  if (rank >= mCount-1)
+    return mMaximum;
+  for (int i=0; i<items.size(); ++i)
+  {
+    if (items.at(i).second > rank)
+      return items.at(i).first;
+  }
+  return mMaximum;
+}
 /* end of 'src/plottables/plottable-statisticalbox.cpp' */
 
 
@@ -24595,6 +28519,14 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
   fillAlpha and \ref clearAlpha. The memory for the alpha map is only allocated if needed, i.e. on
   the first call of \ref setAlpha. \ref clearAlpha restores full opacity and frees the alpha map.
   
+  The cells are stored in square tiles of 2^\ref tileShift by 2^\ref tileShift cells, which are
+  only allocated once a cell inside them is set to a value different from the last \ref fill
+  value. So large, sparsely filled maps and maps that are filled step by step only use the memory
+  they need, and no single huge allocation is required. For very large maps, the cells may be
+  stored as floats (\ref setCellType) and/or in a memory-mapped file instead of RAM (\ref
+  setBackingFile). Whole rows of cells are written and read efficiently with \ref setCells and
+  \ref readCells.
+  
   This class also buffers the minimum and maximum values that are in the data set, to provide
   QCPColorMap::rescaleDataRange with the necessary information quickly. Setting a cell to a value
   that is greater than the current maximum increases this maximum to the new value. However,
@@ -24615,6 +28547,12 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
   one of the dimensions is 0 (see \ref setSize).
 */
 
+/*! \fn bool QCPColorMapData::hasAlpha() const
+  
+  Returns whether this instance has an alpha map, i.e. whether \ref setAlpha or \ref fillAlpha was
+  called since creation or the last call to \ref clearAlpha.
+*/
+
 /* end of documentation of inline functions */
 
 /*!
@@ -24630,8 +28568,14 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
   mKeyRange(keyRange),
   mValueRange(valueRange),
   mIsEmpty(true),
-  mData(0),
-  mAlpha(0),
+  mCellType(ctDouble),
+  mTileColumns(0),
+  mTileRows(0),
+  mFillValue(0),
+  mFillAlpha(255),
+  mHasAlpha(false),
+  mFile(0),
+  mFileMap(0),
   mDataModified(true)
 {
   setSize(keySize, valueSize);
@@ -24640,47 +28584,68 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
 
 QCPColorMapData::~QCPColorMapData()
 {
-  if (mData)
-    delete[] mData;
-  if (mAlpha)
-    delete[] mAlpha;
+  freeTiles();
+  freeAlphaTiles();
+  delete mFile;
 }
 
 /*!
-  Constructs a new QCPColorMapData instance copying the data and range of \a other.
+  Constructs a new QCPColorMapData instance copying the data, cell type and range of \a other. The
+  copy keeps its cells in memory, even if \a other uses a backing file.
 */
 QCPColorMapData::QCPColorMapData(const QCPColorMapData &other) :
   mKeySize(0),
   mValueSize(0),
   mIsEmpty(true),
-  mData(0),
-  mAlpha(0),
+  mCellType(ctDouble),
+  mTileColumns(0),
+  mTileRows(0),
+  mFillValue(0),
+  mFillAlpha(255),
+  mHasAlpha(false),
+  mFile(0),
+  mFileMap(0),
   mDataModified(true)
 {
   *this = other;
 }
 
 /*!
-  Overwrites this color map data instance with the data stored in \a other. The alpha map state is
-  transferred, too.
+  Overwrites this color map data instance with the data stored in \a other. The alpha map state and
+  the cell type are transferred, too. The backing file of this instance (see \ref setBackingFile)
+  is kept, i.e. the data of \a other is written to it.
 */
 QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
 {
   if (&other != this)
   {
-    const int keySize = other.keySize();
-    const int valueSize = other.valueSize();
-    if (!other.mAlpha && mAlpha)
-      clearAlpha();
-    setSize(keySize, valueSize);
-    if (other.mAlpha && !mAlpha)
-      createAlpha(false);
+    mKeySize = other.mKeySize;
+    mValueSize = other.mValueSize;
+    mCellType = other.mCellType;
+    reallocate();
     setRange(other.keyRange(), other.valueRange());
-    if (!isEmpty())
+    mFillValue = other.mFillValue;
+    mFillAlpha = other.mFillAlpha;
+    mHasAlpha = other.mHasAlpha;
+    for (int i=0; i<mTiles.size(); ++i)
     {
-      memcpy(mData, other.mData, sizeof(mData[0])*keySize*valueSize);
-      if (mAlpha)
-        memcpy(mAlpha, other.mAlpha, sizeof(mAlpha[0])*keySize*valueSize);
+      const int tileCellCount = tileWidth(i)*tileHeight(i);
+      if (other.mTiles.at(i) || (mFileMap && mFillValue != 0))
+      {
+        if (char *tile = writableTile(i))
+        {
+          if (other.mTiles.at(i))
+            memcpy(tile, other.mTiles.at(i), tileCellCount*cellBytes());
+          else
+            for (int k=0; k<tileCellCount; ++k)
+              setTileCell(tile, k, mFillValue);
+        }
+      }
+      if (other.mAlphaTiles.at(i))
+      {
+        if (unsigned char *tile = writableAlphaTile(i))
+          memcpy(tile, other.mAlphaTiles.at(i), tileCellCount);
+      }
     }
     mDataBounds = other.mDataBounds;
     mDataModified = true;
@@ -24694,7 +28659,7 @@ double QCPColorMapData::data(double key, double value)
   int keyCell = (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5;
   int valueCell = (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5;
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
-    return mData[valueCell*mKeySize + keyCell];
+    return cell(keyCell, valueCell);
   else
     return 0;
 }
@@ -24703,8 +28668,10 @@ double QCPColorMapData::data(double key, double value)
 double QCPColorMapData::cell(int keyIndex, int valueIndex)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mData[valueIndex*mKeySize + keyIndex];
-  else
+  {
+    const char *tile = mTiles.at(tileIndex(keyIndex, valueIndex));
+    return tile ? tileCell(tile, cellOffset(keyIndex, valueIndex)) : mFillValue;
+  } else
     return 0;
 }
 
@@ -24718,9 +28685,11 @@ double QCPColorMapData::cell(int keyIndex, int valueIndex)
 */
 unsigned char QCPColorMapData::alpha(int keyIndex, int valueIndex)
 {
-  if (mAlpha && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mAlpha[valueIndex*mKeySize + keyIndex];
-  else
+  if (mHasAlpha && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
+  {
+    const unsigned char *tile = mAlphaTiles.at(tileIndex(keyIndex, valueIndex));
+    return tile ? tile[cellOffset(keyIndex, valueIndex)] : mFillAlpha;
+  } else
     return 255;
 }
 
@@ -24742,29 +28711,7 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
   {
     mKeySize = keySize;
     mValueSize = valueSize;
-    if (mData)
-      delete[] mData;
-    mIsEmpty = mKeySize == 0 || mValueSize == 0;
-    if (!mIsEmpty)
-    {
-#ifdef __EXCEPTIONS
-      try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
-#endif
-      mData = new double[mKeySize*mValueSize];
-#ifdef __EXCEPTIONS
-      } catch (...) { mData = 0; }
-#endif
-      if (mData)
-        fill(0);
-      else
-        qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
-    } else
-      mData = 0;
-    
-    if (mAlpha) // if we had an alpha map, recreate it with new size
-      createAlpha();
-    
-    mDataModified = true;
+    reallocate();
   }
 }
 
@@ -24844,6 +28791,57 @@ void QCPColorMapData::setValueRange(const QCPRange &valueRange)
   mValueRange = valueRange;
 }
 
+/*!
+  Sets the precision in which the cells are stored. \ref ctFloat halves the memory (or file)
+  footprint of the map, at the cost of a reduced precision of about seven significant digits, which
+  is usually sufficient for display purposes.
+  
+  Changing the cell type discards the current data and sets the map cells to 0.
+*/
+void QCPColorMapData::setCellType(CellType type)
+{
+  if (mCellType != type)
+  {
+    mCellType = type;
+    reallocate();
+  }
+}
+
+/*!
+  Makes this instance store its cells in the file \a fileName instead of memory. The file is
+  memory-mapped, so the operating system pages the cells in and out as needed, and maps that are
+  much larger than the available RAM can be filled and displayed. Passing an empty string returns
+  to storing the cells in memory.
+  
+  If the file already has exactly the size required by the current key/value size and cell type
+  (see \ref setCellType), its content is kept and the data bounds are recalculated (see \ref
+  recalculateDataBounds). This allows displaying a map that was written to the file before.
+  Otherwise the current data is discarded and the map cells are set to 0. The file holds the raw
+  cells in tiles of 2^\ref tileShift by 2^\ref tileShift cells, and is not deleted when this
+  instance is destroyed. The alpha map (if any) is always held in memory.
+  
+  Returns false if the file couldn't be opened or mapped. In that case the cells are stored in
+  memory.
+*/
+bool QCPColorMapData::setBackingFile(const QString &fileName)
+{
+  freeTiles();
+  delete mFile;
+  mFile = 0;
+  if (!fileName.isEmpty())
+  {
+    mFile = new QFile(fileName);
+    if (!mFile->open(QIODevice::ReadWrite))
+    {
+      qDebug() << Q_FUNC_INFO << "can't open backing file" << fileName << mFile->errorString();
+      delete mFile;
+      mFile = 0;
+    }
+  }
+  reallocate(true);
+  return fileName.isEmpty() || mFileMap || (mFile && mIsEmpty);
+}
+
 /*!
   Sets the data of the cell, which lies at the plot coordinates given by \a key and \a value, to \a
   z.
@@ -24861,14 +28859,67 @@ void QCPColorMapData::setData(double key, double value, double z)
   int keyCell = (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5;
   int valueCell = (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5;
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
+    setCell(keyCell, valueCell, z);
+}
+
+/*! \internal
+  
+  Implements \ref setCells for both double and float input arrays. The cells are written tile
+  segment by tile segment, and the data bounds are updated on the way.
+*/
+template <typename T>
+void QCPColorMapData::writeCells(int keyIndex, int valueIndex, const T *z, int count)
+{
+  if (keyIndex < 0 || count < 0 || keyIndex+count > mKeySize || valueIndex < 0 || valueIndex >= mValueSize)
+  {
+    qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex << count;
+    return;
+  }
+  const int mask = (1<<tileShift)-1;
+  double lower = mDataBounds.lower;
+  double upper = mDataBounds.upper;
+  int i = 0;
+  while (i < count)
   {
-    mData[valueCell*mKeySize + keyCell] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
-     mDataModified = true;
+    const int segment = qMin(count-i, (1<<tileShift)-((keyIndex+i) & mask)); // cells up to the end of the current tile
+    const int index = tileIndex(keyIndex+i, valueIndex);
+    if (!mTiles.at(index)) // cells of unallocated tiles have the fill value, only allocate if it changes
+    {
+      int k = 0;
+      while (k < segment && z[i+k] == mFillValue)
+        ++k;
+      if (k == segment)
+      {
+        i += segment;
+        continue;
+      }
+    }
+    char *tile = writableTile(index);
+    if (!tile)
+      break;
+    const int offset = cellOffset(keyIndex+i, valueIndex);
+    if (mCellType == ctFloat)
+    {
+      float *cells = reinterpret_cast<float*>(tile)+offset;
+      for (int k=0; k<segment; ++k)
+        cells[k] = z[i+k];
+    } else
+    {
+      double *cells = reinterpret_cast<double*>(tile)+offset;
+      for (int k=0; k<segment; ++k)
+        cells[k] = z[i+k];
+    }
+    for (int k=0; k<segment; ++k)
+    {
+      if (z[i+k] < lower)
+        lower = z[i+k];
+      if (z[i+k] > upper)
+        upper = z[i+k];
+    }
+    i += segment;
   }
+  mDataBounds = QCPRange(lower, upper);
+  mDataModified = true;
 }
 
 /*!
@@ -24880,22 +28931,54 @@ void QCPColorMapData::setData(double key, double value, double z)
   range-reversed), the cell with indices (0, 0) is in the bottom left corner and the cell with
   indices (keySize-1, valueSize-1) is in the top right corner of the color map.
   
+  To fill many cells, \ref setCells is considerably faster.
+  
   \see setData, setSize
 */
 void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
   {
-    mData[valueIndex*mKeySize + keyIndex] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
-     mDataModified = true;
+    const int index = tileIndex(keyIndex, valueIndex);
+    if (!mTiles.at(index) && z == mFillValue) // cells of unallocated tiles already have the fill value
+      return;
+    if (char *tile = writableTile(index))
+    {
+      setTileCell(tile, cellOffset(keyIndex, valueIndex), z);
+      if (z < mDataBounds.lower)
+        mDataBounds.lower = z;
+      if (z > mDataBounds.upper)
+        mDataBounds.upper = z;
+      mDataModified = true;
+    }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
+/*!
+  Sets the \a count cells starting at \a keyIndex in the row with \a valueIndex to the values in
+  the array \a z, i.e. the cell with key index <tt>keyIndex+i</tt> is set to <tt>z[i]</tt>.
+  
+  This is the fast way of filling a map, e.g. by streaming it row by row from a file or an
+  acquisition device.
+  
+  \see setCell
+*/
+void QCPColorMapData::setCells(int keyIndex, int valueIndex, const double *z, int count)
+{
+  writeCells(keyIndex, valueIndex, z, count);
+}
+
+/*! \overload
+  
+  Sets the \a count cells starting at \a keyIndex in the row with \a valueIndex to the float values
+  in the array \a z.
+*/
+void QCPColorMapData::setCells(int keyIndex, int valueIndex, const float *z, int count)
+{
+  writeCells(keyIndex, valueIndex, z, count);
+}
+
 /*!
   Sets the alpha of the color map cell given by \a keyIndex and \a valueIndex to \a alpha. A value
   of 0 for \a alpha results in a fully transparent cell, and a value of 255 results in a fully
@@ -24915,15 +28998,47 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
   {
-    if (mAlpha || createAlpha())
+    if (mHasAlpha || createAlpha())
     {
-      mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
-      mDataModified = true;
+      if (unsigned char *tile = writableAlphaTile(tileIndex(keyIndex, valueIndex)))
+      {
+        tile[cellOffset(keyIndex, valueIndex)] = alpha;
+        mDataModified = true;
+      }
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
+/*!
+  Sets the alpha of the \a count cells starting at \a keyIndex in the row with \a valueIndex to the
+  values in the array \a alpha. This is the alpha counterpart of \ref setCells.
+  
+  \see setAlpha
+*/
+void QCPColorMapData::setAlphas(int keyIndex, int valueIndex, const unsigned char *alpha, int count)
+{
+  if (keyIndex < 0 || count < 0 || keyIndex+count > mKeySize || valueIndex < 0 || valueIndex >= mValueSize)
+  {
+    qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex << count;
+    return;
+  }
+  if (!mHasAlpha && !createAlpha())
+    return;
+  const int mask = (1<<tileShift)-1;
+  int i = 0;
+  while (i < count)
+  {
+    const int segment = qMin(count-i, (1<<tileShift)-((keyIndex+i) & mask)); // cells up to the end of the current tile
+    unsigned char *tile = writableAlphaTile(tileIndex(keyIndex+i, valueIndex));
+    if (!tile)
+      return;
+    memcpy(tile+cellOffset(keyIndex+i, valueIndex), alpha+i, segment);
+    i += segment;
+  }
+  mDataModified = true;
+}
+
 /*!
   Goes through the data and updates the buffered minimum and maximum data values.
   
@@ -24941,15 +29056,39 @@ void QCPColorMapData::recalculateDataBounds()
 {
   if (mKeySize > 0 && mValueSize > 0)
   {
-    double minHeight = mData[0];
-    double maxHeight = mData[0];
-    const int dataCount = mValueSize*mKeySize;
-    for (int i=0; i<dataCount; ++i)
+    double minHeight = mTiles.at(0) ? tileCell(mTiles.at(0), 0) : mFillValue;
+    double maxHeight = minHeight;
+    for (int i=0; i<mTiles.size(); ++i)
     {
-      if (mData[i] > maxHeight)
-        maxHeight = mData[i];
-      if (mData[i] < minHeight)
-        minHeight = mData[i];
+      const char *tile = mTiles.at(i);
+      if (!tile) // cells of unallocated tiles have the fill value
+      {
+        minHeight = qMin(minHeight, mFillValue);
+        maxHeight = qMax(maxHeight, mFillValue);
+        continue;
+      }
+      const int tileCellCount = tileWidth(i)*tileHeight(i);
+      if (mCellType == ctFloat)
+      {
+        const float *cells = reinterpret_cast<const float*>(tile);
+        for (int k=0; k<tileCellCount; ++k)
+        {
+          if (cells[k] > maxHeight)
+            maxHeight = cells[k];
+          if (cells[k] < minHeight)
+            minHeight = cells[k];
+        }
+      } else
+      {
+        const double *cells = reinterpret_cast<const double*>(tile);
+        for (int k=0; k<tileCellCount; ++k)
+        {
+          if (cells[k] > maxHeight)
+            maxHeight = cells[k];
+          if (cells[k] < minHeight)
+            minHeight = cells[k];
+        }
+      }
     }
     mDataBounds.lower = minHeight;
     mDataBounds.upper = maxHeight;
@@ -24971,22 +29110,34 @@ void QCPColorMapData::clear()
 */
 void QCPColorMapData::clearAlpha()
 {
-  if (mAlpha)
+  if (mHasAlpha)
   {
-    delete[] mAlpha;
-    mAlpha = 0;
+    freeAlphaTiles();
+    mFillAlpha = 255;
+    mHasAlpha = false;
     mDataModified = true;
   }
 }
 
 /*!
   Sets all cells to the value \a z.
+  
+  Unless a backing file is used (see \ref setBackingFile), this frees the memory of all cells,
+  which is allocated again tile by tile as cells are set to different values.
 */
 void QCPColorMapData::fill(double z)
 {
-  const int dataCount = mValueSize*mKeySize;
-  for (int i=0; i<dataCount; ++i)
-    mData[i] = z;
+  mFillValue = z;
+  if (mFileMap)
+  {
+    for (int i=0; i<mTiles.size(); ++i)
+    {
+      const int tileCellCount = tileWidth(i)*tileHeight(i);
+      for (int k=0; k<tileCellCount; ++k)
+        setTileCell(mTiles.at(i), k, z);
+    }
+  } else
+    freeTiles();
   mDataBounds = QCPRange(z, z);
   mDataModified = true;
 }
@@ -25002,11 +29153,10 @@ void QCPColorMapData::fill(double z)
 */
 void QCPColorMapData::fillAlpha(unsigned char alpha)
 {
-  if (mAlpha || createAlpha(false))
+  if (mHasAlpha || createAlpha(false))
   {
-    const int dataCount = mValueSize*mKeySize;
-    for (int i=0; i<dataCount; ++i)
-      mAlpha[i] = alpha;
+    freeAlphaTiles();
+    mFillAlpha = alpha;
     mDataModified = true;
   }
 }
@@ -25059,44 +29209,385 @@ void QCPColorMapData::cellToCoord(int keyIndex, int valueIndex, double *key, dou
     *value = valueIndex/(double)(mValueSize-1)*(mValueRange.upper-mValueRange.lower)+mValueRange.lower;
 }
 
+/*!
+  Reads the \a count cells starting at \a keyIndex in the row with \a valueIndex into \a z. If \a
+  alphas is not zero, the alpha map values of the cells are written to it (255 if this instance has
+  no alpha map, see \ref hasAlpha).
+  
+  This is the counterpart of \ref setCells. The indices are not checked, so they must be valid.
+  
+  \see cellsAlongKey, cell
+*/
+void QCPColorMapData::readCells(int keyIndex, int valueIndex, int count, double *z, unsigned char *alphas) const
+{
+  const int mask = (1<<tileShift)-1;
+  int i = 0;
+  while (i < count)
+  {
+    const int segment = qMin(count-i, (1<<tileShift)-((keyIndex+i) & mask)); // cells up to the end of the current tile
+    const int index = tileIndex(keyIndex+i, valueIndex);
+    const int offset = cellOffset(keyIndex+i, valueIndex);
+    if (const char *tile = mTiles.at(index))
+    {
+      if (mCellType == ctFloat)
+      {
+        const float *cells = reinterpret_cast<const float*>(tile)+offset;
+        for (int k=0; k<segment; ++k)
+          z[i+k] = cells[k];
+      } else
+        memcpy(z+i, reinterpret_cast<const double*>(tile)+offset, segment*sizeof(double));
+    } else
+    {
+      for (int k=0; k<segment; ++k)
+        z[i+k] = mFillValue;
+    }
+    if (alphas)
+    {
+      const unsigned char *alphaTile = mHasAlpha ? mAlphaTiles.at(index) : 0;
+      if (alphaTile)
+        memcpy(alphas+i, alphaTile+offset, segment);
+      else
+        memset(alphas+i, mHasAlpha ? mFillAlpha : 255, segment);
+    }
+    i += segment;
+  }
+}
+
+/*!
+  Reads the cells with the value index \a valueIndex and the key indices given in the array \a
+  keyIndices of length \a count into \a values. If \a alphas is not zero, the alpha map values of
+  the cells are written to it (255 if this instance has no alpha map, see \ref hasAlpha).
+
+  This is the fast way of reading many cells, e.g. when rendering one line of an image. The indices
+  are not checked, so they must be valid.
+
+  \see cellsAlongValue, readCells, cell
+*/
+void QCPColorMapData::cellsAlongKey(int valueIndex, const int *keyIndices, int count, double *values, unsigned char *alphas) const
+{
+  const int mask = (1<<tileShift)-1;
+  const int rowTileBase = (valueIndex>>tileShift)*mTileColumns;
+  const int rowInTile = valueIndex & mask;
+  const int lastColumn = mTileColumns-1;
+  const int lastColumnWidth = tileWidth(lastColumn);
+  const char * const *tiles = mTiles.constData()+rowTileBase;
+  for (int i=0; i<count; ++i)
+  {
+    const int column = keyIndices[i]>>tileShift;
+    const char *tile = tiles[column];
+    values[i] = tile ? tileCell(tile, rowInTile*(column == lastColumn ? lastColumnWidth : 1<<tileShift) + (keyIndices[i] & mask)) : mFillValue;
+  }
+  if (alphas)
+  {
+    if (mHasAlpha)
+    {
+      const unsigned char * const *alphaTiles = mAlphaTiles.constData()+rowTileBase;
+      for (int i=0; i<count; ++i)
+      {
+        const int column = keyIndices[i]>>tileShift;
+        const unsigned char *tile = alphaTiles[column];
+        alphas[i] = tile ? tile[rowInTile*(column == lastColumn ? lastColumnWidth : 1<<tileShift) + (keyIndices[i] & mask)] : mFillAlpha;
+      }
+    } else
+      memset(alphas, 255, count);
+  }
+}
+
+/*!
+  Reads the cells with the key index \a keyIndex and the value indices given in the array \a
+  valueIndices of length \a count into \a values. If \a alphas is not zero, the alpha map values of
+  the cells are written to it (255 if this instance has no alpha map, see \ref hasAlpha).
+
+  The indices are not checked, so they must be valid.
+
+  \see cellsAlongKey, cell
+*/
+void QCPColorMapData::cellsAlongValue(int keyIndex, const int *valueIndices, int count, double *values, unsigned char *alphas) const
+{
+  const int mask = (1<<tileShift)-1;
+  const int column = keyIndex>>tileShift;
+  const int columnInTile = keyIndex & mask;
+  const int width = tileWidth(column);
+  for (int i=0; i<count; ++i)
+  {
+    const char *tile = mTiles.at((valueIndices[i]>>tileShift)*mTileColumns + column);
+    values[i] = tile ? tileCell(tile, (valueIndices[i] & mask)*width + columnInTile) : mFillValue;
+  }
+  if (alphas)
+  {
+    if (mHasAlpha)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        const unsigned char *tile = mAlphaTiles.at((valueIndices[i]>>tileShift)*mTileColumns + column);
+        alphas[i] = tile ? tile[(valueIndices[i] & mask)*width + columnInTile] : mFillAlpha;
+      }
+    } else
+      memset(alphas, 255, count);
+  }
+}
+
 /*! \internal
 
-  Allocates the internal alpha map with the current data map key/value size and, if \a
-  initializeOpaque is true, initializes all values to 255. If \a initializeOpaque is false, the
-  values are not initialized at all. In this case, the alpha map should be initialized manually,
-  e.g. with \ref fillAlpha.
+  Enables the internal alpha map with all values set to 255. The memory of the alpha map is
+  allocated tile by tile, when cells are set to a different alpha, so \a initializeOpaque has no
+  effect anymore and is kept for compatibility.
 
-  If an alpha map exists already, it is deleted first. If this color map is empty (has either key
-  or value size zero, see \ref isEmpty), the alpha map is cleared.
+  If this color map is empty (has either key or value size zero, see \ref isEmpty), the alpha map
+  is cleared.
 
   The return value indicates the existence of the alpha map after the call. So this method returns
-  true if the data map isn't empty and an alpha map was successfully allocated.
+  true if the data map isn't empty.
+*/
+bool QCPColorMapData::createAlpha(bool initializeOpaque)
+{
+  Q_UNUSED(initializeOpaque)
+  clearAlpha();
+  if (isEmpty())
+    return false;
+  mHasAlpha = true;
+  mDataModified = true;
+  return true;
+}
+
+/*! \internal
+  
+  Sets up the tile grid for the current key/value size and cell type. All cells are set to 0 and
+  all alpha values to 255, and the memory of previously allocated tiles is freed.
+  
+  If a backing file is set, it is resized and mapped (see \ref mapFile). If \a keepFileContent is
+  true and the file already has the required size, its content is kept instead, and the data bounds
+  are recalculated.
+*/
+void QCPColorMapData::reallocate(bool keepFileContent)
+{
+  freeTiles();
+  freeAlphaTiles();
+  mIsEmpty = mKeySize <= 0 || mValueSize <= 0;
+  mTileColumns = mIsEmpty ? 0 : ((mKeySize-1)>>tileShift)+1;
+  mTileRows = mIsEmpty ? 0 : ((mValueSize-1)>>tileShift)+1;
+  mTiles = QVector<char*>(mTileColumns*mTileRows, 0);
+  mAlphaTiles = QVector<unsigned char*>(mTileColumns*mTileRows, 0);
+  mFillValue = 0;
+  mFillAlpha = 255;
+  mHasAlpha = mHasAlpha && !mIsEmpty;
+  mDataBounds = QCPRange(0, 0);
+  mDataModified = true;
+  
+  if (mFile && !mIsEmpty)
+  {
+    const bool keepContent = keepFileContent && mFile->size() == qint64(mKeySize)*qint64(mValueSize)*cellBytes();
+    if (!mapFile(keepContent))
+    {
+      delete mFile; // continue with cells in memory
+      mFile = 0;
+    } else if (keepContent)
+      recalculateDataBounds();
+  }
+}
+
+/*! \internal
+  
+  Frees the memory of all data tiles, or unmaps the backing file. Afterwards, all cells have the
+  fill value.
+*/
+void QCPColorMapData::freeTiles()
+{
+  if (mFileMap)
+  {
+    mFile->unmap(mFileMap);
+    mFileMap = 0;
+  } else
+  {
+    for (int i=0; i<mTiles.size(); ++i)
+      delete[] mTiles.at(i);
+  }
+  mTiles.fill(0);
+}
+
+/*! \internal
+  
+  Frees the memory of all alpha tiles. Afterwards, all cells have the fill alpha.
+*/
+void QCPColorMapData::freeAlphaTiles()
+{
+  for (int i=0; i<mAlphaTiles.size(); ++i)
+    delete[] mAlphaTiles.at(i);
+  mAlphaTiles.fill(0);
+}
+
+/*! \internal
+  
+  Maps the backing file into memory and points all data tiles into it. The tiles are stored
+  consecutively in row-major tile order, each tile holding its cells in row-major order. Unless \a
+  keepContent is true, the file is truncated first, so all cells are 0.
+  
+  Returns whether the file could be mapped.
+*/
+bool QCPColorMapData::mapFile(bool keepContent)
+{
+  const qint64 fileSize = qint64(mKeySize)*qint64(mValueSize)*cellBytes();
+  if (!keepContent && (!mFile->resize(0) || !mFile->resize(fileSize)))
+  {
+    qDebug() << Q_FUNC_INFO << "can't resize backing file" << mFile->fileName() << mFile->errorString();
+    return false;
+  }
+  mFileMap = mFile->map(0, fileSize);
+  if (!mFileMap)
+  {
+    qDebug() << Q_FUNC_INFO << "can't map backing file" << mFile->fileName() << mFile->errorString();
+    return false;
+  }
+  for (int i=0; i<mTiles.size(); ++i)
+  {
+    const qint64 tileRowStart = qint64(i/mTileColumns << tileShift)*mKeySize; // cells in the full tile rows above
+    const qint64 tileStart = tileRowStart + qint64(tileHeight(i))*(i%mTileColumns << tileShift);
+    mTiles[i] = reinterpret_cast<char*>(mFileMap+tileStart*cellBytes());
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns the data tile with index \a tileIndex for writing. If the tile isn't allocated yet, it is
+  allocated and initialized with the fill value. Returns zero if the allocation fails.
+*/
+char *QCPColorMapData::writableTile(int tileIndex)
+{
+  char *tile = mTiles.at(tileIndex);
+  if (!tile)
+  {
+    const int tileCellCount = tileWidth(tileIndex)*tileHeight(tileIndex);
+#ifdef __EXCEPTIONS
+    try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
+#endif
+      tile = new char[tileCellCount*cellBytes()];
+#ifdef __EXCEPTIONS
+    } catch (...) { tile = 0; }
+#endif
+    if (!tile)
+    {
+      qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
+      return 0;
+    }
+    if (mFillValue == 0)
+      memset(tile, 0, tileCellCount*cellBytes());
+    else
+      for (int k=0; k<tileCellCount; ++k)
+        setTileCell(tile, k, mFillValue);
+    mTiles[tileIndex] = tile;
+  }
+  return tile;
+}
+
+/*! \internal
+  
+  Returns the alpha tile with index \a tileIndex for writing. If the tile isn't allocated yet, it is
+  allocated and initialized with the fill alpha. Returns zero if the allocation fails.
+*/
+unsigned char *QCPColorMapData::writableAlphaTile(int tileIndex)
+{
+  unsigned char *tile = mAlphaTiles.at(tileIndex);
+  if (!tile)
+  {
+    const int tileCellCount = tileWidth(tileIndex)*tileHeight(tileIndex);
+#ifdef __EXCEPTIONS
+    try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
+#endif
+      tile = new unsigned char[tileCellCount];
+#ifdef __EXCEPTIONS
+    } catch (...) { tile = 0; }
+#endif
+    if (!tile)
+    {
+      qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
+      return 0;
+    }
+    memset(tile, mFillAlpha, tileCellCount);
+    mAlphaTiles[tileIndex] = tile;
+  }
+  return tile;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMapColorizeTask
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMapColorizeTask
+  \brief A band of map image scanlines which is colorized on a worker thread
+  
+  \internal
+  
+  \ref QCPColorMap::renderMapImage splits large images into bands of consecutive scanlines and
+  hands them to the global QThreadPool as instances of this class. Each task works on its own copy
+  of the color gradient (which is implicitly shared, so only its color buffer may be regenerated per
+  copy), and only writes to the scanlines of its band, so no further synchronization is necessary.
+  When done, the task releases the semaphore it was created with.
 */
-bool QCPColorMapData::createAlpha(bool initializeOpaque)
+class QCPColorMapColorizeTask : public QRunnable
 {
-  clearAlpha();
-  if (isEmpty())
-    return false;
+public:
+  /*!
+    The data and image layout shared by all bands of one colorization. Scanline \a y of the image
+    shows the cells with index <tt>rowCells[y]</tt> in one dimension and the indices
+    <tt>columnCells</tt> in the other dimension. If \a rowsAlongKey is true, the row index is a
+    value index and the column indices are key indices, otherwise it's the other way around.
+  */
+  struct Job
+  {
+    const QCPColorMapData *data;
+    bool rowsAlongKey;
+    const int *rowCells;
+    const int *columnCells;
+    int width;
+    QCPRange range;
+    bool logarithmic;
+    uchar *bits;
+    int bytesPerLine;
+  };
+  
+  /*!
+    Images with fewer pixels than this per band aren't worth the threading overhead.
+  */
+  static const int minimumBandPixels = 65536;
   
-#ifdef __EXCEPTIONS
-  try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
-#endif
-    mAlpha = new unsigned char[mKeySize*mValueSize];
-#ifdef __EXCEPTIONS
-  } catch (...) { mAlpha = 0; }
-#endif
-  if (mAlpha)
+  QCPColorMapColorizeTask(const QCPColorGradient &gradient, const Job &job, int beginLine, int endLine, QSemaphore *done) :
+    mGradient(gradient),
+    mJob(job),
+    mBeginLine(beginLine),
+    mEndLine(endLine),
+    mDone(done)
   {
-    if (initializeOpaque)
-      fillAlpha(255);
-    return true;
-  } else
+  }
+  
+  virtual void run() Q_DECL_OVERRIDE
   {
-    qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
-    return false;
+    QVector<double> values(mJob.width);
+    QVector<unsigned char> alphas(mJob.data->hasAlpha() ? mJob.width : 0);
+    unsigned char *alphaLine = alphas.isEmpty() ? 0 : alphas.data();
+    for (int line=mBeginLine; line<mEndLine; ++line)
+    {
+      if (mJob.rowsAlongKey)
+        mJob.data->cellsAlongKey(mJob.rowCells[line], mJob.columnCells, mJob.width, values.data(), alphaLine);
+      else
+        mJob.data->cellsAlongValue(mJob.rowCells[line], mJob.columnCells, mJob.width, values.data(), alphaLine);
+      QRgb* pixels = reinterpret_cast<QRgb*>(mJob.bits+line*mJob.bytesPerLine);
+      if (alphaLine)
+        mGradient.colorize(values.constData(), alphaLine, mJob.range, pixels, mJob.width, 1, mJob.logarithmic);
+      else
+        mGradient.colorize(values.constData(), mJob.range, pixels, mJob.width, 1, mJob.logarithmic);
+    }
+    if (mDone)
+      mDone->release();
   }
-}
-
+  
+private:
+  QCPColorGradient mGradient;
+  Job mJob;
+  int mBeginLine, mEndLine;
+  QSemaphore *mDone;
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMap
@@ -25157,6 +29648,15 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   other. They are mixed in a multiplicative matter, so an alpha of e.g. 50% (128/255) in both modes
   simultaneously, will result in a total transparency of 25% (64/255).
   
+  \section qcpcolormap-rendering Rendering of large maps
+  
+  Only the part of the map that is visible inside the axis rect is rendered, at the resolution of
+  the screen. So the rendering cost depends on the size of the plot, not on the number of cells.
+  When the map is zoomed out so far that multiple cells fall onto one pixel, the color map uses a
+  pyramid of reduced copies of the data (mip levels), which are created lazily and kept until the
+  data changes. How cells are combined in the reduced levels is controlled with \ref
+  setMipReduction.
+  
   \section qcpcolormap-usage Usage
   
   Like all data representing objects in QCustomPlot, the QCPColorMap is a plottable
@@ -25227,12 +29727,15 @@ QCPColorMap::QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mMapData(new QCPColorMapData(10, 10, QCPRange(0, 5), QCPRange(0, 5))),
   mInterpolate(true),
   mTightBoundary(false),
+  mMipReduction(mrMean),
+  mMapImageResolution(1.0),
   mMapImageInvalidated(true)
 {
 }
 
 QCPColorMap::~QCPColorMap()
 {
+  clearMipLevels();
   delete mMapData;
 }
 
@@ -25258,6 +29761,7 @@ void QCPColorMap::setData(QCPColorMapData *data, bool copy)
     delete mMapData;
     mMapData = data;
   }
+  clearMipLevels();
   mMapImageInvalidated = true;
 }
 
@@ -25330,7 +29834,7 @@ void QCPColorMap::setGradient(const QCPColorGradient &gradient)
 void QCPColorMap::setInterpolate(bool enabled)
 {
   mInterpolate = enabled;
-  mMapImageInvalidated = true; // because oversampling factors might need to change
+  mMapImageInvalidated = true; // because the image is rendered at cell instead of pixel resolution
 }
 
 /*!
@@ -25349,6 +29853,23 @@ void QCPColorMap::setTightBoundary(bool enabled)
   mTightBoundary = enabled;
 }
 
+/*!
+  Sets how multiple cells are combined into one pixel, when the color map is zoomed out so far that
+  cells become smaller than a pixel.
+  
+  \ref mrMean shows the average of the combined cells, while \ref mrMaximum keeps narrow peaks
+  visible at any zoom level.
+*/
+void QCPColorMap::setMipReduction(MipReduction reduction)
+{
+  if (mMipReduction != reduction)
+  {
+    mMipReduction = reduction;
+    clearMipLevels();
+    mMapImageInvalidated = true;
+  }
+}
+
 /*!
   Associates the color scale \a colorScale with this color map.
   
@@ -25432,15 +29953,23 @@ void QCPColorMap::rescaleDataRange(bool recalculateDataBounds)
 */
 void QCPColorMap::updateLegendIcon(Qt::TransformationMode transformMode, const QSize &thumbSize)
 {
-  if (mMapImage.isNull() && !data()->isEmpty())
-    updateMapImage(); // try to update map image if it's null (happens if no draw has happened yet)
-  
-  if (!mMapImage.isNull()) // might still be null, e.g. if data is empty, so check here again
+  if (mMapData->isEmpty() || !mKeyAxis || !mValueAxis || thumbSize.isEmpty())
+    return;
+  if (mMapData->mDataModified)
   {
-    bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
-    bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
-    mLegendIcon = QPixmap::fromImage(mMapImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    clearMipLevels();
+    mMapData->mDataModified = false;
+    mMapImageInvalidated = true;
   }
+  
+  // render the whole map directly at (twice, if smoothing is requested) the thumb resolution:
+  const QSize renderSize = transformMode == Qt::SmoothTransformation ? thumbSize*2 : thumbSize;
+  const QRectF bounds(QPointF(0, 0), QSizeF(renderSize));
+  QImage icon;
+  renderMapImage(&icon, bounds, bounds, renderSize);
+  if (renderSize != thumbSize)
+    icon = icon.scaled(thumbSize, Qt::IgnoreAspectRatio, transformMode);
+  mLegendIcon = QPixmap::fromImage(icon);
 }
 
 /* inherits documentation from base class */
@@ -25524,82 +30053,61 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
   Updates the internal map image buffer by going through the internal \ref QCPColorMapData and
   turning the data values into color pixels with \ref QCPColorGradient::colorize.
   
-  This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
-  has been invalidated for a different reason (e.g. a change of the data range with \ref
-  setDataRange).
+  This method is called by \ref QCPColorMap::draw if the data has been modified, the map image has
+  been invalidated for a different reason (e.g. a change of the data range with \ref setDataRange),
+  or the visible portion of the map has changed due to axis range or axis rect changes.
   
-  If the map cell count is low, the image created will be oversampled in order to avoid a
-  QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
-  without smooth transform enabled. Accordingly, oversampling isn't performed if \ref
-  setInterpolate is true.
+  Only the part of the map inside the clip rect is rendered. Without \ref setInterpolate, the image
+  has one pixel per device pixel and is drawn without scaling. With interpolation, the image has one
+  pixel per cell (or per cell of the used mip level), so the smooth pixmap transform interpolates
+  between cell centers, as before. If cells are smaller than device pixels, the cells are taken from
+  the appropriate mip level (see \ref mipLevel), so the image size never exceeds the visible pixel
+  count.
 */
 void QCPColorMap::updateMapImage()
 {
   QCPAxis *keyAxis = mKeyAxis.data();
-  if (!keyAxis) return;
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) return;
   if (mMapData->isEmpty()) return;
   
-  const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
-  const int keySize = mMapData->keySize();
-  const int valueSize = mMapData->valueSize();
-  int keyOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)keySize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
-  int valueOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)valueSize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
-  
-  // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
-  if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
-    mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
-  else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
-    mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
-  
-  QImage *localMapImage = &mMapImage; // this is the image on which the colorization operates. Either the final mMapImage, or if we need oversampling, mUndersampledMapImage
-  if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
-  {
-    // resize undersampled map image to actual key/value cell sizes:
-    if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
-      mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
-    else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
-      mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
-    localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
-  } else if (!mUndersampledMapImage.isNull())
-    mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
-  
-  const double *rawData = mMapData->mData;
-  const unsigned char *rawAlpha = mMapData->mAlpha;
-  if (keyAxis->orientation() == Qt::Horizontal)
-  {
-    const int lineCount = valueSize;
-    const int rowCount = keySize;
-    for (int line=0; line<lineCount; ++line)
-    {
-      QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-      if (rawAlpha)
-        mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-      else
-        mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-    }
-  } else // keyAxis->orientation() == Qt::Vertical
+  if (mMapData->mDataModified)
+    clearMipLevels();
+  mMapData->mDataModified = false;
+  mMapImageInvalidated = false;
+  mMapImageBounds = mapImageBounds();
+  mMapImageClipRect = clipRect();
+  
+  const QRectF visibleRect = mMapImageBounds.intersected(mMapImageClipRect);
+  if (visibleRect.isEmpty())
   {
-    const int lineCount = keySize;
-    const int rowCount = valueSize;
-    for (int line=0; line<lineCount; ++line)
-    {
-      QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-      if (rawAlpha)
-        mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-      else
-        mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-    }
+    mMapImage = QImage();
+    mMapImageRect = QRectF();
+    return;
   }
   
-  if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
+  QSize imageSize;
+  if (mInterpolate)
   {
-    if (keyAxis->orientation() == Qt::Horizontal)
-      mMapImage = mUndersampledMapImage.scaled(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
-    else
-      mMapImage = mUndersampledMapImage.scaled(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    const bool keyHorizontal = keyAxis->orientation() == Qt::Horizontal;
+    const bool mirrorX = (keyHorizontal ? keyAxis : valueAxis)->rangeReversed();
+    const bool mirrorY = (keyHorizontal ? valueAxis : keyAxis)->rangeReversed();
+    double left, right, top, bottom;
+    imageSize.setWidth(mapImageGridSpan(mMapImageBounds.left(), mMapImageBounds.width(), visibleRect.left(), visibleRect.right(),
+                                        keyHorizontal ? mMapData->keySize() : mMapData->valueSize(), mirrorX, &left, &right));
+    imageSize.setHeight(mapImageGridSpan(mMapImageBounds.top(), mMapImageBounds.height(), visibleRect.top(), visibleRect.bottom(),
+                                         keyHorizontal ? mMapData->valueSize() : mMapData->keySize(), !mirrorY, &top, &bottom));
+    mMapImageRect = QRectF(QPointF(left, top), QPointF(right, bottom));
+  } else
+  {
+    // align the image to the device pixel grid, so it can be drawn without scaling:
+    const double r = mMapImageResolution;
+    const QRect deviceRect(QPoint(qFloor(visibleRect.left()*r), qFloor(visibleRect.top()*r)),
+                           QPoint(qCeil(visibleRect.right()*r)-1, qCeil(visibleRect.bottom()*r)-1));
+    mMapImageRect = QRectF(deviceRect.left()/r, deviceRect.top()/r, deviceRect.width()/r, deviceRect.height()/r);
+    imageSize = deviceRect.size();
   }
-  mMapData->mDataModified = false;
-  mMapImageInvalidated = false;
+  renderMapImage(&mMapImage, mMapImageBounds, mMapImageRect, imageSize);
 }
 
 /* inherits documentation from base class */
@@ -25609,9 +30117,6 @@ void QCPColorMap::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) return;
   applyDefaultAntialiasingHint(painter);
   
-  if (mMapData->mDataModified || mMapImageInvalidated)
-    updateMapImage();
-  
   // use buffer if painting vectorized (PDF):
   const bool useBuffer = painter->modes().testFlag(QCPPainter::pmVectorized);
   QCPPainter *localPainter = painter; // will be redirected to paint on mapBuffer if painting vectorized
@@ -25628,27 +30133,26 @@ void QCPColorMap::draw(QCPPainter *painter)
     localPainter->translate(-mapBufferTarget.topLeft());
   }
   
-  QRectF imageRect = QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
-                            coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
-  // extend imageRect to contain outer halves/quarters of bordering/cornering pixels (cells are centered on map range boundary):
-  double halfCellWidth = 0; // in pixels
-  double halfCellHeight = 0; // in pixels
-  if (keyAxis()->orientation() == Qt::Horizontal)
-  {
-    if (mMapData->keySize() > 1)
-      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->keySize()-1);
-    if (mMapData->valueSize() > 1)
-      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->valueSize()-1);
-  } else // keyAxis orientation is Qt::Vertical
+  // the map image resolution follows the painter scaling (exports, vectorized buffer) and the device pixel ratio:
+  const QTransform transform = localPainter->transform();
+  double resolution = qMax(qAbs(transform.m11())+qAbs(transform.m21()), qAbs(transform.m12())+qAbs(transform.m22()));
+  if (!useBuffer && mParentPlot)
+    resolution *= mParentPlot->bufferDevicePixelRatio();
+  if (mMapData->mDataModified || mMapImageInvalidated || resolution != mMapImageResolution ||
+      mapImageBounds() != mMapImageBounds || clipRect() != mMapImageClipRect)
   {
-    if (mMapData->keySize() > 1)
-      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->keySize()-1);
-    if (mMapData->valueSize() > 1)
-      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->valueSize()-1);
+    mMapImageResolution = resolution;
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+    QElapsedTimer imageClock;
+    imageClock.start();
+    updateMapImage();
+    if (mParentPlot)
+      mParentPlot->replotProfiler()->addPhaseTime(QCPReplotProfiler::fpMapImages, imageClock.nsecsElapsed());
+#else
+    updateMapImage();
+#endif
   }
-  imageRect.adjust(-halfCellWidth, -halfCellHeight, halfCellWidth, halfCellHeight);
-  const bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
-  const bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
+  
   const bool smoothBackup = localPainter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
   QRegion clipBackup;
@@ -25659,7 +30163,8 @@ void QCPColorMap::draw(QCPPainter *painter)
                                   coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
     localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  if (!mMapImage.isNull())
+    localPainter->drawImage(mMapImageRect, mMapImage);
   if (mTightBoundary)
     localPainter->setClipRegion(clipBackup);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -25690,6 +30195,272 @@ void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   painter->drawRect(rect.adjusted(1, 1, 0, 0));
   */
 }
+
+/*! \internal
+  
+  Returns the pixel rect covered by the whole map. Since the cells are centered on the boundaries
+  of the key and value ranges, this includes the outer halves of the bordering cells.
+*/
+QRectF QCPColorMap::mapImageBounds() const
+{
+  QRectF imageRect = QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
+                            coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
+  // extend imageRect to contain outer halves/quarters of bordering/cornering pixels (cells are centered on map range boundary):
+  double halfCellWidth = 0; // in pixels
+  double halfCellHeight = 0; // in pixels
+  if (keyAxis()->orientation() == Qt::Horizontal)
+  {
+    if (mMapData->keySize() > 1)
+      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->keySize()-1);
+    if (mMapData->valueSize() > 1)
+      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->valueSize()-1);
+  } else // keyAxis orientation is Qt::Vertical
+  {
+    if (mMapData->keySize() > 1)
+      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->keySize()-1);
+    if (mMapData->valueSize() > 1)
+      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->valueSize()-1);
+  }
+  imageRect.adjust(-halfCellWidth, -halfCellHeight, halfCellWidth, halfCellHeight);
+  return imageRect;
+}
+
+/*! \internal
+  
+  Colorizes the portion \a target of the map, which covers the pixel rect \a bounds as a whole,
+  into \a image with the pixel dimensions \a size. Each image pixel shows the cell at its center.
+  
+  If \a size is smaller than the cell count of \a target, the cells are taken from the mip level
+  which has about one cell per image pixel (see \ref mipLevel). The axis orientations and range
+  reversals are taken into account, so \a image can be drawn onto \a target without mirroring.
+  
+  Large images are split into bands of scanlines that are colorized in parallel on the global
+  QThreadPool (see \ref QCPColorMapColorizeTask).
+*/
+void QCPColorMap::renderMapImage(QImage *image, const QRectF &bounds, const QRectF &target, const QSize &size)
+{
+  const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+  if (image->size() != size || image->format() != format)
+    *image = QImage(size, format);
+  if (size.isEmpty())
+    return;
+  
+  const bool keyHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const bool mirrorX = (keyHorizontal ? mKeyAxis.data() : mValueAxis.data())->rangeReversed();
+  const bool mirrorY = (keyHorizontal ? mValueAxis.data() : mKeyAxis.data())->rangeReversed();
+  
+  // map image columns and rows to cell indices (QImage counts scanlines from top, but the vertical cell index counts from bottom):
+  QVector<int> columnCells(size.width());
+  QVector<int> rowCells(size.height());
+  const int columnLevel = sampleMapCells(columnCells.data(), size.width(), target.left()-bounds.left(), target.width(), bounds.width(),
+                                         keyHorizontal ? mMapData->keySize() : mMapData->valueSize(), mirrorX);
+  const int rowLevel = sampleMapCells(rowCells.data(), size.height(), target.top()-bounds.top(), target.height(), bounds.height(),
+                                      keyHorizontal ? mMapData->valueSize() : mMapData->keySize(), !mirrorY);
+  
+  // with horizontal key axis, each image scanline is one value row of the data, otherwise one key column:
+  QCPColorMapColorizeTask::Job job;
+  job.data = keyHorizontal ? mipLevel(columnLevel, rowLevel) : mipLevel(rowLevel, columnLevel);
+  job.rowsAlongKey = keyHorizontal;
+  job.rowCells = rowCells.constData();
+  job.columnCells = columnCells.constData();
+  job.width = size.width();
+  job.range = mDataRange;
+  job.logarithmic = mDataScaleType == QCPAxis::stLogarithmic;
+  job.bits = image->bits();
+  job.bytesPerLine = image->bytesPerLine();
+  
+  const int lineCount = size.height();
+  const qint64 pixelCount = (qint64)size.width()*(qint64)lineCount;
+  const int bandCount = (int)qBound(qint64(1), qMin(qint64(QThread::idealThreadCount()), pixelCount/QCPColorMapColorizeTask::minimumBandPixels), qint64(lineCount));
+  QSemaphore bandsDone;
+  for (int band=1; band<bandCount; ++band)
+    QThreadPool::globalInstance()->start(new QCPColorMapColorizeTask(mGradient, job, band*lineCount/bandCount, (band+1)*lineCount/bandCount, &bandsDone));
+  QCPColorMapColorizeTask(mGradient, job, 0, lineCount/bandCount, 0).run(); // first band is processed by this thread
+  bandsDone.acquire(bandCount-1);
+}
+
+/*! \internal
+  
+  Fills \a cells with the cell indices shown by \a pixelCount image pixels along one dimension. The
+  pixels span \a extent pixels starting \a offset pixels after the start of the map bounds, which
+  have a size of \a boundsExtent pixels and contain \a cellCount cells. If \a reversed is true, the
+  cell index increases towards the start of the bounds.
+  
+  Returns the mip level (along this dimension) that has roughly one cell per image pixel. The
+  indices written to \a cells are already divided accordingly.
+*/
+int QCPColorMap::sampleMapCells(int *cells, int pixelCount, double offset, double extent, double boundsExtent, int cellCount, bool reversed) const
+{
+  if (pixelCount < 1)
+    return 0;
+  if (boundsExtent <= 0)
+  {
+    memset(cells, 0, pixelCount*sizeof(int));
+    return 0;
+  }
+  const double cellsPerPixel = extent/(double)pixelCount*cellCount/boundsExtent;
+  int level = cellsPerPixel >= 2 ? qMin(int(qLn(cellsPerPixel)/qLn(2.0)+1e-9), 30) : 0;
+  while (level > 0 && ((cellCount-1)>>(level-1)) == 0) // don't go beyond the level that reduces the map to a single cell
+    --level;
+  
+  const double cellScale = cellCount/boundsExtent;
+  const double pixelExtent = extent/(double)pixelCount;
+  for (int i=0; i<pixelCount; ++i)
+  {
+    double cellPos = (offset+(i+0.5)*pixelExtent)*cellScale;
+    if (reversed)
+      cellPos = cellCount-cellPos;
+    cells[i] = int(qBound(0.0, cellPos, cellCount-1.0)) >> level;
+  }
+  return level;
+}
+
+/*! \internal
+  
+  Determines the span along one dimension of an interpolated map image, where each image pixel
+  corresponds to one cell of the mip level that has roughly one cell per device pixel. The map
+  bounds start at \a boundsStart, have a size of \a boundsExtent pixels and contain \a cellCount
+  cells. The visible portion of the bounds is given by \a visibleStart and \a visibleEnd. If \a
+  reversed is true, the cell index increases towards the start of the bounds.
+  
+  The span includes one additional cell on either side of the visible portion, so the smooth
+  transform interpolates towards the correct neighbours at the clip boundary. It is written to \a
+  targetStart and \a targetEnd, and the number of image pixels is returned.
+*/
+int QCPColorMap::mapImageGridSpan(double boundsStart, double boundsExtent, double visibleStart, double visibleEnd, int cellCount, bool reversed, double *targetStart, double *targetEnd) const
+{
+  const double cellExtent = boundsExtent/(double)cellCount;
+  const double cellsPerPixel = 1.0/(cellExtent*mMapImageResolution);
+  int level = cellsPerPixel >= 2 ? qMin(int(qLn(cellsPerPixel)/qLn(2.0)), 30) : 0;
+  while (level > 0 && ((cellCount-1)>>(level-1)) == 0)
+    --level;
+  const double groupExtent = cellExtent*double(1<<level); // pixel size of one mip level cell
+  const int groupCount = ((cellCount-1)>>level)+1;
+  
+  // visible portion in mip level cells, counted from the side of the bounds where the cell index is zero:
+  const double from = reversed ? (boundsStart+boundsExtent-visibleEnd)/groupExtent : (visibleStart-boundsStart)/groupExtent;
+  const double to = reversed ? (boundsStart+boundsExtent-visibleStart)/groupExtent : (visibleEnd-boundsStart)/groupExtent;
+  const int first = qBound(0, int(from)-1, groupCount-1);
+  const int last = qBound(first, int(to)+1, groupCount-1);
+  
+  const double spanStart = first*groupExtent;
+  const double spanEnd = (last+1)*groupExtent;
+  if (reversed)
+  {
+    *targetStart = boundsStart+boundsExtent-spanEnd;
+    *targetEnd = boundsStart+boundsExtent-spanStart;
+  } else
+  {
+    *targetStart = boundsStart+spanStart;
+    *targetEnd = boundsStart+spanEnd;
+  }
+  return last-first+1;
+}
+
+/*! \internal
+  
+  Returns the map data reduced \a keyLevel times along the key dimension and \a valueLevel times
+  along the value dimension, each reduction halving the cell count (rounding up). Level (0, 0) is
+  the data itself.
+  
+  Levels are created on first use (see \ref createMipLevel) from the coarsest already cached level
+  that is not coarser than the requested one in either dimension, and cached until the data or the
+  \ref setMipReduction "mip reduction" changes.
+*/
+const QCPColorMapData *QCPColorMap::mipLevel(int keyLevel, int valueLevel)
+{
+  keyLevel = qMax(0, keyLevel);
+  valueLevel = qMax(0, valueLevel);
+  if (keyLevel == 0 && valueLevel == 0)
+    return mMapData;
+  const QPair<int, int> levelIndex(keyLevel, valueLevel);
+  QCPColorMapData *level = mMipLevels.value(levelIndex, 0);
+  if (!level)
+  {
+    const QCPColorMapData *source = mMapData;
+    QPair<int, int> sourceIndex(0, 0);
+    for (QMap<QPair<int, int>, QCPColorMapData*>::const_iterator it=mMipLevels.constBegin(); it!=mMipLevels.constEnd(); ++it)
+    {
+      if (it.key().first <= keyLevel && it.key().second <= valueLevel && it.key().first+it.key().second > sourceIndex.first+sourceIndex.second)
+      {
+        source = it.value();
+        sourceIndex = it.key();
+      }
+    }
+    level = createMipLevel(source, keyLevel-sourceIndex.first, valueLevel-sourceIndex.second);
+    mMipLevels.insert(levelIndex, level);
+  }
+  return level;
+}
+
+/*! \internal
+  
+  Creates a new map data instance with the cells of \a source combined in blocks of
+  2^\a keyReduction by 2^\a valueReduction cells (smaller at the upper borders), as configured with
+  \ref setMipReduction. Alpha values are averaged. The result has the cell type of \a source and
+  keeps its cells in memory.
+  
+  The source is read row by row, so this works efficiently with file-backed data (see \ref
+  QCPColorMapData::setBackingFile). The caller takes ownership of the returned instance.
+*/
+QCPColorMapData *QCPColorMap::createMipLevel(const QCPColorMapData *source, int keyReduction, int valueReduction) const
+{
+  const int sourceKeySize = source->keySize();
+  const int sourceValueSize = source->valueSize();
+  const int keySize = ((sourceKeySize-1)>>keyReduction)+1;
+  const int valueSize = ((sourceValueSize-1)>>valueReduction)+1;
+  QCPColorMapData *result = new QCPColorMapData(keySize, valueSize, source->keyRange(), source->valueRange());
+  result->setCellType(source->cellType());
+  const bool hasAlpha = source->hasAlpha();
+  const bool maximum = mMipReduction == mrMaximum;
+  
+  QVector<double> sourceRow(sourceKeySize);
+  QVector<unsigned char> sourceAlphaRow(hasAlpha ? sourceKeySize : 0);
+  QVector<double> row(keySize);
+  QVector<qint64> alphaSum(hasAlpha ? keySize : 0);
+  QVector<unsigned char> alphaRow(hasAlpha ? keySize : 0);
+  for (int valueIndex=0; valueIndex<valueSize; ++valueIndex)
+  {
+    const int sourceBegin = valueIndex << valueReduction;
+    const int sourceEnd = qMin(sourceValueSize, (valueIndex+1) << valueReduction);
+    row.fill(maximum ? -std::numeric_limits<double>::infinity() : 0);
+    alphaSum.fill(0);
+    for (int sourceValueIndex=sourceBegin; sourceValueIndex<sourceEnd; ++sourceValueIndex)
+    {
+      source->readCells(0, sourceValueIndex, sourceKeySize, sourceRow.data(), hasAlpha ? sourceAlphaRow.data() : 0);
+      for (int sourceKeyIndex=0; sourceKeyIndex<sourceKeySize; ++sourceKeyIndex)
+      {
+        double &cell = row[sourceKeyIndex >> keyReduction];
+        cell = maximum ? qMax(cell, sourceRow.at(sourceKeyIndex)) : cell+sourceRow.at(sourceKeyIndex);
+        if (hasAlpha)
+          alphaSum[sourceKeyIndex >> keyReduction] += sourceAlphaRow.at(sourceKeyIndex);
+      }
+    }
+    // turn sums into means, blocks at the upper key border may contain fewer cells:
+    for (int keyIndex=0; keyIndex<keySize; ++keyIndex)
+    {
+      const int blockCellCount = (qMin(sourceKeySize, (keyIndex+1) << keyReduction) - (keyIndex << keyReduction))*(sourceEnd-sourceBegin);
+      if (!maximum)
+        row[keyIndex] /= blockCellCount;
+      if (hasAlpha)
+        alphaRow[keyIndex] = (alphaSum.at(keyIndex)+blockCellCount/2)/blockCellCount;
+    }
+    result->setCells(0, valueIndex, row.constData(), keySize);
+    if (hasAlpha)
+      result->setAlphas(0, valueIndex, alphaRow.constData(), keySize);
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Deletes all cached mip levels. They are recreated on demand by \ref mipLevel.
+*/
+void QCPColorMap::clearMipLevels()
+{
+  qDeleteAll(mMipLevels);
+  mMipLevels.clear();
+}
 /* end of 'src/plottables/plottable-colormap.cpp' */
 
 
@@ -25878,7 +30649,8 @@ QCPFinancial::QCPFinancial(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mBrushPositive(QBrush(QColor(50, 160, 0))),
   mBrushNegative(QBrush(QColor(180, 0, 15))),
   mPenPositive(QPen(QColor(40, 150, 0))),
-  mPenNegative(QPen(QColor(170, 5, 5)))
+  mPenNegative(QPen(QColor(170, 5, 5))),
+  mAdaptiveSampling(true)
 {
   mSelectionDecorator->setBrush(QBrush(QColor(160, 160, 255)));
 }
@@ -26025,6 +30797,26 @@ void QCPFinancial::setPenNegative(const QPen &pen)
   mPenNegative = pen;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this financial chart. If enabled and
+  the bars/candlesticks are narrower than one pixel, all data points that fall into the same pixel
+  column are merged into a single bar/candlestick before drawing. The merged bar opens with the
+  open of the first and closes with the close of the last merged data point, and spans the highest
+  high and lowest low of all of them. This is exactly the OHLC bar of the combined time span, so
+  zoomed out charts look like a chart with a coarser timeframe and are drawn with a number of
+  primitives that is bounded by the pixel width of the axis rect rather than the number of data
+  points.
+  
+  Bars and candlesticks that are at least one pixel wide are always drawn individually. By default,
+  adaptive sampling is enabled.
+  
+  \see QCPGraph::setAdaptiveSampling
+*/
+void QCPFinancial::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys, \a open, \a high, \a low and \a close to the current data.
@@ -26168,6 +30960,9 @@ QCPRange QCPFinancial::getValueRange(bool &foundRange, QCP::SignDomain inSignDom
   value passed as \a timeBinOffset doesn't need to be in the range encompassed by the \a time keys.
   It merely defines the mathematical offset/phase of the bins that will be used to process the
   data.
+  
+  To keep OHLC data up to date while ticks arrive, or for multiple bin sizes at once, use \ref
+  QCPFinancialAggregator instead of calling this function repeatedly.
 */
 QCPFinancialDataContainer QCPFinancial::timeSeriesToOhlc(const QVector<double> &time, const QVector<double> &value, double timeBinSize, double timeBinOffset)
 {
@@ -26211,6 +31006,7 @@ QCPFinancialDataContainer QCPFinancial::timeSeriesToOhlc(const QVector<double> &
 /* inherits documentation from base class */
 void QCPFinancial::draw(QCPPainter *painter)
 {
+  mDataContainer->mergePendingRuns();
   // get visible data range:
   QCPFinancialDataContainer::const_iterator visibleBegin, visibleEnd;
   getVisibleDataBounds(visibleBegin, visibleEnd);
@@ -26305,6 +31101,10 @@ void QCPFinancial::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 /*! \internal
   
   Draws the data from \a begin to \a end-1 as OHLC bars with the provided \a painter.
+  
+  The lines of all bars with the same pen are collected first and then passed to the painter in
+  one call. If adaptive sampling is enabled, bars that share a pixel column are merged beforehand
+  (see \ref getOptimizedData).
 
   This method is a helper function for \ref draw. It is used when the chart style is \ref csOhlc.
 */
@@ -26314,54 +31114,62 @@ void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataConta
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  if (keyAxis->orientation() == Qt::Horizontal)
-  {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
+  QCPFinancialDataContainer::const_iterator drawBegin = begin;
+  QCPFinancialDataContainer::const_iterator drawEnd = end;
+  if (getOptimizedData(&mMergedData, begin, end))
+  {
+    drawBegin = mMergedData.constBegin();
+    drawEnd = mMergedData.constEnd();
+  }
+  
+  // index 0 holds lines drawn with the positive (or only) pen, index 1 those with the negative pen:
+  const bool separateTrends = mTwoColored && !(isSelected && mSelectionDecorator);
+  QVector<QLineF> lines[2];
+  lines[0].reserve(int(drawEnd-drawBegin)*3);
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  for (QCPFinancialDataContainer::const_iterator it = drawBegin; it != drawEnd; ++it)
+  {
+    QVector<QLineF> &trendLines = lines[separateTrends && it->close < it->open ? 1 : 0];
+    double keyPixel = keyAxis->coordToPixel(it->key);
+    double openPixel = valueAxis->coordToPixel(it->open);
+    double closePixel = valueAxis->coordToPixel(it->close);
+    double highPixel = valueAxis->coordToPixel(it->high);
+    double lowPixel = valueAxis->coordToPixel(it->low);
+    double pixelWidth = getPixelWidth(it->key, keyPixel); // sign of this makes sure open/close are on correct sides
+    if (keyIsHorizontal)
+    {
+      trendLines << QLineF(keyPixel, highPixel, keyPixel, lowPixel) // backbone
+                 << QLineF(keyPixel-pixelWidth, openPixel, keyPixel, openPixel) // open
+                 << QLineF(keyPixel, closePixel, keyPixel+pixelWidth, closePixel); // close
+    } else
     {
-      if (isSelected && mSelectionDecorator)
-        mSelectionDecorator->applyPen(painter);
-      else if (mTwoColored)
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-      else
-        painter->setPen(mPen);
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw backbone:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it->high)), QPointF(keyPixel, valueAxis->coordToPixel(it->low)));
-      // draw open:
-      double pixelWidth = getPixelWidth(it->key, keyPixel); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(keyPixel-pixelWidth, openPixel), QPointF(keyPixel, openPixel));
-      // draw close:
-      painter->drawLine(QPointF(keyPixel, closePixel), QPointF(keyPixel+pixelWidth, closePixel));
+      trendLines << QLineF(highPixel, keyPixel, lowPixel, keyPixel) // backbone
+                 << QLineF(openPixel, keyPixel-pixelWidth, openPixel, keyPixel) // open
+                 << QLineF(closePixel, keyPixel, closePixel, keyPixel+pixelWidth); // close
     }
-  } else
+  }
+  
+  for (int i=0; i<2; ++i)
   {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
-    {
-      if (isSelected && mSelectionDecorator)
-        mSelectionDecorator->applyPen(painter);
-      else if (mTwoColored)
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-      else
-        painter->setPen(mPen);
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw backbone:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it->high), keyPixel), QPointF(valueAxis->coordToPixel(it->low), keyPixel));
-      // draw open:
-      double pixelWidth = getPixelWidth(it->key, keyPixel); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(openPixel, keyPixel-pixelWidth), QPointF(openPixel, keyPixel));
-      // draw close:
-      painter->drawLine(QPointF(closePixel, keyPixel), QPointF(closePixel, keyPixel+pixelWidth));
-    }
+    if (lines[i].isEmpty())
+      continue;
+    if (isSelected && mSelectionDecorator)
+      mSelectionDecorator->applyPen(painter);
+    else if (mTwoColored)
+      painter->setPen(i == 0 ? mPenPositive : mPenNegative);
+    else
+      painter->setPen(mPen);
+    painter->drawLines(lines[i]);
   }
 }
 
 /*! \internal
   
   Draws the data from \a begin to \a end-1 as Candlesticks with the provided \a painter.
+  
+  The wicks and boxes of all candlesticks with the same pen and brush are collected first and then
+  passed to the painter in one call each. If adaptive sampling is enabled, candlesticks that share
+  a pixel column are merged beforehand (see \ref getOptimizedData).
 
   This method is a helper function for \ref draw. It is used when the chart style is \ref csCandlestick.
 */
@@ -26371,62 +31179,64 @@ void QCPFinancial::drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDa
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  if (keyAxis->orientation() == Qt::Horizontal)
-  {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
+  QCPFinancialDataContainer::const_iterator drawBegin = begin;
+  QCPFinancialDataContainer::const_iterator drawEnd = end;
+  if (getOptimizedData(&mMergedData, begin, end))
+  {
+    drawBegin = mMergedData.constBegin();
+    drawEnd = mMergedData.constEnd();
+  }
+  
+  // index 0 holds primitives drawn with the positive (or only) pen/brush, index 1 those with the negative pen/brush:
+  const bool separateTrends = mTwoColored && !(isSelected && mSelectionDecorator);
+  QVector<QLineF> wicks[2];
+  QVector<QRectF> boxes[2];
+  wicks[0].reserve(int(drawEnd-drawBegin)*2);
+  boxes[0].reserve(int(drawEnd-drawBegin));
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  for (QCPFinancialDataContainer::const_iterator it = drawBegin; it != drawEnd; ++it)
+  {
+    const int trend = separateTrends && it->close < it->open ? 1 : 0;
+    double keyPixel = keyAxis->coordToPixel(it->key);
+    double openPixel = valueAxis->coordToPixel(it->open);
+    double closePixel = valueAxis->coordToPixel(it->close);
+    double highPixel = valueAxis->coordToPixel(it->high);
+    double lowPixel = valueAxis->coordToPixel(it->low);
+    double boxTopPixel = valueAxis->coordToPixel(qMax(it->open, it->close));
+    double boxBottomPixel = valueAxis->coordToPixel(qMin(it->open, it->close));
+    double pixelWidth = getPixelWidth(it->key, keyPixel);
+    if (keyIsHorizontal)
+    {
+      wicks[trend] << QLineF(keyPixel, highPixel, keyPixel, boxTopPixel) // high
+                   << QLineF(keyPixel, lowPixel, keyPixel, boxBottomPixel); // low
+      boxes[trend] << QRectF(QPointF(keyPixel-pixelWidth, closePixel), QPointF(keyPixel+pixelWidth, openPixel));
+    } else
     {
-      if (isSelected && mSelectionDecorator)
-      {
-        mSelectionDecorator->applyPen(painter);
-        mSelectionDecorator->applyBrush(painter);
-      } else if (mTwoColored)
-      {
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-        painter->setBrush(it->close >= it->open ? mBrushPositive : mBrushNegative);
-      } else
-      {
-        painter->setPen(mPen);
-        painter->setBrush(mBrush);
-      }
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw high:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it->high)), QPointF(keyPixel, valueAxis->coordToPixel(qMax(it->open, it->close))));
-      // draw low:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it->low)), QPointF(keyPixel, valueAxis->coordToPixel(qMin(it->open, it->close))));
-      // draw open-close box:
-      double pixelWidth = getPixelWidth(it->key, keyPixel);
-      painter->drawRect(QRectF(QPointF(keyPixel-pixelWidth, closePixel), QPointF(keyPixel+pixelWidth, openPixel)));
+      wicks[trend] << QLineF(highPixel, keyPixel, boxTopPixel, keyPixel) // high
+                   << QLineF(lowPixel, keyPixel, boxBottomPixel, keyPixel); // low
+      boxes[trend] << QRectF(QPointF(closePixel, keyPixel-pixelWidth), QPointF(openPixel, keyPixel+pixelWidth));
     }
-  } else // keyAxis->orientation() == Qt::Vertical
+  }
+  
+  for (int i=0; i<2; ++i)
   {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
+    if (boxes[i].isEmpty())
+      continue;
+    if (isSelected && mSelectionDecorator)
     {
-      if (isSelected && mSelectionDecorator)
-      {
-        mSelectionDecorator->applyPen(painter);
-        mSelectionDecorator->applyBrush(painter);
-      } else if (mTwoColored)
-      {
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-        painter->setBrush(it->close >= it->open ? mBrushPositive : mBrushNegative);
-      } else
-      {
-        painter->setPen(mPen);
-        painter->setBrush(mBrush);
-      }
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw high:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it->high), keyPixel), QPointF(valueAxis->coordToPixel(qMax(it->open, it->close)), keyPixel));
-      // draw low:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it->low), keyPixel), QPointF(valueAxis->coordToPixel(qMin(it->open, it->close)), keyPixel));
-      // draw open-close box:
-      double pixelWidth = getPixelWidth(it->key, keyPixel);
-      painter->drawRect(QRectF(QPointF(closePixel, keyPixel-pixelWidth), QPointF(openPixel, keyPixel+pixelWidth)));
+      mSelectionDecorator->applyPen(painter);
+      mSelectionDecorator->applyBrush(painter);
+    } else if (mTwoColored)
+    {
+      painter->setPen(i == 0 ? mPenPositive : mPenNegative);
+      painter->setBrush(i == 0 ? mBrushPositive : mBrushNegative);
+    } else
+    {
+      painter->setPen(mPen);
+      painter->setBrush(mBrush);
     }
+    painter->drawLines(wicks[i]);
+    painter->drawRects(boxes[i]);
   }
 }
 
@@ -26474,7 +31284,53 @@ double QCPFinancial::getPixelWidth(double key, double keyPixel) const
       break;
     }
   }
-  return result;
+  return result;
+}
+
+/*! \internal
+  
+  If adaptive sampling is enabled (\ref setAdaptiveSampling) and the bars/candlesticks in the
+  range \a begin to \a end-1 are narrower than one pixel, this method merges all data points that
+  fall into the same key pixel column into one data point and writes the result to \a mergedData.
+  Returns true in that case. Otherwise \a mergedData is cleared and false is returned, meaning the
+  data points should be drawn individually.
+  
+  A merged data point keeps the key of the first data point in its pixel column. Its open is the
+  open of the first, its close the close of the last data point in the column, and high and low
+  are the extrema over the whole column. Since \a begin to \a end-1 is sorted by key, each pixel
+  column is a contiguous run of data points and one linear pass suffices.
+*/
+bool QCPFinancial::getOptimizedData(QVector<QCPFinancialData> *mergedData, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end) const
+{
+  mergedData->resize(0);
+  if (!mAdaptiveSampling || begin == end)
+    return false;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return false; }
+  
+  // bars at least one pixel wide are distinguishable and are drawn individually:
+  if (qAbs(getPixelWidth(begin->key, keyAxis->coordToPixel(begin->key)))*2 >= 1)
+    return false;
+  
+  const int pixelSpan = keyAxis->orientation() == Qt::Horizontal ? keyAxis->axisRect()->width() : keyAxis->axisRect()->height();
+  mergedData->reserve(qMin(int(end-begin), pixelSpan+1));
+  int currentColumn = 0;
+  for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
+  {
+    const int column = qFloor(keyAxis->coordToPixel(it->key));
+    if (!mergedData->isEmpty() && column == currentColumn)
+    {
+      QCPFinancialData &merged = mergedData->last();
+      merged.close = it->close;
+      merged.high = qMax(merged.high, it->high);
+      merged.low = qMin(merged.low, it->low);
+    } else
+    {
+      mergedData->append(*it);
+      currentColumn = column;
+    }
+  }
+  return true;
 }
 
 /*! \internal
@@ -26645,6 +31501,423 @@ QRectF QCPFinancial::selectionHitBox(QCPFinancialDataContainer::const_iterator i
   else
     return QRectF(highPixel, keyPixel-keyWidthPixels, lowPixel-highPixel, keyWidthPixels*2).normalized();
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPFinancialAggregateTask
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPFinancialAggregateTask
+  \brief A chunk of ticks which is aggregated to OHLC bars on a worker thread
+  
+  \internal
+  
+  \ref QCPFinancialAggregator::addTicks splits large amounts of ticks into chunks of consecutive
+  ticks and hands them to the global QThreadPool as instances of this class. Each task aggregates
+  its chunk for all time bin sizes into its own bar vectors, so no further synchronization is
+  necessary. The bars of neighbouring chunks which share a bin are folded afterwards. When done,
+  the task releases the semaphore it was created with.
+*/
+class QCPFinancialAggregateTask : public QRunnable
+{
+public:
+  QCPFinancialAggregateTask(const double *time, const double *value, int count, const QList<double> &timeBinSizes, double timeBinOffset, QVector<QVector<QCPFinancialData> > *bars, QSemaphore *done) :
+    mTime(time),
+    mValue(value),
+    mCount(count),
+    mTimeBinSizes(timeBinSizes),
+    mTimeBinOffset(timeBinOffset),
+    mBars(bars),
+    mDone(done)
+  {
+  }
+  
+  virtual void run() Q_DECL_OVERRIDE
+  {
+    for (int i=0; i<mTimeBinSizes.size(); ++i)
+      QCPFinancialAggregator::aggregate(mTime, mValue, mCount, mTimeBinSizes.at(i), mTimeBinOffset, &(*mBars)[i]);
+    if (mDone)
+      mDone->release();
+  }
+  
+private:
+  const double *mTime, *mValue;
+  int mCount;
+  QList<double> mTimeBinSizes;
+  double mTimeBinOffset;
+  QVector<QVector<QCPFinancialData> > *mBars;
+  QSemaphore *mDone;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPFinancialAggregator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPFinancialAggregator
+  \brief Aggregates a stream of ticks to OHLC bars for multiple time bin sizes
+  
+  Unlike \ref QCPFinancial::timeSeriesToOhlc, which bins a complete time series at once, this class
+  keeps the aggregated bars and folds each new tick into them. Adding a tick with \ref addTick
+  costs constant time per time bin size: It either updates high, low and close of the currently
+  open bar, or opens a new bar.
+  
+  The bars are kept for every time bin size registered with \ref addTimeframe, e.g. for one
+  second, one minute and one hour. Each time bin size has its own \ref QCPFinancialDataContainer,
+  which can be passed to \ref QCPFinancial::setData(QSharedPointer<QCPFinancialDataContainer>)
+  directly. Switching the timeframe of a chart is then just a matter of passing another container,
+  without rescanning any ticks. Since the containers are shared, ticks added later show up in the
+  chart on the next replot.
+  
+  Large amounts of ticks, e.g. when loading a history, are best added with \ref addTicks, which
+  aggregates chunks of the ticks in parallel on the global QThreadPool.
+  
+  The bins of a time bin size \a s start at the times <tt>timeBinOffset+n*s</tt> for integer \a n,
+  and each bar is placed at the center of its bin, so the candles span exactly their bin when drawn
+  with a width of \a s. This way, the bins of a time bin size which is a multiple of another one
+  consist of whole bins of the smaller size, which allows to roll up new timeframes from existing
+  bars (see \ref addTimeframe).
+  
+  The aggregator doesn't keep the ticks themselves. Ticks are expected in ascending time order.
+  Ticks older than the last tick only extend the high and low of their bar (or create a new bar
+  with that single tick), because their position relative to the open and close tick is unknown.
+  
+  QCPFinancialAggregator is not thread-safe, ticks must be added from a single thread.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QList<double> QCPFinancialAggregator::timeBinSizes() const
+  
+  Returns the time bin sizes registered with \ref addTimeframe, in ascending order.
+*/
+
+/*! \fn QSharedPointer<QCPFinancialDataContainer> QCPFinancialAggregator::data(double timeBinSize) const
+  
+  Returns the container with the bars of the time bin size \a timeBinSize, or a null pointer if no
+  timeframe with this time bin size was added (see \ref addTimeframe).
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs an aggregator without any timeframes. The bins of all timeframes start at \a
+  timeBinOffset plus multiples of their time bin size.
+  
+  \see addTimeframe
+*/
+QCPFinancialAggregator::QCPFinancialAggregator(double timeBinOffset) :
+  mTimeBinOffset(timeBinOffset),
+  mLastTickTime(0),
+  mHaveTicks(false)
+{
+}
+
+/*!
+  Adds a timeframe which aggregates the ticks to bars spanning \a timeBinSize each, in the same
+  units as the tick times.
+  
+  If ticks were added already, the bars of the new timeframe are rolled up from the bars of the
+  largest existing time bin size which \a timeBinSize is a multiple of. If there is no such
+  timeframe, the new timeframe only aggregates ticks added from now on.
+  
+  \see removeTimeframe, data
+*/
+void QCPFinancialAggregator::addTimeframe(double timeBinSize)
+{
+  if (timeBinSize <= 0 || qIsNaN(timeBinSize))
+  {
+    qDebug() << Q_FUNC_INFO << "invalid time bin size" << timeBinSize;
+    return;
+  }
+  if (mTimeframes.contains(timeBinSize))
+    return;
+  
+  QSharedPointer<QCPFinancialDataContainer> data(new QCPFinancialDataContainer);
+  if (mHaveTicks)
+  {
+    // find the largest finer timeframe whose bins nest into the new bins:
+    QSharedPointer<QCPFinancialDataContainer> source;
+    QMap<double, QSharedPointer<QCPFinancialDataContainer> >::const_iterator it = mTimeframes.constEnd();
+    while (it != mTimeframes.constBegin())
+    {
+      --it;
+      const double ratio = timeBinSize/it.key();
+      if (ratio > 1 && qAbs(ratio-qRound64(ratio)) < ratio*1e-9)
+      {
+        source = it.value();
+        break;
+      }
+    }
+    if (source)
+    {
+      QVector<QCPFinancialData> bars;
+      for (QCPFinancialDataContainer::const_iterator barIt=source->constBegin(); barIt!=source->constEnd(); ++barIt)
+      {
+        QCPFinancialData bar = *barIt;
+        bar.key = mTimeBinOffset+(std::floor((barIt->key-mTimeBinOffset)/timeBinSize)+0.5)*timeBinSize;
+        if (!bars.isEmpty() && bars.last().key == bar.key)
+          foldBar(bars.last(), bar);
+        else
+          bars.append(bar);
+      }
+      data->set(bars, true);
+    } else
+      qDebug() << Q_FUNC_INFO << "no finer timeframe to roll up from, time bin size" << timeBinSize << "only aggregates ticks added from now on";
+  }
+  mTimeframes.insert(timeBinSize, data);
+}
+
+/*!
+  Removes the timeframe with the time bin size \a timeBinSize. Plottables which still use its
+  container (see \ref data) keep it, but it isn't updated anymore.
+  
+  \see addTimeframe
+*/
+void QCPFinancialAggregator::removeTimeframe(double timeBinSize)
+{
+  mTimeframes.remove(timeBinSize);
+}
+
+/*!
+  Folds the tick with the price \a value at \a time into the bars of all timeframes.
+  
+  If \a time lies in the bin of the last bar of a timeframe, the bar's high, low and close are
+  updated. If it lies in a later bin, a new bar is opened. Both take constant time. Ticks with NaN
+  time or value are ignored.
+  
+  \see addTicks
+*/
+void QCPFinancialAggregator::addTick(double time, double value)
+{
+  if (qIsNaN(time) || qIsNaN(value))
+    return;
+  const bool inOrder = !mHaveTicks || time >= mLastTickTime;
+  QMap<double, QSharedPointer<QCPFinancialDataContainer> >::const_iterator it;
+  for (it=mTimeframes.constBegin(); it!=mTimeframes.constEnd(); ++it)
+  {
+    QCPFinancialDataContainer *data = it.value().data();
+    const double key = mTimeBinOffset+(std::floor((time-mTimeBinOffset)/it.key())+0.5)*it.key();
+    const QCPFinancialData tickBar(key, value, value, value, value);
+    if (data->isEmpty() || key > (data->constEnd()-1)->key) // tick opens a new bar
+    {
+      data->add(tickBar);
+    } else if (key == (data->constEnd()-1)->key) // tick falls into the open bar
+    {
+      QCPFinancialDataContainer::iterator bar = data->end()-1;
+      if (inOrder)
+        foldBar(*bar, tickBar);
+      else
+      {
+        bar->high = qMax(bar->high, value);
+        bar->low = qMin(bar->low, value);
+      }
+    } else // late tick for an earlier bar
+    {
+      QCPFinancialDataContainer::const_iterator found = data->findBegin(key, false);
+      if (found != data->constEnd() && found->key == key)
+      {
+        QCPFinancialDataContainer::iterator bar = data->begin()+(found-data->constBegin());
+        bar->high = qMax(bar->high, value);
+        bar->low = qMin(bar->low, value);
+      } else
+        data->add(tickBar);
+    }
+  }
+  if (inOrder)
+  {
+    mLastTickTime = time;
+    mHaveTicks = true;
+  }
+}
+
+/*!
+  Folds many ticks, given as prices \a value at the times \a time, into the bars of all timeframes.
+  The vectors should have equal length, else only the number of ticks of the shorter vector is
+  used.
+  
+  If you can guarantee that \a time is in ascending order, set \a alreadySorted to true to save
+  sorting the ticks first.
+  
+  The ticks are split into chunks which are aggregated in parallel on the global QThreadPool (see
+  \ref minimumChunkTicks). The resulting bars are then appended to the timeframes, folding the
+  first new bar into the open bar if they share a bin. If the ticks start before the last tick
+  added so far, they are added one by one with \ref addTick instead.
+*/
+void QCPFinancialAggregator::addTicks(const QVector<double> &time, const QVector<double> &value, bool alreadySorted)
+{
+  int count = qMin(time.size(), value.size());
+  if (count == 0)
+    return;
+  
+  QVector<double> sortedTime, sortedValue;
+  const double *timeData = time.constData();
+  const double *valueData = value.constData();
+  if (!alreadySorted)
+  {
+    QVector<QPair<double, double> > ticks;
+    ticks.reserve(count);
+    for (int i=0; i<count; ++i)
+    {
+      if (!qIsNaN(time.at(i)) && !qIsNaN(value.at(i))) // NaN times can't be sorted, and would be skipped anyway
+        ticks.append(qMakePair(time.at(i), value.at(i)));
+    }
+    if (ticks.isEmpty())
+      return;
+    std::stable_sort(ticks.begin(), ticks.end(), lessThanTickTime); // stable, so ticks with equal time keep their order
+    count = ticks.size();
+    sortedTime.resize(count);
+    sortedValue.resize(count);
+    for (int i=0; i<count; ++i)
+    {
+      sortedTime[i] = ticks.at(i).first;
+      sortedValue[i] = ticks.at(i).second;
+    }
+    timeData = sortedTime.constData();
+    valueData = sortedValue.constData();
+  }
+  
+  if (mHaveTicks && timeData[0] < mLastTickTime) // ticks reach back before the last tick, merging needs per-tick handling
+  {
+    for (int i=0; i<count; ++i)
+      addTick(timeData[i], valueData[i]);
+    return;
+  }
+  
+  // aggregate chunks of the ticks in parallel, each chunk for all timeframes:
+  const QList<double> timeBinSizes = mTimeframes.keys();
+  const int chunkCount = qBound(1, qMin(QThread::idealThreadCount(), count/minimumChunkTicks), count);
+  QVector<QVector<QVector<QCPFinancialData> > > chunkBars(chunkCount, QVector<QVector<QCPFinancialData> >(timeBinSizes.size()));
+  QSemaphore chunksDone;
+  for (int chunk=1; chunk<chunkCount; ++chunk)
+  {
+    const int begin = chunk*count/chunkCount;
+    const int end = (chunk+1)*count/chunkCount;
+    QThreadPool::globalInstance()->start(new QCPFinancialAggregateTask(timeData+begin, valueData+begin, end-begin, timeBinSizes, mTimeBinOffset, &chunkBars[chunk], &chunksDone));
+  }
+  QCPFinancialAggregateTask(timeData, valueData, count/chunkCount, timeBinSizes, mTimeBinOffset, &chunkBars[0], 0).run(); // first chunk is processed by this thread
+  chunksDone.acquire(chunkCount-1);
+  
+  // fold the chunk borders and append the bars to the timeframes:
+  for (int i=0; i<timeBinSizes.size(); ++i)
+  {
+    QVector<QCPFinancialData> bars = chunkBars.at(0).at(i);
+    for (int chunk=1; chunk<chunkCount; ++chunk)
+    {
+      const QVector<QCPFinancialData> &nextBars = chunkBars.at(chunk).at(i);
+      int first = 0;
+      if (!bars.isEmpty() && !nextBars.isEmpty() && bars.last().key == nextBars.first().key)
+      {
+        foldBar(bars.last(), nextBars.first());
+        first = 1;
+      }
+      bars << nextBars.mid(first);
+    }
+    appendBars(mTimeframes.value(timeBinSizes.at(i)).data(), bars);
+  }
+  
+  // remember the last valid tick, so later ticks can be checked for their order:
+  for (int i=count-1; i>=0; --i)
+  {
+    if (!qIsNaN(timeData[i]) && !qIsNaN(valueData[i]))
+    {
+      mLastTickTime = timeData[i];
+      mHaveTicks = true;
+      break;
+    }
+  }
+}
+
+/*!
+  Removes all bars from all timeframes. The timeframes themselves are kept.
+*/
+void QCPFinancialAggregator::clear()
+{
+  QMap<double, QSharedPointer<QCPFinancialDataContainer> >::const_iterator it;
+  for (it=mTimeframes.constBegin(); it!=mTimeframes.constEnd(); ++it)
+    it.value()->clear();
+  mLastTickTime = 0;
+  mHaveTicks = false;
+}
+
+/*!
+  Aggregates \a count ticks with the prices \a value at the times \a time to OHLC bars spanning \a
+  timeBinSize each, with the bins starting at \a timeBinOffset plus multiples of \a timeBinSize.
+  The resulting bars are written to \a bars, which is cleared first.
+  
+  The ticks must be in ascending time order. Ticks with NaN time or value are skipped.
+  
+  This is the building block of \ref addTicks, and may be called concurrently from multiple
+  threads for different ticks.
+*/
+void QCPFinancialAggregator::aggregate(const double *time, const double *value, int count, double timeBinSize, double timeBinOffset, QVector<QCPFinancialData> *bars)
+{
+  bars->resize(0);
+  double currentBin = 0;
+  QCPFinancialData bar;
+  bool haveBar = false;
+  for (int i=0; i<count; ++i)
+  {
+    if (qIsNaN(time[i]) || qIsNaN(value[i]))
+      continue;
+    const double bin = std::floor((time[i]-timeBinOffset)/timeBinSize);
+    if (haveBar && bin == currentBin) // tick still in current bin, extend high/low and move close:
+    {
+      if (value[i] < bar.low) bar.low = value[i];
+      if (value[i] > bar.high) bar.high = value[i];
+      bar.close = value[i];
+    } else // tick opens the next bin:
+    {
+      if (haveBar)
+        bars->append(bar);
+      currentBin = bin;
+      bar = QCPFinancialData(timeBinOffset+(bin+0.5)*timeBinSize, value[i], value[i], value[i], value[i]);
+      haveBar = true;
+    }
+  }
+  if (haveBar)
+    bars->append(bar);
+}
+
+/*! \internal
+  
+  Appends the key-sorted \a bars to \a data, whose bars must all have keys smaller than or equal
+  to the first bar of \a bars. If the first bar shares its bin with the last bar of \a data, it is
+  folded into that bar instead of being appended.
+*/
+void QCPFinancialAggregator::appendBars(QCPFinancialDataContainer *data, const QVector<QCPFinancialData> &bars)
+{
+  if (bars.isEmpty())
+    return;
+  if (!data->isEmpty() && (data->constEnd()-1)->key == bars.first().key)
+  {
+    foldBar(*(data->end()-1), bars.first());
+    data->add(bars.mid(1), true);
+  } else
+    data->add(bars, true);
+}
+
+/*! \internal
+  
+  Folds \a laterBar, which lies in the same bin as \a bar but consists of later ticks, into \a bar.
+  The open of \a bar is kept, the close is taken from \a laterBar, and high and low are extended.
+*/
+void QCPFinancialAggregator::foldBar(QCPFinancialData &bar, const QCPFinancialData &laterBar)
+{
+  if (laterBar.high > bar.high) bar.high = laterBar.high;
+  if (laterBar.low < bar.low) bar.low = laterBar.low;
+  bar.close = laterBar.close;
+}
+
+/*! \internal
+  
+  Returns whether the time of tick \a a is less than the time of tick \a b. The ticks are given as
+  pairs of time and value. Used by \ref addTicks to sort the ticks by time.
+*/
+bool QCPFinancialAggregator::lessThanTickTime(const QPair<double, double> &a, const QPair<double, double> &b)
+{
+  return a.first < b.first;
+}
 /* end of 'src/plottables/plottable-financial.cpp' */
 
 
@@ -26730,6 +32003,13 @@ QCPErrorBarsData::QCPErrorBarsData(double errorMinus, double errorPlus) :
   whiskers (\ref setWhiskerWidth). Further, the error bar backbones may leave a gap around the data
   point center to prevent that error bars are drawn too close to or even through scatter points.
   This gap size can be controlled via \ref setSymbolGap.
+
+  \section qcperrorbars-performance Performance
+
+  With many data points per pixel, the error bars of neighbouring data points are merged into one
+  error bar per pixel, spanning the extremes of the merged error bars (see \ref
+  setAdaptiveSampling). This keeps the cost of drawing the error bars in line with the cost of
+  drawing the data plottable they belong to.
 */
 
 /* start of documentation of inline functions */
@@ -26761,7 +32041,8 @@ QCPErrorBars::QCPErrorBars(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mDataContainer(new QVector<QCPErrorBarsData>),
   mErrorType(etValueError),
   mWhiskerWidth(9),
-  mSymbolGap(10)
+  mSymbolGap(10),
+  mAdaptiveSampling(true)
 {
   setPen(QPen(Qt::black, 0));
   setBrush(Qt::NoBrush);
@@ -26885,6 +32166,24 @@ void QCPErrorBars::setSymbolGap(double pixels)
   mSymbolGap = pixels;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting the error bars. If enabled and there
+  are more visible data points than pixels, consecutive error bars whose centers fall into the same
+  pixel column (for \ref etValueError, or pixel row for \ref etKeyError) are merged into one error
+  bar. It spans the envelope of the merged error bars, i.e. from the lowest to the highest error
+  bar end, with whiskers only at these two ends. Further, whiskers narrower than one pixel (see
+  \ref setWhiskerWidth) are not drawn.
+  
+  By default, adaptive sampling is enabled. Error bars then cost roughly as much to draw as the
+  data plottable they belong to, even with thousands of data points per pixel.
+  
+  \see QCPGraph::setAdaptiveSampling
+*/
+void QCPErrorBars::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
 
   Adds symmetrical error values as specified in \a error. The errors will be associated one-to-one
@@ -27125,8 +32424,8 @@ void QCPErrorBars::draw(QCPPainter *painter)
   // if the sort key isn't the main key, we must check the visibility for each data point/error bar individually
   // (getVisibleDataBounds applies range restriction, but otherwise can only return full data range):
   bool checkPointVisibility = !mDataPlottable->interface1D()->sortKeyIsMainKey();
-      
-    // check data validity if flag set:
+  
+  // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
   QCPErrorBarsDataContainer::const_iterator it;
   for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd(); ++it)
@@ -27142,7 +32441,6 @@ void QCPErrorBars::draw(QCPPainter *painter)
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
-  QVector<QLineF> backbones, whiskers;
   for (int i=0; i<allSegments.size(); ++i)
   {
     QCPErrorBarsDataContainer::const_iterator begin, end;
@@ -27161,15 +32459,9 @@ void QCPErrorBars::draw(QCPPainter *painter)
       capFixPen.setCapStyle(Qt::FlatCap);
       painter->setPen(capFixPen);
     }
-    backbones.clear();
-    whiskers.clear();
-    for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
-    {
-      if (!checkPointVisibility || errorBarVisible(it-mDataContainer->constBegin()))
-        getErrorBarLines(it, backbones, whiskers);
-    }
-    painter->drawLines(backbones);
-    painter->drawLines(whiskers);
+    getOptimizedErrorBarLines(begin, end, checkPointVisibility, mBackbones, mWhiskers);
+    painter->drawLines(mBackbones);
+    painter->drawLines(mWhiskers);
   }
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
@@ -27375,6 +32667,17 @@ void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it
   QPointF centerPixel = mDataPlottable->interface1D()->dataPixelPosition(index);
   if (qIsNaN(centerPixel.x()) || qIsNaN(centerPixel.y()))
     return;
+  getErrorBarLines(it, centerPixel, true, backbones, whiskers);
+}
+
+/*! \internal \overload
+
+  Calculates the lines that make up the error bar belonging to the data point \a it, whose center
+  in pixel coordinates was already determined as \a centerPixel. If \a withWhiskers is false, no
+  whiskers are added to \a whiskers.
+*/
+void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, const QPointF &centerPixel, bool withWhiskers, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const
+{
   QCPAxis *errorAxis = mErrorType == etValueError ? mValueAxis : mKeyAxis;
   QCPAxis *orthoAxis = mErrorType == etValueError ? mKeyAxis : mValueAxis;
   const double centerErrorAxisPixel = errorAxis->orientation() == Qt::Horizontal ? centerPixel.x() : centerPixel.y();
@@ -27391,12 +32694,14 @@ void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it
     {
       if ((errorStart > errorEnd) != errorAxis->rangeReversed())
         backbones.append(QLineF(centerOrthoAxisPixel, errorStart, centerOrthoAxisPixel, errorEnd));
-      whiskers.append(QLineF(centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5, errorEnd));
+      if (withWhiskers)
+        whiskers.append(QLineF(centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5, errorEnd));
     } else
     {
       if ((errorStart < errorEnd) != errorAxis->rangeReversed())
         backbones.append(QLineF(errorStart, centerOrthoAxisPixel, errorEnd, centerOrthoAxisPixel));
-      whiskers.append(QLineF(errorEnd, centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5));
+      if (withWhiskers)
+        whiskers.append(QLineF(errorEnd, centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5));
     }
   }
   // minus error:
@@ -27408,13 +32713,169 @@ void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it
     {
       if ((errorStart < errorEnd) != errorAxis->rangeReversed())
         backbones.append(QLineF(centerOrthoAxisPixel, errorStart, centerOrthoAxisPixel, errorEnd));
-      whiskers.append(QLineF(centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5, errorEnd));
+      if (withWhiskers)
+        whiskers.append(QLineF(centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5, errorEnd));
     } else
     {
       if ((errorStart > errorEnd) != errorAxis->rangeReversed())
         backbones.append(QLineF(errorStart, centerOrthoAxisPixel, errorEnd, centerOrthoAxisPixel));
-      whiskers.append(QLineF(errorEnd, centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5));
+      if (withWhiskers)
+        whiskers.append(QLineF(errorEnd, centerOrthoAxisPixel-mWhiskerWidth*0.5, errorEnd, centerOrthoAxisPixel+mWhiskerWidth*0.5));
+    }
+  }
+}
+
+/*! \internal
+
+  Calculates the lines of all error bars from \a begin to \a end, as they are drawn by \ref draw.
+  \a backbones and \a whiskers are cleared first, but keep their allocated memory, so passing the
+  same vectors for every frame avoids reallocations.
+
+  If \a checkPointVisibility is true, error bars outside the visible key range are skipped. The
+  pixel position of each data point is only requested once from the data plottable for both the
+  visibility check and the line calculation.
+
+  If adaptive sampling is enabled (\ref setAdaptiveSampling) and there are more data points than
+  pixels along the axis orthogonal to the error bars, consecutive error bars whose centers fall
+  into the same pixel column are merged into one backbone spanning the extremes of their ends, and
+  whiskers are only added at these extremes. Like for single error bars, the backbone leaves out
+  the symbol gap (\ref setSymbolGap), centered at the mean pixel position of the column's data
+  points. Whiskers narrower than one pixel are skipped altogether. Pixel columns containing a
+  single error bar are output unchanged.
+*/
+void QCPErrorBars::getOptimizedErrorBarLines(const QCPErrorBarsDataContainer::const_iterator &begin, const QCPErrorBarsDataContainer::const_iterator &end, bool checkPointVisibility, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const
+{
+  backbones.resize(0);
+  whiskers.resize(0);
+  if (!mDataPlottable || begin == end) return;
+  
+  QCPPlottableInterface1D *dataInterface = mDataPlottable->interface1D();
+  const QCPErrorBarsDataContainer::const_iterator dataBegin = mDataContainer->constBegin();
+  QCPAxis *errorAxis = mErrorType == etValueError ? mValueAxis : mKeyAxis;
+  QCPAxis *orthoAxis = mErrorType == etValueError ? mKeyAxis : mValueAxis;
+  const bool withWhiskers = !mAdaptiveSampling || mWhiskerWidth >= 1.0;
+  const double orthoPixelSpan = orthoAxis->orientation() == Qt::Horizontal ? orthoAxis->axisRect()->width() : orthoAxis->axisRect()->height();
+  
+  if (!mAdaptiveSampling || end-begin <= orthoPixelSpan)
+  {
+    backbones.reserve(2*(end-begin));
+    if (withWhiskers)
+      whiskers.reserve(2*(end-begin));
+    for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+    {
+      const int index = it-dataBegin;
+      const QPointF centerPixel = dataInterface->dataPixelPosition(index);
+      if (qIsNaN(centerPixel.x()) || qIsNaN(centerPixel.y()))
+        continue;
+      if (!checkPointVisibility || errorBarVisible(index, centerPixel))
+        getErrorBarLines(it, centerPixel, withWhiskers, backbones, whiskers);
+    }
+    return;
+  }
+  
+  // more error bars than pixels, merge the error bars of each pixel column into their envelope:
+  const bool errorAxisIsX = errorAxis->orientation() == Qt::Horizontal;
+  backbones.reserve(2*int(orthoPixelSpan)+2);
+  if (withWhiskers)
+    whiskers.reserve(2*int(orthoPixelSpan)+2);
+  QCPErrorBarsDataContainer::const_iterator columnFirst = end; // first data point of the current pixel column
+  QPointF columnFirstCenter;
+  int columnCount = 0;
+  int currentColumn = 0;
+  double columnOrthoPixel = 0, columnMin = 0, columnMax = 0, columnCenterSum = 0;
+  for (QCPErrorBarsDataContainer::const_iterator it=begin; ; ++it)
+  {
+    int column = 0;
+    QPointF centerPixel;
+    double lower = 0, upper = 0;
+    if (it != end)
+    {
+      const int index = it-dataBegin;
+      centerPixel = dataInterface->dataPixelPosition(index);
+      if (qIsNaN(centerPixel.x()) || qIsNaN(centerPixel.y()))
+        continue;
+      if (checkPointVisibility && !errorBarVisible(index, centerPixel))
+        continue;
+      column = qFloor(errorAxisIsX ? centerPixel.y() : centerPixel.x());
+      // pixel extent of this error bar along the error axis:
+      const double errorPixel = errorAxisIsX ? centerPixel.x() : centerPixel.y();
+      const double errorCoord = errorAxis->pixelToCoord(errorPixel);
+      lower = errorPixel;
+      upper = errorPixel;
+      if (!qIsNaN(it->errorPlus))
+      {
+        const double plusPixel = errorAxis->coordToPixel(errorCoord+it->errorPlus);
+        lower = qMin(lower, plusPixel);
+        upper = qMax(upper, plusPixel);
+      }
+      if (!qIsNaN(it->errorMinus))
+      {
+        const double minusPixel = errorAxis->coordToPixel(errorCoord-it->errorMinus);
+        lower = qMin(lower, minusPixel);
+        upper = qMax(upper, minusPixel);
+      }
+      if (columnCount > 0 && column == currentColumn)
+      {
+        columnMin = qMin(columnMin, lower);
+        columnMax = qMax(columnMax, upper);
+        columnCenterSum += errorPixel;
+        ++columnCount;
+        continue;
+      }
+    }
+    
+    // a new pixel column starts (or the data ended), output the finished pixel column:
+    if (columnCount == 1)
+    {
+      getErrorBarLines(columnFirst, columnFirstCenter, withWhiskers, backbones, whiskers);
+    } else if (columnCount > 1)
+    {
+      // split the backbone at the symbol gap around the column's mean data point pixel:
+      double segments[4] = {columnMin, columnMax, 0, 0};
+      int segmentCount = 1;
+      if (mSymbolGap > 0)
+      {
+        const double columnCenter = columnCenterSum/columnCount;
+        segments[1] = qMin(columnMax, columnCenter-mSymbolGap*0.5);
+        segments[2] = qMax(columnMin, columnCenter+mSymbolGap*0.5);
+        segments[3] = columnMax;
+        segmentCount = 2;
+      }
+      for (int i=0; i<segmentCount; ++i)
+      {
+        if (segments[2*i] >= segments[2*i+1])
+          continue;
+        if (errorAxisIsX)
+          backbones.append(QLineF(segments[2*i], columnOrthoPixel, segments[2*i+1], columnOrthoPixel));
+        else
+          backbones.append(QLineF(columnOrthoPixel, segments[2*i], columnOrthoPixel, segments[2*i+1]));
+      }
+      if (errorAxisIsX)
+      {
+        if (withWhiskers)
+        {
+          whiskers.append(QLineF(columnMin, columnOrthoPixel-mWhiskerWidth*0.5, columnMin, columnOrthoPixel+mWhiskerWidth*0.5));
+          whiskers.append(QLineF(columnMax, columnOrthoPixel-mWhiskerWidth*0.5, columnMax, columnOrthoPixel+mWhiskerWidth*0.5));
+        }
+      } else
+      {
+        if (withWhiskers)
+        {
+          whiskers.append(QLineF(columnOrthoPixel-mWhiskerWidth*0.5, columnMin, columnOrthoPixel+mWhiskerWidth*0.5, columnMin));
+          whiskers.append(QLineF(columnOrthoPixel-mWhiskerWidth*0.5, columnMax, columnOrthoPixel+mWhiskerWidth*0.5, columnMax));
+        }
+      }
     }
+    if (it == end)
+      break;
+    columnFirst = it;
+    columnFirstCenter = centerPixel;
+    columnOrthoPixel = errorAxisIsX ? centerPixel.y() : centerPixel.x();
+    columnMin = lower;
+    columnMax = upper;
+    columnCenterSum = errorAxisIsX ? centerPixel.x() : centerPixel.y();
+    currentColumn = column;
+    columnCount = 1;
   }
 }
 
@@ -27560,7 +33021,17 @@ void QCPErrorBars::getDataSegments(QList<QCPDataRange> &selectedSegments, QList<
 */
 bool QCPErrorBars::errorBarVisible(int index) const
 {
-  QPointF centerPixel = mDataPlottable->interface1D()->dataPixelPosition(index);
+  return errorBarVisible(index, mDataPlottable->interface1D()->dataPixelPosition(index));
+}
+
+/*! \internal \overload
+
+  Returns whether the error bar at the specified \a index, whose data point center in pixel
+  coordinates is \a centerPixel, is visible within the current key axis range. This avoids
+  requesting the pixel position from the data plottable again, when it is already known.
+*/
+bool QCPErrorBars::errorBarVisible(int index, const QPointF &centerPixel) const
+{
   const double centerKeyPixel = mKeyAxis->orientation() == Qt::Horizontal ? centerPixel.x() : centerPixel.y();
   if (qIsNaN(centerKeyPixel))
     return false;
@@ -62,6 +62,15 @@
 #include <QtCore/QStack>
 #include <QtCore/QCache>
 #include <QtCore/QMargins>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QFile>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QTextStream>
 #include <qmath.h>
 #include <limits>
 #include <algorithm>
@@ -84,6 +93,9 @@
 #  include <QtGui/QPrintEngine>
 #else
 #  include <QtNumeric>
+#  include <QtGui/QGuiApplication>
+#  include <QtGui/QScreen>
+#  include <QtGui/QWindow>
 #  include <QtWidgets/QWidget>
 #  include <QtPrintSupport/QtPrintSupport>
 #endif
@@ -105,6 +117,8 @@ class QCPItemPosition;
 class QCPLayer;
 class QCPAbstractLegendItem;
 class QCPSelectionRect;
+class QCPReplotScheduler;
+class QCPReplotProfiler;
 class QCPColorMap;
 class QCPColorScale;
 class QCPBars;
@@ -235,6 +249,12 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phRasterLines      = 0x008 ///< <tt>0x008</tt> Graph/Curve lines with thin solid pens (up to 3 pixels) are rasterized directly into the paint buffer by \ref QCPLineRasterizer instead of
+                                                ///<                QPainter. While this hint is set and OpenGL is disabled, \ref QCPPaintBufferImage is used as paint buffer.
+                    ,phBlitDrag         = 0x010 ///< <tt>0x010</tt> While an axis rect is range dragged, layers in \ref QCPLayer::lmBuffered mode which only hold plottables of that axis rect are scrolled
+                                                ///<                in their paint buffer and only the exposed strip is redrawn. Replots during the drag are coalesced to the screen refresh rate (see \ref QCPAxisRect::mouseMoveEvent).
+                    ,phProgressiveZoom  = 0x020 ///< <tt>0x020</tt> Mouse wheel zooming replots with a coarse, non-antialiased preview (see \ref QCustomPlot::replotCoarse) and refines
+                                                ///<                with a full quality replot once the wheel comes to rest (see \ref QCustomPlot::setRefineDelay).
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -503,6 +523,34 @@ protected:
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPPainter::PainterModes)
 Q_DECLARE_METATYPE(QCPPainter::PainterMode)
 
+
+class QCP_LIB_DECL QCPLineRasterizer
+{
+public:
+  explicit QCPLineRasterizer(QCPPainter *painter);
+  
+  // getters:
+  bool isValid() const { return mValid; }
+  
+  // non-virtual methods:
+  void drawPolyline(const QPointF *points, int pointCount);
+  
+protected:
+  // non-property members:
+  bool mValid;
+  bool mAntialiased;
+  uchar *mBits;
+  int mBytesPerLine;
+  QTransform mTransform;
+  QRect mClipRect;
+  quint32 mColor;
+  double mHalfWidth;
+  
+  // non-virtual methods:
+  void drawSegment(const QPointF &start, const QPointF &end, bool skipStartCap);
+  void blendPixel(quint32 *pixel, int coverage) const;
+};
+
 /* end of 'src/painter.h' */
 
 
@@ -530,6 +578,7 @@ public:
   virtual void donePainting() {}
   virtual void draw(QCPPainter *painter) const = 0;
   virtual void clear(const QColor &color) = 0;
+  virtual bool scroll(const QRect &rect, const QPoint &delta);
   
 protected:
   // property members:
@@ -554,6 +603,7 @@ public:
   virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
   virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
   void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(const QRect &rect, const QPoint &delta) Q_DECL_OVERRIDE;
   
 protected:
   // non-property members:
@@ -564,6 +614,27 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio);
+  virtual ~QCPPaintBufferImage();
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(const QRect &rect, const QPoint &delta) Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  QImage mBuffer;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
@@ -674,7 +745,9 @@ protected:
   
   // non-virtual methods:
   void draw(QCPPainter *painter);
+  void drawExposed(QCPPainter *painter, const QRegion &region);
   void drawToPaintBuffer();
+  void drawScrolledToPaintBuffer(const QRect &rect, const QPoint &delta);
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
   
@@ -1508,6 +1581,18 @@ Q_DECLARE_METATYPE(QCPLineEnding::EndingStyle)
 /* including file 'src/axis/axisticker.h', size 4177                         */
 /* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
+class QCP_LIB_DECL QCPNumberFormatter
+{
+public:
+  static QString toString(double value, const QLocale &locale, QChar formatChar, int precision);
+  static bool findExponent(const QString &text, int *ePos, int *eLast, QString *exponent);
+
+protected:
+  static int writeDigits(double value, char formatChar, int precision, char *buffer);
+  static bool scaledDigits(double absValue, int scaleExponent, qint64 *digits);
+  static int writeInteger(qint64 value, int minDigits, char *buffer);
+};
+
 class QCP_LIB_DECL QCPAxisTicker
 {
   Q_GADGET
@@ -2380,12 +2465,15 @@ public:
   QCPDataContainer();
   
   // getters:
-  int size() const { return mData.size()-mPreallocSize; }
+  int size() const { return mData.size()-mPreallocSize+mPendingSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  int capacity() const { return mCapacity; }
+  int revision() const { return mRevision; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setCapacity(int capacity);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2401,10 +2489,12 @@ public:
   void sort();
   void squeeze(bool preAllocation=true, bool postAllocation=true);
   
-  const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
-  const_iterator constEnd() const { return mData.constEnd(); }
-  iterator begin() { return mData.begin()+mPreallocSize; }
-  iterator end() { return mData.end(); }
+  void mergePendingRuns() { compactForGrowth(mPendingSize); mergePendingRunsLazily(); }
+  
+  const_iterator constBegin() const { if (!mPendingRuns.isEmpty()) mergePendingRunsLazily(); return mData.constBegin()+mPreallocSize; }
+  const_iterator constEnd() const { if (!mPendingRuns.isEmpty()) mergePendingRunsLazily(); return mData.constEnd(); }
+  iterator begin() { ++mRevision; mergePendingRuns(); return mData.begin()+mPreallocSize; }
+  iterator end() { ++mRevision; mergePendingRuns(); return mData.end(); }
   const_iterator findBegin(double sortKey, bool expandedRange=true) const;
   const_iterator findEnd(double sortKey, bool expandedRange=true) const;
   const_iterator at(int index) const { return constBegin()+qBound(0, index, size()); }
@@ -2416,15 +2506,23 @@ public:
 protected:
   // property members:
   bool mAutoSqueeze;
+  int mCapacity;
   
   // non-property memebers:
-  QVector<DataType> mData;
+  mutable QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  mutable QList<QVector<DataType> > mPendingRuns;
+  mutable int mPendingSize;
+  int mRevision;
   
   // non-virtual methods:
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void addPendingRun(const QVector<DataType> &run);
+  void mergePendingRunsLazily() const;
+  void enforceCapacity();
+  void compactForGrowth(int n);
 };
 
 // include implementation in header since it is a class template:
@@ -2452,6 +2550,23 @@ protected:
   specifying that added data is already itself sorted by key, if he can guarantee that this is the
   case (see for example \ref add(const QVector<DataType> &data, bool alreadySorted)).
 
+  Added data which falls between existing keys isn't merged into the sorted data immediately.
+  Instead, it is kept as a sorted run in a small log-structured buffer, where runs of similar size
+  are merged with each other. The buffered runs are merged into the sorted data as a whole by
+  \ref mergePendingRuns, which the plottables call at the start of their draw, or when the buffer
+  grows too large. Many small out-of-order additions between two replots thus cost amortized
+  O(log n) each, instead of moving the existing data on every addition.
+
+  \warning If runs are still pending, the const accessors (\ref constBegin, \ref findBegin, etc.)
+  merge them as a fallback, which modifies the container. Concurrent const access from several
+  threads is thus only safe after calling \ref mergePendingRuns (or after the plottable was drawn)
+  and before adding further data.
+
+  For rolling windows of a fixed number of data points (e.g. strip charts), set a capacity with
+  \ref setCapacity. The container then drops the data points with the smallest keys whenever it
+  holds more than the capacity, and keeps its buffer at twice the capacity. The data stays
+  contiguous, so the iterators work as usual.
+
   The data can be accessed with the provided const iterators (\ref constBegin, \ref constEnd). If
   it is necessary to alter existing data in-place, the non-const iterators can be used (\ref begin,
   \ref end). Changing data members that are not the sort key (for most data types called \a key) is
@@ -2510,11 +2625,36 @@ protected:
   Returns the number of data points in the container.
 */
 
+/*! \fn int QCPDataContainer<DataType>::capacity() const
+  
+  Returns the maximum number of data points held by the container, or 0 if it is unlimited.
+  
+  \see setCapacity
+*/
+
+/*! \fn int QCPDataContainer<DataType>::revision() const
+  
+  Returns a counter that changes whenever the data in this container may have changed, i.e. when
+  data is set, added or removed, or when the non-const iterators (\ref begin, \ref end) are
+  requested. Plottables can compare it with a previously stored value to find out whether data
+  they derived from this container is still up to date.
+*/
+
 /*! \fn bool QCPDataContainer<DataType>::isEmpty() const
   
   Returns whether this container holds no data points.
 */
 
+/*! \fn void QCPDataContainer<DataType>::mergePendingRuns()
+  
+  Merges the data points that were added between existing keys and are still buffered as pending
+  runs into the sorted data. The plottables call this at the start of their draw, so the const
+  accessors don't need to modify the container while drawing.
+  
+  Call this before reading the container from several threads concurrently, see the warning in
+  the class description.
+*/
+
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::constBegin() const
   
   Returns a const iterator to the first data point in this container.
@@ -2568,8 +2708,11 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mCapacity(0),
   mPreallocSize(0),
-  mPreallocIteration(0)
+  mPreallocIteration(0),
+  mPendingSize(0),
+  mRevision(0)
 {
 }
 
@@ -2592,6 +2735,30 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Limits the number of data points in this container to \a capacity. Set \a capacity to 0 (the
+  default) for an unlimited container.
+  
+  Whenever data is added and the container then holds more than \a capacity data points, the data
+  points with the smallest (sort-)keys are dropped. Dropping them as well as \ref removeBefore
+  only move the start of the data inside the internal buffer. The buffer is allocated for twice
+  the capacity, and before added data points would exceed it, the remaining data points are moved
+  back to its start. This costs amortized constant time per added data point and doesn't release
+  memory with auto squeeze (\ref setAutoSqueeze). The buffer is thus never reallocated when
+  adding data, unless a single \ref add call passes more than \a capacity data points. Note that
+  \ref set replaces the buffer.
+  
+  If the container currently holds more than \a capacity data points, the ones with the smallest
+  keys are removed immediately.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setCapacity(int capacity)
+{
+  ++mRevision;
+  mCapacity = qMax(0, capacity);
+  enforceCapacity();
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2617,11 +2784,15 @@ void QCPDataContainer<DataType>::set(const QCPDataContainer<DataType> &data)
 template <class DataType>
 void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool alreadySorted)
 {
+  ++mRevision;
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
+  mPendingRuns.clear();
+  mPendingSize = 0;
   if (!alreadySorted)
     sort();
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2635,23 +2806,29 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
 {
   if (data.isEmpty())
     return;
+  ++mRevision;
   
   const int n = data.size();
-  const int oldSize = size();
+  const int oldSize = mData.size()-mPreallocSize; // size of the sorted data, without pending runs
   
-  if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*constBegin(), *(data.constEnd()-1))) // prepend if new data keys are all smaller than or equal to existing ones
+  if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(mData.constBegin()+mPreallocSize), *(data.constEnd()-1))) // prepend if new data keys are all smaller than or equal to existing ones
   {
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
-  } else // don't need to prepend, so append and merge if necessary
+    std::copy(data.constBegin(), data.constEnd(), mData.begin()+mPreallocSize);
+  } else if (oldSize == 0 || !qcpLessThanSortKey<DataType>(*data.constBegin(), *(mData.constEnd()-1))) // append if new data keys are all greater than or equal to existing ones
   {
+    compactForGrowth(n);
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
-    if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+    std::copy(data.constBegin(), data.constEnd(), mData.end()-n);
+  } else // new data overlaps existing keys, defer the merge
+  {
+    QVector<DataType> run(n);
+    std::copy(data.constBegin(), data.constEnd(), run.begin());
+    addPendingRun(run);
   }
+  enforceCapacity();
 }
 
 /*!
@@ -2660,6 +2837,9 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
   If you can guarantee that the data points in \a data have ascending order with respect to the
   DataType's sort key, set \a alreadySorted to true to avoid an unnecessary sorting run.
   
+  If the keys of \a data overlap with the existing keys, the merge is deferred until the data is
+  accessed next, see the detailed description of this class.
+  
   \see set, remove
 */
 template <class DataType>
@@ -2672,25 +2852,28 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
     set(data, alreadySorted);
     return;
   }
+  ++mRevision;
   
-  const int n = data.size();
-  const int oldSize = size();
+  QVector<DataType> run = data;
+  if (!alreadySorted)
+    std::sort(run.begin(), run.end(), qcpLessThanSortKey<DataType>);
+  const int n = run.size();
+  const int oldSize = mData.size()-mPreallocSize; // size of the sorted data, without pending runs
   
-  if (alreadySorted && oldSize > 0 && !qcpLessThanSortKey<DataType>(*constBegin(), *(data.constEnd()-1))) // prepend if new data is sorted and keys are all smaller than or equal to existing ones
+  if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(mData.constBegin()+mPreallocSize), *(run.constEnd()-1))) // prepend if new data keys are all smaller than or equal to existing ones
   {
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
-  } else // don't need to prepend, so append and then sort and merge if necessary
+    std::copy(run.constBegin(), run.constEnd(), mData.begin()+mPreallocSize);
+  } else if (oldSize == 0 || !qcpLessThanSortKey<DataType>(*run.constBegin(), *(mData.constEnd()-1))) // append if new data keys are all greater than or equal to existing ones
   {
+    compactForGrowth(n);
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
-    if (!alreadySorted) // sort appended subrange if it wasn't already sorted
-      std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
-    if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
-  }
+    std::copy(run.constBegin(), run.constEnd(), mData.end()-n);
+  } else // new data overlaps existing keys, defer the merge
+    addPendingRun(run);
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2702,20 +2885,22 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 template <class DataType>
 void QCPDataContainer<DataType>::add(const DataType &data)
 {
-  if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
+  ++mRevision;
+  if (mData.size() == mPreallocSize || !qcpLessThanSortKey<DataType>(data, *(mData.constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
+    compactForGrowth(1);
     mData.append(data);
-  } else if (qcpLessThanSortKey<DataType>(data, *constBegin()))  // quickly handle prepends using preallocated space
+  } else if (qcpLessThanSortKey<DataType>(data, *(mData.constBegin()+mPreallocSize)))  // quickly handle prepends using preallocated space
   {
     if (mPreallocSize < 1)
       preallocateGrow(1);
     --mPreallocSize;
-    *begin() = data;
-  } else // handle inserts, maintaining sorted keys
+    mData[mPreallocSize] = data;
+  } else // handle inserts as a pending run of one data point, merged later
   {
-    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
-    mData.insert(insertionPoint, data);
+    addPendingRun(QVector<DataType>() << data);
   }
+  enforceCapacity();
 }
 
 /*!
@@ -2800,9 +2985,12 @@ void QCPDataContainer<DataType>::remove(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::clear()
 {
+  ++mRevision;
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
+  mPendingRuns.clear();
+  mPendingSize = 0;
 }
 
 /*!
@@ -3153,8 +3341,14 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
     return;
   
   int newPreallocSize = minimumPreallocSize;
-  newPreallocSize += (1u<<qBound(4, mPreallocIteration+4, 15)) - 12; // do 4 up to 32768-12 preallocation, doubling in each intermediate iteration
-  ++mPreallocIteration;
+  if (mCapacity > 0) // grow only as far as needed, within the buffer of a container with capacity
+  {
+    compactForGrowth(minimumPreallocSize-mPreallocSize);
+  } else
+  {
+    newPreallocSize += (1u<<qBound(4, mPreallocIteration+4, 15)) - 12; // do 4 up to 32768-12 preallocation, doubling in each intermediate iteration
+    ++mPreallocIteration;
+  }
   
   int sizeDifference = newPreallocSize-mPreallocSize;
   mData.resize(mData.size()+sizeDifference);
@@ -3179,6 +3373,8 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
 template <class DataType>
 void QCPDataContainer<DataType>::performAutoSqueeze()
 {
+  if (mCapacity > 0) // a container with capacity keeps its buffer, see setCapacity
+    return;
   const int totalAlloc = mData.capacity();
   const int postAllocSize = totalAlloc-mData.size();
   const int usedSize = size();
@@ -3197,6 +3393,108 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
   if (shrinkPreAllocation || shrinkPostAllocation)
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
+
+/*! \internal
+  
+  Adds the sorted \a run to the pending runs, which hold added data points that overlap the keys of
+  the sorted data and haven't been merged into it yet.
+  
+  The pending runs are kept in decreasing size order: The new run is merged with the most recent
+  runs as long as they are not larger than it. Like in a binary counter, each data point thus takes
+  part in O(log n) run merges. If the pending data points exceed a quarter of the sorted data, all
+  runs are merged into the sorted data with \ref mergePendingRuns.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::addPendingRun(const QVector<DataType> &run)
+{
+  QVector<DataType> newRun = run;
+  while (!mPendingRuns.isEmpty() && mPendingRuns.last().size() <= newRun.size())
+  {
+    const QVector<DataType> olderRun = mPendingRuns.takeLast();
+    QVector<DataType> mergedRun(olderRun.size()+newRun.size());
+    std::merge(olderRun.constBegin(), olderRun.constEnd(), newRun.constBegin(), newRun.constEnd(), mergedRun.begin(), qcpLessThanSortKey<DataType>); // older run first, so equal keys keep their insertion order
+    newRun = mergedRun;
+  }
+  mPendingRuns.append(newRun);
+  mPendingSize += run.size();
+  
+  const int sortedSize = mData.size()-mPreallocSize;
+  if (mPendingSize > qMax(4096, sortedSize/4))
+    mergePendingRuns();
+}
+
+/*! \internal
+  
+  Merges all pending runs (see \ref addPendingRun) into the sorted data. This is the
+  implementation of \ref mergePendingRuns. It is also called by the const accessors (\ref
+  constBegin, \ref constEnd) if runs are still pending, so the container always appears sorted
+  from the outside.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::mergePendingRunsLazily() const
+{
+  if (mPendingRuns.isEmpty())
+    return;
+  
+  QVector<DataType> run = mPendingRuns.takeLast();
+  while (!mPendingRuns.isEmpty())
+  {
+    const QVector<DataType> olderRun = mPendingRuns.takeLast();
+    QVector<DataType> mergedRun(olderRun.size()+run.size());
+    std::merge(olderRun.constBegin(), olderRun.constEnd(), run.constBegin(), run.constEnd(), mergedRun.begin(), qcpLessThanSortKey<DataType>);
+    run = mergedRun;
+  }
+  mPendingSize = 0;
+  
+  const int n = run.size();
+  const int oldSize = mData.size()-mPreallocSize;
+  mData.resize(mData.size()+n);
+  std::copy(run.constBegin(), run.constEnd(), mData.end()-n);
+  if (oldSize > 0 && qcpLessThanSortKey<DataType>(*(mData.constEnd()-n), *(mData.constEnd()-n-1))) // merge the two partitions if the run doesn't simply extend the sorted data
+    std::inplace_merge(mData.begin()+mPreallocSize, mData.end()-n, mData.end(), qcpLessThanSortKey<DataType>);
+}
+
+/*! \internal
+  
+  If a capacity is set (\ref setCapacity), drops the data points with the smallest keys beyond the
+  capacity by moving them into the preallocation pool. The additions make room beforehand with
+  \ref compactForGrowth, so the buffer only exceeds twice the capacity if more than the capacity
+  was added at once. In that case, the data is moved back to the start of the buffer here. If runs
+  are pending, enough room for merging them is left in the buffer.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::enforceCapacity()
+{
+  if (mCapacity <= 0)
+    return;
+  
+  if (size() > mCapacity)
+  {
+    mergePendingRuns();
+    mPreallocSize += size()-mCapacity;
+  }
+  compactForGrowth(mPendingSize); // also leaves room for merging the pending runs later
+  if (mData.capacity() < 2*mCapacity)
+    mData.reserve(2*mCapacity);
+}
+
+/*! \internal
+  
+  If a capacity is set (\ref setCapacity) and \a n more data points wouldn't fit into the buffer of
+  twice the capacity, moves the data back to the start of the buffer, dropping the preallocation
+  pool. This is called before the buffer grows, so it doesn't need to be reallocated.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::compactForGrowth(int n)
+{
+  if (mCapacity <= 0 || mData.size()+n <= 2*mCapacity || mPreallocSize == 0)
+    return;
+  
+  std::copy(mData.begin()+mPreallocSize, mData.end(), mData.begin());
+  mData.resize(mData.size()-mPreallocSize);
+  mPreallocSize = 0;
+  mPreallocIteration = 0;
+}
 /* end of 'src/datacontainer.cpp' */
 
 
@@ -3562,6 +3860,9 @@ class QCP_LIB_DECL QCustomPlot : public QWidget
   Q_PROPERTY(bool noAntialiasingOnDrag READ noAntialiasingOnDrag WRITE setNoAntialiasingOnDrag)
   Q_PROPERTY(Qt::KeyboardModifier multiSelectModifier READ multiSelectModifier WRITE setMultiSelectModifier)
   Q_PROPERTY(bool openGl READ openGl WRITE setOpenGl)
+  Q_PROPERTY(int coarseReplotBudget READ coarseReplotBudget WRITE setCoarseReplotBudget)
+  Q_PROPERTY(int refineDelay READ refineDelay WRITE setRefineDelay)
+  Q_PROPERTY(QCPReplotScheduler* replotScheduler READ replotScheduler WRITE setReplotScheduler)
   /// \endcond
 public:
   /*!
@@ -3607,6 +3908,13 @@ public:
   QCP::SelectionRectMode selectionRectMode() const { return mSelectionRectMode; }
   QCPSelectionRect *selectionRect() const { return mSelectionRect; }
   bool openGl() const { return mOpenGl; }
+  int coarseReplotBudget() const { return mCoarseReplotBudget; }
+  int refineDelay() const { return mRefineDelay; }
+  bool coarseReplot() const { return mCoarseReplot; }
+  QCPReplotScheduler *replotScheduler() const { return mReplotScheduler.data(); }
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  QCPReplotProfiler *replotProfiler() const { return mReplotProfiler; }
+#endif
   
   // setters:
   void setViewport(const QRect &rect);
@@ -3631,6 +3939,9 @@ public:
   void setSelectionRectMode(QCP::SelectionRectMode mode);
   void setSelectionRect(QCPSelectionRect *selectionRect);
   void setOpenGl(bool enabled, int multisampling=16);
+  void setCoarseReplotBudget(int milliseconds);
+  void setRefineDelay(int milliseconds);
+  void setReplotScheduler(QCPReplotScheduler *scheduler);
   
   // non-property methods:
   // plottable interface:
@@ -3696,6 +4007,7 @@ public:
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
+  Q_SLOT void replotCoarse();
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -3745,6 +4057,8 @@ protected:
   QCP::SelectionRectMode mSelectionRectMode;
   QCPSelectionRect *mSelectionRect;
   bool mOpenGl;
+  int mCoarseReplotBudget, mRefineDelay;
+  QPointer<QCPReplotScheduler> mReplotScheduler;
   
   // non-property members:
   QList<QSharedPointer<QCPAbstractPaintBuffer> > mPaintBuffers;
@@ -3754,6 +4068,14 @@ protected:
   QVariant mMouseEventLayerableDetails;
   bool mReplotting;
   bool mReplotQueued;
+  QPointer<QCPAxisRect> mDragScrollAxisRect;
+  bool mDragFrameReplot;
+  bool mCoarseReplot;
+  int mCoarseSampleDensity;
+  QTimer mRefineTimer;
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+  QCPReplotProfiler *mReplotProfiler;
+#endif
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
@@ -3791,7 +4113,7 @@ protected:
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   QList<QCPLayerable*> layerableListAt(const QPointF &pos, bool onlySelectable, QList<QVariant> *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
-  void setupPaintBuffers();
+  void setupPaintBuffers(const QList<QCPLayer*> &preservedLayers=QList<QCPLayer*>());
   QCPAbstractPaintBuffer *createPaintBuffer();
   bool hasInvalidatedPaintBuffers();
   bool setupOpenGl();
@@ -3808,6 +4130,120 @@ protected:
 Q_DECLARE_METATYPE(QCustomPlot::LayerInsertMode)
 Q_DECLARE_METATYPE(QCustomPlot::RefreshPriority)
 
+
+class QCP_LIB_DECL QCPReplotScheduler : public QObject
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(double frameRate READ frameRate WRITE setFrameRate)
+  /// \endcond
+public:
+  explicit QCPReplotScheduler(QObject *parent=0);
+  
+  // getters:
+  double frameRate() const { return mFrameRate; }
+  int renderedFrames() const { return mRenderedFrames; }
+  int skippedFrames() const { return mSkippedFrames; }
+  
+  // setters:
+  void setFrameRate(double frameRate);
+  
+  // non-property methods:
+  void schedule(QCustomPlot *plot);
+  void unschedule(QCustomPlot *plot);
+  bool isScheduled(QCustomPlot *plot) const;
+  void resetFrameCounters();
+  
+protected:
+  // property members:
+  double mFrameRate;
+  
+  // non-property members:
+  QList<QPointer<QCustomPlot> > mScheduledPlots;
+  QTimer mFrameTimer;
+  QElapsedTimer mFrameClock;
+  double mNextFrameTime;
+  int mRenderedFrames, mSkippedFrames;
+  bool mRendering;
+  
+  // non-virtual methods:
+  double frameInterval() const;
+  double frameClockTime() const;
+  Q_SLOT void renderFrame();
+};
+
+
+#ifdef QCUSTOMPLOT_PROFILE_REPLOT
+class QCP_LIB_DECL QCPReplotProfiler
+{
+public:
+  /*!
+    Defines the phases of a replot that are timed separately. Phases may be nested, e.g. the axis
+    ticking is part of the layout phase.
+  */
+  enum Phase { fpLayout          ///< Layout update (\ref QCustomPlot::updateLayout), including axis ticking
+               ,fpAxisTicks      ///< Tick generation of all axes (\ref QCPAxisTicker::generate)
+               ,fpPaintBuffers   ///< Setup and clearing of the paint buffers
+               ,fpLayers         ///< Drawing of all layers into their paint buffers
+               ,fpMapImages      ///< Updates of color map images (\ref QCPColorMap), part of \ref fpLayers
+               ,fpPaintEvent     ///< Compositing of the paint buffers onto the widget surface in a paint event
+             };
+  static const int phaseCount = fpPaintEvent+1;
+  
+  explicit QCPReplotProfiler(int historySize=120);
+  
+  // getters:
+  int historySize() const { return mHistorySize; }
+  bool overlayVisible() const { return mOverlayVisible; }
+  
+  // setters:
+  void setHistorySize(int frames);
+  void setOverlayVisible(bool visible);
+  
+  // non-property methods:
+  QVector<double> frameTimes() const;
+  QVector<double> phaseTimes(Phase phase) const;
+  QVector<double> layerableTimes(QCPLayerable *layerable) const;
+  QList<QCPLayerable*> layerables() const;
+  void clear();
+  bool saveCsv(const QString &fileName) const;
+  
+  // recording interface, used by QCustomPlot and layerables:
+  void beginFrame();
+  void endFrame(qint64 nanoseconds);
+  void addPhaseTime(Phase phase, qint64 nanoseconds);
+  void addLayerableTime(QCPLayerable *layerable, qint64 nanoseconds);
+  
+  void drawOverlay(QCPPainter *painter, const QRect &viewport) const;
+  
+protected:
+  struct TimingHistory
+  {
+    TimingHistory() : next(0), count(0) {}
+    QVector<double> times; // in milliseconds
+    int next, count;
+    QPointer<QCPLayerable> layerable;
+  };
+  
+  // property members:
+  int mHistorySize;
+  bool mOverlayVisible;
+  
+  // non-property members:
+  TimingHistory mFrameHistory;
+  TimingHistory mPhaseHistories[phaseCount];
+  QHash<QCPLayerable*, TimingHistory> mLayerableHistories;
+  qint64 mFramePhaseTimes[phaseCount];
+  
+  // non-virtual methods:
+  void pushTime(TimingHistory *history, qint64 nanoseconds) const;
+  QVector<double> historyTimes(const TimingHistory &history) const;
+  static double averageTime(const QVector<double> &times);
+  static QString phaseName(Phase phase);
+  static QString layerableName(QCPLayerable *layerable);
+};
+#endif // QCUSTOMPLOT_PROFILE_REPLOT
+
 /* end of 'src/core.h' */
 
 
@@ -4337,11 +4773,24 @@ void QCPAbstractPlottable1D<DataType>::getDataSegments(QList<QCPDataRange> &sele
 
   Further it uses a faster line drawing technique based on \ref QCPPainter::drawLine rather than \c
   QPainter::drawPolyline if the configured \ref QCustomPlot::setPlottingHints() and \a painter
-  style allows.
+  style allows. If the plotting hint \ref QCP::phRasterLines is set, thin solid lines are
+  rasterized directly into the paint buffer by \ref QCPLineRasterizer.
 */
 template <class DataType>
 void QCPAbstractPlottable1D<DataType>::drawPolyline(QCPPainter *painter, const QVector<QPointF> &lineData) const
 {
+  // if drawing thin solid line into a raster image buffer, bypass QPainter entirely:
+  if (mParentPlot->plottingHints().testFlag(QCP::phRasterLines) &&
+      !painter->modes().testFlag(QCPPainter::pmVectorized) &&
+      !painter->modes().testFlag(QCPPainter::pmNoCaching))
+  {
+    QCPLineRasterizer rasterizer(painter);
+    if (rasterizer.isValid())
+    {
+      rasterizer.drawPolyline(lineData.constData(), lineData.size());
+      return;
+    }
+  }
   // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
   if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
       painter->pen().style() == Qt::SolidLine &&
@@ -4643,6 +5092,10 @@ protected:
   QPoint mDragStart;
   bool mDragging;
   QHash<QCPAxis::AxisType, QList<QCPAxis*> > mAxes;
+  QPoint mDragLastPos, mDragRenderedPos;
+  QTimer mDragFrameTimer;
+  QElapsedTimer mDragFrameClock;
+  int mDragFrameInterval;
   
   // reimplemented virtual methods:
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const Q_DECL_OVERRIDE;
@@ -4658,6 +5111,8 @@ protected:
   // non-property methods:
   void drawBackground(QCPPainter *painter);
   void updateAxesOffset(QCPAxis::AxisType type);
+  QList<QCPLayer*> dragScrollLayers(QPoint *delta) const;
+  Q_SLOT void dragFrame();
   
 private:
   Q_DISABLE_COPY(QCPAxisRect)
@@ -5116,6 +5571,43 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCP_LIB_DECL QCPGraphDataSource
+{
+public:
+  QCPGraphDataSource();
+  virtual ~QCPGraphDataSource();
+  
+  // getters:
+  int revision() const { return mRevision; }
+  
+  // introduced virtual methods:
+  virtual int size() const = 0;
+  virtual const double *keys() const = 0;
+  virtual const double *values() const = 0;
+  
+  // non-virtual methods:
+  void dataChanged();
+  
+protected:
+  // non-property members:
+  int mRevision;
+};
+
+class QCP_LIB_DECL QCPVectorGraphDataSource : public QCPGraphDataSource
+{
+public:
+  QCPVectorGraphDataSource(const QVector<double> *keys, const QVector<double> *values);
+  
+  // reimplemented virtual methods:
+  virtual int size() const Q_DECL_OVERRIDE { return qMin(mKeys->size(), mValues->size()); }
+  virtual const double *keys() const Q_DECL_OVERRIDE { return mKeys->constData(); }
+  virtual const double *values() const Q_DECL_OVERRIDE { return mValues->constData(); }
+  
+protected:
+  // non-property members:
+  const QVector<double> *mKeys, *mValues;
+};
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5152,10 +5644,12 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  QSharedPointer<QCPGraphDataSource> dataSource() const { return mDataSource; }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
   void setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void setDataSource(QSharedPointer<QCPGraphDataSource> source);
   void setLineStyle(LineStyle ls);
   void setScatterStyle(const QCPScatterStyle &style);
   void setScatterSkip(int skip);
@@ -5170,6 +5664,15 @@ public:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual int dataCount() const Q_DECL_OVERRIDE;
+  virtual double dataMainKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataSortKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataMainValue(int index) const Q_DECL_OVERRIDE;
+  virtual QCPRange dataValueRange(int index) const Q_DECL_OVERRIDE;
+  virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
+  virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
+  virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
   
 protected:
   // property members:
@@ -5178,6 +5681,11 @@ protected:
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  QSharedPointer<QCPGraphDataSource> mDataSource;
+  
+  // non-property members:
+  mutable int mDataSourceRevision;
+  mutable QPolygonF mChannelFillPolygon;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5206,17 +5714,154 @@ protected:
   QPointF lowerFillBasePoint(double lowerKey) const;
   QPointF upperFillBasePoint(double upperKey) const;
   const QPolygonF getChannelFillPolygon(const QVector<QPointF> *lines) const;
-  int findIndexBelowX(const QVector<QPointF> *data, double x) const;
-  int findIndexAboveX(const QVector<QPointF> *data, double x) const;
-  int findIndexBelowY(const QVector<QPointF> *data, double y) const;
-  int findIndexAboveY(const QVector<QPointF> *data, double y) const;
+  bool appendChannelFillLine(QPolygonF *polygon, const QVector<QPointF> &line, double lowKey, double highKey, bool keyIsX, bool reversed) const;
   double pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const;
+  double sourcePointDistance(const QPointF &pixelPoint, int &closestIndex) const;
+  double lineDistanceSqr(const QPointF &pixelPoint) const;
+  void getSourceData(QVector<QCPGraphData> *data, const QCPDataRange &dataRange, int indexModulo) const;
+  void checkDataSource() const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
 };
 Q_DECLARE_METATYPE(QCPGraph::LineStyle)
 
+
+class QCP_LIB_DECL QCPBandData
+{
+public:
+  QCPBandData();
+  QCPBandData(double key, double value, double lower, double upper);
+  
+  inline double sortKey() const { return key; }
+  inline static QCPBandData fromSortKey(double sortKey) { return QCPBandData(sortKey, 0, 0, 0); }
+  inline static bool sortKeyIsMainKey() { return true; }
+  
+  inline double mainKey() const { return key; }
+  inline double mainValue() const { return value; }
+  
+  inline QCPRange valueRange() const
+  {
+    QCPRange result(lower, upper);
+    result.expand(value);
+    return result;
+  }
+  
+  double key, value, lower, upper;
+};
+Q_DECLARE_TYPEINFO(QCPBandData, Q_PRIMITIVE_TYPE);
+
+
+/*! \typedef QCPBandDataContainer
+  
+  Container for storing \ref QCPBandData points. The data is stored sorted by \a key.
+  
+  This template instantiation is the container in which QCPBand holds its data. For details about
+  the generic container, see the documentation of the class template \ref QCPDataContainer.
+  
+  \see QCPBandData, QCPBand::setData
+*/
+typedef QCPDataContainer<QCPBandData> QCPBandDataContainer;
+
+class QCP_LIB_DECL QCPBandDataSource : public QCPGraphDataSource
+{
+public:
+  // introduced virtual methods:
+  virtual const double *lower() const = 0;
+  virtual const double *upper() const = 0;
+};
+
+class QCP_LIB_DECL QCPVectorBandDataSource : public QCPBandDataSource
+{
+public:
+  QCPVectorBandDataSource(const QVector<double> *keys, const QVector<double> *values, const QVector<double> *lower, const QVector<double> *upper);
+  
+  // reimplemented virtual methods:
+  virtual int size() const Q_DECL_OVERRIDE { return qMin(qMin(mKeys->size(), mValues->size()), qMin(mLower->size(), mUpper->size())); }
+  virtual const double *keys() const Q_DECL_OVERRIDE { return mKeys->constData(); }
+  virtual const double *values() const Q_DECL_OVERRIDE { return mValues->constData(); }
+  virtual const double *lower() const Q_DECL_OVERRIDE { return mLower->constData(); }
+  virtual const double *upper() const Q_DECL_OVERRIDE { return mUpper->constData(); }
+  
+protected:
+  // non-property members:
+  const QVector<double> *mKeys, *mValues, *mLower, *mUpper;
+};
+
+class QCP_LIB_DECL QCPBand : public QCPAbstractPlottable1D<QCPBandData>
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QPen boundsPen READ boundsPen WRITE setBoundsPen)
+  Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  /// \endcond
+public:
+  explicit QCPBand(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  
+  // getters:
+  QSharedPointer<QCPBandDataContainer> data() const { return mDataContainer; }
+  QPen boundsPen() const { return mBoundsPen; }
+  QCPScatterStyle scatterStyle() const { return mScatterStyle; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
+  QSharedPointer<QCPBandDataSource> dataSource() const { return mDataSource; }
+  
+  // setters:
+  void setData(QSharedPointer<QCPBandDataContainer> data);
+  void setData(const QVector<double> &keys, const QVector<double> &values, const QVector<double> &lower, const QVector<double> &upper, bool alreadySorted=false);
+  void setDataSource(QSharedPointer<QCPBandDataSource> source);
+  void setBoundsPen(const QPen &pen);
+  void setScatterStyle(const QCPScatterStyle &style);
+  void setAdaptiveSampling(bool enabled);
+  
+  // non-property methods:
+  void addData(const QVector<double> &keys, const QVector<double> &values, const QVector<double> &lower, const QVector<double> &upper, bool alreadySorted=false);
+  void addData(double key, double value, double lower, double upper);
+  
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual int dataCount() const Q_DECL_OVERRIDE;
+  virtual double dataMainKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataSortKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataMainValue(int index) const Q_DECL_OVERRIDE;
+  virtual QCPRange dataValueRange(int index) const Q_DECL_OVERRIDE;
+  virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
+  virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
+  virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  
+protected:
+  // property members:
+  QPen mBoundsPen;
+  QCPScatterStyle mScatterStyle;
+  bool mAdaptiveSampling;
+  QSharedPointer<QCPBandDataSource> mDataSource;
+  
+  // non-property members:
+  mutable int mDataSourceRevision;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  
+  // introduced virtual methods:
+  virtual void drawFill(QCPPainter *painter, const QVector<QPointF> &lowerLine, const QVector<QPointF> &upperLine) const;
+  virtual void getOptimizedData(QVector<QCPBandData> *data, const QCPBandDataContainer::const_iterator &begin, const QCPBandDataContainer::const_iterator &end) const;
+  virtual void getOptimizedScatterData(QVector<QCPBandData> *data, const QCPBandDataContainer::const_iterator &begin, const QCPBandDataContainer::const_iterator &end) const;
+  
+  // non-virtual methods:
+  void getVisibleDataBounds(QCPBandDataContainer::const_iterator &begin, QCPBandDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
+  void getLines(QVector<QPointF> *valueLine, QVector<QPointF> *lowerLine, QVector<QPointF> *upperLine, const QCPDataRange &dataRange) const;
+  QVector<QPolygonF> getFillPolygons(const QVector<QPointF> &lowerLine, const QVector<QPointF> &upperLine) const;
+  void getSourceData(QVector<QCPBandData> *data, const QCPDataRange &dataRange, bool scatterData) const;
+  void checkDataSource() const;
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
 /* end of 'src/plottables/plottable-graph.h' */
 
 
@@ -5262,6 +5907,7 @@ class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable1D<QCPCurveData>
   Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
   Q_PROPERTY(int scatterSkip READ scatterSkip WRITE setScatterSkip)
   Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   /*!
@@ -5282,6 +5928,7 @@ public:
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   int scatterSkip() const { return mScatterSkip; }
   LineStyle lineStyle() const { return mLineStyle; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPCurveDataContainer> data);
@@ -5290,6 +5937,7 @@ public:
   void setScatterStyle(const QCPScatterStyle &style);
   void setScatterSkip(int skip);
   void setLineStyle(LineStyle style);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -5302,11 +5950,19 @@ public:
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
+  static const int chunkSize = 256; ///< the number of consecutive data points whose bounding box is stored in the chunk index, see \ref updateChunkBounds
+  
 protected:
   // property members:
   QCPScatterStyle mScatterStyle;
   int mScatterSkip;
   LineStyle mLineStyle;
+  bool mAdaptiveSampling;
+  
+  // non-property members:
+  mutable QVector<QCPRange> mChunkKeyBounds, mChunkValueBounds;
+  mutable const QCPCurveDataContainer *mChunkBoundsContainer;
+  mutable int mChunkBoundsRevision;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5326,6 +5982,7 @@ protected:
   bool getTraverse(double prevKey, double prevValue, double key, double value, double keyMin, double valueMax, double keyMax, double valueMin, QPointF &crossA, QPointF &crossB) const;
   void getTraverseCornerPoints(int prevRegion, int currentRegion, double keyMin, double valueMax, double keyMax, double valueMin, QVector<QPointF> &beforeTraverse, QVector<QPointF> &afterTraverse) const;
   double pointDistance(const QPointF &pixelPoint, QCPCurveDataContainer::const_iterator &closestData) const;
+  void updateChunkBounds() const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -5443,6 +6100,7 @@ class QCP_LIB_DECL QCPBars : public QCPAbstractPlottable1D<QCPBarsData>
   Q_PROPERTY(QCPBarsGroup* barsGroup READ barsGroup WRITE setBarsGroup)
   Q_PROPERTY(double baseValue READ baseValue WRITE setBaseValue)
   Q_PROPERTY(double stackingGap READ stackingGap WRITE setStackingGap)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   Q_PROPERTY(QCPBars* barBelow READ barBelow)
   Q_PROPERTY(QCPBars* barAbove READ barAbove)
   /// \endcond
@@ -5468,6 +6126,7 @@ public:
   QCPBarsGroup *barsGroup() const { return mBarsGroup; }
   double baseValue() const { return mBaseValue; }
   double stackingGap() const { return mStackingGap; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   QCPBars *barBelow() const { return mBarBelow.data(); }
   QCPBars *barAbove() const { return mBarAbove.data(); }
   QSharedPointer<QCPBarsDataContainer> data() const { return mDataContainer; }
@@ -5480,6 +6139,7 @@ public:
   void setBarsGroup(QCPBarsGroup *barsGroup);
   void setBaseValue(double baseValue);
   void setStackingGap(double pixels);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -5501,8 +6161,14 @@ protected:
   QCPBarsGroup *mBarsGroup;
   double mBaseValue;
   double mStackingGap;
+  bool mAdaptiveSampling;
   QPointer<QCPBars> mBarBelow, mBarAbove;
   
+  // non-property members:
+  mutable QVector<double> mStackedBases;
+  mutable QVector<QPair<const QCPBarsDataContainer*, int> > mStackedBasesState;
+  mutable double mStackedBasesBaseValue;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
@@ -5510,8 +6176,12 @@ protected:
   // non-virtual methods:
   void getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin, QCPBarsDataContainer::const_iterator &end) const;
   QRectF getBarRect(double key, double value) const;
+  QRectF getBarRect(double key, double value, double base) const;
+  void getBarRects(QVector<QRectF> *rects, const QCPBarsDataContainer::const_iterator &begin, const QCPBarsDataContainer::const_iterator &end) const;
   void getPixelWidth(double key, double &lower, double &upper) const;
   double getStackedBaseValue(double key, bool positive) const;
+  double getStackedBaseValueAt(int index) const;
+  void updateStackedBases() const;
   static void connectBars(QCPBars* lower, QCPBars* upper);
   
   friend class QCustomPlot;
@@ -5611,6 +6281,12 @@ public:
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
+  // static methods:
+  static QCPStatisticalBoxDataContainer samplesToBoxes(const QVector<double> &keys, const QVector<QVector<double> > &samples, int firstSample=0, double whiskerFactor=1.5);
+  static QCPStatisticalBoxData samplesToBox(double key, double *samples, int count, double whiskerFactor=1.5);
+  
+  static const int minimumChunkSamples = 65536; ///< samples converted at once are only split into parallel chunks of at least this size
+  
 protected:
   // property members:
   double mWidth;
@@ -5632,11 +6308,54 @@ protected:
   QRectF getQuartileBox(QCPStatisticalBoxDataContainer::const_iterator it) const;
   QVector<QLineF> getWhiskerBackboneLines(QCPStatisticalBoxDataContainer::const_iterator it) const;
   QVector<QLineF> getWhiskerBarLines(QCPStatisticalBoxDataContainer::const_iterator it) const;
+  static double partitionedQuantile(double *samples, int begin, int end, double position);
   
   friend class QCustomPlot;
   friend class QCPLegend;
 };
 
+class QCP_LIB_DECL QCPQuantileSketch
+{
+public:
+  explicit QCPQuantileSketch(int accuracy=200, quint32 seed=0);
+  
+  // getters:
+  int accuracy() const { return mAccuracy; }
+  qint64 count() const { return mCount; }
+  bool isEmpty() const { return mCount == 0; }
+  double minimum() const { return mMinimum; }
+  double maximum() const { return mMaximum; }
+  int retainedCount() const;
+  
+  // non-property methods:
+  void addValue(double value);
+  void addValues(const QVector<double> &values);
+  void merge(const QCPQuantileSketch &other);
+  void clear();
+  double quantile(double fraction) const;
+  double rank(double value) const;
+  QVector<double> histogram(const QCPRange &range, int binCount) const;
+  QCPStatisticalBoxData box(double key, double whiskerFactor=1.5) const;
+  
+protected:
+  // property members:
+  int mAccuracy;
+  
+  // non-property members:
+  qint64 mCount;
+  double mMinimum, mMaximum;
+  QVector<QVector<double> > mLevels;
+  quint32 mRandomState;
+  
+  // non-virtual methods:
+  int levelCapacity(int level) const;
+  void compress();
+  void compactLevel(int level);
+  QVector<QPair<double, qint64> > cumulativeItems() const;
+  double valueAtPosition(const QVector<QPair<double, qint64> > &items, double position) const;
+  double valueAtRank(const QVector<QPair<double, qint64> > &items, qint64 rank) const;
+};
+
 /* end of 'src/plottables/plottable-statisticalbox.h' */
 
 
@@ -5646,6 +6365,13 @@ protected:
 class QCP_LIB_DECL QCPColorMapData
 {
 public:
+  /*!
+    Defines the precision in which the cells are stored (see \ref setCellType).
+  */
+  enum CellType { ctDouble ///< Cells are stored as 64 bit doubles
+                  ,ctFloat ///< Cells are stored as 32 bit floats, which halves the memory footprint
+                };
+  
   QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange);
   ~QCPColorMapData();
   QCPColorMapData(const QCPColorMapData &other);
@@ -5657,6 +6383,8 @@ public:
   QCPRange keyRange() const { return mKeyRange; }
   QCPRange valueRange() const { return mValueRange; }
   QCPRange dataBounds() const { return mDataBounds; }
+  CellType cellType() const { return mCellType; }
+  QString backingFile() const { return mFile ? mFile->fileName() : QString(); }
   double data(double key, double value);
   double cell(int keyIndex, int valueIndex);
   unsigned char alpha(int keyIndex, int valueIndex);
@@ -5668,9 +6396,14 @@ public:
   void setRange(const QCPRange &keyRange, const QCPRange &valueRange);
   void setKeyRange(const QCPRange &keyRange);
   void setValueRange(const QCPRange &valueRange);
+  void setCellType(CellType type);
+  bool setBackingFile(const QString &fileName);
   void setData(double key, double value, double z);
   void setCell(int keyIndex, int valueIndex, double z);
+  void setCells(int keyIndex, int valueIndex, const double *z, int count);
+  void setCells(int keyIndex, int valueIndex, const float *z, int count);
   void setAlpha(int keyIndex, int valueIndex, unsigned char alpha);
+  void setAlphas(int keyIndex, int valueIndex, const unsigned char *alpha, int count);
   
   // non-property methods:
   void recalculateDataBounds();
@@ -5679,22 +6412,49 @@ public:
   void fill(double z);
   void fillAlpha(unsigned char alpha);
   bool isEmpty() const { return mIsEmpty; }
+  bool hasAlpha() const { return mHasAlpha; }
   void coordToCell(double key, double value, int *keyIndex, int *valueIndex) const;
   void cellToCoord(int keyIndex, int valueIndex, double *key, double *value) const;
+  void readCells(int keyIndex, int valueIndex, int count, double *z, unsigned char *alphas=0) const;
+  void cellsAlongKey(int valueIndex, const int *keyIndices, int count, double *values, unsigned char *alphas=0) const;
+  void cellsAlongValue(int keyIndex, const int *valueIndices, int count, double *values, unsigned char *alphas=0) const;
+  
+  static const int tileShift = 8; ///< the cells are stored in square tiles with an edge length of 2^tileShift cells
   
 protected:
   // property members:
   int mKeySize, mValueSize;
   QCPRange mKeyRange, mValueRange;
   bool mIsEmpty;
+  CellType mCellType;
   
   // non-property members:
-  double *mData;
-  unsigned char *mAlpha;
+  QVector<char*> mTiles;
+  QVector<unsigned char*> mAlphaTiles;
+  int mTileColumns, mTileRows;
+  double mFillValue;
+  unsigned char mFillAlpha;
+  bool mHasAlpha;
+  QFile *mFile;
+  uchar *mFileMap;
   QCPRange mDataBounds;
   bool mDataModified;
   
   bool createAlpha(bool initializeOpaque=true);
+  void reallocate(bool keepFileContent=false);
+  void freeTiles();
+  void freeAlphaTiles();
+  bool mapFile(bool keepContent);
+  char *writableTile(int tileIndex);
+  unsigned char *writableAlphaTile(int tileIndex);
+  int tileIndex(int keyIndex, int valueIndex) const { return (valueIndex>>tileShift)*mTileColumns + (keyIndex>>tileShift); }
+  int tileWidth(int tileIndex) const { return qMin(1<<tileShift, mKeySize-(tileIndex%mTileColumns << tileShift)); }
+  int tileHeight(int tileIndex) const { return qMin(1<<tileShift, mValueSize-(tileIndex/mTileColumns << tileShift)); }
+  int cellOffset(int keyIndex, int valueIndex) const { return (valueIndex & ((1<<tileShift)-1))*tileWidth(tileIndex(keyIndex, valueIndex)) + (keyIndex & ((1<<tileShift)-1)); }
+  int cellBytes() const { return mCellType == ctFloat ? int(sizeof(float)) : int(sizeof(double)); }
+  template <typename T> void writeCells(int keyIndex, int valueIndex, const T *z, int count);
+  double tileCell(const char *tile, int offset) const { return mCellType == ctFloat ? reinterpret_cast<const float*>(tile)[offset] : reinterpret_cast<const double*>(tile)[offset]; }
+  void setTileCell(char *tile, int offset, double z) { if (mCellType == ctFloat) reinterpret_cast<float*>(tile)[offset] = z; else reinterpret_cast<double*>(tile)[offset] = z; }
   
   friend class QCPColorMap;
 };
@@ -5710,8 +6470,20 @@ class QCP_LIB_DECL QCPColorMap : public QCPAbstractPlottable
   Q_PROPERTY(bool interpolate READ interpolate WRITE setInterpolate)
   Q_PROPERTY(bool tightBoundary READ tightBoundary WRITE setTightBoundary)
   Q_PROPERTY(QCPColorScale* colorScale READ colorScale WRITE setColorScale)
+  Q_PROPERTY(MipReduction mipReduction READ mipReduction WRITE setMipReduction)
   /// \endcond
 public:
+  /*!
+    Defines how cells are combined when the color map is zoomed out so far that multiple cells fall
+    onto one pixel.
+    
+    \see setMipReduction
+  */
+  enum MipReduction { mrMean     ///< The pixel shows the mean of the combined cells
+                      ,mrMaximum ///< The pixel shows the maximum of the combined cells, so isolated peaks remain visible
+                    };
+  Q_ENUMS(MipReduction)
+  
   explicit QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis);
   virtual ~QCPColorMap();
   
@@ -5723,6 +6495,7 @@ public:
   bool tightBoundary() const { return mTightBoundary; }
   QCPColorGradient gradient() const { return mGradient; }
   QCPColorScale *colorScale() const { return mColorScale.data(); }
+  MipReduction mipReduction() const { return mMipReduction; }
   
   // setters:
   void setData(QCPColorMapData *data, bool copy=false);
@@ -5732,6 +6505,7 @@ public:
   void setInterpolate(bool enabled);
   void setTightBoundary(bool enabled);
   void setColorScale(QCPColorScale *colorScale);
+  void setMipReduction(MipReduction reduction);
   
   // non-property methods:
   void rescaleDataRange(bool recalculateDataBounds=false);
@@ -5756,11 +6530,16 @@ protected:
   bool mInterpolate;
   bool mTightBoundary;
   QPointer<QCPColorScale> mColorScale;
+  MipReduction mMipReduction;
   
   // non-property members:
-  QImage mMapImage, mUndersampledMapImage;
+  QImage mMapImage;
+  QRectF mMapImageRect, mMapImageBounds;
+  QRect mMapImageClipRect;
+  double mMapImageResolution;
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
+  QMap<QPair<int, int>, QCPColorMapData*> mMipLevels;
   
   // introduced virtual methods:
   virtual void updateMapImage();
@@ -5769,9 +6548,19 @@ protected:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
+  // non-virtual methods:
+  QRectF mapImageBounds() const;
+  void renderMapImage(QImage *image, const QRectF &bounds, const QRectF &target, const QSize &size);
+  int sampleMapCells(int *cells, int pixelCount, double offset, double extent, double boundsExtent, int cellCount, bool reversed) const;
+  int mapImageGridSpan(double boundsStart, double boundsExtent, double visibleStart, double visibleEnd, int cellCount, bool reversed, double *targetStart, double *targetEnd) const;
+  const QCPColorMapData *mipLevel(int keyLevel, int valueLevel);
+  QCPColorMapData *createMipLevel(const QCPColorMapData *source, int keyReduction, int valueReduction) const;
+  void clearMipLevels();
+  
   friend class QCustomPlot;
   friend class QCPLegend;
 };
+Q_DECLARE_METATYPE(QCPColorMap::MipReduction)
 
 /* end of 'src/plottables/plottable-colormap.h' */
 
@@ -5822,6 +6611,7 @@ class QCP_LIB_DECL QCPFinancial : public QCPAbstractPlottable1D<QCPFinancialData
   Q_PROPERTY(QBrush brushNegative READ brushNegative WRITE setBrushNegative)
   Q_PROPERTY(QPen penPositive READ penPositive WRITE setPenPositive)
   Q_PROPERTY(QPen penNegative READ penNegative WRITE setPenNegative)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   /*!
@@ -5859,6 +6649,7 @@ public:
   QBrush brushNegative() const { return mBrushNegative; }
   QPen penPositive() const { return mPenPositive; }
   QPen penNegative() const { return mPenNegative; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPFinancialDataContainer> data);
@@ -5871,6 +6662,7 @@ public:
   void setBrushNegative(const QBrush &brush);
   void setPenPositive(const QPen &pen);
   void setPenNegative(const QPen &pen);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &open, const QVector<double> &high, const QVector<double> &low, const QVector<double> &close, bool alreadySorted=false);
@@ -5893,6 +6685,10 @@ protected:
   bool mTwoColored;
   QBrush mBrushPositive, mBrushNegative;
   QPen mPenPositive, mPenNegative;
+  bool mAdaptiveSampling;
+  
+  // non-property members:
+  QVector<QCPFinancialData> mMergedData;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5902,6 +6698,7 @@ protected:
   void drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, bool isSelected);
   void drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, bool isSelected);
   double getPixelWidth(double key, double keyPixel) const;
+  bool getOptimizedData(QVector<QCPFinancialData> *mergedData, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end) const;
   double ohlcSelectTest(const QPointF &pos, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, QCPFinancialDataContainer::const_iterator &closestDataPoint) const;
   double candlestickSelectTest(const QPointF &pos, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, QCPFinancialDataContainer::const_iterator &closestDataPoint) const;
   void getVisibleDataBounds(QCPFinancialDataContainer::const_iterator &begin, QCPFinancialDataContainer::const_iterator &end) const;
@@ -5912,6 +6709,44 @@ protected:
 };
 Q_DECLARE_METATYPE(QCPFinancial::ChartStyle)
 
+
+class QCP_LIB_DECL QCPFinancialAggregator
+{
+public:
+  explicit QCPFinancialAggregator(double timeBinOffset=0);
+  
+  // getters:
+  double timeBinOffset() const { return mTimeBinOffset; }
+  QList<double> timeBinSizes() const { return mTimeframes.keys(); }
+  QSharedPointer<QCPFinancialDataContainer> data(double timeBinSize) const { return mTimeframes.value(timeBinSize); }
+  
+  // non-property methods:
+  void addTimeframe(double timeBinSize);
+  void removeTimeframe(double timeBinSize);
+  void addTick(double time, double value);
+  void addTicks(const QVector<double> &time, const QVector<double> &value, bool alreadySorted=false);
+  void clear();
+  
+  // static methods:
+  static void aggregate(const double *time, const double *value, int count, double timeBinSize, double timeBinOffset, QVector<QCPFinancialData> *bars);
+  
+  static const int minimumChunkTicks = 65536; ///< ticks added at once are only split into parallel chunks of at least this size
+  
+protected:
+  // property members:
+  double mTimeBinOffset;
+  QMap<double, QSharedPointer<QCPFinancialDataContainer> > mTimeframes;
+  
+  // non-property members:
+  double mLastTickTime;
+  bool mHaveTicks;
+  
+  // non-virtual methods:
+  void appendBars(QCPFinancialDataContainer *data, const QVector<QCPFinancialData> &bars);
+  static void foldBar(QCPFinancialData &bar, const QCPFinancialData &laterBar);
+  static bool lessThanTickTime(const QPair<double, double> &a, const QPair<double, double> &b);
+};
+
 /* end of 'src/plottables/plottable-financial.h' */
 
 
@@ -5956,6 +6791,7 @@ class QCP_LIB_DECL QCPErrorBars : public QCPAbstractPlottable, public QCPPlottab
   Q_PROPERTY(ErrorType errorType READ errorType WRITE setErrorType)
   Q_PROPERTY(double whiskerWidth READ whiskerWidth WRITE setWhiskerWidth)
   Q_PROPERTY(double symbolGap READ symbolGap WRITE setSymbolGap)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   
@@ -5978,6 +6814,7 @@ public:
   ErrorType errorType() const { return mErrorType; }
   double whiskerWidth() const { return mWhiskerWidth; }
   double symbolGap() const { return mSymbolGap; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPErrorBarsDataContainer> data);
@@ -5987,6 +6824,7 @@ public:
   void setErrorType(ErrorType type);
   void setWhiskerWidth(double pixels);
   void setSymbolGap(double pixels);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &error);
@@ -6017,6 +6855,10 @@ protected:
   ErrorType mErrorType;
   double mWhiskerWidth;
   double mSymbolGap;
+  bool mAdaptiveSampling;
+  
+  // non-property members:
+  QVector<QLineF> mBackbones, mWhiskers;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -6026,11 +6868,14 @@ protected:
   
   // non-virtual methods:
   void getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
+  void getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, const QPointF &centerPixel, bool withWhiskers, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
+  void getOptimizedErrorBarLines(const QCPErrorBarsDataContainer::const_iterator &begin, const QCPErrorBarsDataContainer::const_iterator &end, bool checkPointVisibility, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
   void getVisibleDataBounds(QCPErrorBarsDataContainer::const_iterator &begin, QCPErrorBarsDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   double pointDistance(const QPointF &pixelPoint, QCPErrorBarsDataContainer::const_iterator &closestData) const;
   // helpers:
   void getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments) const;
   bool errorBarVisible(int index) const;
+  bool errorBarVisible(int index, const QPointF &centerPixel) const;
   bool rectIntersectsLine(const QRectF &pixelRect, const QLineF &line) const;
   
   friend class QCustomPlot;